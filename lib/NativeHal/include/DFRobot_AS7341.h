@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+
+// Fake of the DFRobot AS7341 driver. Counts follow the spectrum set with
+// native_setSpectrum() (given at AGAIN 4, ATIME 29, ASTEP 599), scaled by
+// gain and integration time, clipped at full scale, with 1 % noise. A
+// measurement completes after the real integration time.
+class DFRobot_AS7341 {
+public:
+    typedef enum { eSpm = 0, eSyns = 1, eSynd = 3 } eMode_t;
+    typedef enum { eF1F4ClearNIR = 0, eF5F8ClearNIR = 1 } eChChoose_t;
+
+    typedef struct {
+        uint16_t ADF1, ADF2, ADF3, ADF4, ADCLEAR, ADNIR;
+    } sModeOneData_t;
+    typedef struct {
+        uint16_t ADF5, ADF6, ADF7, ADF8, ADCLEAR, ADNIR;
+    } sModeTwoData_t;
+
+    int begin(eMode_t mode = eSpm);
+    void setAGAIN(uint8_t value) { again = value; }
+    void setAtime(uint8_t value) { atime = value; }
+    void setAstep(uint16_t value) { astep = value; }
+    void setWtime(uint8_t value) { (void)value; }
+
+    void startMeasure(eChChoose_t group);
+    bool measureComplete();
+    sModeOneData_t readSpectralDataOne();
+    sModeTwoData_t readSpectralDataTwo();
+
+private:
+    uint16_t channel(int index);
+
+    uint8_t  again = 4;
+    uint8_t  atime = 29;
+    uint16_t astep = 599;
+    uint32_t measureStartedUs = 0;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+
+// Fake of robtillaart/HX711. A simulated conversion completes every 100 ms
+// (10 SPS, RATE pin low); DOUT then falls and an attached interrupt fires.
+// Raw counts are NATIVE_HX711_OFFSET + load * NATIVE_HX711_COUNTS_PER_GRAM
+// plus Gaussian noise, with the load from native_setLoad().
+#define NATIVE_HX711_OFFSET          84000
+#define NATIVE_HX711_COUNTS_PER_GRAM 391.0f
+#define NATIVE_HX711_PERIOD_MS       100
+
+class HX711 {
+public:
+    void begin(uint8_t dataPin, uint8_t clockPin, bool fastProcessor = false);
+    bool is_ready();
+    void wait_ready(uint32_t ms = 0);
+    float read();
+    float read_average(uint8_t times = 10);
+
+    void  set_scale(float scale = 1.0f) { this->scale = scale; }
+    float get_scale() const { return scale; }
+    void  set_offset(int32_t offset = 0) { this->offset = offset; }
+    int32_t get_offset() const { return offset; }
+    void  tare(uint8_t times = 10) { offset = (int32_t)read_average(times); }
+    float get_units(uint8_t times = 1) { return (read_average(times) - offset) / scale; }
+
+    void power_down() {}
+    void power_up() {}
+
+private:
+    uint8_t  dataPin = 0;
+    uint32_t lastReadConversion = 0;
+    float    scale = 1.0f;
+    int32_t  offset = 0;
+};
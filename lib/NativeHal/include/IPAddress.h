@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include "Print.h"
+
+class IPAddress : public Printable {
+public:
+    IPAddress() : bytes{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+    explicit IPAddress(uint32_t address) { memcpy(bytes, &address, 4); }
+
+    uint8_t operator[](int i) const { return bytes[i]; }
+    operator uint32_t() const { uint32_t v; memcpy(&v, bytes, 4); return v; }
+    bool operator==(const IPAddress& o) const { return memcmp(bytes, o.bytes, 4) == 0; }
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+        return String(buf);
+    }
+    size_t printTo(Print& p) const override { return p.print(toString()); }
+
+private:
+    uint8_t bytes[4];
+};
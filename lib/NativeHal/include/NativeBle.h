@@ -0,0 +1,106 @@
+#pragma once
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+// BLE GATT server without a radio. Notifications are printed; writes come
+// from native_bleWrite() (the console's "ble <text>"), which feeds the first
+// writable characteristic's callbacks like a connected phone would.
+class BLEServer;
+class BLECharacteristic;
+
+class BLEServerCallbacks {
+public:
+    virtual ~BLEServerCallbacks() = default;
+    virtual void onConnect(BLEServer*) {}
+    virtual void onDisconnect(BLEServer*) {}
+};
+
+class BLECharacteristicCallbacks {
+public:
+    virtual ~BLECharacteristicCallbacks() = default;
+    virtual void onRead(BLECharacteristic*) {}
+    virtual void onWrite(BLECharacteristic*) {}
+};
+
+class BLEDescriptor {
+public:
+    virtual ~BLEDescriptor() = default;
+};
+
+class BLE2902 : public BLEDescriptor {};
+
+class BLECharacteristic {
+public:
+    static const uint32_t PROPERTY_READ     = 1 << 0;
+    static const uint32_t PROPERTY_WRITE    = 1 << 1;
+    static const uint32_t PROPERTY_NOTIFY   = 1 << 2;
+    static const uint32_t PROPERTY_BROADCAST = 1 << 3;
+    static const uint32_t PROPERTY_INDICATE = 1 << 4;
+    static const uint32_t PROPERTY_WRITE_NR = 1 << 5;
+
+    BLECharacteristic(const char* uuid, uint32_t properties) : uuid(uuid), properties(properties) {}
+
+    void setCallbacks(BLECharacteristicCallbacks* cb) { callbacks = cb; }
+    BLECharacteristicCallbacks* getCallbacks() const { return callbacks; }
+    void addDescriptor(BLEDescriptor* d) { descriptors.push_back(d); }
+
+    void setValue(const uint8_t* data, size_t len) { value.assign((const char*)data, len); }
+    void setValue(const char* s) { value = s; }
+    void setValue(const std::string& s) { value = s; }
+    void setValue(const String& s) { value = s.c_str(); }
+    std::string getValue() const { return value; }
+    uint8_t* getData() { return (uint8_t*)value.data(); }
+    size_t getLength() const { return value.size(); }
+
+    void notify();
+    void indicate() { notify(); }
+
+    const std::string uuid;
+    const uint32_t properties;
+
+private:
+    BLECharacteristicCallbacks* callbacks = nullptr;
+    std::vector<BLEDescriptor*> descriptors;
+    std::string value;
+};
+
+class BLEService {
+public:
+    explicit BLEService(const char* uuid) : uuid(uuid) {}
+    BLECharacteristic* createCharacteristic(const char* uuid, uint32_t properties);
+    void start() {}
+
+    const std::string uuid;
+    std::vector<BLECharacteristic*> characteristics;
+};
+
+class BLEAdvertising {
+public:
+    void start();
+    void stop() {}
+    void addServiceUUID(const char*) {}
+    void setScanResponse(bool) {}
+};
+
+class BLEServer {
+public:
+    void setCallbacks(BLEServerCallbacks* cb) { callbacks = cb; }
+    BLEService* createService(const char* uuid);
+    BLEAdvertising* getAdvertising() { return &advertising; }
+    void startAdvertising() { advertising.start(); }
+    uint32_t getConnectedCount() const { return 0; }
+
+    std::vector<BLEService*> services;
+
+private:
+    BLEServerCallbacks* callbacks = nullptr;
+    BLEAdvertising advertising;
+};
+
+class BLEDevice {
+public:
+    static void init(const std::string& name);
+    static BLEServer* createServer();
+    static BLEAdvertising* getAdvertising();
+};
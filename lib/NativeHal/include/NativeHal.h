@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Host side of the HAL: clocks, where the "SD card" lives, and the knobs of
+// the fake sensors. The console in main.cpp drives these from stdin; tools
+// and benchmarks can call them directly.
+//
+// Environment:
+//   SCALE_SD_ROOT      directory that stands in for the SD card (./sdcard)
+//   SCALE_PORT_OFFSET  added to every listening port, so port 80 does not
+//                      need root (8000 -> http://localhost:8080/)
+
+uint32_t native_millis();
+uint32_t native_micros();
+
+// Thrown by vTaskDelete(nullptr) to unwind the calling task's thread
+struct NativeTaskDeleted {};
+
+// SD paths ("/food.db") and SQLite paths ("/sd/food.db") on the host
+const std::string& native_sdRoot();
+std::string native_sdPath(const char* path);
+
+int native_portOffset();
+
+// Fake sensors. All thread-safe; changes show up in the next conversion.
+void  native_setLoad(float grams);                 // mass on the platform
+float native_load();
+void  native_setNoise(float grams);                // RMS noise of the HX711 fake
+void  native_setTemperature(float celsius);        // DS18B20 reading
+void  native_setSpectrum(const uint16_t basis[10]);   // AS7341 counts at AGAIN 4, ATIME 29, ASTEP 599
+void  native_setBatteryMilliVolts(uint32_t mv);    // at the cell, before the 1:2 divider
+
+// Delivers text to the BLE RX characteristic as if a phone wrote it
+bool  native_bleWrite(const std::string& text);
+
+// Interrupts attached with attachInterrupt(); fakes raise them from their threads
+void  native_raiseInterrupt(uint8_t pin);
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// FreeRTOS on std::thread. Tasks are threads (core and priority are
+// recorded but not enforced), queues and semaphores are mutex + condition
+// variable, critical sections are spinlocks. One tick is one millisecond.
+// "FromISR" calls are the plain calls: fake interrupts run on threads too.
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void*);
+
+struct NativeTask;
+struct NativeQueue;
+struct NativeSemaphore;
+typedef NativeTask*      TaskHandle_t;
+typedef NativeQueue*     QueueHandle_t;
+typedef NativeSemaphore* SemaphoreHandle_t;
+
+#define pdFALSE  ((BaseType_t)0)
+#define pdTRUE   ((BaseType_t)1)
+#define pdPASS   pdTRUE
+#define pdFAIL   pdFALSE
+
+#define portMAX_DELAY       ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS  ((TickType_t)1)
+#define configTICK_RATE_HZ  1000
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define tskNO_AFFINITY      ((BaseType_t)0x7fffffff)
+#define portYIELD_FROM_ISR(...) do {} while (0)
+#define taskYIELD()         native_yield()
+
+struct portMUX_TYPE {
+    std::atomic<bool> locked{false};
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+void native_muxEnter(portMUX_TYPE* mux);
+void native_muxExit(portMUX_TYPE* mux);
+#define portENTER_CRITICAL(mux)     native_muxEnter(mux)
+#define portEXIT_CRITICAL(mux)      native_muxExit(mux)
+#define portENTER_CRITICAL_ISR(mux) native_muxEnter(mux)
+#define portEXIT_CRITICAL_ISR(mux)  native_muxExit(mux)
+
+void native_yield();
+
+// Tasks
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                              UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, handle, tskNO_AFFINITY);
+}
+void vTaskDelete(TaskHandle_t task);   // only nullptr (the calling task) is supported
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char* pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);   // always the full stack
+
+// Direct-to-task notifications (counting semantics only)
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+
+// Queues
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks);
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks);
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+#define xQueueSendToBack(q, item, ticks) xQueueSend(q, item, ticks)
+inline BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xQueueSend(q, item, 0);
+}
+inline BaseType_t xQueueReceiveFromISR(QueueHandle_t q, void* item, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xQueueReceive(q, item, 0);
+}
+
+// Semaphores and mutexes (mutexes are not priority-inheriting here)
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial);
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem);
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xSemaphoreGive(sem);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// NVS on the host: one file per namespace under $SCALE_SD_ROOT/.nvs/,
+// rewritten on every put. Values are untyped byte strings, so a get*() of
+// a key stored with a different type returns garbage, as NVS would fail.
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+    size_t getBytesLength(const char* key);
+
+    size_t putChar(const char* key, int8_t v)      { return putValue(key, v); }
+    size_t putUChar(const char* key, uint8_t v)    { return putValue(key, v); }
+    size_t putShort(const char* key, int16_t v)    { return putValue(key, v); }
+    size_t putUShort(const char* key, uint16_t v)  { return putValue(key, v); }
+    size_t putInt(const char* key, int32_t v)      { return putValue(key, v); }
+    size_t putUInt(const char* key, uint32_t v)    { return putValue(key, v); }
+    size_t putLong(const char* key, int32_t v)     { return putValue(key, v); }
+    size_t putULong(const char* key, uint32_t v)   { return putValue(key, v); }
+    size_t putLong64(const char* key, int64_t v)   { return putValue(key, v); }
+    size_t putULong64(const char* key, uint64_t v) { return putValue(key, v); }
+    size_t putFloat(const char* key, float v)      { return putValue(key, v); }
+    size_t putDouble(const char* key, double v)    { return putValue(key, v); }
+    size_t putBool(const char* key, bool v)        { return putValue(key, (uint8_t)v); }
+    size_t putString(const char* key, const char* v);
+    size_t putString(const char* key, const String& v) { return putString(key, v.c_str()); }
+
+    int8_t   getChar(const char* key, int8_t d = 0)        { return getValue(key, d); }
+    uint8_t  getUChar(const char* key, uint8_t d = 0)      { return getValue(key, d); }
+    int16_t  getShort(const char* key, int16_t d = 0)      { return getValue(key, d); }
+    uint16_t getUShort(const char* key, uint16_t d = 0)    { return getValue(key, d); }
+    int32_t  getInt(const char* key, int32_t d = 0)        { return getValue(key, d); }
+    uint32_t getUInt(const char* key, uint32_t d = 0)      { return getValue(key, d); }
+    int32_t  getLong(const char* key, int32_t d = 0)       { return getValue(key, d); }
+    uint32_t getULong(const char* key, uint32_t d = 0)     { return getValue(key, d); }
+    int64_t  getLong64(const char* key, int64_t d = 0)     { return getValue(key, d); }
+    uint64_t getULong64(const char* key, uint64_t d = 0)   { return getValue(key, d); }
+    float    getFloat(const char* key, float d = NAN)      { return getValue(key, d); }
+    double   getDouble(const char* key, double d = NAN)    { return getValue(key, d); }
+    bool     getBool(const char* key, bool d = false)      { return getValue(key, (uint8_t)d) != 0; }
+    String   getString(const char* key, const String& d = String());
+
+private:
+    template <typename T> size_t putValue(const char* key, T v) { return putBytes(key, &v, sizeof(v)); }
+    template <typename T> T getValue(const char* key, T d) {
+        T v;
+        return getBytes(key, &v, sizeof(v)) == sizeof(v) ? v : d;
+    }
+    bool save();
+
+    std::string name;
+    bool open = false;
+    bool readOnly = false;
+    std::map<std::string, std::vector<uint8_t>> values;
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include "FS.h"
+
+// The SD card is a host directory, $SCALE_SD_ROOT or ./sdcard
+class SDFS : public fs::FS {
+public:
+    bool begin(uint8_t csPin = 0);
+    void end() {}
+    uint64_t cardSize();
+    uint64_t totalBytes();
+    uint64_t usedBytes();
+};
+
+extern SDFS SD;
@@ -0,0 +1,18 @@
+#pragma once
+#include "Print.h"
+
+// Byte stream with Arduino's blocking-read helpers. read() returns -1 when
+// nothing is available; there is no timeout on the host.
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(uint8_t* buffer, size_t length);
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+    String readString();
+    String readStringUntil(char terminator);
+    void setTimeout(unsigned long) {}
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+
+// Headless stand-in for TFT_eSPI: the API DisplayManager uses, drawing into
+// nothing. It counts the pixels pushed to the panel so benchmarks can see
+// how much a redraw costs on the bus.
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+#define TFT_GREEN 0x07E0
+#define TFT_RED   0xF800
+
+class TFT_eSPI : public Print {
+public:
+    TFT_eSPI(int16_t w = 170, int16_t h = 320) : panelWidth(w), panelHeight(h) {}
+
+    void init() {}
+    void begin() { init(); }
+    void setRotation(uint8_t r) { rotation = r & 3; }
+    int16_t width() const { return rotation & 1 ? panelHeight : panelWidth; }
+    int16_t height() const { return rotation & 1 ? panelWidth : panelHeight; }
+
+    void fillScreen(uint32_t) { pixelsPushed += (uint64_t)width() * height(); }
+    void fillRect(int32_t, int32_t, int32_t w, int32_t h, uint32_t) { if (w > 0 && h > 0) pixelsPushed += (uint64_t)w * h; }
+    void setTextSize(uint8_t s) { textSize = s; }
+    void setTextColor(uint16_t, uint16_t = 0) {}
+    void setTextWrap(bool, bool = false) {}
+    void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+
+    // Glyphs are 6x8 at size 1, as the built-in GLCD font
+    size_t write(uint8_t) override { pixelsPushed += 48ULL * textSize * textSize; return 1; }
+    using Print::write;
+
+    uint64_t pixelsPushed = 0;
+
+protected:
+    int16_t panelWidth, panelHeight;
+    uint8_t rotation = 0;
+    uint8_t textSize = 1;
+    int16_t cursorX = 0, cursorY = 0;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+public:
+    explicit TFT_eSprite(TFT_eSPI* tft) : TFT_eSPI(0, 0), tft(tft) {}
+
+    void setColorDepth(int8_t) {}
+    void* createSprite(int16_t w, int16_t h) {
+        panelWidth = w;
+        panelHeight = h;
+        rotation = 0;
+        isCreated = w > 0 && h > 0;
+        return isCreated ? this : nullptr;
+    }
+    void deleteSprite() { isCreated = false; }
+    bool created() const { return isCreated; }
+
+    // Drawing into the sprite is RAM-only; only the push reaches the panel
+    size_t write(uint8_t) override { return 1; }
+    using Print::write;
+    void fillRect(int32_t, int32_t, int32_t, int32_t, uint32_t) {}
+    void pushSprite(int32_t, int32_t) { tft->pixelsPushed += (uint64_t)panelWidth * panelHeight; }
+    void pushSprite(int32_t, int32_t, int32_t, int32_t, int32_t w, int32_t h) {
+        if (w > 0 && h > 0) tft->pixelsPushed += (uint64_t)w * h;
+    }
+
+private:
+    TFT_eSPI* tft;
+    bool isCreated = false;
+};
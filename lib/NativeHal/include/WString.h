@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Arduino String on top of std::string. Only the members the firmware uses,
+// with the same semantics (indexOf() returns -1, toInt() stops at the first
+// non-digit, float conversions default to two decimals).
+class String {
+public:
+    String() = default;
+    String(const char* s) : s(s ? s : "") {}
+    String(const char* s, size_t n) : s(s, n) {}
+    explicit String(const std::string& s) : s(s) {}
+    explicit String(char c) : s(1, c) {}
+    explicit String(int v, unsigned char base = 10);
+    explicit String(unsigned int v, unsigned char base = 10);
+    explicit String(long v, unsigned char base = 10);
+    explicit String(unsigned long v, unsigned char base = 10);
+    explicit String(long long v, unsigned char base = 10);
+    explicit String(unsigned long long v, unsigned char base = 10);
+    explicit String(float v, unsigned int decimals = 2);
+    explicit String(double v, unsigned int decimals = 2);
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    bool reserve(unsigned int size) { s.reserve(size); return true; }
+
+    char charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+    void setCharAt(unsigned int i, char c) { if (i < s.size()) s[i] = c; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char& operator[](unsigned int i) { return s[i]; }
+
+    bool concat(const String& other) { s += other.s; return true; }
+    bool concat(const char* other) { if (other) s += other; return true; }
+    bool concat(char c) { s += c; return true; }
+    template <typename T> bool concat(T v) { s += String(v).s; return true; }
+
+    String& operator+=(const String& other) { s += other.s; return *this; }
+    String& operator+=(const char* other) { if (other) s += other; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    template <typename T> String& operator+=(T v) { s += String(v).s; return *this; }
+
+    bool equals(const String& other) const { return s == other.s; }
+    bool equalsIgnoreCase(const String& other) const;
+    bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String& suffix) const;
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& str, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(const String& str) const;
+
+    String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    void replace(const String& find, const String& with);
+    void remove(unsigned int index) { if (index < s.size()) s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < s.size()) s.erase(index, count); }
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+    bool operator==(const String& o) const { return s == o.s; }
+    bool operator==(const char* o) const { return s == (o ? o : ""); }
+    bool operator!=(const String& o) const { return s != o.s; }
+    bool operator!=(const char* o) const { return !(*this == o); }
+    bool operator<(const String& o) const { return s < o.s; }
+    bool operator>(const String& o) const { return s > o.s; }
+
+    const std::string& str() const { return s; }
+
+private:
+    std::string s;
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+template <typename T> String operator+(const String& a, T b) { String r(a); r += b; return r; }
+
+// Arduino's F() / flash strings are plain strings on the host
+class __FlashStringHelper;
+#define F(s) (s)
@@ -0,0 +1,42 @@
+#pragma once
+#include <Arduino.h>
+
+// The host is always "connected"; servers listen on localhost (plus
+// SCALE_PORT_OFFSET). Soft-AP calls succeed and report 192.168.4.1.
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+typedef enum { WIFI_POWER_19_5dBm = 78, WIFI_POWER_2dBm = 8 } wifi_power_t;
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t m) { currentMode = m; return true; }
+    wifi_mode_t getMode() const { return currentMode; }
+    wl_status_t begin(const char* ssid, const char* password = nullptr);
+    wl_status_t status() const { return currentStatus; }
+    bool isConnected() const { return currentStatus == WL_CONNECTED; }
+    bool disconnect(bool wifiOff = false);
+    bool setTxPower(wifi_power_t) { return true; }
+    bool softAP(const char* ssid, const char* password = nullptr, int channel = 1,
+                int hidden = 0, int maxConnections = 4);
+    bool setHostname(const char* name) { (void)name; return true; }
+
+    IPAddress localIP() const { return IPAddress(127, 0, 0, 1); }
+    IPAddress softAPIP() const { return IPAddress(192, 168, 4, 1); }
+    String macAddress() const { return "F4:12:FA:42:C0:DE"; }
+    String SSID() const { return ssid; }
+    int8_t RSSI() const { return -50; }
+
+private:
+    wifi_mode_t currentMode = WIFI_OFF;
+    wl_status_t currentStatus = WL_DISCONNECTED;
+    String ssid;
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,18 @@
+#pragma once
+#include <Arduino.h>
+
+// Fake of lib/ds18b20: one sensor on the bus reading native_setTemperature()
+// (22 degC by default), with the real 750 ms conversion time.
+#define DEVICE_DISCONNECTED_C -127
+
+class DS18B20
+{
+public:
+    DS18B20( uint8_t pin ) { (void)pin; }
+
+    float getTemperature( uint8_t index );
+    uint32_t requestTemperature() { return 750U; }
+    float readTemperature( uint8_t index ) { return getTemperature( index ); }
+    uint64_t getAddres( uint8_t index ) { return 0x28ff000000000001ULL + index; }
+    uint8_t getDeviceCount() { return 1U; }
+};
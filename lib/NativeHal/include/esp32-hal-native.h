@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Set for every host build; firmware code that must differ tests this
+#define ESP32_NATIVE 1
+
+// ESP-IDF odds and ends the firmware touches. Heap figures are fixed
+// numbers for the T-Display S3 (no accounting on the host).
+class EspClass {
+public:
+    uint32_t getHeapSize()     { return 320 * 1024; }
+    uint32_t getFreeHeap()     { return 200 * 1024; }
+    uint32_t getMinFreeHeap()  { return 180 * 1024; }
+    uint32_t getMaxAllocHeap() { return 110 * 1024; }
+    uint32_t getPsramSize()    { return 8 * 1024 * 1024; }
+    uint32_t getFreePsram()    { return 8 * 1024 * 1024; }
+    uint32_t getMinFreePsram() { return 8 * 1024 * 1024; }
+    uint32_t getMaxAllocPsram() { return 8 * 1024 * 1024; }
+    uint32_t getCpuFreqMHz()   { return 240; }
+    uint64_t getEfuseMac()     { return 0x0000f412fa42c0deULL; }
+    void restart();
+};
+
+extern EspClass ESP;
+
+int64_t esp_timer_get_time();
+void* ps_malloc(size_t size);
+void* ps_calloc(size_t n, size_t size);
+void* ps_realloc(void* ptr, size_t size);
@@ -0,0 +1,2 @@
+#pragma once
+// Pulled in by FoodManager.h on the device; nothing needed on the host
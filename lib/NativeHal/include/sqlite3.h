@@ -0,0 +1,10 @@
+#pragma once
+// System SQLite, with the device's "/sd/..." database paths mapped into
+// $SCALE_SD_ROOT like every other SD file.
+#include_next <sqlite3.h>
+
+int native_sqlite3_open(const char* filename, sqlite3** db);
+int native_sqlite3_open_v2(const char* filename, sqlite3** db, int flags, const char* vfs);
+
+#define sqlite3_open(filename, db)                  native_sqlite3_open(filename, db)
+#define sqlite3_open_v2(filename, db, flags, vfs)   native_sqlite3_open_v2(filename, db, flags, vfs)
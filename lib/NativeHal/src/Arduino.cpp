@@ -0,0 +1,211 @@
+#include "Arduino.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unistd.h>
+
+#define NATIVE_PIN_COUNT   49
+#define NATIVE_BATTERY_PIN 4   // PIN_BAT_VOLT on the T-Display S3, behind a 1:2 divider
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static const auto startTime = std::chrono::steady_clock::now();
+
+uint32_t native_millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - startTime).count();
+}
+
+uint32_t native_micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - startTime).count();
+}
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+/* ---------- Serial ---------- */
+
+// Tasks print concurrently; keep each write in one piece
+static std::mutex serialLock;
+
+size_t HardwareSerial::write(uint8_t c) {
+    std::lock_guard<std::mutex> lock(serialLock);
+    fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    std::lock_guard<std::mutex> lock(serialLock);
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    std::lock_guard<std::mutex> lock(serialLock);
+    fflush(stdout);
+}
+
+/* ---------- GPIO ---------- */
+
+static std::atomic<uint8_t> pinLevels[NATIVE_PIN_COUNT];
+static std::atomic<bool>    pinLevelsInit{false};
+static void (*interruptHandlers[NATIVE_PIN_COUNT])() = {};
+static std::atomic<uint32_t> batteryMilliVolts{4100};
+
+// Inputs float high: buttons are wired active-low with pull-ups
+static void initPins() {
+    if (pinLevelsInit.exchange(true)) return;
+    for (auto& level : pinLevels) level = HIGH;
+}
+
+void pinMode(uint8_t pin, uint8_t) {
+    initPins();
+    (void)pin;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    initPins();
+    if (pin < NATIVE_PIN_COUNT) pinLevels[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    initPins();
+    return pin < NATIVE_PIN_COUNT ? pinLevels[pin].load() : LOW;
+}
+
+uint32_t analogReadMilliVolts(uint8_t pin) {
+    return pin == NATIVE_BATTERY_PIN ? batteryMilliVolts / 2 : 0;
+}
+
+uint16_t analogRead(uint8_t pin) {
+    return (uint16_t)std::min<uint32_t>(4095, analogReadMilliVolts(pin) * 4095 / 3100);
+}
+
+void native_setBatteryMilliVolts(uint32_t mv) {
+    batteryMilliVolts = mv;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int) {
+    if (pin < NATIVE_PIN_COUNT) interruptHandlers[pin] = isr;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < NATIVE_PIN_COUNT) interruptHandlers[pin] = nullptr;
+}
+
+void native_raiseInterrupt(uint8_t pin) {
+    if (pin < NATIVE_PIN_COUNT && interruptHandlers[pin]) interruptHandlers[pin]();
+}
+
+/* ---------- math ---------- */
+
+static std::mt19937& rng() {
+    static thread_local std::mt19937 engine(std::random_device{}());
+    return engine;
+}
+
+long random(long max) {
+    return max > 0 ? random(0, max) : 0;
+}
+
+long random(long min, long max) {
+    if (min >= max) return min;
+    return std::uniform_int_distribution<long>(min, max - 1)(rng());
+}
+
+void randomSeed(unsigned long seed) {
+    rng().seed(seed);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+#if defined(__GLIBC__) && (__GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38))
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+size_t strlcat(char* dst, const char* src, size_t size) {
+    size_t used = strnlen(dst, size);
+    if (used == size) return size + strlen(src);
+    return used + strlcpy(dst + used, src, size - used);
+}
+#endif
+
+/* ---------- time ---------- */
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char*, const char*, const char*) {
+    // Same POSIX TZ the ESP32 core builds from the offsets
+    char tz[32];
+    long offset = -(gmtOffsetSec / 3600);
+    if (daylightOffsetSec) snprintf(tz, sizeof(tz), "UTC%ldDST", offset);
+    else snprintf(tz, sizeof(tz), "UTC%ld", offset);
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+void configTzTime(const char* tz, const char*, const char*, const char*) {
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+bool getLocalTime(struct tm* info, uint32_t) {
+    time_t now = time(nullptr);
+    localtime_r(&now, info);
+    return true;
+}
+
+/* ---------- ESP ---------- */
+
+void EspClass::restart() {
+    fflush(stdout);
+    fprintf(stderr, "[native] ESP.restart()\n");
+    _exit(0);
+}
+
+void* ps_malloc(size_t size) { return malloc(size); }
+void* ps_calloc(size_t n, size_t size) { return calloc(n, size); }
+void* ps_realloc(void* ptr, size_t size) { return realloc(ptr, size); }
+
+/* ---------- host paths ---------- */
+
+const std::string& native_sdRoot() {
+    static const std::string root = [] {
+        const char* env = getenv("SCALE_SD_ROOT");
+        std::string r = env && *env ? env : "sdcard";
+        while (r.size() > 1 && r.back() == '/') r.pop_back();
+        return r;
+    }();
+    return root;
+}
+
+std::string native_sdPath(const char* path) {
+    std::string p = path ? path : "";
+    if (p.rfind("/sd/", 0) == 0) p.erase(0, 3);   // SQLite VFS mount point on the device
+    if (p.empty() || p[0] != '/') p.insert(0, "/");
+    return native_sdRoot() + p;
+}
+
+int native_portOffset() {
+    static const int offset = [] {
+        const char* env = getenv("SCALE_PORT_OFFSET");
+        return env ? atoi(env) : 8000;
+    }();
+    return offset;
+}
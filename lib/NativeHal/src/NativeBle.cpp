@@ -0,0 +1,59 @@
+#include "NativeBle.h"
+#include <mutex>
+
+static std::mutex bleLock;
+static std::string deviceName;
+static std::vector<BLEServer*> servers;
+
+void BLEDevice::init(const std::string& name) {
+    deviceName = name;
+}
+
+BLEServer* BLEDevice::createServer() {
+    std::lock_guard<std::mutex> lock(bleLock);
+    servers.push_back(new BLEServer);
+    return servers.back();
+}
+
+BLEAdvertising* BLEDevice::getAdvertising() {
+    static BLEAdvertising advertising;
+    return &advertising;
+}
+
+BLEService* BLEServer::createService(const char* uuid) {
+    std::lock_guard<std::mutex> lock(bleLock);
+    services.push_back(new BLEService(uuid));
+    return services.back();
+}
+
+BLECharacteristic* BLEService::createCharacteristic(const char* uuid, uint32_t properties) {
+    std::lock_guard<std::mutex> lock(bleLock);
+    characteristics.push_back(new BLECharacteristic(uuid, properties));
+    return characteristics.back();
+}
+
+void BLEAdvertising::start() {
+    Serial.printf("[native] BLE '%s' advertising (simulated, use 'ble <text>')\n", deviceName.c_str());
+}
+
+void BLECharacteristic::notify() {
+    Serial.printf("[native] BLE notify %s: %s\n", uuid.c_str(), value.c_str());
+}
+
+bool native_bleWrite(const std::string& text) {
+    BLECharacteristic* target = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(bleLock);
+        for (BLEServer* server : servers)
+            for (BLEService* service : server->services)
+                for (BLECharacteristic* c : service->characteristics)
+                    if (!target && c->getCallbacks() &&
+                        (c->properties & (BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR)))
+                        target = c;
+    }
+    if (!target) return false;
+
+    target->setValue(text);
+    target->getCallbacks()->onWrite(target);
+    return true;
+}
@@ -0,0 +1,306 @@
+#include "NativeRtos.h"
+#include "NativeHal.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct NativeTask {
+    NativeTask() = default;
+    explicit NativeTask(const char* name) : name(name) {}
+
+    std::string             name;
+    uint32_t                stackDepth = 0;
+    std::mutex              lock;
+    std::condition_variable wake;
+    uint32_t                notifications = 0;
+};
+
+struct NativeQueue {
+    std::mutex              lock;
+    std::condition_variable changed;
+    std::vector<uint8_t>    storage;
+    size_t                  itemSize;
+    size_t                  capacity;
+    size_t                  head = 0;
+    size_t                  count = 0;
+};
+
+struct NativeSemaphore {
+    std::mutex              lock;
+    std::condition_variable changed;
+    uint32_t                count;
+    uint32_t                max;
+    bool                    recursive = false;
+    std::thread::id         owner;
+    uint32_t                depth = 0;
+};
+
+static thread_local NativeTask* currentTask = nullptr;
+static NativeTask mainTask("loopTask");
+
+// Waits on cv until ready() or the tick timeout; returns ready()
+template <typename Lock, typename Ready>
+static bool waitFor(std::condition_variable& cv, Lock& lock, TickType_t ticks, Ready ready) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+/* ---------- critical sections ---------- */
+
+void native_muxEnter(portMUX_TYPE* mux) {
+    while (mux->locked.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+void native_muxExit(portMUX_TYPE* mux) {
+    mux->locked.store(false, std::memory_order_release);
+}
+
+void native_yield() {
+    std::this_thread::yield();
+}
+
+/* ---------- tasks ---------- */
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                   UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    NativeTask* task = new NativeTask;
+    task->name = name ? name : "";
+    task->stackDepth = stackDepth;
+    if (handle) *handle = task;
+
+    std::thread([task, fn, arg]() {
+        currentTask = task;
+        try {
+            fn(arg);
+        } catch (const NativeTaskDeleted&) {
+        }
+        // The handle may still be held by others; tasks are never freed
+    }).detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task && task != xTaskGetCurrentTaskHandle()) {
+        fprintf(stderr, "[native] vTaskDelete of another task is not supported\n");
+        return;
+    }
+    throw NativeTaskDeleted();
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) std::this_thread::yield();
+    else std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+    return native_millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return currentTask ? currentTask : &mainTask;
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+    return (task ? task : xTaskGetCurrentTaskHandle())->name.c_str();
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return (task ? task : xTaskGetCurrentTaskHandle())->stackDepth;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    NativeTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->lock);
+    if (!waitFor(task->wake, lock, ticks, [task] { return task->notifications > 0; })) return 0;
+
+    uint32_t value = task->notifications;
+    task->notifications = clearOnExit ? 0 : value - 1;
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(task->lock);
+        task->notifications++;
+    }
+    task->wake.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdFALSE;
+}
+
+/* ---------- queues ---------- */
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    if (length == 0) return nullptr;
+    NativeQueue* q = new NativeQueue;
+    q->itemSize = itemSize;
+    q->capacity = length;
+    q->storage.resize((size_t)length * itemSize);
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    delete q;
+}
+
+static BaseType_t queueSend(QueueHandle_t q, const void* item, TickType_t ticks, bool front) {
+    if (!q) return pdFAIL;
+    std::unique_lock<std::mutex> lock(q->lock);
+    if (!waitFor(q->changed, lock, ticks, [q] { return q->count < q->capacity; })) return pdFAIL;
+
+    size_t slot;
+    if (front) {
+        q->head = (q->head + q->capacity - 1) % q->capacity;
+        slot = q->head;
+    } else {
+        slot = (q->head + q->count) % q->capacity;
+    }
+    memcpy(&q->storage[slot * q->itemSize], item, q->itemSize);
+    q->count++;
+    lock.unlock();
+    q->changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) {
+    return queueSend(q, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void* item, TickType_t ticks) {
+    return queueSend(q, item, ticks, true);
+}
+
+// Only meaningful for length-1 queues, as in FreeRTOS
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void* item) {
+    if (!q) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(q->lock);
+        q->head = 0;
+        q->count = 1;
+        memcpy(q->storage.data(), item, q->itemSize);
+    }
+    q->changed.notify_all();
+    return pdPASS;
+}
+
+static BaseType_t queueReceive(QueueHandle_t q, void* item, TickType_t ticks, bool remove) {
+    if (!q) return pdFAIL;
+    std::unique_lock<std::mutex> lock(q->lock);
+    if (!waitFor(q->changed, lock, ticks, [q] { return q->count > 0; })) return pdFAIL;
+
+    memcpy(item, &q->storage[q->head * q->itemSize], q->itemSize);
+    if (remove) {
+        q->head = (q->head + 1) % q->capacity;
+        q->count--;
+        lock.unlock();
+        q->changed.notify_all();
+    }
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks) {
+    return queueReceive(q, item, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void* item, TickType_t ticks) {
+    return queueReceive(q, item, ticks, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    if (!q) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(q->lock);
+        q->head = 0;
+        q->count = 0;
+    }
+    q->changed.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->lock);
+    return q->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+    std::lock_guard<std::mutex> lock(q->lock);
+    return q->capacity - q->count;
+}
+
+/* ---------- semaphores ---------- */
+
+static SemaphoreHandle_t createSemaphore(uint32_t max, uint32_t initial, bool recursive) {
+    NativeSemaphore* s = new NativeSemaphore;
+    s->max = max;
+    s->count = initial;
+    s->recursive = recursive;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return createSemaphore(1, 0, false); }
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) { return createSemaphore(max, initial, false); }
+SemaphoreHandle_t xSemaphoreCreateMutex() { return createSemaphore(1, 1, false); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return createSemaphore(1, 1, true); }
+
+void vSemaphoreDelete(SemaphoreHandle_t s) {
+    delete s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+    if (!s) return pdFAIL;
+    std::unique_lock<std::mutex> lock(s->lock);
+    if (!waitFor(s->changed, lock, ticks, [s] { return s->count > 0; })) return pdFAIL;
+    s->count--;
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    if (!s) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(s->lock);
+        if (s->count >= s->max) return pdFAIL;
+        s->count++;
+    }
+    s->changed.notify_one();
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t ticks) {
+    if (!s) return pdFAIL;
+    std::thread::id self = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lock(s->lock);
+    if (s->depth && s->owner == self) {
+        s->depth++;
+        return pdPASS;
+    }
+    if (!waitFor(s->changed, lock, ticks, [s] { return s->depth == 0; })) return pdFAIL;
+    s->owner = self;
+    s->depth = 1;
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s) {
+    if (!s) return pdFAIL;
+    {
+        std::lock_guard<std::mutex> lock(s->lock);
+        if (!s->depth || s->owner != std::this_thread::get_id()) return pdFAIL;
+        if (--s->depth) return pdPASS;
+    }
+    s->changed.notify_one();
+    return pdPASS;
+}
@@ -0,0 +1,19 @@
+#include "NativeHal.h"
+#include <sqlite3.h>
+
+#undef sqlite3_open
+#undef sqlite3_open_v2
+
+// ":memory:" and temporary databases are not files on the card
+static std::string hostPath(const char* filename) {
+    if (!filename || !*filename || *filename == ':') return filename ? filename : "";
+    return native_sdPath(filename);
+}
+
+int native_sqlite3_open(const char* filename, sqlite3** db) {
+    return sqlite3_open(hostPath(filename).c_str(), db);
+}
+
+int native_sqlite3_open_v2(const char* filename, sqlite3** db, int flags, const char* vfs) {
+    return sqlite3_open_v2(hostPath(filename).c_str(), db, flags, vfs);
+}
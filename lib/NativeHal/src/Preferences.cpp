@@ -0,0 +1,103 @@
+#include "Preferences.h"
+#include <mutex>
+#include <sys/stat.h>
+
+// File format: repeated [u16 key length][key][u32 value length][value]
+static std::mutex nvsLock;
+
+static std::string namespacePath(const std::string& name) {
+    return native_sdRoot() + "/.nvs/" + name + ".bin";
+}
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    std::lock_guard<std::mutex> lock(nvsLock);
+    this->name = name;
+    this->readOnly = readOnly;
+    values.clear();
+
+    FILE* f = fopen(namespacePath(this->name).c_str(), "rb");
+    if (f) {
+        uint16_t keyLen;
+        while (fread(&keyLen, sizeof(keyLen), 1, f) == 1) {
+            std::string key(keyLen, '\0');
+            uint32_t len;
+            if (fread(&key[0], 1, keyLen, f) != keyLen || fread(&len, sizeof(len), 1, f) != 1) break;
+            std::vector<uint8_t> value(len);
+            if (fread(value.data(), 1, len, f) != len) break;
+            values[key] = std::move(value);
+        }
+        fclose(f);
+    }
+    open = true;
+    return true;
+}
+
+void Preferences::end() {
+    open = false;
+    values.clear();
+}
+
+bool Preferences::save() {
+    std::lock_guard<std::mutex> lock(nvsLock);
+    mkdir(native_sdRoot().c_str(), 0755);
+    mkdir((native_sdRoot() + "/.nvs").c_str(), 0755);
+
+    std::string path = namespacePath(name);
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    for (const auto& [key, value] : values) {
+        uint16_t keyLen = key.size();
+        uint32_t len = value.size();
+        fwrite(&keyLen, sizeof(keyLen), 1, f);
+        fwrite(key.data(), 1, keyLen, f);
+        fwrite(&len, sizeof(len), 1, f);
+        fwrite(value.data(), 1, len, f);
+    }
+    bool ok = fclose(f) == 0;
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+bool Preferences::clear() {
+    if (!open || readOnly) return false;
+    values.clear();
+    return save();
+}
+
+bool Preferences::remove(const char* key) {
+    if (!open || readOnly || !values.erase(key)) return false;
+    return save();
+}
+
+bool Preferences::isKey(const char* key) {
+    return open && values.count(key);
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!open || readOnly) return 0;
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    values[key].assign(bytes, bytes + len);
+    return save() ? len : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    auto it = values.find(key);
+    if (!open || it == values.end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    auto it = values.find(key);
+    return open && it != values.end() ? it->second.size() : 0;
+}
+
+size_t Preferences::putString(const char* key, const char* v) {
+    return putBytes(key, v, strlen(v) + 1) ? strlen(v) : 0;
+}
+
+String Preferences::getString(const char* key, const String& d) {
+    auto it = values.find(key);
+    if (!open || it == values.end() || it->second.empty()) return d;
+    return String((const char*)it->second.data());
+}
@@ -0,0 +1,52 @@
+#include "Stream.h"
+#include <cstdarg>
+#include <cstdio>
+#include <vector>
+
+size_t Print::printf(const char* format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(small)) return write((const uint8_t*)small, len);
+
+    std::vector<char> big(len + 1);
+    va_start(args, format);
+    vsnprintf(big.data(), big.size(), format, args);
+    va_end(args);
+    return write((const uint8_t*)big.data(), len);
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+        int c = read();
+        if (c < 0) break;
+        buffer[n++] = (uint8_t)c;
+    }
+    return n;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+        int c = read();
+        if (c < 0 || c == terminator) break;
+        buffer[n++] = (char)c;
+    }
+    return n;
+}
+
+String Stream::readString() {
+    std::string s;
+    for (int c; (c = read()) >= 0;) s += (char)c;
+    return String(s);
+}
+
+String Stream::readStringUntil(char terminator) {
+    std::string s;
+    for (int c; (c = read()) >= 0 && c != terminator;) s += (char)c;
+    return String(s);
+}
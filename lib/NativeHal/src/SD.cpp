@@ -0,0 +1,176 @@
+#include "SD.h"
+#include "NativeHal.h"
+#include <cstdio>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SDFS SD;
+
+namespace fs {
+
+struct File::Impl {
+    std::string hostPath;
+    std::string path;       // as the firmware named it, e.g. "/food.db"
+    FILE*       file = nullptr;
+    DIR*        dir = nullptr;
+
+    ~Impl() {
+        if (file) fclose(file);
+        if (dir) closedir(dir);
+    }
+};
+
+File::File(const std::string& hostPath, const std::string& path, const char* mode) {
+    struct stat st;
+    bool isDir = stat(hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+
+    auto f = std::make_shared<Impl>();
+    f->hostPath = hostPath;
+    f->path = path;
+    if (isDir) {
+        f->dir = opendir(hostPath.c_str());
+        if (!f->dir) return;
+    } else {
+        // Arduino's "w" is the device's read/write-create; "r" must exist
+        std::string m = mode;
+        if (m == "w") m = "w+";
+        else if (m == "a") m = "a+";
+        f->file = fopen(hostPath.c_str(), m.c_str());
+        if (!f->file) return;
+    }
+    impl = std::move(f);
+}
+
+size_t File::write(uint8_t c) {
+    return impl && impl->file ? fwrite(&c, 1, 1, impl->file) : 0;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    return impl && impl->file ? fwrite(buffer, 1, size, impl->file) : 0;
+}
+
+void File::flush() {
+    if (impl && impl->file) fflush(impl->file);
+}
+
+int File::available() {
+    if (!impl || !impl->file) return 0;
+    long pos = ftell(impl->file);
+    long len = (long)size();
+    return pos < len ? (int)(len - pos) : 0;
+}
+
+int File::read() {
+    if (!impl || !impl->file) return -1;
+    int c = fgetc(impl->file);
+    return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+    if (!impl || !impl->file) return -1;
+    int c = fgetc(impl->file);
+    if (c == EOF) return -1;
+    ungetc(c, impl->file);
+    return c;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    return impl && impl->file ? fread(buffer, 1, size, impl->file) : 0;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+    return impl && impl->file && fseek(impl->file, pos, whence[mode]) == 0;
+}
+
+size_t File::position() const {
+    return impl && impl->file ? (size_t)ftell(impl->file) : 0;
+}
+
+size_t File::size() const {
+    if (!impl || !impl->file) return 0;
+    fflush(impl->file);
+    struct stat st;
+    return fstat(fileno(impl->file), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+time_t File::getLastWrite() {
+    if (!impl) return 0;
+    if (impl->file) fflush(impl->file);
+    struct stat st;
+    return stat(impl->hostPath.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+const char* File::path() const {
+    return impl ? impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const {
+    if (!impl) return nullptr;
+    size_t slash = impl->path.rfind('/');
+    return impl->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+bool File::isDirectory() const {
+    return impl && impl->dir;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl || !impl->dir) return File();
+    while (struct dirent* entry = readdir(impl->dir)) {
+        if (entry->d_name[0] == '.') continue;
+        std::string path = impl->path;
+        if (path.empty() || path.back() != '/') path += '/';
+        path += entry->d_name;
+        return File(impl->hostPath + "/" + entry->d_name, path, mode);
+    }
+    return File();
+}
+
+void File::close() {
+    impl.reset();
+}
+
+File::operator bool() const {
+    return impl != nullptr;
+}
+
+File FS::open(const char* path, const char* mode, bool) {
+    return File(native_sdPath(path), path, mode);
+}
+
+bool FS::exists(const char* path) {
+    struct stat st;
+    return stat(native_sdPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return unlink(native_sdPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return ::rename(native_sdPath(from).c_str(), native_sdPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return ::mkdir(native_sdPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+    return ::rmdir(native_sdPath(path).c_str()) == 0;
+}
+
+}  // namespace fs
+
+// "Mounting" creates the card directory so a fresh checkout just runs
+bool SDFS::begin(uint8_t) {
+    const std::string& root = native_sdRoot();
+    struct stat st;
+    if (stat(root.c_str(), &st) != 0 && ::mkdir(root.c_str(), 0755) != 0) return false;
+    return stat(root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+uint64_t SDFS::cardSize()   { return 16ULL << 30; }
+uint64_t SDFS::totalBytes() { return 16ULL << 30; }
+uint64_t SDFS::usedBytes()  { return 0; }
@@ -0,0 +1,122 @@
+#include "HX711.h"
+#include "DFRobot_AS7341.h"
+#include "ds18b20.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+// Simulated world, shared by the fakes and set from the console
+static std::atomic<float> load{0};
+static std::atomic<float> noiseGrams{0.05f};
+static std::atomic<float> temperature{22.0f};
+
+static std::mutex spectrumLock;
+static uint16_t spectrumBasis[10] = {1200, 1800, 2300, 2700, 3000, 3300, 3500, 3100, 9000, 1400};
+
+static float gaussian(float sigma) {
+    static thread_local std::mt19937 engine(std::random_device{}());
+    return sigma > 0 ? std::normal_distribution<float>(0, sigma)(engine) : 0;
+}
+
+void native_setLoad(float grams) { load = grams; }
+float native_load() { return load; }
+void native_setNoise(float grams) { noiseGrams = grams; }
+void native_setTemperature(float celsius) { temperature = celsius; }
+
+void native_setSpectrum(const uint16_t basis[10]) {
+    std::lock_guard<std::mutex> lock(spectrumLock);
+    memcpy(spectrumBasis, basis, sizeof(spectrumBasis));
+}
+
+/* ---------- HX711 ---------- */
+
+static uint32_t hx711Conversion() {
+    return native_millis() / NATIVE_HX711_PERIOD_MS;
+}
+
+void HX711::begin(uint8_t dataPin, uint8_t, bool) {
+    this->dataPin = dataPin;
+    lastReadConversion = hx711Conversion();
+
+    // DOUT edge generator: the real chip pulls DOUT low when a sample is ready
+    static std::once_flag started;
+    std::call_once(started, [dataPin] {
+        std::thread([dataPin] {
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(NATIVE_HX711_PERIOD_MS));
+                native_raiseInterrupt(dataPin);
+            }
+        }).detach();
+    });
+}
+
+bool HX711::is_ready() {
+    return hx711Conversion() != lastReadConversion;
+}
+
+void HX711::wait_ready(uint32_t ms) {
+    while (!is_ready()) delay(ms ? ms : 1);
+}
+
+float HX711::read() {
+    wait_ready(1);
+    lastReadConversion = hx711Conversion();
+
+    float counts = NATIVE_HX711_OFFSET + (load + gaussian(noiseGrams)) * NATIVE_HX711_COUNTS_PER_GRAM;
+    return (float)constrain((int32_t)lroundf(counts), -0x800000, 0x7fffff);
+}
+
+float HX711::read_average(uint8_t times) {
+    if (times == 0) times = 1;
+    double sum = 0;
+    for (uint8_t i = 0; i < times; ++i) sum += read();
+    return sum / times;
+}
+
+/* ---------- AS7341 ---------- */
+
+int DFRobot_AS7341::begin(eMode_t) {
+    return 0;
+}
+
+void DFRobot_AS7341::startMeasure(eChChoose_t) {
+    measureStartedUs = native_micros();
+}
+
+bool DFRobot_AS7341::measureComplete() {
+    uint32_t integrationUs = (uint32_t)((atime + 1) * (astep + 1) * 2.78f);
+    return native_micros() - measureStartedUs >= integrationUs;
+}
+
+// AGAIN 0 is x0.5, then doubling up to x512 at 10
+uint16_t DFRobot_AS7341::channel(int index) {
+    uint16_t basis;
+    {
+        std::lock_guard<std::mutex> lock(spectrumLock);
+        basis = spectrumBasis[index];
+    }
+    float gain = ldexpf(1.0f, (int)again - 4);
+    float integration = (float)(atime + 1) * (astep + 1) / (30.0f * 600.0f);
+    float counts = basis * gain * integration * (1.0f + gaussian(0.01f));
+
+    float fullScale = std::min(65535.0f, (float)(atime + 1) * (astep + 1));
+    return (uint16_t)constrain(counts, 0.0f, fullScale);
+}
+
+DFRobot_AS7341::sModeOneData_t DFRobot_AS7341::readSpectralDataOne() {
+    return {channel(0), channel(1), channel(2), channel(3), channel(8), channel(9)};
+}
+
+DFRobot_AS7341::sModeTwoData_t DFRobot_AS7341::readSpectralDataTwo() {
+    return {channel(4), channel(5), channel(6), channel(7), channel(8), channel(9)};
+}
+
+/* ---------- DS18B20 ---------- */
+
+float DS18B20::getTemperature( uint8_t )
+{
+    // 1/16 degC resolution like the real 12-bit conversion
+    return roundf( ( temperature + gaussian( 0.03f ) ) * 16.0f ) / 16.0f;
+}
@@ -0,0 +1,111 @@
+#include "WString.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+template <typename T>
+static std::string integerToString(T v, unsigned char base) {
+    if (base == 10) return std::to_string(v);
+
+    bool negative = v < 0;
+    unsigned long long u = negative ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+    std::string out;
+    do {
+        int digit = u % base;
+        out += (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        u /= base;
+    } while (u);
+    if (negative) out += '-';
+    std::reverse(out.begin(), out.end());
+    return out;
+}
+
+static std::string floatToString(double v, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    return buf;
+}
+
+String::String(int v, unsigned char base) : s(integerToString(v, base)) {}
+String::String(unsigned int v, unsigned char base) : s(integerToString(v, base)) {}
+String::String(long v, unsigned char base) : s(integerToString(v, base)) {}
+String::String(unsigned long v, unsigned char base) : s(integerToString(v, base)) {}
+String::String(long long v, unsigned char base) : s(integerToString(v, base)) {}
+String::String(unsigned long long v, unsigned char base) : s(integerToString(v, base)) {}
+String::String(float v, unsigned int decimals) : s(floatToString(v, decimals)) {}
+String::String(double v, unsigned int decimals) : s(floatToString(v, decimals)) {}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    return s.size() == other.s.size() && strcasecmp(s.c_str(), other.s.c_str()) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return s.size() >= suffix.s.size() &&
+           s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t i = s.find(c, from);
+    return i == std::string::npos ? -1 : (int)i;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+    size_t i = s.find(str.s, from);
+    return i == std::string::npos ? -1 : (int)i;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t i = s.rfind(c);
+    return i == std::string::npos ? -1 : (int)i;
+}
+
+int String::lastIndexOf(const String& str) const {
+    size_t i = s.rfind(str.s);
+    return i == std::string::npos ? -1 : (int)i;
+}
+
+// Arduino swaps the bounds when they are reversed
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s.size()) return String();
+    if (to > s.size()) to = s.size();
+    return String(s.substr(from, to - from));
+}
+
+void String::trim() {
+    size_t begin = 0, end = s.size();
+    while (begin < end && isspace((unsigned char)s[begin])) ++begin;
+    while (end > begin && isspace((unsigned char)s[end - 1])) --end;
+    s = s.substr(begin, end - begin);
+}
+
+void String::toLowerCase() {
+    for (char& c : s) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (char& c : s) c = toupper((unsigned char)c);
+}
+
+void String::replace(const String& find, const String& with) {
+    if (find.s.empty()) return;
+    size_t pos = 0;
+    while ((pos = s.find(find.s, pos)) != std::string::npos) {
+        s.replace(pos, find.s.size(), with.s);
+        pos += with.s.size();
+    }
+}
+
+long String::toInt() const {
+    return strtol(s.c_str(), nullptr, 10);
+}
+
+float String::toFloat() const {
+    return strtof(s.c_str(), nullptr);
+}
+
+double String::toDouble() const {
+    return strtod(s.c_str(), nullptr);
+}
@@ -0,0 +1,19 @@
+#include "WiFi.h"
+
+WiFiClass WiFi;
+
+wl_status_t WiFiClass::begin(const char* ssid, const char*) {
+    this->ssid = ssid ? ssid : "";
+    currentStatus = WL_CONNECTED;
+    return currentStatus;
+}
+
+bool WiFiClass::disconnect(bool) {
+    currentStatus = WL_DISCONNECTED;
+    return true;
+}
+
+bool WiFiClass::softAP(const char* ssid, const char*, int, int, int) {
+    Serial.printf("[native] soft-AP '%s' (simulated)\n", ssid);
+    return true;
+}
@@ -0,0 +1,81 @@
+// Process entry for env:native: runs the sketch like the ESP32 core's
+// loopTask, plus a console on stdin that plays the physical world.
+//
+//   w <grams>        put a mass on the platform (0 to empty it)
+//   noise <grams>    RMS noise of the load cell
+//   t <celsius>      load-cell temperature
+//   spec <10 counts> AS7341 spectrum (F1-F8, Clear, NIR at default gain)
+//   bat <mV>         battery voltage
+//   ble <text>       write text to the BLE RX characteristic
+//   press <gpio> [ms]   hold an active-low button down (default 100 ms)
+//   quit
+
+#include "Arduino.h"
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+static void handleCommand(const std::string& line) {
+    std::istringstream in(line);
+    std::string cmd;
+    in >> cmd;
+
+    if (cmd == "w") {
+        float grams;
+        if (in >> grams) native_setLoad(grams);
+    } else if (cmd == "noise") {
+        float grams;
+        if (in >> grams) native_setNoise(grams);
+    } else if (cmd == "t") {
+        float celsius;
+        if (in >> celsius) native_setTemperature(celsius);
+    } else if (cmd == "spec") {
+        uint16_t counts[10];
+        int n = 0;
+        while (n < 10 && in >> counts[n]) ++n;
+        if (n == 10) native_setSpectrum(counts);
+        else fprintf(stderr, "[native] spec needs 10 values\n");
+    } else if (cmd == "bat") {
+        uint32_t mv;
+        if (in >> mv) native_setBatteryMilliVolts(mv);
+    } else if (cmd == "ble") {
+        std::string text;
+        std::getline(in >> std::ws, text);
+        if (!native_bleWrite(text)) fprintf(stderr, "[native] no BLE characteristic to write\n");
+    } else if (cmd == "press") {
+        int pin, ms = 100;
+        if (!(in >> pin)) return;
+        in >> ms;
+        std::thread([pin, ms] {
+            digitalWrite(pin, LOW);
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            digitalWrite(pin, HIGH);
+        }).detach();
+    } else if (cmd == "quit" || cmd == "exit") {
+        fflush(stdout);
+        _Exit(0);
+    } else if (!cmd.empty()) {
+        fprintf(stderr, "[native] commands: w, noise, t, spec, bat, ble, press, quit\n");
+    }
+}
+
+// Test suites bring their own main()
+#ifndef PIO_UNIT_TESTING
+int main() {
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    std::thread([] {
+        std::string line;
+        while (std::getline(std::cin, line)) handleCommand(line);
+        // stdin closed (e.g. run in the background): keep running
+    }).detach();
+
+    try {
+        setup();
+        for (;;) loop();
+    } catch (const NativeTaskDeleted&) {
+        // loop() deleted itself; the other tasks carry on
+    }
+    for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+}
+#endif
@@ -15,6 +15,19 @@ float DS18B20::getTemperature( uint8_t index )
     return sensors.getTempCByIndex( index );
 }
 
+uint32_t DS18B20::requestTemperature()
+{
+    sensors.setWaitForConversion( false );
+    sensors.requestTemperatures();
+    sensors.setWaitForConversion( true );
+    return sensors.millisToWaitForConversion( sensors.getResolution() );
+}
+
+float DS18B20::readTemperature( uint8_t index )
+{
+    return sensors.getTempCByIndex( index );
+}
+
 uint64_t DS18B20::getAddres( uint8_t index )
 {
     uint64_t retval;
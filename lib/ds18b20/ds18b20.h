@@ -20,6 +20,21 @@ public:
      */
     float getTemperature( uint8_t index );
 
+    /**
+     * @brief Start a conversion on all sensors without waiting for it
+     *
+     * @return `uint32_t`   Time in milliseconds until the result is ready
+     */
+    uint32_t requestTemperature();
+
+    /**
+     * @brief Read the result of the last requested conversion
+     *
+     * @param index         Sensor index
+     * @return `float`      Temperature in Celsius, `DEVICE_DISCONNECTED_C` on error
+     */
+    float readTemperature( uint8_t index );
+
     /**
      * @brief Get device address
      *
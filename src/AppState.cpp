@@ -0,0 +1,429 @@
+#include "AppState.h"
+#include <WiFi.h>
+#include <algorithm>
+#include <cmath>
+#include "Scale_LoadCell.h"
+#include "Color_Sensor.h"
+#include "pin_config.h"
+#include "Metrics.h"
+
+extern FoodManager foodManager;
+
+// Below this the battery is about to brown out; stop buffering log writes
+#define BATTERY_WARN_MV 3400
+
+// Board buttons, active low, polled by the app task:
+//   tare button       short: tare            long: back to the boot zero
+//   container button  short: next container  long: drop the newest tare
+#define BUTTON_TARE_PIN        PIN_BUTTON_2
+#define BUTTON_CONTAINER_PIN   PIN_BUTTON_1
+#define BUTTON_LONG_MS         800
+#define BUTTON_DEBOUNCE_MS     30
+
+// A container recalled onto an empty platform is expected to go on next;
+// an item this close to its weight is the container, not food
+#define CONTAINER_MATCH_GRAMS  3.0f
+#define CONTAINER_MATCH_RATIO  0.03f
+
+static QueueHandle_t commandQueue = nullptr;
+static TaskHandle_t  appTaskHandle = nullptr;
+
+// Published copy, guarded by a spinlock: the copy takes well under a
+// microsecond, so neither side waits noticeably
+static AppSnapshot   published = {};
+static portMUX_TYPE  publishLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Working state, only touched by the app task
+static AppSnapshot   state = {};
+
+static void publish() {
+    state.sequence++;
+    portENTER_CRITICAL(&publishLock);
+    published = state;
+    portEXIT_CRITICAL(&publishLock);
+}
+
+static void reply(const AppCommand& cmd, AppResult result, float grams = 0) {
+    if (!cmd.reply) return;
+    AppReply r = {cmd.id, result, grams};
+    xQueueOverwrite(cmd.reply, &r);
+}
+
+// Food and color for hands-free logging, only touched by the app task
+static char autoLogColor[APP_COLOR_MAX] = "";
+
+// Weight of a recalled container that is not on the platform yet, 0 = none
+static float expectedContainer = 0;
+
+// End of the local day state.totals counts; 0 until the clock has synced
+static time_t totalsUntil = 0;
+
+// /reset before the clock synced; recorded once the day is known
+static bool resetUnsynced = false;
+
+enum ButtonPress : uint8_t { PRESS_NONE, PRESS_SHORT, PRESS_LONG };
+
+struct Button {
+    uint8_t  pin;
+    bool     down;
+    bool     longFired;
+    uint32_t changedAt;
+};
+
+static Button tareButton = {BUTTON_TARE_PIN, false, false, 0};
+static Button containerButton = {BUTTON_CONTAINER_PIN, false, false, 0};
+static size_t nextContainer = 0;   // container button cycles the library
+
+// Adds `grams` of food to the totals and queues the log row
+static void addLogEntry(const FoodItem& food, float grams, const char* color) {
+    float factor = grams / 100.0;
+    DailyNutrition macros = {
+        food.calories * factor,
+        food.protein  * factor,
+        food.carbs    * factor,
+        food.fat      * factor
+    };
+
+    state.totals.calories += macros.calories;
+    state.totals.protein  += macros.protein;
+    state.totals.carbs    += macros.carbs;
+    state.totals.fat      += macros.fat;
+
+    // Timestamp
+    String timestamp = "offline";
+    time_t now = 0;
+    if (state.timeSynced && WiFi.status() == WL_CONNECTED) {
+        now = time(nullptr);
+        struct tm tm;
+        localtime_r(&now, &tm);
+        char buf[25];
+        strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+        timestamp = buf;
+    }
+
+    foodManager.queueLogEntry(food, grams, timestamp, now, macros, color);
+
+    strlcpy(state.foodName, food.name.c_str(), sizeof(state.foodName));
+    state.foodPer100g = {food.calories, food.protein, food.carbs, food.fat};
+    strlcpy(state.lastLog.food, food.name.c_str(), sizeof(state.lastLog.food));
+    state.lastLog.grams = grams;
+    state.lastLog.macros = macros;
+    state.lastLog.ts = now;
+    state.logCount++;
+    state.version++;
+}
+
+// Today's totals from the rollup, plus `extra` the rollup does not have
+static void loadTotals(time_t now, DailyNutrition extra) {
+    DailyNutrition today = {0, 0, 0, 0};
+    foodManager.restoreDailyTotalsFromDatabase(today);
+    state.totals.calories = today.calories + extra.calories;
+    state.totals.protein  = today.protein  + extra.protein;
+    state.totals.carbs    = today.carbs    + extra.carbs;
+    state.totals.fat      = today.fat      + extra.fat;
+    state.version++;
+
+    struct tm tm;
+    localtime_r(&now, &tm);
+    tm.tm_mday++;
+    tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    totalsUntil = mktime(&tm);
+}
+
+// Only a settled reading is logged, never whatever the load was doing
+// mid-step. With an item the detector saw go on, that item's own weight is
+// logged, so foods can be stacked on one plate; otherwise the whole load.
+static void logFood(const AppCommand& cmd) {
+    const WeightReading& reading = state.reading;
+    if (!reading.stable || scale_isSettling()) return reply(cmd, APP_NOT_SETTLED);
+
+    float grams = state.pendingGrams > 0 ? state.pendingGrams : reading.grams;
+    if (grams <= 0) return reply(cmd, APP_INVALID_WEIGHT);
+
+    FoodItem food;
+    if (!foodManager.findFood(cmd.food, food)) return reply(cmd, APP_FOOD_NOT_FOUND);
+
+    addLogEntry(food, grams, cmd.color);
+    state.pendingGrams = 0;
+
+    // The caller reads the snapshot next; it must already show this entry
+    publish();
+    reply(cmd, APP_OK, grams);
+}
+
+// Mirrors the scale's tare stack into the state after any change
+static void tareChanged() {
+    const TareStack& tares = scale_getTares();
+    state.tareGrams = tares.total();
+    state.tareDepth = tares.depth();
+    strlcpy(state.container, tares.container(), sizeof(state.container));
+    Serial.printf("🟡 Tare %.1fg, %u deep %s\n", state.tareGrams, state.tareDepth, state.container);
+    state.reading = scale_getReading();
+    state.pendingGrams = 0;   // measured against the old zero
+    state.version++;
+    publish();
+}
+
+static AppResult recallContainer(const char* name) {
+    ContainerItem container;
+    if (!foodManager.findContainer(name, container)) return APP_CONTAINER_NOT_FOUND;
+
+    float gross = state.reading.grams + scale_getTares().total();
+    expectedContainer = gross < container.tareGrams / 2 ? container.tareGrams : 0;
+    scale_recallTare(container.tareGrams, container.name);
+    return APP_OK;
+}
+
+static AppResult changeTare(const AppCommand& cmd) {
+    AppResult result = APP_OK;
+    switch (cmd.type) {
+        case CMD_TARE:
+            if (!scale_tare()) result = APP_TARE_LIMIT;
+            break;
+        case CMD_UNTARE:
+            if (!scale_untare()) result = APP_TARE_LIMIT;
+            break;
+        case CMD_CLEAR_TARE:
+            scale_clearTare();
+            break;
+        default:
+            result = recallContainer(cmd.food);
+            break;
+    }
+    if (cmd.type != CMD_RECALL_CONTAINER) expectedContainer = 0;
+    if (result == APP_OK) tareChanged();
+    return result;
+}
+
+static ButtonPress pollButton(Button& button, uint32_t now) {
+    bool pressed = digitalRead(button.pin) == LOW;
+    if (pressed != button.down) {
+        if (now - button.changedAt < BUTTON_DEBOUNCE_MS) return PRESS_NONE;
+        button.down = pressed;
+        button.changedAt = now;
+        bool wasLong = button.longFired;
+        button.longFired = false;
+        return !pressed && !wasLong ? PRESS_SHORT : PRESS_NONE;
+    }
+    if (button.down && !button.longFired && now - button.changedAt >= BUTTON_LONG_MS) {
+        button.longFired = true;
+        return PRESS_LONG;
+    }
+    return PRESS_NONE;
+}
+
+static void handleButtons() {
+    uint32_t now = millis();
+    switch (pollButton(tareButton, now)) {
+        case PRESS_SHORT: changeTare(app_command(CMD_TARE)); break;
+        case PRESS_LONG:  changeTare(app_command(CMD_CLEAR_TARE)); break;
+        default: break;
+    }
+    switch (pollButton(containerButton, now)) {
+        case PRESS_SHORT: {
+            ContainerItem container;
+            if (!foodManager.containerAt(nextContainer, container)) {
+                nextContainer = 0;
+                if (!foodManager.containerAt(0, container)) {
+                    Serial.println("⚠️ No containers in the library");
+                    break;
+                }
+            }
+            nextContainer++;
+            changeTare(app_command(CMD_RECALL_CONTAINER, container.name));
+            break;
+        }
+        case PRESS_LONG:
+            changeTare(app_command(CMD_UNTARE));
+            break;
+        default:
+            break;
+    }
+}
+
+static void setAutoLog(const AppCommand& cmd) {
+    FoodItem food;
+    if (cmd.food[0] && !foodManager.findFood(cmd.food, food)) return reply(cmd, APP_FOOD_NOT_FOUND);
+
+    strlcpy(state.autoLogFood, cmd.food, sizeof(state.autoLogFood));
+    strlcpy(autoLogColor, cmd.color, sizeof(autoLogColor));
+    state.version++;
+    publish();
+    reply(cmd, APP_OK);
+}
+
+// Items going on are logged straight away when hands-free logging is on,
+// or kept for the next CMD_LOG_FOOD. Taking something off forgets the
+// pending item: it may be the one that went.
+static void handleWeighEvent(const WeighEvent& event) {
+    state.lastWeigh = event;
+    state.weighCount++;
+    state.version++;
+
+    if (event.type == WEIGH_REMOVED) state.pendingGrams = 0;
+    if (event.type != WEIGH_ADDED) return;
+
+    if (expectedContainer > 0) {
+        float tolerance = std::max(CONTAINER_MATCH_GRAMS, CONTAINER_MATCH_RATIO * expectedContainer);
+        bool isContainer = std::fabs(event.grams - expectedContainer) <= tolerance;
+        expectedContainer = 0;
+        if (isContainer) return;
+    }
+    state.pendingGrams = event.grams;
+    if (!state.autoLogFood[0]) return;
+
+    FoodItem food;
+    if (!foodManager.findFood(state.autoLogFood, food)) {
+        Serial.printf("⚠️ Hands-free food '%s' is gone, logging stopped\n", state.autoLogFood);
+        state.autoLogFood[0] = '\0';
+        return;
+    }
+    addLogEntry(food, event.grams, autoLogColor);
+    state.pendingGrams = 0;
+    Serial.printf("🤚 Logged %.1fg of %s hands-free\n", event.grams, state.autoLogFood);
+}
+
+static void handleCommand(const AppCommand& cmd) {
+    switch (cmd.type) {
+        case CMD_TARE:
+        case CMD_UNTARE:
+        case CMD_CLEAR_TARE:
+        case CMD_RECALL_CONTAINER:
+            reply(cmd, changeTare(cmd));
+            break;
+        case CMD_LOG_FOOD:
+            logFood(cmd);
+            break;
+        case CMD_RESET_TOTALS:
+            // Recorded in the rollup too, or the next boot would restore them
+            if (state.timeSynced) foodManager.resetDailyTotals(time(nullptr));
+            else resetUnsynced = true;
+            state.totals = {0, 0, 0, 0};
+            state.foodName[0] = '\0';
+            state.foodPer100g = {0, 0, 0, 0};
+            state.version++;
+            break;
+        case CMD_AUTO_LOG:
+            setAutoLog(cmd);
+            break;
+        case CMD_NETWORK:
+            state.network = cmd.network;
+            state.version++;
+            break;
+    }
+}
+
+static void appTask(void*) {
+    MetricHistogram& cycle = metrics_histogram(METRIC_TASK_CYCLE, "task", "app");
+
+    for (;;) {
+        // Commands wake the task at once; otherwise it ticks to publish weight
+        AppCommand cmd;
+        bool received = xQueueReceive(commandQueue, &cmd, pdMS_TO_TICKS(APP_TASK_PERIOD_MS)) == pdTRUE;
+        MetricTimer timer(cycle);
+        if (received) {
+            handleCommand(cmd);
+            while (xQueueReceive(commandQueue, &cmd, 0) == pdTRUE) handleCommand(cmd);
+        }
+
+        handleButtons();
+        state.reading = scale_getReading();
+        WeighEvent weighEvent;
+        while (scale_popEvent(weighEvent)) handleWeighEvent(weighEvent);
+
+        // Keep the newest usable spectrum; clipped ones would skew the ratios
+        SpectralSample spectrum;
+        while (popSpectralSample(spectrum)) {
+            if (spectrum.saturated) continue;
+            std::copy(spectrum.f, spectrum.f + 10, state.spectrum.begin());
+            state.spectrumAt = spectrum.timestamp;
+        }
+
+        foodManager.handle();
+
+        // Battery sense is behind a 1:2 divider
+        if (analogReadMilliVolts(PIN_BAT_VOLT) * 2 < BATTERY_WARN_MV) {
+            foodManager.flushLogQueue();
+        }
+
+        time_t now = time(nullptr);
+        if (!state.timeSynced && now > 24 * 3600) {
+            Serial.println("✅ Time synchronized!");
+            state.timeSynced = true;
+            if (resetUnsynced) foodManager.resetDailyTotals(now);
+            // Entries logged so far have no day and are not in the rollup
+            loadTotals(now, state.totals);
+        } else if (state.timeSynced && now >= totalsUntil) {
+            Serial.println("🌅 New day, totals start from zero");
+            loadTotals(now, {0, 0, 0, 0});
+        }
+
+        publish();
+    }
+}
+
+void app_start() {
+    if (appTaskHandle) return;
+
+    pinMode(BUTTON_TARE_PIN, INPUT_PULLUP);
+    pinMode(BUTTON_CONTAINER_PIN, INPUT_PULLUP);
+    state.reading = scale_getReading();
+    publish();
+
+    commandQueue = xQueueCreate(APP_QUEUE_SIZE, sizeof(AppCommand));
+    metrics_gauge(METRIC_QUEUE_DEPTH, "queue", "app", [](void*) -> uint32_t {
+        return commandQueue ? uxQueueMessagesWaiting(commandQueue) : 0;
+    });
+    if (!commandQueue ||
+        xTaskCreatePinnedToCore(appTask, "app", APP_TASK_STACK, nullptr,
+                                APP_TASK_PRIORITY, &appTaskHandle, APP_TASK_CORE) != pdPASS) {
+        Serial.println("❌ Failed to start app task");
+        appTaskHandle = nullptr;
+    }
+}
+
+void app_getSnapshot(AppSnapshot& out) {
+    portENTER_CRITICAL(&publishLock);
+    out = published;
+    portEXIT_CRITICAL(&publishLock);
+}
+
+bool app_post(const AppCommand& cmd) {
+    return commandQueue && xQueueSend(commandQueue, &cmd, 0) == pdTRUE;
+}
+
+QueueHandle_t app_createReplyQueue() {
+    return xQueueCreate(1, sizeof(AppReply));
+}
+
+AppReply app_request(AppCommand& cmd, QueueHandle_t replyQueue) {
+    static uint32_t nextId = 1;   // only needs to differ between a task's requests
+
+    AppReply r = {0, APP_TIMEOUT, 0};
+    cmd.id = __atomic_fetch_add(&nextId, 1, __ATOMIC_RELAXED);
+    cmd.reply = replyQueue;
+
+    // A reply that arrived after an earlier timeout must not be taken for this one
+    xQueueReset(replyQueue);
+    if (!app_post(cmd)) return r;
+
+    uint32_t deadline = millis() + APP_REPLY_TIMEOUT_MS;
+    for (;;) {
+        // Read the clock once: a second read could land past the deadline
+        // and wrap the wait to weeks
+        int32_t left = (int32_t)(deadline - millis());
+        if (left <= 0) break;
+        if (xQueueReceive(replyQueue, &r, pdMS_TO_TICKS(left)) != pdTRUE) break;
+        if (r.id == cmd.id) return r;
+    }
+    return {cmd.id, APP_TIMEOUT, 0};
+}
+
+AppCommand app_command(AppCommandType type, const char* food, const char* color) {
+    AppCommand cmd = {};
+    cmd.type = type;
+    strlcpy(cmd.food, food, sizeof(cmd.food));
+    strlcpy(cmd.color, color, sizeof(cmd.color));
+    return cmd;
+}
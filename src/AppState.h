@@ -0,0 +1,114 @@
+#pragma once
+#include <Arduino.h>
+#include "FoodManager.h"
+#include "ColorMap.h"
+#include "WeightFilter.h"
+#include "WeighEvent.h"
+#include "TareStack.h"
+
+// The app task owns the mutable scale state: filtered weight, daily totals,
+// current food, latest spectrum. Nothing else writes it. Other tasks
+//  - read it through app_getSnapshot(), a consistent copy published after
+//    every change, and
+//  - change it by posting AppCommands to the app task's queue.
+
+#define APP_TASK_STACK     8192    // SQLite runs on this task
+#define APP_TASK_PRIORITY  4       // below the scale acquisition task
+#define APP_TASK_CORE      1
+#define APP_TASK_PERIOD_MS 10      // publish rate when no command arrives
+#define APP_QUEUE_SIZE     16
+#define APP_REPLY_TIMEOUT_MS 1000
+
+#define APP_FOOD_NAME_MAX 48
+#define APP_COLOR_MAX     24
+
+enum AppCommandType : uint8_t {
+    CMD_TARE,           // push the current load on the tare stack
+    CMD_LOG_FOOD,       // log the newest added item as `food`, reply with the result
+    CMD_RESET_TOTALS,
+    CMD_AUTO_LOG,       // log every item added from now on as `food`; "" stops
+    CMD_UNTARE,         // pop the newest tare
+    CMD_CLEAR_TARE,     // back to the boot zero
+    CMD_RECALL_CONTAINER,   // tare by the library weight of container `food`
+    CMD_NETWORK,        // Wi-Fi came up or changed: `network` is the new state
+};
+
+enum AppResult : uint8_t {
+    APP_OK,
+    APP_NOT_SETTLED,
+    APP_INVALID_WEIGHT,
+    APP_FOOD_NOT_FOUND,
+    APP_CONTAINER_NOT_FOUND,
+    APP_TARE_LIMIT,     // tare stack full on a push, empty on a pop
+    APP_TIMEOUT,
+};
+
+// Where the web UI is reached, for the display footer
+struct AppNetwork {
+    uint32_t ip;       // IPAddress as a number, 0 before Wi-Fi is up
+    bool     apMode;   // serving its own access point rather than joined to one
+};
+
+struct AppCommand {
+    AppCommandType type;
+    uint32_t       id;                 // echoed in the reply
+    QueueHandle_t  reply;              // length-1 queue of AppReply, or nullptr
+    char           food[APP_FOOD_NAME_MAX];
+    char           color[APP_COLOR_MAX];
+    AppNetwork     network;            // CMD_NETWORK only
+};
+
+struct AppReply {
+    uint32_t  id;
+    AppResult result;
+    float     grams;
+};
+
+// The most recent logged food, for the log-events topic on /ws
+struct AppLogEvent {
+    char           food[APP_FOOD_NAME_MAX];
+    float          grams;
+    DailyNutrition macros;
+    time_t         ts;             // 0 when the clock was not synced
+};
+
+// Plain data only, so a snapshot can be copied in one go
+struct AppSnapshot {
+    uint32_t       sequence;       // bumps on every publish
+    uint32_t       version;        // bumps when anything but the live weight changes
+    WeightReading  reading;
+    DailyNutrition totals;
+    DailyNutrition foodPer100g;
+    char           foodName[APP_FOOD_NAME_MAX];   // "" when nothing is selected
+    Spectrum       spectrum;
+    uint32_t       spectrumAt;     // millis() of the newest usable spectrum, 0 = none
+    bool           timeSynced;
+    uint32_t       logCount;       // foods logged since boot; lastLog is the newest
+    AppLogEvent    lastLog;
+    uint32_t       weighCount;     // weigh events since boot; lastWeigh is the newest
+    WeighEvent     lastWeigh;
+    float          pendingGrams;   // newest added item not logged yet, 0 = none
+    char           autoLogFood[APP_FOOD_NAME_MAX];   // "" unless hands-free logging is on
+    float          tareGrams;      // sum of the tare stack; gross = reading + tareGrams
+    uint8_t        tareDepth;
+    char           container[TARE_LABEL_MAX];        // recalled container, "" for none
+    AppNetwork     network;
+};
+
+// Starts the app task; FoodManager and the sensors must be set up already
+void app_start();
+
+// Latest published state; safe from any task
+void app_getSnapshot(AppSnapshot& out);
+
+// Fire-and-forget command; false if the queue is full
+bool app_post(const AppCommand& cmd);
+
+// Sends cmd and waits for the app task's answer on `reply` (a queue from
+// app_createReplyQueue(), one per calling task)
+AppReply app_request(AppCommand& cmd, QueueHandle_t reply);
+QueueHandle_t app_createReplyQueue();
+
+// Builds a command; food and color are only used by CMD_LOG_FOOD and
+// CMD_AUTO_LOG, food also by CMD_RECALL_CONTAINER (the container name)
+AppCommand app_command(AppCommandType type, const char* food = "", const char* color = "");
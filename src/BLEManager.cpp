@@ -1,16 +1,12 @@
 #include "BLEManager.h"
+#include "AppState.h"
+#include "Metrics.h"
 
 // BLE UUIDs
 #define NUS_SERVICE_UUID "6E400001-B5A3-F393-E0A9-E50E24DCCA9E"
 #define NUS_CHAR_UUID_RX "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"
 #define NUS_CHAR_UUID_TX "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"
 
-extern std::vector<FoodItem> foodDatabase;
-extern DailyNutrition dailyTotals;
-extern FoodItem currentFood;
-extern float weight;
-extern bool needDisplayUpdate;
-
 static BLEManager* bleManagerRef = nullptr;  // Static reference!
 
 class ServerCallbacks : public BLEServerCallbacks {
@@ -61,36 +57,84 @@ void BLEManager::begin() {
     Serial.println("🔵 BLE advertising ‘KitchenScaleBLE’");
 
     bleQueue = xQueueCreate(10, sizeof(BLECommand));
+    appReply = app_createReplyQueue();
+    metrics_gauge(METRIC_QUEUE_DEPTH, "queue", "ble", [](void* queue) -> uint32_t {
+        return uxQueueMessagesWaiting(static_cast<QueueHandle_t>(queue));
+    }, bleQueue);
     bleManagerRef = this;  // Set static pointer to this
+
+    xTaskCreatePinnedToCore(bleTask, "ble", BLE_TASK_STACK, this,
+                            BLE_TASK_PRIORITY, nullptr, BLE_TASK_CORE);
 }
 
-void BLEManager::loop() {
-    processBLE();
+void BLEManager::bleTask(void* arg) {
+    for (;;) static_cast<BLEManager*>(arg)->processBLE();
 }
 
+// Tare commands as on /ws; false for anything else
+static bool tareCommand(const String& s, AppCommand& cmd) {
+    if (s == "tare") cmd = app_command(CMD_TARE);
+    else if (s == "untare") cmd = app_command(CMD_UNTARE);
+    else if (s == "tare:clear") cmd = app_command(CMD_CLEAR_TARE);
+    else if (s.startsWith("container:")) cmd = app_command(CMD_RECALL_CONTAINER, s.substring(10).c_str());
+    else return false;
+    return true;
+}
+
+// Blocks until a food name or tare command arrives; a food is logged like
+// a web selection
 void BLEManager::processBLE() {
+    static MetricHistogram& cycle = metrics_histogram(METRIC_TASK_CYCLE, "task", "ble");
     BLECommand cmd;
-    while (xQueueReceive(bleQueue, &cmd, 0) == pdTRUE) {
-        String s;
-        s.reserve(cmd.len);
-        for (int i = 0; i < cmd.len; ++i) s += (char)cmd.data[i];
-        s.trim();
-
-        for (auto& item : foodDatabase) {
-            if (s.equalsIgnoreCase(item.name)) {
-                currentFood = item;
-                float factor = weight / 100.0f;
-                dailyTotals.calories += item.calories * factor;
-                dailyTotals.protein  += item.protein  * factor;
-                dailyTotals.carbs    += item.carbs    * factor;
-                dailyTotals.fat      += item.fat      * factor;
-                needDisplayUpdate = true;
-
-                String response = "Logged: " + item.name;
-                sendNotification(response);
+    if (xQueueReceive(bleQueue, &cmd, portMAX_DELAY) != pdTRUE) return;
+    MetricTimer timer(cycle);
+
+    String s;
+    s.reserve(cmd.len);
+    for (int i = 0; i < cmd.len; ++i) s += (char)cmd.data[i];
+    s.trim();
+
+    AppCommand tare;
+    if (tareCommand(s, tare)) {
+        AppReply reply = app_request(tare, appReply);
+        AppSnapshot state;
+        app_getSnapshot(state);
+        switch (reply.result) {
+            case APP_OK:
+                sendNotification("Tare " + String(state.tareGrams, 0) + " g " + state.container);
+                break;
+            case APP_CONTAINER_NOT_FOUND:
+                sendNotification("No container: " + s.substring(10));
+                break;
+            case APP_TARE_LIMIT:
+                sendNotification(tare.type == CMD_TARE ? "Tare stack full" : "No tare to undo");
+                break;
+            default:
+                sendNotification("Busy, try again");
                 break;
-            }
         }
+        return;
+    }
+
+    AppCommand log = app_command(CMD_LOG_FOOD, s.c_str());
+    AppReply reply = app_request(log, appReply);
+
+    switch (reply.result) {
+        case APP_OK:
+            sendNotification("Logged: " + s + " (" + String(reply.grams, 0) + " g)");
+            break;
+        case APP_NOT_SETTLED:
+            sendNotification("Weight not settled");
+            break;
+        case APP_INVALID_WEIGHT:
+            sendNotification("Invalid weight");
+            break;
+        case APP_FOOD_NOT_FOUND:
+            sendNotification("Not found: " + s);
+            break;
+        default:
+            sendNotification("Busy, try again");
+            break;
     }
 }
 
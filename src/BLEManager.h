@@ -6,6 +6,10 @@
 #include <BLE2902.h>
 #include "FoodManager.h"
 
+#define BLE_TASK_STACK    4096
+#define BLE_TASK_PRIORITY 2
+#define BLE_TASK_CORE     0
+
 // Make BLECommand PUBLIC
 struct BLECommand {
     uint8_t data[64];
@@ -18,14 +22,16 @@ QueueHandle_t getQueue() {
     return bleQueue;
 }
 
+    // Also starts the task that handles received food names
     void begin();
     void sendNotification(const String& message);
-    void loop();  // New: call loop inside main
 
 private:
+    static void bleTask(void* arg);
     void processBLE();
 
     BLECharacteristic* pTxCharacteristic;
     BLECharacteristic* pRxCharacteristic;
     QueueHandle_t bleQueue = nullptr;
+    QueueHandle_t appReply = nullptr;
 };
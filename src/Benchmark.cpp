@@ -0,0 +1,69 @@
+#include "Benchmark.h"
+#include <algorithm>
+
+// Nearest-rank percentiles over the sorted samples
+BenchStats BenchSamples::stats() {
+    BenchStats s;
+    if (samples.empty()) return s;
+
+    std::sort(samples.begin(), samples.end());
+    auto rank = [&](uint32_t percent) {
+        size_t i = (samples.size() * percent + 99) / 100;
+        return samples[i ? i - 1 : 0];
+    };
+
+    double sum = 0;
+    for (int64_t us : samples) sum += us;
+
+    s.count = samples.size();
+    s.min   = samples.front();
+    s.p50   = rank(50);
+    s.p95   = rank(95);
+    s.p99   = rank(99);
+    s.max   = samples.back();
+    s.mean  = sum / samples.size();
+    return s;
+}
+
+Benchmark::Benchmark(JsonWriter& json, const char* platform) : json(json) {
+    json.beginObject();
+    json.key("suite").value(BENCH_SUITE_NAME);
+    json.key("version").value((int32_t)BENCH_REPORT_VERSION);
+    json.key("platform").value(platform);
+    json.key("results").beginArray();
+}
+
+void Benchmark::beginResult(const char* name, BenchParams params, const char* unit) {
+    json.beginObject();
+    json.key("name").value(name);
+    json.key("params").beginObject();
+    for (const BenchParam& p : params) json.key(p.key).value(p.value);
+    json.endObject();
+    json.key("unit").value(unit);
+    results++;
+}
+
+void Benchmark::record(const char* name, BenchParams params, BenchSamples& samples, const char* unit) {
+    BenchStats s = samples.stats();
+    beginResult(name, params, unit);
+    json.key("n").value((int32_t)s.count);
+    json.key("min").value(s.min);
+    json.key("p50").value(s.p50);
+    json.key("p95").value(s.p95);
+    json.key("p99").value(s.p99);
+    json.key("max").value(s.max);
+    json.key("mean").value(s.mean);
+    json.endObject();
+}
+
+void Benchmark::value(const char* name, BenchParams params, const char* unit, double value) {
+    beginResult(name, params, unit);
+    json.key("value").value(value);
+    json.endObject();
+}
+
+void Benchmark::finish() {
+    json.endArray();
+    json.endObject();
+    json.flush();
+}
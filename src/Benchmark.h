@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+#include <esp_timer.h>
+#include "JsonWriter.h"
+
+// Benchmark harness for env:bench (device) and env:native_bench (host).
+// Scenarios are timed with esp_timer_get_time() and written as one JSON
+// report, so two runs can be compared with tools/bench_diff.py:
+//
+//   {"suite":"scale-bench","version":1,"platform":"esp32s3","results":[
+//     {"name":"catalogue.find","params":{"foods":5000},"unit":"us",
+//      "n":1000,"min":3,"p50":4,"p95":6,"p99":9,"max":41,"mean":4.21},
+//     {"name":"hx711.rate","params":{"seconds":10},"unit":"sps","value":79.8},
+//     ...]}
+//
+// A result is identified by its name plus params; units say which way is
+// better ("us", "ms" and "bytes" lower, "sps" and "ops" higher).
+
+#define BENCH_SUITE_NAME     "scale-bench"
+#define BENCH_REPORT_VERSION 1
+#define BENCH_MAX_SAMPLES    4096   // per result; further samples are ignored
+
+struct BenchParam {
+    const char* key;
+    int32_t     value;
+};
+
+using BenchParams = std::initializer_list<BenchParam>;
+
+struct BenchStats {
+    uint32_t count = 0;
+    int64_t  min = 0, p50 = 0, p95 = 0, p99 = 0, max = 0;
+    double   mean = 0;
+};
+
+// Per-iteration times of one result, for scenarios that time themselves
+// (e.g. when every iteration needs untimed setup)
+class BenchSamples {
+public:
+    BenchSamples() { samples.reserve(64); }
+
+    void add(int64_t us) {
+        if (samples.size() < BENCH_MAX_SAMPLES) samples.push_back(us);
+    }
+    void clear() { samples.clear(); }
+    size_t size() const { return samples.size(); }
+
+    // Sorts the samples in place
+    BenchStats stats();
+
+private:
+    std::vector<int64_t> samples;
+};
+
+// Microsecond stopwatch around one block
+class BenchTimer {
+public:
+    BenchTimer() : start(esp_timer_get_time()) {}
+    int64_t elapsed() const { return esp_timer_get_time() - start; }
+
+private:
+    int64_t start;
+};
+
+class Benchmark {
+public:
+    // Opens the report; results are streamed to json as they are recorded
+    Benchmark(JsonWriter& json, const char* platform);
+
+    // Runs fn warmup times untimed, then iterations times timed
+    template <typename Fn>
+    void run(const char* name, BenchParams params, uint32_t iterations, Fn&& fn, uint32_t warmup = 1) {
+        for (uint32_t i = 0; i < warmup; ++i) fn();
+        samples.clear();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            BenchTimer timer;
+            fn();
+            samples.add(timer.elapsed());
+        }
+        record(name, params, samples);
+    }
+
+    // Distribution result from samples the scenario collected itself
+    void record(const char* name, BenchParams params, BenchSamples& samples, const char* unit = "us");
+
+    // Single-number result: a rate, a size, a count
+    void value(const char* name, BenchParams params, const char* unit, double value);
+
+    // Closes the report and flushes the writer
+    void finish();
+
+    uint32_t resultCount() const { return results; }
+
+private:
+    void beginResult(const char* name, BenchParams params, const char* unit);
+
+    JsonWriter&  json;
+    BenchSamples samples;
+    uint32_t     results = 0;
+};
@@ -0,0 +1,119 @@
+#include "CalibrationModel.h"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+CalibrationModel CalibrationModel::fromFactor(float offset, float factor) {
+    CalibrationModel model;
+    model.offset0 = offset;
+    model.gain0 = factor;
+    model.seal();
+    return model;
+}
+
+float CalibrationModel::toGrams(int32_t raw, float temperature) const {
+    float dT = std::isnan(temperature) ? 0.0f : temperature - CALIBRATION_REF_TEMP;
+    float offset = offset0 + offsetSlope * dT;
+    float gain = gain0 + gainSlope * dT;
+    return (raw - offset) / gain;
+}
+
+uint16_t CalibrationModel::computeChecksum() const {
+    // Fletcher-16 over everything after the checksum field
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&offset0);
+    size_t len = sizeof(*this) - offsetof(CalibrationModel, offset0);
+    uint16_t a = version & 0xFF, b = a;
+    for (size_t i = 0; i < len; ++i) {
+        a = (a + bytes[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return uint16_t((b << 8) | a);
+}
+
+bool CalibrationModel::isValid() const {
+    return version == CALIBRATION_VERSION && checksum == computeChecksum() &&
+           std::isfinite(gain0) && std::fabs(gain0) > 1e-6f;
+}
+
+void CalibrationFitter::add(float temperature, int32_t raw, float referenceGrams) {
+    if (std::isnan(temperature)) return;
+
+    double dT = temperature - CALIBRATION_REF_TEMP;
+    double a[4] = {1.0, dT, referenceGrams, referenceGrams * dT};
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) ata[i][j] += a[i] * a[j];
+        atb[i] += a[i] * raw;
+    }
+    btb += (double)raw * raw;
+    rows++;
+
+    if (temperature < minTemp) minTemp = temperature;
+    if (temperature > maxTemp) maxTemp = temperature;
+}
+
+bool CalibrationFitter::addCsvLine(const char* line) {
+    if (!line || *line == '#' || !(isdigit((unsigned char)*line) || *line == '-')) return false;
+
+    char* end;
+    strtoul(line, &end, 10);  // millis, only kept for plotting
+    if (*end != ',') return false;
+    float temperature = strtof(end + 1, &end);
+    if (*end != ',') return false;
+    long raw = strtol(end + 1, &end, 10);
+    if (*end != ',') return false;
+    float reference = strtof(end + 1, &end);
+
+    add(temperature, (int32_t)raw, reference);
+    return true;
+}
+
+bool CalibrationFitter::fit(CalibrationModel& out) const {
+    if (rows < 4) return false;
+
+    // Gaussian elimination with partial pivoting on the 4x4 normal equations
+    double m[4][5];
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) m[i][j] = ata[i][j];
+        m[i][4] = atb[i];
+    }
+
+    for (int col = 0; col < 4; ++col) {
+        int pivot = col;
+        for (int r = col + 1; r < 4; ++r) {
+            if (std::fabs(m[r][col]) > std::fabs(m[pivot][col])) pivot = r;
+        }
+        if (std::fabs(m[pivot][col]) < 1e-9) return false;  // e.g. no reference mass, or one temperature only
+        if (pivot != col) {
+            for (int k = 0; k < 5; ++k) std::swap(m[col][k], m[pivot][k]);
+        }
+        for (int r = 0; r < 4; ++r) {
+            if (r == col) continue;
+            double f = m[r][col] / m[col][col];
+            for (int k = col; k < 5; ++k) m[r][k] -= f * m[col][k];
+        }
+    }
+
+    out = CalibrationModel();
+    out.offset0     = float(m[0][4] / m[0][0]);
+    out.offsetSlope = float(m[1][4] / m[1][1]);
+    out.gain0       = float(m[2][4] / m[2][2]);
+    out.gainSlope   = float(m[3][4] / m[3][3]);
+    out.seal();
+    return out.isValid();
+}
+
+float CalibrationFitter::residualGrams(const CalibrationModel& model) const {
+    if (rows == 0) return 0;
+
+    // SSE = b'b - 2 x'A'b + x'A'Ax, so no rows have to be replayed
+    double x[4] = {model.offset0, model.offsetSlope, model.gain0, model.gainSlope};
+    double sse = btb;
+    for (int i = 0; i < 4; ++i) {
+        sse -= 2 * x[i] * atb[i];
+        for (int j = 0; j < 4; ++j) sse += x[i] * ata[i][j] * x[j];
+    }
+    if (sse < 0) sse = 0;
+    return float(std::sqrt(sse / rows) / std::fabs(model.gain0));
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Load-cell model with linear temperature drift on both zero and span:
+//
+//   raw = offset(T) + grams * gain(T)
+//   offset(T) = offset0 + offsetSlope * (T - CALIBRATION_REF_TEMP)
+//   gain(T)   = gain0   + gainSlope   * (T - CALIBRATION_REF_TEMP)
+//
+// Stored as a 24-byte blob (NVS on the device, printed by the host fitter).
+
+#define CALIBRATION_VERSION  1
+#define CALIBRATION_REF_TEMP 25.0f   // degC the coefficients are centred on
+
+struct CalibrationModel {
+    uint16_t version     = 0;
+    uint16_t checksum    = 0;
+    float    offset0     = 0;   // raw counts at zero load, ref temp
+    float    offsetSlope = 0;   // raw counts per degC
+    float    gain0       = 1;   // raw counts per gram, ref temp
+    float    gainSlope   = 0;   // (raw counts per gram) per degC
+    float    reserved    = 0;
+
+    // Uncompensated model equivalent to HX711::set_offset()/set_scale()
+    static CalibrationModel fromFactor(float offset, float factor);
+
+    // Convert a raw sample. A NaN temperature means "no sensor" and
+    // evaluates the model at the reference temperature.
+    float toGrams(int32_t raw, float temperature) const;
+
+    uint16_t computeChecksum() const;
+    void seal() { version = CALIBRATION_VERSION; checksum = computeChecksum(); }
+    bool isValid() const;
+};
+
+static_assert(sizeof(CalibrationModel) == 24, "CalibrationModel must stay compact");
+
+// Streaming least-squares fit of the four model coefficients. Each row of
+// /calibration.csv is added once; no samples are kept in memory.
+class CalibrationFitter {
+public:
+    void add(float temperature, int32_t raw, float referenceGrams);
+
+    // Parse one line of /calibration.csv ("millis,temperature,raw,reference").
+    // Comment/header lines are ignored. Returns true if a row was added.
+    bool addCsvLine(const char* line);
+
+    // Solve the normal equations. Needs rows at zero load and at least one
+    // reference mass, ideally spread over the temperature range.
+    bool fit(CalibrationModel& out) const;
+
+    size_t rowCount() const { return rows; }
+    float minTemperature() const { return minTemp; }
+    float maxTemperature() const { return maxTemp; }
+
+    // RMS residual of the fitted model over the rows seen, in grams
+    float residualGrams(const CalibrationModel& model) const;
+
+private:
+    double ata[4][4] = {};
+    double atb[4] = {};
+    double btb = 0;
+    size_t rows = 0;
+    float  minTemp = 1e9f;
+    float  maxTemp = -1e9f;
+};
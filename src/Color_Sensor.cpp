@@ -1,4 +1,10 @@
 #include "Color_Sensor.h"
+#include "SampleRing.h"
+#include "Metrics.h"
+
+// Spectra handed from the acquisition task to loop()
+static SampleRing<SpectralSample, 8> spectralSamples;
+static TaskHandle_t spectralTaskHandle = nullptr;
 
 /* ---------- PUBLIC API ---------- */
 bool initSpectralSensor(DFRobot_AS7341 &sensor,
@@ -17,49 +23,73 @@ bool initSpectralSensor(DFRobot_AS7341 &sensor,
   return true;
 }
 
-bool captureSpectrum(DFRobot_AS7341 &sensor, spectralColor &out, colorSensorState &state) {
+/*  Run one SMUX group to completion. In eSpm mode startMeasure() may
+    already wait for the result; either way the task only sleeps here.   */
+static void measureGroup(DFRobot_AS7341 &sensor, DFRobot_AS7341::eChChoose_t group) {
+  sensor.startMeasure(group);
+  while (!sensor.measureComplete()) {
+    vTaskDelay(pdMS_TO_TICKS(2));
+  }
+}
 
-  /* First SMUX group: F1-F4 + Clear + NIR */
-  if (state == INACTIVE) {
+static void spectralAcquisitionTask(void *arg) {
+  DFRobot_AS7341 &sensor = *static_cast<DFRobot_AS7341 *>(arg);
+  SpectralSettings settings;
 
-    sensor.startMeasure(DFRobot_AS7341::eF1F4ClearNIR);
-    state = ACTIVE1;
-    return false;
+  for (;;) {
+    SpectralSample sample;
+    sample.settings = settings;
 
-  } else if (state == ACTIVE1) {
+    /* First SMUX group: F1-F4 + Clear + NIR */
+    measureGroup(sensor, DFRobot_AS7341::eF1F4ClearNIR);
+    auto g1 = sensor.readSpectralDataOne();
 
-    if (sensor.measureComplete()) {
-        auto g1 = sensor.readSpectralDataOne();
-        out.f[0] = g1.ADF1;  out.f[1] = g1.ADF2;  out.f[2] = g1.ADF3;  out.f[3] = g1.ADF4;
-        out.f[8] = g1.ADCLEAR;   // Clear (no-filter)
-        out.f[9] = g1.ADNIR;     // Near-IR
+    /* Second SMUX group: F5-F8 + Clear + NIR */
+    measureGroup(sensor, DFRobot_AS7341::eF5F8ClearNIR);
+    auto g2 = sensor.readSpectralDataTwo();
 
-        sensor.startMeasure(DFRobot_AS7341::eF5F8ClearNIR);
-        state = ACTIVE2;
-    }
+    sample.timestamp = millis();
+    sample.f[0] = g1.ADF1;  sample.f[1] = g1.ADF2;  sample.f[2] = g1.ADF3;  sample.f[3] = g1.ADF4;
+    sample.f[4] = g2.ADF5;  sample.f[5] = g2.ADF6;  sample.f[6] = g2.ADF7;  sample.f[7] = g2.ADF8;
 
-    return false;
-    
-  } else if (state == ACTIVE2) {
+    /* Average the duplicate Clear/NIR measurements for stability */
+    sample.f[8] = uint16_t((uint32_t(g1.ADCLEAR) + g2.ADCLEAR) / 2);
+    sample.f[9] = uint16_t((uint32_t(g1.ADNIR)   + g2.ADNIR)   / 2);
 
-    if (sensor.measureComplete()) {
-        auto g2 = sensor.readSpectralDataTwo();
-        out.f[4] = g2.ADF5;  out.f[5] = g2.ADF6;  out.f[6] = g2.ADF7;  out.f[7] = g2.ADF8;
+    // Clear is averaged; a clipped single group still counts as saturated
+    uint16_t clearPeak = max(g1.ADCLEAR, g2.ADCLEAR);
+    uint16_t peaks[10];
+    memcpy(peaks, sample.f, sizeof(peaks));
+    peaks[8] = clearPeak;
+    sample.saturated = SpectralAutoRange::saturated(peaks, settings);
 
-        /* Average the duplicate Clear/NIR measurements for stability */
-        out.f[8] = uint16_t((uint32_t(out.f[8]) + g2.ADCLEAR) / 2);
-        out.f[9] = uint16_t((uint32_t(out.f[9]) + g2.ADNIR)   / 2);
+    spectralSamples.push(sample);  // a full ring drops the newest; loop() only wants recent ones anyway
 
-        state = INACTIVE;  // Reset state for next capture
-        return true;       // Spectrum capture complete
+    // New settings only take effect between spectra
+    if (SpectralAutoRange::update(peaks, settings)) {
+      sensor.setAGAIN(settings.again);
+      sensor.setAtime(settings.atime);
+      sensor.setAstep(settings.astep);
     }
-  } else {
+  }
+}
 
-    Serial.println("Invalid state in captureSpectrum()");
+bool startSpectralAcquisition(DFRobot_AS7341 &sensor) {
+  if (spectralTaskHandle) return true;
 
-    // Invalid state, reset to INACTIVE
-    state = INACTIVE;
+  metrics_gauge(METRIC_QUEUE_DEPTH, "queue", "spectral", [](void*) -> uint32_t { return spectralSamples.size(); });
+  BaseType_t ok = xTaskCreatePinnedToCore(spectralAcquisitionTask, "spectral", SPECTRAL_TASK_STACK,
+                                          &sensor, SPECTRAL_TASK_PRIORITY, &spectralTaskHandle,
+                                          SPECTRAL_TASK_CORE);
+  if (ok != pdPASS) {
+    Serial.println("❌ Failed to start spectral acquisition task");
+    spectralTaskHandle = nullptr;
+    return false;
   }
+  Serial.println("🌈 Spectral acquisition running");
+  return true;
+}
 
-  return false;  // No valid capture  
+bool popSpectralSample(SpectralSample &out) {
+  return spectralSamples.pop(out);
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include <DFRobot_AS7341.h>
+#include "SpectralAutoRange.h"
 
 /*  A single entry in your colour-reference table.
     Provide one row per colour you want to classify.          */
@@ -9,22 +10,31 @@ struct spectralColor {
   uint16_t f[10];              // F1-F8, Clear, NIR (in that order)
 };
 
-enum colorSensorState {
-    INACTIVE,
-    ACTIVE1,
-    ACTIVE2
+/*  One complete spectrum from the acquisition task.
+    Both SMUX groups were taken back-to-back with the same settings.  */
+struct SpectralSample {
+  uint16_t         f[10];      // F1-F8, Clear, NIR (in that order)
+  uint32_t         timestamp;  // millis() when the second group finished
+  SpectralSettings settings;   // gain / integration used for this spectrum
+  bool             saturated;  // a channel hit full scale, don't trust ratios
 };
 
+#define SPECTRAL_TASK_STACK     4096
+#define SPECTRAL_TASK_PRIORITY  2     // below the scale task
+#define SPECTRAL_TASK_CORE      1
+
 /*  Initialise the AS7341 in spectral-pulse mode (eSpm).
     Returns true on success, false if the chip is missing.    */
 bool initSpectralSensor(DFRobot_AS7341 &sensor,
-                        uint8_t  again  = 4,      // 0-10  (×0.5 … ×512) gain
-                        uint8_t  atime  = 100,    // integration time register - time per step
-                        uint16_t astep  = 999,    // number of steps - steps per read 
-                        uint8_t  wtime  = 0);     // wait time between reads
+                        uint8_t  again  = SPECTRAL_AGAIN_DEFAULT,  // 0-10  (×0.5 … ×512) gain
+                        uint8_t  atime  = SPECTRAL_ATIME_DEFAULT,  // integration time register - time per step
+                        uint16_t astep  = SPECTRAL_ASTEP,          // number of steps - steps per read
+                        uint8_t  wtime  = 0);                      // wait time between reads
 
-/*  Grab one full 10-channel spectrum.  
-    On success ‘out[0]…out[9]’ is filled as:
-    F1-F8 = visible bands, [8]=Clear, [9]=NIR.               */
-bool captureSpectrum(DFRobot_AS7341 &sensor, spectralColor &out, colorSensorState &state);
+/*  Start the background task that measures F1-F4 and F5-F8 back-to-back,
+    auto-ranges gain/integration after every spectrum and publishes the
+    results. The task owns the sensor (and its I2C traffic) from then on. */
+bool startSpectralAcquisition(DFRobot_AS7341 &sensor);
 
+/*  Pop the oldest unread spectrum. Single consumer; never blocks.      */
+bool popSpectralSample(SpectralSample &out);
@@ -0,0 +1,135 @@
+#include "CsvReader.h"
+#include <cstring>
+
+CsvReader::CsvReader(char* buffer, size_t capacity, char separator)
+    : buffer(buffer), capacity(capacity), separator(separator) {}
+
+bool CsvReader::commit(size_t n, RowFn fn, void* ctx) {
+    used += n;
+    total += n;
+    return parse(false, fn, ctx);
+}
+
+bool CsvReader::write(const char* data, size_t len, RowFn fn, void* ctx) {
+    while (len) {
+        size_t n = len < spaceLeft() ? len : spaceLeft();
+        memcpy(space(), data, n);
+        used += n;
+        total += n;
+        data += n;
+        len -= n;
+        if (spaceLeft() == 0 && !parse(false, fn, ctx)) return false;
+    }
+    return !stopped && !overflow;
+}
+
+bool CsvReader::finish(RowFn fn, void* ctx) {
+    return parse(true, fn, ctx);
+}
+
+// Finds each row end (a line break outside quotes), then splits the row.
+// Most rows have no quotes, so the search jumps from line break to line
+// break and only walks byte by byte through rows that do.
+bool CsvReader::parse(bool final, RowFn fn, void* ctx) {
+    if (stopped || overflow) return false;
+
+    size_t start = 0;
+    size_t pos = scanned;
+    while (pos < used) {
+        char* end = nullptr;
+        if (!inQuotes) {
+            char* nl = (char*)memchr(buffer + pos, '\n', used - pos);
+            size_t stop = nl ? nl - buffer : used;
+            if (!memchr(buffer + pos, '"', stop - pos)) {
+                end = nl;
+                pos = stop;
+            }
+        }
+        if (!end) {
+            for (; pos < used; ++pos) {
+                char ch = buffer[pos];
+                if (ch == '"') inQuotes = !inQuotes;
+                else if (ch == '\n' && !inQuotes) break;
+            }
+            end = pos < used ? buffer + pos : nullptr;
+        }
+        if (!end) break;
+
+        CsvRow row;
+        split(buffer + start, end, row);
+        pos = start = end - buffer + 1;
+        if (row.count == 1 && row.lengths[0] == 0) continue;   // blank line
+        if (!fn(ctx, row)) {
+            stopped = true;
+            return false;
+        }
+    }
+
+    if (final) {
+        if (start < used) {
+            CsvRow row;
+            split(buffer + start, buffer + used, row);   // terminated in the byte kept free below
+            if (!(row.count == 1 && row.lengths[0] == 0) && !fn(ctx, row)) {
+                stopped = true;
+                return false;
+            }
+        }
+        used = scanned = 0;
+        inQuotes = false;
+        return true;
+    }
+
+    // Keep the unfinished row for the next fill
+    used -= start;
+    memmove(buffer, buffer + start, used);
+    scanned = used;
+    // One byte stays free for finish() to terminate an unfinished last row
+    if (used + 1 >= capacity) {
+        overflow = true;
+        return false;
+    }
+    return true;
+}
+
+void CsvReader::split(char* start, char* end, CsvRow& row) {
+    if (end > start && end[-1] == '\r') --end;
+    *end = '\0';
+
+    row.count = 0;
+    char* p = start;
+    for (;;) {
+        char* field = p;
+        size_t length;
+        if (*p == '"') {
+            char* out = p++;
+            field = out;
+            while (p < end) {
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') {
+                        *out++ = '"';
+                        p += 2;
+                        continue;
+                    }
+                    ++p;
+                    break;
+                }
+                *out++ = *p++;
+            }
+            while (p < end && *p != separator) ++p;   // anything after the closing quote
+            length = out - field;
+            *out = '\0';
+        } else {
+            char* sep = (char*)memchr(p, separator, end - p);
+            p = sep ? sep : end;
+            length = p - field;
+        }
+
+        if (row.count < CSV_MAX_FIELDS) {
+            row.fields[row.count] = field;
+            row.lengths[row.count] = length;
+            row.count++;
+        }
+        if (p >= end) break;
+        *p++ = '\0';
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Single-pass CSV tokenizer over a block buffer the caller fills. Rows are
+// split where they stand: every field is NUL-terminated in place of its
+// separator and quoted fields ("a, b", "say ""hi""") are unescaped in place,
+// so a row is a set of pointers into the block and no byte is copied. A row
+// cut off at the end of a block moves to the front for the next fill; each
+// byte is scanned once however the input is sliced. No Arduino
+// dependencies: the scale and tools/food_import.cpp share it.
+//
+//   char block[8192];
+//   CsvReader csv(block, sizeof(block));
+//   size_t n;
+//   while ((n = fread(csv.space(), 1, csv.spaceLeft(), f)) > 0) csv.commit(n, onRow, ctx);
+//   csv.finish(onRow, ctx);
+//
+// Blank lines are skipped, CRLF line ends are fine, and fields past
+// CSV_MAX_FIELDS are dropped. A row has to fit in the block.
+
+#define CSV_MAX_FIELDS 32
+
+struct CsvRow {
+    const char* fields[CSV_MAX_FIELDS];
+    size_t      lengths[CSV_MAX_FIELDS];
+    size_t      count;
+
+    // "" for a column the row does not have
+    const char* operator[](size_t i) const { return i < count ? fields[i] : ""; }
+};
+
+class CsvReader {
+public:
+    // Called for every row; false stops the reader
+    using RowFn = bool (*)(void* ctx, const CsvRow& row);
+
+    CsvReader(char* buffer, size_t capacity, char separator = ',');
+
+    // Where the next bytes go, and how many fit
+    char*  space() { return buffer + used; }
+    size_t spaceLeft() const { return capacity - used; }
+
+    // n bytes were written to space(): hands every row they complete to fn.
+    // False once fn stopped or a row was longer than the block.
+    bool commit(size_t n, RowFn fn, void* ctx);
+
+    // Copies data in for input that arrives in another buffer. Rows are
+    // only handed out once the block is full (or at finish()), so small
+    // slices still come out a block at a time.
+    bool write(const char* data, size_t len, RowFn fn, void* ctx);
+
+    // End of input: the last row may lack its line break
+    bool finish(RowFn fn, void* ctx);
+
+    bool     overflowed() const { return overflow; }
+    uint64_t bytes() const { return total; }
+
+private:
+    bool parse(bool final, RowFn fn, void* ctx);
+    void split(char* start, char* end, CsvRow& row);
+
+    char*    buffer;
+    size_t   capacity;
+    size_t   used = 0;
+    size_t   scanned = 0;       // bytes of the pending row already searched for its end
+    bool     inQuotes = false;  // quote state at scanned
+    bool     overflow = false;
+    bool     stopped = false;
+    char     separator;
+    uint64_t total = 0;
+};
@@ -2,54 +2,106 @@
 #include <WiFi.h>  // For access to WiFi status and IP
 #include "WebServerManager.h"
 
-extern FoodItem currentFood;  // In other files
+void DisplayManager::setWeightFields(float weight) {
+    // Right-aligned so a changing weight only touches the digits that moved
+    screen.setf(FIELD_WEIGHT, "Wt: %5.0f g", weight);
 
-void DisplayManager::begin() {
-    tft.begin();
-    tft.setRotation(1);
-    tft.fillScreen(TFT_BLACK);
-    tft.setTextColor(TFT_GREEN, TFT_BLACK);
-    tft.setTextSize(2);
-    tft.println("Smart Kitchen Scale");
+    if (hasFood) {
+        float fct = weight / 100.0;
+        screen.setf(FIELD_FOOD_MACROS1, "Cal: %.0f  Prot: %.0f", foodPer100g.calories * fct, foodPer100g.protein * fct);
+        screen.setf(FIELD_FOOD_MACROS2, "Carb: %.0f  Fat:  %.0f", foodPer100g.carbs * fct, foodPer100g.fat * fct);
+    }
 }
 
-void DisplayManager::updateDisplay(float weight, FoodItem* currentFood, DailyNutrition& totals, const String& ip, const String& mode) {
-    tft.fillScreen(TFT_BLACK);
-    tft.setCursor(0, 0);
-    tft.setTextSize(1);
-
-    tft.println("Kitchen Scale");
-    tft.printf("Wt: %.0f g\n\n", weight);
+void DisplayManager::updateDisplay(const AppSnapshot& state, const String& ip, const String& mode) {
+    hasFood = state.foodName[0] != '\0';
+    foodPer100g = state.foodPer100g;
+    const DailyNutrition& totals = state.totals;
 
-    if (currentFood) {
-        float fct = weight / 100.0;
-        tft.setTextSize(2);
-        tft.println(currentFood->name);
-        tft.printf("Cal: %.0f  Prot: %.0f\n",
-                   currentFood->calories * fct,
-                   currentFood->protein  * fct);
-        tft.printf("Carb: %.0f  Fat:  %.0f\n\n",
-                   currentFood->carbs * fct,
-                   currentFood->fat   * fct);
+    // The title says what the weight is net of
+    if (state.container[0] && state.tareDepth > 1) screen.setf(FIELD_TITLE, "Tare: %s +%u", state.container, state.tareDepth - 1);
+    else if (state.container[0]) screen.setf(FIELD_TITLE, "Tare: %s", state.container);
+    else if (state.tareDepth) screen.setf(FIELD_TITLE, "Tare: %.0f g", state.tareGrams);
+    else screen.set(FIELD_TITLE, "Kitchen Scale");
+    if (hasFood) {
+        screen.set(FIELD_FOOD, state.foodName);
     } else {
-        tft.println("No selection\n");
+        screen.set(FIELD_FOOD, "No selection");
+        screen.set(FIELD_FOOD_MACROS1, "");
+        screen.set(FIELD_FOOD_MACROS2, "");
     }
+    setWeightFields(state.reading.grams);
 
-    tft.setTextSize(2);
-    tft.println("Daily Totals:");
-    tft.printf("Cal: %.0f  Prot: %.0f\n", totals.calories, totals.protein);
-    tft.printf("Carb: %.0f  Fat:  %.0f\n", totals.carbs, totals.fat);
+    screen.set(FIELD_TOTALS_TITLE, "Daily Totals:");
+    screen.setf(FIELD_TOTALS1, "Cal: %.0f  Prot: %.0f", totals.calories, totals.protein);
+    screen.setf(FIELD_TOTALS2, "Carb: %.0f  Fat:  %.0f", totals.carbs, totals.fat);
 
-    // Draw IP at the bottom in small font, if connected
+    // IP at the bottom in small font, if connected
     if (!ip.isEmpty()) {
-        tft.setTextSize(1);
-        tft.setCursor(0, tft.height() - 20);
-        tft.print("Mode: ");
-        tft.print(mode);
-    
-        tft.setCursor(0, tft.height() - 10);
-        tft.print("IP: ");
-        tft.print(ip);
+        screen.setf(FIELD_MODE, "Mode: %s", mode.c_str());
+        screen.setf(FIELD_IP, "IP: %s", ip.c_str());
+    } else {
+        screen.set(FIELD_MODE, "");
+        screen.set(FIELD_IP, "");
+    }
+
+    render();
+}
+
+void DisplayManager::updateWeight(float weight) {
+    if (millis() - lastWeightUpdate < DISPLAY_WEIGHT_PERIOD_MS) return;
+    lastWeightUpdate = millis();
+
+    setWeightFields(weight);
+    render();
+}
+
+#ifndef DISPLAY_BACKEND_LVGL
+
+void DisplayManager::begin() {
+    tft.begin();
+    tft.setRotation(1);
+    tft.fillScreen(DISPLAY_BG);
+
+    // Glyphs are rendered off-screen and pushed as one block per dirty span
+    sprite.setColorDepth(16);
+    if (!sprite.createSprite(tft.width(), SCREEN_GLYPH_H * 3)) {
+        Serial.println("⚠️ Display sprite allocation failed");
     }
-        
+    sprite.setTextWrap(false);
+
+    screen.invalidate();
+    screen.set(FIELD_TITLE, "Smart Kitchen Scale");
+    render();
 }
+
+void DisplayManager::handle() {
+}
+
+void DisplayManager::render() {
+    screen.render([this](ScreenField, const Rectangle& rect, const char* text, const ScreenFieldLayout& layout) {
+        if (!sprite.created()) {
+            // No sprite memory: draw straight to the panel
+            tft.fillRect(rect.topLeft.x, rect.topLeft.y, rect.width, rect.height, DISPLAY_BG);
+            tft.setTextSize(layout.textSize);
+            tft.setTextColor(DISPLAY_FG, DISPLAY_BG);
+            tft.setCursor(layout.x, layout.y);
+            tft.print(text);
+            return;
+        }
+
+        // Draw the whole line shifted so the dirty span lands at the sprite
+        // origin; glyphs outside the sprite are clipped
+        int32_t w = rect.width, h = rect.height;
+        sprite.fillRect(0, 0, w, h, DISPLAY_BG);
+        sprite.setTextSize(layout.textSize);
+        sprite.setTextColor(DISPLAY_FG, DISPLAY_BG);
+        sprite.setCursor((int32_t)layout.x - (int32_t)rect.topLeft.x, 0);
+        sprite.print(text);
+
+        // One windowed block transfer over the 8-bit parallel bus
+        sprite.pushSprite(rect.topLeft.x, rect.topLeft.y, 0, 0, w, h);
+    });
+}
+
+#endif
@@ -1,13 +1,46 @@
 #pragma once
 
+#include "AppState.h"
+#include "ScreenModel.h"
+
+// Two backends share the screen model and the formatting below; pick one
+// at build time. env:lvgl builds with -DDISPLAY_BACKEND_LVGL.
+#ifdef DISPLAY_BACKEND_LVGL
+#include "LvglScreen.h"
+#else
 #include <TFT_eSPI.h>
-#include "Utils.h"
+#define DISPLAY_FG TFT_GREEN
+#define DISPLAY_BG TFT_BLACK
+#endif
+
+// Live weight refresh limit (~25 Hz); only changed digits are repainted
+#define DISPLAY_WEIGHT_PERIOD_MS 40
 
 class DisplayManager {
 public:
     void begin();
-    void updateDisplay(float weight, FoodItem* currentFood, DailyNutrition& totals, const String& ip = "", const String& mode = "");
+    void updateDisplay(const AppSnapshot& state, const String& ip = "", const String& mode = "");
+
+    // Cheap path for the live readout: weight and the food macros that
+    // depend on it. Call as often as you like.
+    void updateWeight(float weight);
+
+    // Backend housekeeping (LVGL timers, touch); call from the display task
+    void handle();
 
 private:
+    void setWeightFields(float weight);
+    void render();
+
+    ScreenModel screen;
+    bool hasFood = false;
+    DailyNutrition foodPer100g = {0, 0, 0, 0};
+    uint32_t lastWeightUpdate = 0;
+
+#ifdef DISPLAY_BACKEND_LVGL
+    LvglScreen lvglScreen;
+#else
     TFT_eSPI tft;
+    TFT_eSprite sprite = TFT_eSprite(&tft);   // one line of the tallest field
+#endif
 };
@@ -0,0 +1,179 @@
+// LVGL backend for DisplayManager (env:lvgl, -DDISPLAY_BACKEND_LVGL).
+//
+// TFT_eSPI has no DMA on the S3 parallel bus, so this backend drives the
+// ST7789 through the ESP-IDF i80 LCD driver instead. LVGL renders into one
+// of two partial buffers while the other is still being clocked out by DMA;
+// the transfer-done callback hands the buffer back with lv_disp_flush_ready().
+
+#ifdef DISPLAY_BACKEND_LVGL
+
+#include "DisplayManager.h"
+#include "pin_config.h"
+#include <esp_heap_caps.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_vendor.h>
+
+#ifdef DISPLAY_TOUCH
+#include <Wire.h>
+#include "TouchLib.h"
+#endif
+
+#define LVGL_HOR_RES          320
+#define LVGL_VER_RES          170
+#define LVGL_BUFFER_LINES     40       // 2 x 25.6 KB of internal, DMA-capable SRAM
+#define LVGL_PIXEL_CLOCK_HZ   (6528000)
+#define LVGL_PERF_LOG_MS      10000
+
+static lv_disp_draw_buf_t drawBuffer;
+static lv_disp_drv_t      displayDriver;
+static esp_lcd_panel_handle_t panel = nullptr;
+
+// Filled by LVGL's monitor callback, logged every LVGL_PERF_LOG_MS
+static uint32_t perfFrames = 0;
+static uint32_t perfRenderMs = 0;
+static uint32_t perfPixels = 0;
+static uint32_t perfLoggedAt = 0;
+
+#ifdef DISPLAY_TOUCH
+// The touch controller shares GPIO 17/18 with the HX711 on this build, so
+// it is opt-in (-DDISPLAY_TOUCH) for boards wired without the load cell.
+#if defined(TOUCH_MODULES_CST_MUTUAL)
+static TouchLib touch(Wire, PIN_IIC_SDA, PIN_IIC_SCL, CTS328_SLAVE_ADDRESS, PIN_TOUCH_RES);
+#elif defined(TOUCH_MODULES_CST_SELF)
+static TouchLib touch(Wire, PIN_IIC_SDA, PIN_IIC_SCL, CTS820_SLAVE_ADDRESS, PIN_TOUCH_RES);
+#endif
+
+static void readTouch(lv_indev_drv_t*, lv_indev_data_t* data) {
+    if (touch.read() && touch.getPointNum() > 0) {
+        TP_Point p = touch.getPoint(0);
+        data->point.x = p.x;
+        data->point.y = p.y;
+        data->state = LV_INDEV_STATE_PR;
+    } else {
+        data->state = LV_INDEV_STATE_REL;
+    }
+}
+#endif
+
+static bool onTransferDone(esp_lcd_panel_io_handle_t, esp_lcd_panel_io_event_data_t*, void* ctx) {
+    lv_disp_flush_ready(static_cast<lv_disp_drv_t*>(ctx));
+    return false;
+}
+
+// Queues the DMA transfer and returns at once; LVGL goes on rendering into
+// the other buffer
+static void flushDisplay(lv_disp_drv_t*, const lv_area_t* area, lv_color_t* pixels) {
+    esp_lcd_panel_draw_bitmap(panel, area->x1, area->y1, area->x2 + 1, area->y2 + 1, pixels);
+}
+
+static void monitorDisplay(lv_disp_drv_t*, uint32_t renderMs, uint32_t pixels) {
+    perfFrames++;
+    perfRenderMs += renderMs;
+    perfPixels += pixels;
+}
+
+void DisplayManager::begin() {
+    pinMode(PIN_POWER_ON, OUTPUT);
+    digitalWrite(PIN_POWER_ON, HIGH);
+    pinMode(PIN_LCD_RD, OUTPUT);
+    digitalWrite(PIN_LCD_RD, HIGH);
+
+    esp_lcd_i80_bus_handle_t bus = nullptr;
+    esp_lcd_i80_bus_config_t busConfig = {};
+    busConfig.dc_gpio_num = PIN_LCD_DC;
+    busConfig.wr_gpio_num = PIN_LCD_WR;
+    busConfig.clk_src = LCD_CLK_SRC_PLL160M;
+    const int dataPins[8] = {PIN_LCD_D0, PIN_LCD_D1, PIN_LCD_D2, PIN_LCD_D3,
+                             PIN_LCD_D4, PIN_LCD_D5, PIN_LCD_D6, PIN_LCD_D7};
+    for (int i = 0; i < 8; ++i) busConfig.data_gpio_nums[i] = dataPins[i];
+    busConfig.bus_width = 8;
+    busConfig.max_transfer_bytes = LVGL_HOR_RES * LVGL_BUFFER_LINES * sizeof(lv_color_t);
+    ESP_ERROR_CHECK(esp_lcd_new_i80_bus(&busConfig, &bus));
+
+    esp_lcd_panel_io_handle_t io = nullptr;
+    esp_lcd_panel_io_i80_config_t ioConfig = {};
+    ioConfig.cs_gpio_num = PIN_LCD_CS;
+    ioConfig.pclk_hz = LVGL_PIXEL_CLOCK_HZ;
+    ioConfig.trans_queue_depth = 20;
+    ioConfig.on_color_trans_done = onTransferDone;
+    ioConfig.user_ctx = &displayDriver;
+    ioConfig.lcd_cmd_bits = 8;
+    ioConfig.lcd_param_bits = 8;
+    ioConfig.dc_levels.dc_data_level = 1;
+    ESP_ERROR_CHECK(esp_lcd_new_panel_io_i80(bus, &ioConfig, &io));
+
+    esp_lcd_panel_dev_config_t panelConfig = {};
+    panelConfig.reset_gpio_num = PIN_LCD_RES;
+    panelConfig.color_space = ESP_LCD_COLOR_SPACE_RGB;
+    panelConfig.bits_per_pixel = 16;
+    ESP_ERROR_CHECK(esp_lcd_new_panel_st7789(io, &panelConfig, &panel));
+
+    esp_lcd_panel_reset(panel);
+    esp_lcd_panel_init(panel);
+    esp_lcd_panel_invert_color(panel, true);
+    esp_lcd_panel_swap_xy(panel, true);
+    esp_lcd_panel_mirror(panel, false, true);
+    esp_lcd_panel_set_gap(panel, 0, 35);   // 170-line panel on a 240-line controller
+
+    pinMode(PIN_LCD_BL, OUTPUT);
+    digitalWrite(PIN_LCD_BL, HIGH);
+
+    lv_init();
+
+    // Draw buffers must be DMA-capable, which rules out PSRAM
+    size_t pixels = LVGL_HOR_RES * LVGL_BUFFER_LINES;
+    auto* buf1 = (lv_color_t*)heap_caps_malloc(pixels * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    auto* buf2 = (lv_color_t*)heap_caps_malloc(pixels * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!buf1) {
+        Serial.println("❌ LVGL draw buffer allocation failed");
+        return;
+    }
+    if (!buf2) Serial.println("⚠️ LVGL running single-buffered");
+    lv_disp_draw_buf_init(&drawBuffer, buf1, buf2, pixels);
+
+    lv_disp_drv_init(&displayDriver);
+    displayDriver.hor_res = LVGL_HOR_RES;
+    displayDriver.ver_res = LVGL_VER_RES;
+    displayDriver.flush_cb = flushDisplay;
+    displayDriver.monitor_cb = monitorDisplay;
+    displayDriver.draw_buf = &drawBuffer;
+    lv_disp_drv_register(&displayDriver);
+
+#ifdef DISPLAY_TOUCH
+    if (touch.init()) {
+        touch.setRotation(1);
+        static lv_indev_drv_t touchDriver;
+        lv_indev_drv_init(&touchDriver);
+        touchDriver.type = LV_INDEV_TYPE_POINTER;
+        touchDriver.read_cb = readTouch;
+        lv_indev_drv_register(&touchDriver);
+    } else {
+        Serial.println("⚠️ Touch controller not found");
+    }
+#endif
+
+    lvglScreen.create(lv_scr_act());
+    screen.invalidate();
+    screen.set(FIELD_TITLE, "Smart Kitchen Scale");
+    render();
+}
+
+void DisplayManager::handle() {
+    lv_timer_handler();
+
+    uint32_t now = millis();
+    if (now - perfLoggedAt >= LVGL_PERF_LOG_MS && perfFrames > 0) {
+        Serial.printf("🖥️ LVGL: %u frames, %.1f ms render avg, %u px avg\n",
+                      perfFrames, (float)perfRenderMs / perfFrames, perfPixels / perfFrames);
+        perfFrames = perfRenderMs = perfPixels = 0;
+        perfLoggedAt = now;
+    }
+}
+
+// Labels only; LVGL draws and flushes them from handle()
+void DisplayManager::render() {
+    lvglScreen.render(screen);
+}
+
+#endif
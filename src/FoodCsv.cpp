@@ -0,0 +1,80 @@
+#include "FoodCsv.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+static bool contains(const char* text, const char* word) {
+    size_t n = strlen(word);
+    for (; *text; ++text) {
+        if (strncasecmp(text, word, n) == 0) return true;
+    }
+    return false;
+}
+
+static bool isFatColumn(const char* title) {
+    return (contains(title, "fat") || contains(title, "lipid")) && !contains(title, "satur") &&
+           !contains(title, "trans") && !contains(title, "mono") && !contains(title, "poly");
+}
+
+bool FoodCsvColumns::readHeader(const CsvRow& row) {
+    int16_t found[5] = {-1, -1, -1, -1, -1};   // name, calories, protein, carbs, fat
+    int16_t energy = -1;
+
+    for (size_t i = 0; i < row.count; ++i) {
+        const char* title = row.fields[i];
+        int16_t col = (int16_t)i;
+        if (found[0] < 0 && (contains(title, "name") || contains(title, "description") || strcasecmp(title, "food") == 0))
+            found[0] = col;
+        else if (found[1] < 0 && (contains(title, "kcal") || contains(title, "calor")))
+            found[1] = col;
+        else if (energy < 0 && contains(title, "energy") && !contains(title, "kj"))
+            energy = col;
+        else if (found[2] < 0 && contains(title, "protein"))
+            found[2] = col;
+        else if (found[3] < 0 && contains(title, "carb"))
+            found[3] = col;
+        else if (found[4] < 0 && isFatColumn(title))
+            found[4] = col;
+    }
+    if (found[1] < 0) found[1] = energy;
+
+    // A header names at least the food and one macro; data rows do not
+    if (found[0] < 0 || (found[1] < 0 && found[2] < 0 && found[3] < 0 && found[4] < 0)) return false;
+
+    name     = found[0];
+    calories = found[1];
+    protein  = found[2];
+    carbs    = found[3];
+    fat      = found[4];
+    return true;
+}
+
+static bool number(const CsvRow& row, int16_t col, float& out) {
+    const char* text = col >= 0 ? row[col] : "";
+    while (isspace((unsigned char)*text)) ++text;
+    if (!*text) {
+        out = 0;
+        return true;
+    }
+    char* end;
+    out = strtof(text, &end);
+    while (isspace((unsigned char)*end)) ++end;
+    return end != text && *end == '\0';
+}
+
+bool FoodCsvColumns::parse(const CsvRow& row, const char*& nameOut, FoodMacros& per100g) const {
+    // A row cut short is broken, not a food with missing macros
+    int16_t last = name;
+    for (int16_t col : {calories, protein, carbs, fat}) {
+        if (col > last) last = col;
+    }
+    if ((size_t)last >= row.count) return false;
+
+    nameOut = row[name];
+    while (isspace((unsigned char)*nameOut)) ++nameOut;
+    if (!*nameOut) return false;
+
+    return number(row, calories, per100g.calories) && number(row, protein, per100g.protein) &&
+           number(row, carbs, per100g.carbs) && number(row, fat, per100g.fat);
+}
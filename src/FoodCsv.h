@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "CsvReader.h"
+#include "FoodIndex.h"
+
+// Where the name and the macros per 100 g sit in a nutrition CSV. The
+// scale's own layout is the default:
+//
+//   Name,Calories,Protein,Carbs,Fat
+//
+// A first row that names its columns maps them instead, case-insensitive
+// and first match wins, so public tables load without editing:
+//
+//   name      "name", "description", "food"
+//   calories  "kcal" or "calor", else "energy" that is not "kj"
+//   protein   "protein"
+//   carbs     "carb"
+//   fat       "fat" or "lipid", not saturated/trans/mono/poly
+//
+// No Arduino dependencies: the scale and tools/food_import.cpp share it.
+
+struct FoodCsvColumns {
+    int16_t name = 0;
+    int16_t calories = 1;
+    int16_t protein = 2;
+    int16_t carbs = 3;
+    int16_t fat = 4;
+
+    // True if row is a header; the columns it names replace the defaults
+    bool readHeader(const CsvRow& row);
+
+    // False when the row stops before the last mapped column, the name is
+    // empty or a macro is not a number; an empty macro cell reads as 0
+    bool parse(const CsvRow& row, const char*& name, FoodMacros& per100g) const;
+};
@@ -0,0 +1,98 @@
+#include "FoodImporter.h"
+#include <SD.h>
+
+FoodImporter::FoodImporter(FoodManager& foods) : foods(foods), csv(block, sizeof(block)) {}
+
+FoodImporter::~FoodImporter() {
+    if (active) foods.endImport();
+}
+
+bool FoodImporter::begin() {
+    if (active || !foods.beginImport()) {
+        failure = "another import is running";
+        return false;
+    }
+    active = true;
+    startMs = millis();
+    return true;
+}
+
+bool FoodImporter::onRow(void* ctx, const CsvRow& row) {
+    FoodImporter& self = *static_cast<FoodImporter*>(ctx);
+    if (!self.headerChecked) {
+        self.headerChecked = true;
+        if (self.columns.readHeader(row)) return true;
+    }
+
+    ImportProgress& stats = self.stats;
+    stats.rows++;
+    const char* name;
+    FoodMacros per100g;
+    if (!self.columns.parse(row, name, per100g)) {
+        stats.failed++;
+    } else {
+        switch (self.foods.importFood(name, per100g)) {
+            case IMPORT_ADDED:     stats.added++; break;
+            case IMPORT_DUPLICATE: stats.duplicates++; break;
+            case IMPORT_FAILED:    stats.failed++; break;
+        }
+    }
+
+    if (stats.rows % IMPORT_PROGRESS_ROWS == 0) {
+        uint32_t ms = millis() - self.startMs;
+        Serial.printf("⏳ Import: %u rows, %u added (%u rows/s)\n", (unsigned)stats.rows, (unsigned)stats.added,
+                      ms ? (unsigned)((uint64_t)stats.rows * 1000 / ms) : 0);
+    }
+    return true;
+}
+
+// After each block: the batch is committed so the lock is free while the
+// next block is read or still on its way
+bool FoodImporter::checkpoint(bool ok) {
+    if (!ok && !failure) failure = csv.overflowed() ? "row longer than the import block" : "import stopped";
+    if (!foods.commitImport() && !failure) failure = "database write failed";
+    stats.bytes = csv.bytes();
+    stats.elapsedMs = millis() - startMs;
+    return failure == nullptr;
+}
+
+bool FoodImporter::write(const char* data, size_t len) {
+    if (!active || failure) return false;
+    // Rows only come out when the block fills, so most calls have no batch
+    // to commit
+    return checkpoint(csv.write(data, len, onRow, this));
+}
+
+bool FoodImporter::finish() {
+    if (!active) return false;
+    bool ok = failure == nullptr && checkpoint(csv.finish(onRow, this));
+    active = false;
+    if (!foods.endImport() && !failure) failure = "database write failed";
+    stats.elapsedMs = millis() - startMs;
+    ok = ok && failure == nullptr;
+
+    Serial.printf("%s Import: %u rows, %u added, %u duplicates, %u failed in %u ms (%u rows/s)\n",
+                  ok ? "✅" : "❌", (unsigned)stats.rows, (unsigned)stats.added, (unsigned)stats.duplicates,
+                  (unsigned)stats.failed, (unsigned)stats.elapsedMs, (unsigned)stats.rowsPerSecond());
+    return ok;
+}
+
+bool FoodImporter::importFile(const char* path) {
+    File f = SD.open(path);
+    if (!f) {
+        failure = "cannot open file";
+        return false;
+    }
+    if (!begin()) {
+        f.close();
+        return false;
+    }
+
+    bool ok = true;
+    size_t n;
+    while (ok && (n = f.read((uint8_t*)csv.space(), csv.spaceLeft())) > 0) {
+        ok = checkpoint(csv.commit(n, onRow, this));
+    }
+    f.close();
+    return finish() && ok;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <Arduino.h>
+#include "CsvReader.h"
+#include "FoodCsv.h"
+#include "FoodManager.h"
+
+// Streams a nutrition CSV into the catalogue: the whole file is never in
+// memory, every row goes through one cached INSERT, and FoodIndex is built
+// once at the end (see FoodManager::beginImport()). Fed from an SD file or
+// an HTTP upload:
+//
+//   FoodImporter importer(foodManager);
+//   importer.importFile("/foods.csv");
+//
+//   importer.begin();
+//   while (...) importer.write(data, len);
+//   importer.finish();
+//
+// It holds an IMPORT_BLOCK_SIZE block, so keep it on the heap.
+
+#define IMPORT_BLOCK_SIZE     32768   // bytes per SD read, and per batch of rows handed out
+#define IMPORT_PROGRESS_ROWS  10000   // a Serial progress line every this many rows
+
+struct ImportProgress {
+    uint32_t rows = 0;         // data rows read
+    uint32_t added = 0;
+    uint32_t duplicates = 0;   // name already in the catalogue
+    uint32_t failed = 0;       // no name, a macro that is not a number, or the insert failed
+    uint64_t bytes = 0;
+    uint32_t elapsedMs = 0;
+
+    uint32_t rowsPerSecond() const { return elapsedMs ? (uint64_t)rows * 1000 / elapsedMs : 0; }
+};
+
+class FoodImporter {
+public:
+    explicit FoodImporter(FoodManager& foods);
+    ~FoodImporter();   // an unfinished import keeps the batches it committed
+
+    // False while another import runs
+    bool begin();
+    // Any slice of the file; false once the import has failed
+    bool write(const char* data, size_t len);
+    // Last row, last batch, then the catalogue is reindexed
+    bool finish();
+
+    // begin(), the whole file a block at a time, finish()
+    bool importFile(const char* path);
+
+    const ImportProgress& progress() const { return stats; }
+    const char* error() const { return failure; }   // nullptr while fine
+
+private:
+    static bool onRow(void* ctx, const CsvRow& row);
+    bool checkpoint(bool ok);
+
+    FoodManager&   foods;
+    char           block[IMPORT_BLOCK_SIZE];
+    CsvReader      csv;
+    FoodCsvColumns columns;
+    ImportProgress stats;
+    bool           active = false;
+    bool           headerChecked = false;
+    uint32_t       startMs = 0;
+    const char*    failure = nullptr;
+};
@@ -0,0 +1,207 @@
+#include "FoodIndex.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+// Prefix scans stop after this many matching keys so one-letter queries on
+// a huge catalogue stay bounded; ranking is then over the first matches.
+#define FOOD_INDEX_SCAN_LIMIT 4096
+#define FOOD_INDEX_MAX_RESULTS 32
+
+static bool isWordChar(char c) {
+    return isalnum((unsigned char)c) || (unsigned char)c >= 0x80;
+}
+
+void FoodIndex::fold(const char* in, char* out, size_t cap) {
+    while (*in == ' ') ++in;
+    size_t n = 0;
+    for (; *in && n + 1 < cap; ++in) out[n++] = (char)tolower((unsigned char)*in);
+    while (n > 0 && out[n - 1] == ' ') --n;
+    out[n] = '\0';
+}
+
+void FoodIndex::clear() {
+    arena.clear();
+    entries.clear();
+    byName.clear();
+    words.clear();
+    deadBytes = 0;
+    bulkLoading = false;
+}
+
+void FoodIndex::reserve(size_t foods, size_t nameBytes) {
+    arena.reserve(2 * nameBytes + 2 * foods);
+    entries.reserve(foods);
+    byName.reserve(foods);
+    words.reserve(foods * 2);
+}
+
+void FoodIndex::beginBulkLoad() {
+    bulkLoading = true;
+}
+
+void FoodIndex::endBulkLoad() {
+    bulkLoading = false;
+    std::sort(byName.begin(), byName.end(), [this](uint32_t a, uint32_t b) {
+        return strcmp(folded(entries[a].nameOffset), folded(entries[b].nameOffset)) < 0;
+    });
+    std::sort(words.begin(), words.end(), [this](const WordKey& a, const WordKey& b) {
+        return strcmp(folded(a.offset), folded(b.offset)) < 0;
+    });
+}
+
+void FoodIndex::add(int32_t id, const char* name, const FoodMacros& per100g) {
+    size_t len = std::min(strlen(name), (size_t)UINT16_MAX - 1);
+
+    FoodIndexEntry entry;
+    entry.id = id;
+    entry.per100g = per100g;
+    entry.nameOffset = (uint32_t)arena.size();
+
+    // "folded\0original\0"; folding can only shorten the name (trimming)
+    arena.resize(arena.size() + 2 * len + 2);
+    char* key = &arena[entry.nameOffset];
+    fold(name, key, len + 1);
+    entry.nameLength = (uint16_t)strlen(key);
+    memcpy(key + entry.nameLength + 1, name, len);
+    key[entry.nameLength + 1 + len] = '\0';
+    arena.resize(entry.nameOffset + entry.nameLength + 1 + len + 1);
+
+    uint32_t index = (uint32_t)entries.size();
+    entries.push_back(entry);
+
+    const char* k = folded(entry.nameOffset);
+    if (bulkLoading) {
+        byName.push_back(index);
+    } else {
+        auto pos = std::lower_bound(byName.begin(), byName.end(), k, [this](uint32_t e, const char* q) {
+            return strcmp(folded(entries[e].nameOffset), q) < 0;
+        });
+        byName.insert(pos, index);
+    }
+
+    for (uint32_t i = 0; i < entry.nameLength; ++i) {
+        if (!isWordChar(k[i]) || (i > 0 && isWordChar(k[i - 1]))) continue;
+        WordKey word = {entry.nameOffset + i, index};
+        if (bulkLoading) {
+            words.push_back(word);
+        } else {
+            auto pos = std::lower_bound(words.begin(), words.end(), folded(word.offset),
+                                        [this](const WordKey& w, const char* q) {
+                                            return strcmp(folded(w.offset), q) < 0;
+                                        });
+            words.insert(pos, word);
+        }
+    }
+}
+
+const FoodIndexEntry* FoodIndex::find(const char* name) const {
+    char key[MAX_NAME];
+    fold(name, key, sizeof(key));
+
+    auto pos = std::lower_bound(byName.begin(), byName.end(), key, [this](uint32_t e, const char* q) {
+        return strcmp(folded(entries[e].nameOffset), q) < 0;
+    });
+    if (pos == byName.end() || strcmp(folded(entries[*pos].nameOffset), key) != 0) return nullptr;
+    return &entries[*pos];
+}
+
+bool FoodIndex::remove(const char* name) {
+    char key[MAX_NAME];
+    fold(name, key, sizeof(key));
+
+    auto pos = std::lower_bound(byName.begin(), byName.end(), key, [this](uint32_t e, const char* q) {
+        return strcmp(folded(entries[e].nameOffset), q) < 0;
+    });
+    if (pos == byName.end() || strcmp(folded(entries[*pos].nameOffset), key) != 0) return false;
+
+    uint32_t index = *pos;
+    FoodIndexEntry& entry = entries[index];
+    byName.erase(pos);
+
+    // Drop this entry's word keys; each is found by binary search
+    const char* k = folded(entry.nameOffset);
+    for (uint32_t i = 0; i < entry.nameLength; ++i) {
+        if (!isWordChar(k[i]) || (i > 0 && isWordChar(k[i - 1]))) continue;
+        auto w = std::lower_bound(words.begin(), words.end(), k + i, [this](const WordKey& wk, const char* q) {
+            return strcmp(folded(wk.offset), q) < 0;
+        });
+        while (w != words.end() && w->entry != index && strcmp(folded(w->offset), k + i) == 0) ++w;
+        if (w != words.end() && w->entry == index) words.erase(w);
+    }
+
+    deadBytes += 2 * entry.nameLength + 2 + sizeof(FoodIndexEntry);
+    entry.id = -1;
+
+    if (deadBytes > arena.size() / 2) compact();
+    return true;
+}
+
+size_t FoodIndex::search(const char* query, const FoodIndexEntry** out, size_t maxResults) const {
+    char key[MAX_QUERY];
+    fold(query, key, sizeof(key));
+    size_t keyLength = strlen(key);
+    if (keyLength == 0 || maxResults == 0) return 0;
+    if (maxResults > FOOD_INDEX_MAX_RESULTS) maxResults = FOOD_INDEX_MAX_RESULTS;
+
+    // rank: 0 exact name, 1 name prefix, 2 later word; then shorter names
+    uint32_t ranks[FOOD_INDEX_MAX_RESULTS];
+    size_t found = 0;
+
+    auto w = std::lower_bound(words.begin(), words.end(), key, [this](const WordKey& wk, const char* q) {
+        return strcmp(folded(wk.offset), q) < 0;
+    });
+
+    for (size_t scanned = 0; w != words.end() && scanned < FOOD_INDEX_SCAN_LIMIT; ++w, ++scanned) {
+        if (strncmp(folded(w->offset), key, keyLength) != 0) break;
+
+        const FoodIndexEntry* entry = &entries[w->entry];
+        uint32_t tier = w->offset != entry->nameOffset ? 2 : entry->nameLength == keyLength ? 0 : 1;
+        uint32_t rank = (tier << 16) | entry->nameLength;
+
+        // The same food can match through several words: keep its best rank
+        size_t slot = found;
+        for (size_t i = 0; i < found; ++i) {
+            if (out[i] == entry) { slot = i; break; }
+        }
+        if (slot < found) {
+            if (rank >= ranks[slot]) continue;
+            for (size_t i = slot; i + 1 < found; ++i) { out[i] = out[i + 1]; ranks[i] = ranks[i + 1]; }
+            found--;
+        }
+
+        // Insertion into the small sorted result list
+        if (found == maxResults && rank >= ranks[found - 1]) continue;
+        size_t i = found < maxResults ? found++ : found - 1;
+        while (i > 0 && ranks[i - 1] > rank) {
+            out[i] = out[i - 1];
+            ranks[i] = ranks[i - 1];
+            --i;
+        }
+        out[i] = entry;
+        ranks[i] = rank;
+    }
+    return found;
+}
+
+// Rebuild without the removed entries once they waste half the arena
+void FoodIndex::compact() {
+    std::vector<char> oldArena;
+    std::vector<FoodIndexEntry> oldEntries;
+    oldArena.swap(arena);
+    oldEntries.swap(entries);
+
+    clear();
+    reserve(oldEntries.size(), oldArena.size() / 2);
+    beginBulkLoad();
+    for (const FoodIndexEntry& e : oldEntries) {
+        if (e.id < 0) continue;
+        add(e.id, &oldArena[e.nameOffset + e.nameLength + 1], e.per100g);
+    }
+    endBulkLoad();
+}
+
+size_t FoodIndex::memoryUsage() const {
+    return arena.capacity() + entries.capacity() * sizeof(FoodIndexEntry) +
+           byName.capacity() * sizeof(uint32_t) + words.capacity() * sizeof(WordKey);
+}
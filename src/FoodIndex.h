@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// In-RAM catalogue index, built from the Food table and kept in sync on
+// add/delete so lookups never touch SQLite.
+//
+// Names live once in a single arena as "folded\0original\0". Two sorted key
+// arrays point into it: one per food (exact, case-insensitive lookup) and one
+// per word start (prefix search on any word, so "bre" finds "Chicken Breast").
+// All lookups are binary searches. Large arrays land in PSRAM through the
+// normal heap, so the catalogue can grow to tens of thousands of items.
+
+struct FoodMacros {
+    float calories;
+    float protein;
+    float carbs;
+    float fat;
+};
+
+struct FoodIndexEntry {
+    int32_t    id;           // Food.food_id, -1 once removed
+    FoodMacros per100g;
+    uint32_t   nameOffset;   // folded name in the arena; original follows it
+    uint16_t   nameLength;
+};
+
+class FoodIndex {
+public:
+    void clear();
+    void reserve(size_t foods, size_t nameBytes);
+
+    // Between these, add() appends unsorted and the keys are sorted once
+    void beginBulkLoad();
+    void endBulkLoad();
+
+    void add(int32_t id, const char* name, const FoodMacros& per100g);
+    bool remove(const char* name);
+
+    // Exact, case-insensitive match
+    const FoodIndexEntry* find(const char* name) const;
+
+    // Up to maxResults foods with a word starting with query, best first:
+    // exact name, then name prefix, then other words; shorter names first.
+    size_t search(const char* query, const FoodIndexEntry** out, size_t maxResults) const;
+
+    const char* name(const FoodIndexEntry& entry) const { return &arena[entry.nameOffset + entry.nameLength + 1]; }
+    size_t size() const { return byName.size(); }
+    size_t memoryUsage() const;
+
+    static constexpr size_t MAX_QUERY = 64;    // search terms
+    static constexpr size_t MAX_NAME  = 256;   // exact lookups
+
+private:
+    struct WordKey {
+        uint32_t offset;   // arena offset of the word start (folded)
+        uint32_t entry;    // index into entries
+    };
+
+    const char* folded(uint32_t offset) const { return &arena[offset]; }
+    static void fold(const char* in, char* out, size_t cap);
+    void compact();
+
+    std::vector<char>           arena;
+    std::vector<FoodIndexEntry> entries;
+    std::vector<uint32_t>       byName;   // entry indices sorted by folded name
+    std::vector<WordKey>        words;    // sorted by folded text from word start
+    size_t                      deadBytes = 0;
+    bool                        bulkLoading = false;
+};
@@ -1,47 +1,432 @@
 #include "FoodManager.h"
+#include "FoodImporter.h"
 #include <SD.h>
+#include <algorithm>
+#include <memory>
 
 #include <sqlite3.h>
 
-sqlite3* db;  // Add this at the top or as a class member
-sqlite3_stmt* stmt;
-extern DailyNutrition dailyTotals;
-extern FoodItem currentFood;
+// SQL for each StatementId, in enum order
+static const char* const statementSQL[STMT_COUNT] = {
+    "BEGIN;",
+    "COMMIT;",
+    "ROLLBACK;",
+    // Ignored when idx_food_name already has the name: no row changes
+    "INSERT OR IGNORE INTO Food (name, calories, protein, carbs, fat) VALUES (?, ?, ?, ?, ?);",
+    // Names match as FoodIndex folds them, through idx_food_name; IN rather
+    // than = so a card the migration could not clean up loses every repeat
+    "DELETE FROM ColorMap WHERE food_id IN (SELECT food_id FROM Food WHERE lower(trim(name)) = lower(trim(?)));",
+    "DELETE FROM Food WHERE lower(trim(name)) = lower(trim(?));",
+    R"(SELECT Food.food_id, Food.name, IFNULL(ColorMap.color_name, '')
+       FROM Food LEFT JOIN ColorMap ON Food.food_id = ColorMap.food_id
+       WHERE Food.food_id > ? ORDER BY Food.food_id LIMIT ?;)",
+    "REPLACE INTO ColorMap (food_id, color_name) VALUES (?, ?);",
+    "INSERT INTO LogEntry (timestamp, food_id, grams, calories, protein, carbs, fat, ts) VALUES (?, ?, ?, ?, ?, ?, ?, ?);",
+    R"(INSERT INTO DailyTotals (day, calories, protein, carbs, fat, entries)
+       VALUES (?, ?, ?, ?, ?, 1)
+       ON CONFLICT(day) DO UPDATE SET
+           calories = calories + excluded.calories,
+           protein  = protein  + excluded.protein,
+           carbs    = carbs    + excluded.carbs,
+           fat      = fat      + excluded.fat,
+           entries  = entries  + 1;)",
+    R"(SELECT MAX(d.calories - IFNULL(r.calories, 0), 0), MAX(d.protein - IFNULL(r.protein, 0), 0),
+              MAX(d.carbs - IFNULL(r.carbs, 0), 0), MAX(d.fat - IFNULL(r.fat, 0), 0)
+       FROM DailyTotals d LEFT JOIN TotalsReset r ON r.day = d.day WHERE d.day = ?;)",
+    R"(INSERT INTO Container (name, tare_grams) VALUES (?, ?)
+       ON CONFLICT(name) DO UPDATE SET name = excluded.name, tare_grams = excluded.tare_grams;)",
+    "DELETE FROM Container WHERE name = ?;",
+    R"(INSERT INTO MealTotals (day, meal, calories, protein, carbs, fat, entries)
+       VALUES (?, ?, ?, ?, ?, ?, 1)
+       ON CONFLICT(day, meal) DO UPDATE SET
+           calories = calories + excluded.calories,
+           protein  = protein  + excluded.protein,
+           carbs    = carbs    + excluded.carbs,
+           fat      = fat      + excluded.fat,
+           entries  = entries  + 1;)",
+    R"(SELECT day, calories, protein, carbs, fat, entries FROM DailyTotals
+       WHERE day >= ? AND day <= ? ORDER BY day LIMIT ?;)",
+    R"(SELECT day, meal, calories, protein, carbs, fat, entries FROM MealTotals
+       WHERE day >= ?1 AND day <= ?2 AND (day > ?3 OR meal > ?4)
+       ORDER BY day, meal LIMIT ?5;)",
+    "SELECT min(log_id), max(log_id) FROM LogEntry WHERE ts >= ? AND ts < ?;",
+    // IFNULL keeps the ts index out of it: a rowid range scan in log_id order
+    R"(SELECT LogEntry.log_id, IFNULL(LogEntry.ts, 0), LogEntry.timestamp, LogEntry.food_id,
+              IFNULL(Food.name, ''), LogEntry.grams, LogEntry.calories, LogEntry.protein,
+              LogEntry.carbs, LogEntry.fat
+       FROM LogEntry LEFT JOIN Food ON Food.food_id = LogEntry.food_id
+       WHERE LogEntry.log_id > ?1 AND LogEntry.log_id <= ?2
+         AND IFNULL(LogEntry.ts, 0) >= ?3 AND IFNULL(LogEntry.ts, 0) < ?4
+       ORDER BY LogEntry.log_id LIMIT ?5;)",
+    R"(REPLACE INTO TotalsReset (day, calories, protein, carbs, fat)
+       SELECT ?1, IFNULL(SUM(calories), 0), IFNULL(SUM(protein), 0), IFNULL(SUM(carbs), 0), IFNULL(SUM(fat), 0)
+       FROM DailyTotals WHERE day = ?1;)",
+    R"(SELECT DISTINCT day_key(ts) FROM LogEntry
+       WHERE food_id IN (SELECT food_id FROM Food WHERE lower(trim(name)) = lower(trim(?))) AND ts IS NOT NULL;)",
+    "DELETE FROM MealTotals WHERE day = ?;",
+    R"(INSERT INTO MealTotals (day, meal, calories, protein, carbs, fat, entries)
+       SELECT ?1, meal_slot(ts), IFNULL(SUM(calories), 0), IFNULL(SUM(protein), 0),
+              IFNULL(SUM(carbs), 0), IFNULL(SUM(fat), 0), COUNT(*)
+       FROM LogEntry WHERE ts >= ?2 AND ts < ?3
+       GROUP BY 2;)",
+    "DELETE FROM DailyTotals WHERE day = ?;",
+    R"(INSERT INTO DailyTotals (day, calories, protein, carbs, fat, entries)
+       SELECT day, SUM(calories), SUM(protein), SUM(carbs), SUM(fat), SUM(entries)
+       FROM MealTotals WHERE day = ?
+       GROUP BY day;)",
+};
 
-void FoodManager::addFood(const String& name, float calories, float protein, float carbs, float fat) {
-    const char* sql = "INSERT INTO Food (name, calories, protein, carbs, fat) VALUES (?, ?, ?, ?, ?);";
+// /metrics label for each StatementId, in enum order
+static const char* const statementNames[STMT_COUNT] = {
+    "begin", "commit", "rollback", "insert_food", "delete_food_color", "delete_food",
+    "list_foods", "set_color", "insert_log", "upsert_daily", "select_daily",
+    "upsert_container", "delete_container", "upsert_meal", "history_days", "history_meals",
+    "export_range", "export_log", "reset_daily", "food_log_days", "clear_meals_day",
+    "rebuild_meals_day", "clear_daily_day", "rebuild_daily_day",
+};
 
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_double(stmt, 2, calories);
-        sqlite3_bind_double(stmt, 3, protein);
-        sqlite3_bind_double(stmt, 4, carbs);
-        sqlite3_bind_double(stmt, 5, fat);
+static const char* const mealNames[MEAL_COUNT] = {"breakfast", "lunch", "dinner", "snack"};
 
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
-            Serial.println("❌ Failed to insert food item.");
-        } else {
-            Serial.println("✅ Food inserted into database.");
+const char* meal_name(uint8_t meal) {
+    return meal < MEAL_COUNT ? mealNames[meal] : "";
+}
+
+// Days since 1970-01-01 of a YYYYMMDD date and back, proleptic Gregorian.
+// Week buckets step through dates with these instead of mktime(), which
+// would also drag the time zone in.
+static int32_t daysFromKey(int32_t key) {
+    int32_t y = key / 10000, m = key / 100 % 100, d = key % 100;
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    int32_t yoe = y - era * 400;
+    int32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static int32_t keyFromDays(int32_t days) {
+    days += 719468;
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int32_t doe = days - era * 146097;
+    int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int32_t mp = (5 * doy + 2) / 153;
+    int32_t d = doy - (153 * mp + 2) / 5 + 1;
+    int32_t m = mp < 10 ? mp + 3 : mp - 9;
+    return (yoe + era * 400 + (m <= 2)) * 10000 + m * 100 + d;
+}
+
+static int32_t addDays(int32_t key, int32_t n) {
+    return keyFromDays(daysFromKey(key) + n);
+}
+
+// Monday on or before the date; 1970-01-01 was a Thursday
+static int32_t weekStart(int32_t key) {
+    int32_t days = daysFromKey(key);
+    return keyFromDays(days - (days % 7 + 10) % 7);
+}
+
+// Prepared on first use, then only reset between calls
+CachedStatement FoodManager::statement(StatementId id) {
+    if (!db) return CachedStatement(nullptr);
+
+    if (!statements[id]) {
+        if (sqlite3_prepare_v3(db, statementSQL[id], -1, SQLITE_PREPARE_PERSISTENT,
+                               &statements[id], nullptr) != SQLITE_OK) {
+            Serial.printf("❌ Failed to prepare statement %d: %s\n", id, sqlite3_errmsg(db));
+            statements[id] = nullptr;
         }
+    }
+    return CachedStatement(statements[id], statementLatency[id]);
+}
 
-        sqlite3_finalize(stmt);
-    } else {
-        Serial.printf("❌ Failed to prepare SQL insert: %s\n", sqlite3_errmsg(db));
+void FoodManager::finalizeStatements() {
+    for (auto& stmt : statements) {
+        if (stmt) sqlite3_finalize(stmt);
+        stmt = nullptr;
+    }
+}
+
+bool FoodManager::addFood(const String& name, float calories, float protein, float carbs, float fat) {
+    Guard guard(*this);
+    CachedStatement stmt = statement(STMT_INSERT_FOOD);
+    if (!stmt) return false;
+
+    sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_double(stmt, 2, calories);
+    sqlite3_bind_double(stmt, 3, protein);
+    sqlite3_bind_double(stmt, 4, carbs);
+    sqlite3_bind_double(stmt, 5, fat);
+
+    if (stmt.step() != SQLITE_DONE) {
+        Serial.println("❌ Failed to insert food item.");
+        return false;
+    }
+    if (sqlite3_changes(db) == 0) {
+        Serial.println("⚠️ Food already in the catalogue, not added.");
+        return false;
     }
+    foodIndex.add(sqlite3_last_insert_rowid(db), name.c_str(), {calories, protein, carbs, fat});
+    Serial.println("✅ Food inserted into database.");
+    return true;
   }
 
-void FoodManager::begin(int sdCsPin) {
+// Deleting a food cascades to its log entries, so the days they were
+// rolled up into are rebuilt in the same savepoint. Queued entries are
+// flushed first: they would no longer insert, and take the batch with them.
+bool FoodManager::deleteFood(const String& name) {
+    Guard guard(*this);
+    if (!db) return false;
+    flushLogQueue();
+    sqlite3_exec(db, "SAVEPOINT delete_food;", nullptr, nullptr, nullptr);
+
+    std::vector<int32_t> days;
+    bool ok = false;
+    {
+        CachedStatement stmt = statement(STMT_FOOD_LOG_DAYS);
+        if (stmt) {
+            sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+            int rc;
+            while ((rc = stmt.step()) == SQLITE_ROW) days.push_back(sqlite3_column_int(stmt, 0));
+            ok = rc == SQLITE_DONE;
+        }
+    }
+    if (ok) {
+        CachedStatement stmt = statement(STMT_DELETE_FOOD_COLOR);
+        if (stmt) {
+            sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+            stmt.step();  // Ignore result, there may be no mapping
+        }
+    }
+    if (ok) {
+        CachedStatement stmt = statement(STMT_DELETE_FOOD);
+        ok = false;
+        if (stmt) {
+            sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+            ok = stmt.step() == SQLITE_DONE && sqlite3_changes(db) > 0;
+        }
+    }
+    for (size_t i = 0; ok && i < days.size(); ++i) ok = rebuildRollupDay(days[i]);
+
+    if (!ok) {
+        sqlite3_exec(db, "ROLLBACK TO delete_food; RELEASE delete_food;", nullptr, nullptr, nullptr);
+        return false;
+    }
+    sqlite3_exec(db, "RELEASE delete_food;", nullptr, nullptr, nullptr);
+
+    foodIndex.remove(name.c_str());
+    return true;
+}
+
+bool FoodManager::findFood(const String& name, FoodItem& out) {
+    Guard guard(*this);
+    const FoodIndexEntry* entry = foodIndex.find(name.c_str());
+    if (!entry) return false;
+
+    out.id       = entry->id;
+    out.name     = foodIndex.name(*entry);
+    out.calories = entry->per100g.calories;
+    out.protein  = entry->per100g.protein;
+    out.carbs    = entry->per100g.carbs;
+    out.fat      = entry->per100g.fat;
+    return true;
+}
+
+bool FoodManager::setFoodColor(int foodId, const String& color) {
+    Guard guard(*this);
+    CachedStatement stmt = statement(STMT_SET_COLOR);
+    if (!stmt) return false;
+
+    sqlite3_bind_int(stmt, 1, foodId);
+    sqlite3_bind_text(stmt, 2, color.c_str(), -1, SQLITE_TRANSIENT);
+    return stmt.step() == SQLITE_DONE;
+}
+
+// Selections are buffered in RAM and written in one transaction per batch:
+// on SD every commit costs a full journal sync.
+// ts == 0 means the clock is not synced: the row is kept but not rolled up.
+bool FoodManager::queueLogEntry(const FoodItem& food, float grams, const String& timestamp, time_t ts,
+                                const DailyNutrition& macros, const String& color) {
+    Guard guard(*this);
+    if (pendingCount == LOG_QUEUE_SIZE && !flushLogQueue()) {
+        Serial.println("❌ Log queue full and flush failed, dropping entry");
+        return false;
+    }
+
+    PendingLogEntry& entry = pendingLogs[pendingCount++];
+    entry.foodId   = food.id;
+    entry.grams    = grams;
+    entry.ts       = ts;
+    entry.macros   = macros;
+    entry.queuedAt = millis();
+    strlcpy(entry.timestamp, timestamp.c_str(), sizeof(entry.timestamp));
+    strlcpy(entry.color, color.c_str(), sizeof(entry.color));
+
+    if (pendingCount >= LOG_FLUSH_THRESHOLD) flushLogQueue();
+    return true;
+}
+
+bool FoodManager::writeLogEntry(const PendingLogEntry& entry) {
+    {
+        CachedStatement stmt = statement(STMT_INSERT_LOG);
+        if (!stmt) return false;
+        sqlite3_bind_text(stmt, 1, entry.timestamp, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 2, entry.foodId);
+        sqlite3_bind_double(stmt, 3, entry.grams);
+        sqlite3_bind_double(stmt, 4, entry.macros.calories);
+        sqlite3_bind_double(stmt, 5, entry.macros.protein);
+        sqlite3_bind_double(stmt, 6, entry.macros.carbs);
+        sqlite3_bind_double(stmt, 7, entry.macros.fat);
+        if (entry.ts) sqlite3_bind_int64(stmt, 8, entry.ts);
+        else          sqlite3_bind_null(stmt, 8);
+        if (stmt.step() != SQLITE_DONE) return false;
+    }
+
+    if (entry.ts && !addToRollups(entry.ts, entry.macros)) return false;
+
+    if (entry.color[0]) {
+        CachedStatement stmt = statement(STMT_SET_COLOR);
+        if (!stmt) return false;
+        sqlite3_bind_int(stmt, 1, entry.foodId);
+        sqlite3_bind_text(stmt, 2, entry.color, -1, SQLITE_STATIC);
+        if (stmt.step() != SQLITE_DONE) return false;
+    }
+    return true;
+}
+
+bool FoodManager::beginImport() {
+    Guard guard(*this);
+    if (!db || importing) return false;
+    importing = true;
+    importBatchRows = 0;
+    return true;
+}
+
+ImportResult FoodManager::importFood(const char* name, const FoodMacros& per100g) {
+    if (!importing) return IMPORT_FAILED;
+
+    if (!importBatchOpen) {
+        xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+        CachedStatement begin = statement(STMT_BEGIN);
+        if (!begin || begin.step() != SQLITE_DONE) {
+            xSemaphoreGiveRecursive(lock);
+            return IMPORT_FAILED;
+        }
+        importBatchOpen = true;
+    }
+
+    // FoodIndex only knows the names from before the import; the unique
+    // index also sees the ones added since, earlier in the same file
+    ImportResult result = IMPORT_FAILED;
+    {
+        CachedStatement stmt = statement(STMT_INSERT_FOOD);
+        if (stmt) {
+            sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+            sqlite3_bind_double(stmt, 2, per100g.calories);
+            sqlite3_bind_double(stmt, 3, per100g.protein);
+            sqlite3_bind_double(stmt, 4, per100g.carbs);
+            sqlite3_bind_double(stmt, 5, per100g.fat);
+            if (stmt.step() == SQLITE_DONE) result = sqlite3_changes(db) ? IMPORT_ADDED : IMPORT_DUPLICATE;
+        }
+    }
+
+    if (++importBatchRows >= IMPORT_BATCH_ROWS && !commitImport()) return IMPORT_FAILED;
+    return result;
+}
+
+// Ends the open batch and lets go of the lock it held
+bool FoodManager::commitImport() {
+    if (!importBatchOpen) return true;
+    CachedStatement commit = statement(STMT_COMMIT);
+    bool ok = commit && commit.step() == SQLITE_DONE;
+    if (!ok) {
+        Serial.printf("❌ Import commit failed: %s\n", sqlite3_errmsg(db));
+        CachedStatement rollback = statement(STMT_ROLLBACK);
+        if (rollback) rollback.step();
+    }
+    importBatchOpen = false;
+    importBatchRows = 0;
+    xSemaphoreGiveRecursive(lock);
+    return ok;
+}
+
+bool FoodManager::endImport() {
+    Guard guard(*this);
+    if (!importing) return false;
+    bool ok = commitImport();
+    importing = false;
+    loadDatabase();
+    return ok;
+}
+
+// Writes every queued entry in a single transaction. On failure the batch is
+// rolled back and stays queued for the next attempt.
+bool FoodManager::flushLogQueue() {
+    static MetricHistogram& sdWrite = metrics_histogram(METRIC_SD_WRITE, "op", "log_flush");
+    Guard guard(*this);
+    if (pendingCount == 0) return true;
+    MetricTimer timer(sdWrite);
+
+    CachedStatement begin = statement(STMT_BEGIN);
+    if (!begin || begin.step() != SQLITE_DONE) return false;
+
+    bool ok = true;
+    for (size_t i = 0; ok && i < pendingCount; ++i) {
+        ok = writeLogEntry(pendingLogs[i]);
+    }
+
+    CachedStatement end = statement(ok ? STMT_COMMIT : STMT_ROLLBACK);
+    if (ok) ok = end && end.step() == SQLITE_DONE;
+    else if (end) end.step();
+
+    if (ok) {
+        Serial.printf("💾 Flushed %u log entries\n", (unsigned)pendingCount);
+        pendingCount = 0;
+    } else {
+        Serial.printf("❌ Log flush failed: %s\n", sqlite3_errmsg(db));
+    }
+    return ok;
+}
+
+// Call from the app task: flushes once the oldest queued entry is old enough
+void FoodManager::handle() {
+    Guard guard(*this);
+    if (pendingCount && millis() - pendingLogs[0].queuedAt >= LOG_FLUSH_INTERVAL_MS) {
+        flushLogQueue();
+    }
+}
+
+void FoodManager::begin(int sdCsPin, const char* dbPath) {
+    if (!lock) {
+        lock = xSemaphoreCreateRecursiveMutex();
+        for (int id = 0; id < STMT_COUNT; ++id) {
+            statementLatency[id] = &metrics_histogram(METRIC_SQLITE_STATEMENT, "statement", statementNames[id]);
+        }
+        metrics_gauge(METRIC_QUEUE_DEPTH, "queue", "log", [](void* self) -> uint32_t {
+            return static_cast<FoodManager*>(self)->pendingLogCount();
+        }, this);
+    }
+    Guard guard(*this);
+
     if (!SD.begin(sdCsPin)) {
         Serial.println("❌ SD card init failed.");
         return;
     }
 
-    if (sqlite3_open("/sd/food.db", &db) != SQLITE_OK) {
+    // Day boundaries are local; make localtime() right before NTP syncs
+    setenv("TZ", LOCAL_TIMEZONE, 1);
+    tzset();
+
+    end();
+
+    if (sqlite3_open(dbPath, &db) != SQLITE_OK) {
         Serial.println("❌ Cannot open SQLite database.");
         return;
     }
 
     sqlite3_exec(db, "PRAGMA foreign_keys = ON;", nullptr, nullptr, nullptr);
+    configureJournal();
+    registerFunctions();
 
     const char* initSQL = R"(
     PRAGMA foreign_keys = ON;
@@ -60,14 +445,54 @@ void FoodManager::begin(int sdCsPin) {
         food_id INTEGER NOT NULL,
         grams REAL NOT NULL,
         timestamp TEXT NOT NULL,
+        calories REAL,
+        protein REAL,
+        carbs REAL,
+        fat REAL,
+        ts INTEGER,
         FOREIGN KEY (food_id) REFERENCES Food(food_id) ON DELETE CASCADE
     );
 
+    CREATE TABLE IF NOT EXISTS DailyTotals (
+        day INTEGER PRIMARY KEY,
+        calories REAL NOT NULL DEFAULT 0,
+        protein REAL NOT NULL DEFAULT 0,
+        carbs REAL NOT NULL DEFAULT 0,
+        fat REAL NOT NULL DEFAULT 0,
+        entries INTEGER NOT NULL DEFAULT 0
+    );
+
+    CREATE TABLE IF NOT EXISTS MealTotals (
+        day INTEGER NOT NULL,
+        meal INTEGER NOT NULL,
+        calories REAL NOT NULL DEFAULT 0,
+        protein REAL NOT NULL DEFAULT 0,
+        carbs REAL NOT NULL DEFAULT 0,
+        fat REAL NOT NULL DEFAULT 0,
+        entries INTEGER NOT NULL DEFAULT 0,
+        PRIMARY KEY (day, meal)
+    ) WITHOUT ROWID;
+
+    -- DailyTotals as it stood at the day's last /reset
+    CREATE TABLE IF NOT EXISTS TotalsReset (
+        day INTEGER PRIMARY KEY,
+        calories REAL NOT NULL,
+        protein REAL NOT NULL,
+        carbs REAL NOT NULL,
+        fat REAL NOT NULL
+    );
+
     CREATE TABLE IF NOT EXISTS ColorMap (
         food_id INTEGER PRIMARY KEY,
         color_name TEXT,
         FOREIGN KEY (food_id) REFERENCES Food(food_id) ON DELETE CASCADE
     );
+
+    CREATE TABLE IF NOT EXISTS Container (
+        container_id INTEGER PRIMARY KEY AUTOINCREMENT,
+        name TEXT NOT NULL UNIQUE COLLATE NOCASE,
+        tare_grams REAL NOT NULL
+    );
 )";
 
     char* errMsg = nullptr;
@@ -78,108 +503,566 @@ void FoodManager::begin(int sdCsPin) {
         Serial.println("✅ SQLite schema initialized.");
     }
 
-    restoreDailyTotalsFromDatabase();
+    migrateSchema();
+
 int count = 0;
 sqlite3_exec(db, "SELECT COUNT(*) FROM Food;", [](void* data, int argc, char** argv, char**) -> int {
     if (argc > 0 && argv[0]) *(int*)data = atoi(argv[0]);
     return 0;
 }, &count, nullptr);
 
-if (count == 0 && SD.exists("/food_db.csv")) {
-    Serial.println("⚙️ Importing old food_db.csv into SQLite...");
-    File f = SD.open("/food_db.csv");
-    while (f.available()) {
-        String line = f.readStringUntil('\n');
-        line.trim();
-        if (line.length() == 0 || line.startsWith("Name")) continue;
-
-        // Split CSV line
-        std::vector<String> parts;
-        while (line.length()) {
-            int idx = line.indexOf(',');
-            if (idx == -1) {
-                parts.push_back(line);
-                break;
-            }
-            parts.push_back(line.substring(0, idx));
-            line = line.substring(idx + 1);
-        }
-
-        if (parts.size() >= 5) {
-            const char* sql = "INSERT INTO Food (name, calories, protein, carbs, fat) VALUES (?, ?, ?, ?, ?);";
-            sqlite3_stmt* stmt;
-            if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
-                sqlite3_bind_text(stmt, 1, parts[0].c_str(), -1, SQLITE_TRANSIENT);
-                sqlite3_bind_double(stmt, 2, parts[1].toFloat());
-                sqlite3_bind_double(stmt, 3, parts[2].toFloat());
-                sqlite3_bind_double(stmt, 4, parts[3].toFloat());
-                sqlite3_bind_double(stmt, 5, parts[4].toFloat());
-                if (sqlite3_step(stmt) == SQLITE_DONE) {
-                    Serial.printf("✅ Imported: %s\n", parts[0].c_str());
-                } else {
-                    Serial.printf("❌ Insert failed: %s\n", sqlite3_errmsg(db));
-                }
-                sqlite3_finalize(stmt);
+    // First boot on a card that still has the old CSV catalogue
+    if (count == 0 && SD.exists("/food_db.csv")) {
+        Serial.println("⚙️ Importing old food_db.csv into SQLite...");
+        std::unique_ptr<FoodImporter> importer(new FoodImporter(*this));
+        if (importer->importFile("/food_db.csv")) return;   // reindexed at the end of the import
+    }
+
+    loadDatabase();
+}
+
+// WAL turns each commit into an append instead of a rollback-journal
+// rewrite. The SD VFS has no shared memory, which WAL only does without when
+// the connection holds an exclusive lock; we are the only connection anyway.
+void FoodManager::configureJournal() {
+    const char* pragmas = R"(
+        PRAGMA locking_mode = EXCLUSIVE;
+        PRAGMA synchronous = NORMAL;
+        PRAGMA cache_size = -64;
+        PRAGMA wal_autocheckpoint = 256;
+    )";
+    sqlite3_exec(db, pragmas, nullptr, nullptr, nullptr);
+
+    char mode[16] = "";
+    sqlite3_exec(db, "PRAGMA journal_mode = WAL;", [](void* data, int argc, char** argv, char**) -> int {
+        if (argc > 0 && argv[0]) strlcpy((char*)data, argv[0], 16);
+        return 0;
+    }, mode, nullptr);
+
+    if (strcmp(mode, "wal") == 0) {
+        Serial.println("✅ SQLite journal: WAL");
+    } else {
+        Serial.printf("⚠️ WAL unavailable, journal mode is '%s'\n", mode);
+    }
+}
+
+int32_t FoodManager::dayKey(time_t t) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    return (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday;
+}
+
+time_t FoodManager::dayStart(int32_t day) {
+    struct tm tm = {};
+    tm.tm_year  = day / 10000 - 1900;
+    tm.tm_mon   = day / 100 % 100 - 1;
+    tm.tm_mday  = day % 100;
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+uint8_t FoodManager::mealSlot(time_t t) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    if (tm.tm_hour < MEAL_BREAKFAST_HOUR || tm.tm_hour >= MEAL_SNACK_HOUR) return MEAL_SNACK;
+    if (tm.tm_hour < MEAL_LUNCH_HOUR) return MEAL_BREAKFAST;
+    if (tm.tm_hour < MEAL_DINNER_HOUR) return MEAL_LUNCH;
+    return MEAL_DINNER;
+}
+
+// day_key(ts) and meal_slot(ts) for rollup SQL, so it buckets exactly like
+// addToRollups() does
+void FoodManager::registerFunctions() {
+    sqlite3_create_function(db, "day_key", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr,
+        [](sqlite3_context* ctx, int, sqlite3_value** argv) {
+            sqlite3_result_int(ctx, dayKey((time_t)sqlite3_value_int64(argv[0])));
+        }, nullptr, nullptr);
+    sqlite3_create_function(db, "meal_slot", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr,
+        [](sqlite3_context* ctx, int, sqlite3_value** argv) {
+            sqlite3_result_int(ctx, mealSlot((time_t)sqlite3_value_int64(argv[0])));
+        }, nullptr, nullptr);
+}
+
+bool FoodManager::hasColumn(const char* table, const char* column) {
+    String sql = String("PRAGMA table_info(") + table + ");";
+    sqlite3_stmt* stmt;
+    bool found = false;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (!found && sqlite3_step(stmt) == SQLITE_ROW) {
+            found = strcmp(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), column) == 0;
+        }
+        sqlite3_finalize(stmt);
+    }
+    return found;
+}
+
+// Brings databases created by older firmware up to the current schema.
+// Each step runs once, tracked through PRAGMA user_version.
+void FoodManager::migrateSchema() {
+    int version = 0;
+    sqlite3_exec(db, "PRAGMA user_version;", [](void* data, int argc, char** argv, char**) -> int {
+        if (argc > 0 && argv[0]) *(int*)data = atoi(argv[0]);
+        return 0;
+    }, &version, nullptr);
+
+    if (version < 1) {
+        Serial.println("⚙️ Migrating LogEntry to epoch timestamps + daily rollup...");
+        sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+
+        const char* columns[][2] = {
+            {"calories", "REAL"}, {"protein", "REAL"}, {"carbs", "REAL"}, {"fat", "REAL"}, {"ts", "INTEGER"}
+        };
+        for (auto& col : columns) {
+            if (!hasColumn("LogEntry", col[0])) {
+                String sql = String("ALTER TABLE LogEntry ADD COLUMN ") + col[0] + " " + col[1] + ";";
+                sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr);
             }
         }
+
+        // Old rows carry a local "YYYY-MM-DD HH:MM:SS" string or "offline"
+        const char* migrateSQL = R"(
+            UPDATE LogEntry SET ts = CAST(strftime('%s', timestamp, 'utc') AS INTEGER)
+            WHERE ts IS NULL AND timestamp GLOB '[0-9][0-9][0-9][0-9]-*';
+
+            CREATE INDEX IF NOT EXISTS idx_logentry_ts ON LogEntry(ts);
+
+            DELETE FROM DailyTotals;
+            INSERT INTO DailyTotals (day, calories, protein, carbs, fat, entries)
+            SELECT CAST(strftime('%Y%m%d', ts, 'unixepoch', 'localtime') AS INTEGER),
+                   IFNULL(SUM(calories), 0), IFNULL(SUM(protein), 0),
+                   IFNULL(SUM(carbs), 0), IFNULL(SUM(fat), 0), COUNT(*)
+            FROM LogEntry WHERE ts IS NOT NULL
+            GROUP BY 1;
+
+            PRAGMA user_version = 1;
+        )";
+
+        char* errMsg = nullptr;
+        if (sqlite3_exec(db, migrateSQL, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+            Serial.printf("❌ Migration failed: %s\n", errMsg);
+            sqlite3_free(errMsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return;
+        }
+        sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+        Serial.println("✅ Migration done.");
+    }
+
+    // The ts index grows the macro columns so a rollup rebuild reads only
+    // the index; it covers every lookup the plain one did
+    if (version < 2) {
+        Serial.println("⚙️ Migrating to a covering history index + meal rollup...");
+        sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+
+        const char* migrateSQL = R"(
+            CREATE INDEX IF NOT EXISTS idx_logentry_history ON LogEntry(ts, calories, protein, carbs, fat);
+            DROP INDEX IF EXISTS idx_logentry_ts;
+            PRAGMA user_version = 2;
+        )";
+
+        char* errMsg = nullptr;
+        if (sqlite3_exec(db, migrateSQL, nullptr, nullptr, &errMsg) != SQLITE_OK || !rebuildRollups()) {
+            Serial.printf("❌ Migration failed: %s\n", errMsg ? errMsg : sqlite3_errmsg(db));
+            sqlite3_free(errMsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return;
+        }
+        sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+        Serial.println("✅ Migration done.");
+    }
+
+    // Food names become unique the way FoodIndex folds them (trimmed, ASCII
+    // case-insensitive). Older cards can hold repeats: their log entries
+    // and colours move to the first food of that name before it goes.
+    if (version < 3) {
+        Serial.println("⚙️ Migrating to unique food names...");
+        sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+
+        const char* migrateSQL = R"(
+            CREATE TEMP TABLE food_merge AS
+            SELECT f.food_id AS old_id, k.keep_id
+            FROM Food f JOIN (SELECT lower(trim(name)) AS folded, MIN(food_id) AS keep_id
+                              FROM Food GROUP BY 1 HAVING COUNT(*) > 1) k
+                 ON lower(trim(f.name)) = k.folded
+            WHERE f.food_id <> k.keep_id;
+
+            UPDATE LogEntry SET food_id = (SELECT keep_id FROM food_merge WHERE old_id = LogEntry.food_id)
+            WHERE food_id IN (SELECT old_id FROM food_merge);
+            UPDATE OR IGNORE ColorMap SET food_id = (SELECT keep_id FROM food_merge WHERE old_id = ColorMap.food_id)
+            WHERE food_id IN (SELECT old_id FROM food_merge);
+            DELETE FROM Food WHERE food_id IN (SELECT old_id FROM food_merge);
+            DROP TABLE food_merge;
+
+            CREATE UNIQUE INDEX IF NOT EXISTS idx_food_name ON Food(lower(trim(name)));
+            PRAGMA user_version = 3;
+        )";
+
+        char* errMsg = nullptr;
+        if (sqlite3_exec(db, migrateSQL, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+            Serial.printf("❌ Migration failed: %s\n", errMsg);
+            sqlite3_free(errMsg);
+            sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return;
+        }
+        sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+        Serial.println("✅ Migration done.");
     }
-    f.close();
 }
 
+// First and last log_id with a ts in range, from the ts index, so the page
+// scans cover only that stretch of the table. Rows are in log_id order and
+// not strictly in ts order (the clock can be set back), hence min and max
+// rather than the first and last by ts. False when nothing is in range.
+bool FoodManager::findExportRange(ExportQuery& query) {
+    if (query.from <= 0) {
+        // Unsynced rows have no ts to index: the whole table it is
+        query.lastId = INT64_MAX;
+        return true;
+    }
+    CachedStatement stmt = statement(STMT_EXPORT_RANGE);
+    if (!stmt) return false;
+    sqlite3_bind_int64(stmt, 1, query.from);
+    sqlite3_bind_int64(stmt, 2, query.to);
+    if (stmt.step() != SQLITE_ROW || sqlite3_column_type(stmt, 0) == SQLITE_NULL) {
+        query.lastId = 0;
+        return false;
+    }
+    query.afterId = std::max<int64_t>(query.afterId, sqlite3_column_int64(stmt, 0) - 1);
+    query.lastId = sqlite3_column_int64(stmt, 1);
+    return true;
 }
 
-void FoodManager::restoreDailyTotalsFromDatabase() {
-    if (!db) return;
+// A savepoint rather than BEGIN, so a migration can run it inside its own
+// transaction
+bool FoodManager::rebuildRollups() {
+    Guard guard(*this);
+    if (!db) return false;
 
-    const char* query = "SELECT SUM(calories), SUM(protein), SUM(carbs), SUM(fat) FROM LogEntry;";
-    sqlite3_stmt* stmt;
+    const char* rebuildSQL = R"(
+        SAVEPOINT rollups;
+        DELETE FROM MealTotals;
+        INSERT INTO MealTotals (day, meal, calories, protein, carbs, fat, entries)
+        SELECT day_key(ts), meal_slot(ts),
+               IFNULL(SUM(calories), 0), IFNULL(SUM(protein), 0),
+               IFNULL(SUM(carbs), 0), IFNULL(SUM(fat), 0), COUNT(*)
+        FROM LogEntry WHERE ts IS NOT NULL
+        GROUP BY 1, 2;
 
-    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            dailyTotals.calories = sqlite3_column_double(stmt, 0);
-            dailyTotals.protein  = sqlite3_column_double(stmt, 1);
-            dailyTotals.carbs    = sqlite3_column_double(stmt, 2);
-            dailyTotals.fat      = sqlite3_column_double(stmt, 3);
-            Serial.println("✅ Restored daily totals from DB");
-        } else {
-            Serial.println("⚠️ No daily log data found");
+        DELETE FROM DailyTotals;
+        INSERT INTO DailyTotals (day, calories, protein, carbs, fat, entries)
+        SELECT day, SUM(calories), SUM(protein), SUM(carbs), SUM(fat), SUM(entries)
+        FROM MealTotals GROUP BY day;
+        RELEASE rollups;
+    )";
+
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, rebuildSQL, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        Serial.printf("❌ Rollup rebuild failed: %s\n", errMsg);
+        sqlite3_free(errMsg);
+        sqlite3_exec(db, "ROLLBACK TO rollups; RELEASE rollups;", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
+
+// One day of both rollups from the ts index, as rebuildRollups() would
+// leave it
+bool FoodManager::rebuildRollupDay(int32_t day) {
+    const StatementId steps[] = {STMT_CLEAR_MEALS_DAY, STMT_REBUILD_MEALS_DAY, STMT_CLEAR_DAILY_DAY,
+                                 STMT_REBUILD_DAILY_DAY};
+    for (StatementId id : steps) {
+        CachedStatement stmt = statement(id);
+        if (!stmt) return false;
+        sqlite3_bind_int(stmt, 1, day);
+        if (id == STMT_REBUILD_MEALS_DAY) {
+            sqlite3_bind_int64(stmt, 2, dayStart(day));
+            sqlite3_bind_int64(stmt, 3, dayStart(addDays(day, 1)));
+        }
+        if (stmt.step() != SQLITE_DONE) return false;
+    }
+    return true;
+}
+
+bool FoodManager::addToRollups(time_t ts, const DailyNutrition& macros) {
+    int32_t day = dayKey(ts);
+    {
+        CachedStatement stmt = statement(STMT_UPSERT_DAILY);
+        if (!stmt) return false;
+
+        sqlite3_bind_int(stmt, 1, day);
+        sqlite3_bind_double(stmt, 2, macros.calories);
+        sqlite3_bind_double(stmt, 3, macros.protein);
+        sqlite3_bind_double(stmt, 4, macros.carbs);
+        sqlite3_bind_double(stmt, 5, macros.fat);
+        if (stmt.step() != SQLITE_DONE) return false;
+    }
+
+    CachedStatement stmt = statement(STMT_UPSERT_MEAL);
+    if (!stmt) return false;
+
+    sqlite3_bind_int(stmt, 1, day);
+    sqlite3_bind_int(stmt, 2, mealSlot(ts));
+    sqlite3_bind_double(stmt, 3, macros.calories);
+    sqlite3_bind_double(stmt, 4, macros.protein);
+    sqlite3_bind_double(stmt, 5, macros.carbs);
+    sqlite3_bind_double(stmt, 6, macros.fat);
+    return stmt.step() == SQLITE_DONE;
+}
+
+static void readTotals(sqlite3_stmt* stmt, int col, HistoryRow& row) {
+    row.totals.calories = sqlite3_column_double(stmt, col);
+    row.totals.protein  = sqlite3_column_double(stmt, col + 1);
+    row.totals.carbs    = sqlite3_column_double(stmt, col + 2);
+    row.totals.fat      = sqlite3_column_double(stmt, col + 3);
+    row.entries         = sqlite3_column_int(stmt, col + 4);
+}
+
+// Meals and days are rollup rows as they are. Weeks are summed from
+// DailyTotals here, whole weeks at a time: the first one starts on the
+// Monday on or before fromDay, and each page scans at most max weeks of
+// days so the last week on a page is never cut short.
+size_t FoodManager::readHistory(HistoryQuery& query, HistoryRow* out, size_t max) {
+    Guard guard(*this);
+    if (!db || max == 0) return 0;
+    size_t n = 0;
+
+    if (query.bucket == HISTORY_MEAL) {
+        CachedStatement stmt = statement(STMT_HISTORY_MEALS);
+        if (!stmt) return 0;
+        sqlite3_bind_int(stmt, 1, std::max(query.fromDay, query.afterDay));
+        sqlite3_bind_int(stmt, 2, query.toDay);
+        sqlite3_bind_int(stmt, 3, query.afterDay);
+        sqlite3_bind_int(stmt, 4, query.afterMeal);
+        sqlite3_bind_int(stmt, 5, (int)max);
+        while (stmt.step() == SQLITE_ROW) {
+            HistoryRow& row = out[n++];
+            row.day  = sqlite3_column_int(stmt, 0);
+            row.meal = (uint8_t)sqlite3_column_int(stmt, 1);
+            readTotals(stmt, 2, row);
+        }
+    } else if (query.bucket == HISTORY_DAY) {
+        CachedStatement stmt = statement(STMT_HISTORY_DAYS);
+        if (!stmt) return 0;
+        sqlite3_bind_int(stmt, 1, std::max(query.fromDay, query.afterDay + 1));
+        sqlite3_bind_int(stmt, 2, query.toDay);
+        sqlite3_bind_int(stmt, 3, (int)max);
+        while (stmt.step() == SQLITE_ROW) {
+            HistoryRow& row = out[n++];
+            row.day  = sqlite3_column_int(stmt, 0);
+            row.meal = 0;
+            readTotals(stmt, 1, row);
         }
-        sqlite3_finalize(stmt);
     } else {
-        Serial.printf("❌ Failed to restore totals: %s\n", sqlite3_errmsg(db));
+        int32_t start = query.afterDay ? addDays(query.afterDay, 7) : weekStart(query.fromDay);
+        // Skips over empty stretches until a window has data
+        while (n == 0 && start <= query.toDay) {
+            int32_t end = std::min(query.toDay, addDays(start, 7 * (int32_t)max - 1));
+            CachedStatement stmt = statement(STMT_HISTORY_DAYS);
+            if (!stmt) return 0;
+            sqlite3_bind_int(stmt, 1, start);
+            sqlite3_bind_int(stmt, 2, end);
+            sqlite3_bind_int(stmt, 3, -1);
+            while (stmt.step() == SQLITE_ROW) {
+                HistoryRow day;
+                readTotals(stmt, 1, day);
+                int32_t week = weekStart(sqlite3_column_int(stmt, 0));
+                if (n == 0 || out[n - 1].day != week) {
+                    out[n++] = {week, 0, {0, 0, 0, 0}, 0};
+                }
+                HistoryRow& row = out[n - 1];
+                row.totals.calories += day.totals.calories;
+                row.totals.protein  += day.totals.protein;
+                row.totals.carbs    += day.totals.carbs;
+                row.totals.fat      += day.totals.fat;
+                row.entries         += day.entries;
+            }
+            start = addDays(end, 1);
+        }
+    }
+
+    if (n) {
+        query.afterDay  = out[n - 1].day;
+        query.afterMeal = out[n - 1].meal;
+    }
+    return n;
+}
+
+// Single-row lookup of today's rollup; cost does not depend on log size.
+// Needs the wall clock, so it is a no-op until NTP has synced. Queued
+// entries are flushed first, or the rollup would lack them.
+bool FoodManager::restoreDailyTotalsFromDatabase(DailyNutrition& out) {
+    Guard guard(*this);
+    if (!db) return false;
+
+    time_t now = time(nullptr);
+    if (now < 24 * 3600) return false;
+    flushLogQueue();
+
+    CachedStatement stmt = statement(STMT_SELECT_DAILY);
+    if (!stmt) return false;
+
+    sqlite3_bind_int(stmt, 1, dayKey(now));
+    if (stmt.step() == SQLITE_ROW) {
+        out.calories = sqlite3_column_double(stmt, 0);
+        out.protein  = sqlite3_column_double(stmt, 1);
+        out.carbs    = sqlite3_column_double(stmt, 2);
+        out.fat      = sqlite3_column_double(stmt, 3);
+        Serial.println("✅ Restored daily totals from DB");
+        return true;
     }
+    Serial.println("⚠️ No log entries for today yet");
+    return false;
 }
 
+// The day's rollup as it stands now becomes its baseline, so the queue is
+// flushed first: entries still in it were logged before the reset
+bool FoodManager::resetDailyTotals(time_t now) {
+    Guard guard(*this);
+    if (!db || !flushLogQueue()) return false;
+
+    CachedStatement stmt = statement(STMT_RESET_DAILY);
+    if (!stmt) return false;
+    sqlite3_bind_int(stmt, 1, dayKey(now));
+    return stmt.step() == SQLITE_DONE;
+}
+
+
+
+void FoodManager::end() {
+    Guard guard(*this);
+    if (!db) return;
 
+    flushLogQueue();
+    finalizeStatements();
+    sqlite3_close(db);
+    db = nullptr;
+    pendingCount = 0;
+}
 
+// Builds the in-RAM catalogue index; lookups and search never hit SQLite
 void FoodManager::loadDatabase() {
-    foodDatabase.clear();
+    Guard guard(*this);
+    foodIndex.clear();
+
+    // Size the arrays up front so a large catalogue is not regrown row by row
+    size_t sizes[2] = {0, 0};
+    sqlite3_exec(db, "SELECT COUNT(*), IFNULL(SUM(LENGTH(name)), 0) FROM Food;", [](void* data, int argc, char** argv, char**) -> int {
+        if (argc > 1 && argv[0] && argv[1]) {
+            ((size_t*)data)[0] = atol(argv[0]);
+            ((size_t*)data)[1] = atol(argv[1]);
+        }
+        return 0;
+    }, sizes, nullptr);
+    foodIndex.reserve(sizes[0], sizes[1]);
 
     const char* selectSQL = "SELECT food_id, name, calories, protein, carbs, fat FROM Food;";
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, selectSQL, -1, &stmt, nullptr) == SQLITE_OK) {
+        foodIndex.beginBulkLoad();
         while (sqlite3_step(stmt) == SQLITE_ROW) {
-            FoodItem item;
-            item.id      = sqlite3_column_int(stmt, 0);
-            item.name    = String(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-            item.calories = sqlite3_column_double(stmt, 2);
-            item.protein = sqlite3_column_double(stmt, 3);
-            item.carbs   = sqlite3_column_double(stmt, 4);
-            item.fat     = sqlite3_column_double(stmt, 5);
-            foodDatabase.push_back(item);
+            FoodMacros per100g = {
+                (float)sqlite3_column_double(stmt, 2),
+                (float)sqlite3_column_double(stmt, 3),
+                (float)sqlite3_column_double(stmt, 4),
+                (float)sqlite3_column_double(stmt, 5)
+            };
+            foodIndex.add(sqlite3_column_int(stmt, 0),
+                          reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), per100g);
         }
+        foodIndex.endBulkLoad();
         sqlite3_finalize(stmt);
-        Serial.printf("✅ Loaded %d food items from database.\n", foodDatabase.size());
+        Serial.printf("✅ Indexed %u food items (%u bytes).\n",
+                      (unsigned)foodIndex.size(), (unsigned)foodIndex.memoryUsage());
     } else {
         Serial.println("❌ Failed to prepare SELECT in loadDatabase()");
     }
+
+    loadContainers();
+}
+
+void FoodManager::loadContainers() {
+    containerTotal = 0;
+    const char* selectSQL = "SELECT name, tare_grams FROM Container ORDER BY name LIMIT ?;";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, selectSQL, -1, &stmt, nullptr) != SQLITE_OK) return;
+
+    sqlite3_bind_int(stmt, 1, CONTAINER_MAX);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        ContainerItem& c = containers[containerTotal++];
+        strlcpy(c.name, reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), sizeof(c.name));
+        c.tareGrams = (float)sqlite3_column_double(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+    Serial.printf("✅ %u containers in the library\n", (unsigned)containerTotal);
+}
+
+bool FoodManager::saveContainer(const char* name, float tareGrams) {
+    Guard guard(*this);
+    size_t i = 0;
+    while (i < containerTotal && strcasecmp(containers[i].name, name) < 0) ++i;
+    bool exists = i < containerTotal && strcasecmp(containers[i].name, name) == 0;
+    if (!exists && containerTotal == CONTAINER_MAX) return false;
+
+    CachedStatement stmt = statement(STMT_UPSERT_CONTAINER);
+    if (!stmt) return false;
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_double(stmt, 2, tareGrams);
+    if (stmt.step() != SQLITE_DONE) return false;
+
+    if (!exists) {
+        memmove(&containers[i + 1], &containers[i], (containerTotal - i) * sizeof(ContainerItem));
+        containerTotal++;
+    }
+    strlcpy(containers[i].name, name, sizeof(containers[i].name));
+    containers[i].tareGrams = tareGrams;
+    return true;
+}
+
+bool FoodManager::deleteContainer(const char* name) {
+    Guard guard(*this);
+    CachedStatement stmt = statement(STMT_DELETE_CONTAINER);
+    if (!stmt) return false;
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_TRANSIENT);
+    if (stmt.step() != SQLITE_DONE || sqlite3_changes(db) == 0) return false;
+
+    for (size_t i = 0; i < containerTotal; ++i) {
+        if (strcasecmp(containers[i].name, name) != 0) continue;
+        memmove(&containers[i], &containers[i + 1], (containerTotal - i - 1) * sizeof(ContainerItem));
+        containerTotal--;
+        break;
+    }
+    return true;
+}
+
+bool FoodManager::findContainer(const char* name, ContainerItem& out) {
+    Guard guard(*this);
+    for (size_t i = 0; i < containerTotal; ++i) {
+        if (strcasecmp(containers[i].name, name) == 0) {
+            out = containers[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FoodManager::containerAt(size_t index, ContainerItem& out) {
+    Guard guard(*this);
+    if (index >= containerTotal) return false;
+    out = containers[index];
+    return true;
+}
+
+size_t FoodManager::containerCount() {
+    Guard guard(*this);
+    return containerTotal;
 }
 
 
 std::map<String, String> foodColorMap;
 
 void FoodManager::loadColorMap() {
+    Guard guard(*this);
     foodColorMap.clear();
 
     const char* query = R"(SELECT Food.name, ColorMap.color_name
@@ -202,6 +1085,6 @@ void FoodManager::loadColorMap() {
 
 
 
-std::vector<FoodItem>& FoodManager::getDatabase() {
-  return foodDatabase;
+const FoodIndex& FoodManager::getIndex() const {
+  return foodIndex;
 }
@@ -0,0 +1,358 @@
+#pragma once
+#include "esp_mac.h"
+#include <Arduino.h>
+#include <vector>
+#include <map>
+#include <sqlite3.h>
+#include "FoodIndex.h"
+#include "Metrics.h"
+#include "TareStack.h"
+#include "LogExport.h"
+
+struct FoodItem {
+    int id;
+    String name;
+    float calories;   
+    float protein;
+    float carbs;
+    float fat;
+    int usageCount = 0;  // ✅ If analyzeFoodLog is still in use
+};
+
+struct DailyNutrition {
+  float calories, protein, carbs, fat;
+};
+
+// A bowl or pan in the container library; the name doubles as its tare label
+struct ContainerItem {
+    char  name[TARE_LABEL_MAX];
+    float tareGrams;
+};
+
+
+// SQLite path of the catalogue and log (the SD card is mounted at /sd)
+#define FOOD_DB_PATH "/sd/food.db"
+
+// POSIX TZ used for log timestamps and day boundaries
+#define LOCAL_TIMEZONE "CET-1CEST,M3.5.0/2,M10.5.0/3"
+
+// Log write batching: entries are committed together once this many are
+// queued or the oldest has waited this long
+#define LOG_QUEUE_SIZE        32
+#define LOG_FLUSH_THRESHOLD   8
+#define LOG_FLUSH_INTERVAL_MS 2000
+
+// Containers mirrored in RAM so a recall never waits for the card
+#define CONTAINER_MAX 32
+
+// Catalogue import: rows per transaction
+#define IMPORT_BATCH_ROWS 1000
+
+enum ImportResult : uint8_t {
+    IMPORT_ADDED,
+    IMPORT_DUPLICATE,   // name already in the catalogue (idx_food_name)
+    IMPORT_FAILED,
+};
+
+// Local hour each meal of the MealTotals rollup starts at; the snack slot
+// runs from MEAL_SNACK_HOUR to MEAL_BREAKFAST_HOUR the next morning
+#define MEAL_BREAKFAST_HOUR 4
+#define MEAL_LUNCH_HOUR     11
+#define MEAL_DINNER_HOUR    16
+#define MEAL_SNACK_HOUR     22
+
+enum MealSlot : uint8_t {
+    MEAL_BREAKFAST,
+    MEAL_LUNCH,
+    MEAL_DINNER,
+    MEAL_SNACK,
+    MEAL_COUNT
+};
+
+const char* meal_name(uint8_t meal);
+
+enum HistoryBucket : uint8_t {
+    HISTORY_MEAL,
+    HISTORY_DAY,
+    HISTORY_WEEK,
+};
+
+// One bucket of /history: a meal, a day or a week (Monday to Sunday)
+struct HistoryRow {
+    int32_t        day;       // YYYYMMDD; the Monday for a week
+    uint8_t        meal;      // MealSlot, meal buckets only
+    DailyNutrition totals;
+    int32_t        entries;
+};
+
+// A walk over the rollups in time order. readHistory() moves the cursor
+// past each page it returns, so pages can be read with the lock released in
+// between, like forEachFoodColor().
+struct HistoryQuery {
+    HistoryBucket bucket;
+    int32_t       fromDay;    // YYYYMMDD, inclusive
+    int32_t       toDay;
+    int32_t       afterDay = 0;   // cursor: last bucket returned, 0 before the first
+    uint8_t       afterMeal = 0;
+};
+
+// A walk over LogEntry in log_id order for /export. forEachLogEntry() moves
+// afterId past each page, so a client that lost the connection can resume
+// from the last log_id it got. from/to bound ts; rows logged before the
+// clock synced have none and only come with from = 0.
+struct ExportQuery {
+    int64_t from = 0;          // epoch seconds, inclusive
+    int64_t to = INT64_MAX;    // exclusive
+    int64_t afterId = 0;       // cursor: last log_id returned
+    int64_t lastId = -1;       // highest log_id in range, found on the first page
+};
+
+struct PendingLogEntry {
+    int            foodId;
+    float          grams;
+    time_t         ts;              // 0 when the clock was not synced
+    DailyNutrition macros;
+    uint32_t       queuedAt;        // millis()
+    char           timestamp[20];   // "YYYY-MM-DD HH:MM:SS" or "offline"
+    char           color[24];
+};
+
+// Hot queries are compiled once and kept in FoodManager's statement cache
+enum StatementId {
+    STMT_BEGIN,
+    STMT_COMMIT,
+    STMT_ROLLBACK,
+    STMT_INSERT_FOOD,
+    STMT_DELETE_FOOD_COLOR,
+    STMT_DELETE_FOOD,
+    STMT_LIST_FOODS,
+    STMT_SET_COLOR,
+    STMT_INSERT_LOG,
+    STMT_UPSERT_DAILY,
+    STMT_SELECT_DAILY,
+    STMT_UPSERT_CONTAINER,
+    STMT_DELETE_CONTAINER,
+    STMT_UPSERT_MEAL,
+    STMT_HISTORY_DAYS,
+    STMT_HISTORY_MEALS,
+    STMT_EXPORT_RANGE,
+    STMT_EXPORT_LOG,
+    STMT_RESET_DAILY,
+    STMT_FOOD_LOG_DAYS,
+    STMT_CLEAR_MEALS_DAY,
+    STMT_REBUILD_MEALS_DAY,
+    STMT_CLEAR_DAILY_DAY,
+    STMT_REBUILD_DAILY_DAY,
+    STMT_COUNT
+};
+
+// Borrowed cached statement; resets and clears bindings when it goes out of
+// scope so the next caller starts clean and no read transaction stays open.
+// Time spent in step() goes to the statement's /metrics histogram.
+class CachedStatement {
+public:
+    CachedStatement(sqlite3_stmt* stmt, MetricHistogram* latency = nullptr)
+        : stmt(stmt), latency(latency) {}
+    ~CachedStatement() {
+        if (stmt) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+        if (latency && stepped) latency->observe(stepUs);
+    }
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+
+    int step() {
+        int64_t start = esp_timer_get_time();
+        int rc = sqlite3_step(stmt);
+        stepUs += (uint32_t)(esp_timer_get_time() - start);
+        stepped = true;
+        return rc;
+    }
+
+    operator sqlite3_stmt*() const { return stmt; }
+    explicit operator bool() const { return stmt != nullptr; }
+
+private:
+    sqlite3_stmt*    stmt;
+    MetricHistogram* latency;
+    uint32_t         stepUs = 0;
+    bool             stepped = false;
+};
+
+class FoodManager {
+public:
+  // Holds the manager's recursive lock: the app task logs while the web task
+  // edits the catalogue, and both share one SQLite handle and FoodIndex.
+  // Take one around getIndex() reads; the other public methods lock themselves.
+  class Guard {
+  public:
+      explicit Guard(FoodManager& manager) : lock(manager.lock) {
+          if (lock) xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+      }
+      ~Guard() {
+          if (lock) xSemaphoreGiveRecursive(lock);
+      }
+      Guard(const Guard&) = delete;
+      Guard& operator=(const Guard&) = delete;
+
+  private:
+      SemaphoreHandle_t lock;
+  };
+
+void begin(int sdCsPin, const char* dbPath = FOOD_DB_PATH);
+  // Flushes queued log entries and closes the database
+  void end();
+  void loadDatabase();
+  // False when the catalogue already has the name (case-insensitive)
+  bool addFood(const String& name, float calories, float protein, float carbs, float fat);
+  bool deleteFood(const String& name);
+  const FoodIndex& getIndex() const;
+
+  // Typed accessors used by the web/BLE handlers; findFood() is an index
+  // lookup (case-insensitive) and does not touch SQLite
+  bool findFood(const String& name, FoodItem& out);
+  bool queueLogEntry(const FoodItem& food, float grams, const String& timestamp, time_t ts,
+                     const DailyNutrition& macros, const String& color);
+  bool setFoodColor(int foodId, const String& color);
+
+  // Container library (name -> tare weight, names case-insensitive). The
+  // table is mirrored in RAM: findContainer() and containerAt() never touch
+  // SQLite, only saving and deleting do. False when the library is full or
+  // the name is not there.
+  bool saveContainer(const char* name, float tareGrams);   // adds or updates
+  bool deleteContainer(const char* name);
+  bool findContainer(const char* name, ContainerItem& out);
+  bool containerAt(size_t index, ContainerItem& out);      // in name order
+  size_t containerCount();
+
+  // Bulk catalogue load, used by FoodImporter. Rows go through the cached
+  // insert in transactions of IMPORT_BATCH_ROWS, and the lock is only held
+  // while a batch is open, so logging carries on in between. FoodIndex is
+  // rebuilt once by endImport() rather than row by row; until then the new
+  // foods are in SQLite only. Names the catalogue already has, from before
+  // or earlier in the same import, are skipped.
+  bool beginImport();   // false while another import runs
+  ImportResult importFood(const char* name, const FoodMacros& per100g);
+  bool commitImport();  // ends the open batch early, before waiting for input
+  bool endImport();     // commits the last batch and reindexes
+
+  // Commits all queued log entries now (also call on power-loss warning)
+  bool flushLogQueue();
+  size_t pendingLogCount() const { return pendingCount; }
+  void handle();
+
+  // Calls fn(name, color) for up to limit foods with food_id above afterId,
+  // in id order; color is "" when unmapped. Returns the last id passed to fn,
+  // or afterId when there are none left, so a caller can walk the catalogue
+  // a page at a time without holding the lock in between.
+  template <typename Fn>
+  int forEachFoodColor(int afterId, int limit, Fn&& fn) {
+      Guard guard(*this);
+      CachedStatement stmt = statement(STMT_LIST_FOODS);
+      if (!stmt) return afterId;
+      sqlite3_bind_int(stmt, 1, afterId);
+      sqlite3_bind_int(stmt, 2, limit);
+      int lastId = afterId;
+      while (stmt.step() == SQLITE_ROW) {
+          lastId = sqlite3_column_int(stmt, 0);
+          fn(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)),
+             reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
+      }
+      return lastId;
+  }
+
+  // Every food in one pass
+  template <typename Fn>
+  void forEachFoodColor(Fn&& fn) {
+      forEachFoodColor(0, INT32_MAX, fn);
+  }
+
+// Today's totals from the DailyTotals rollup, less what was there at the
+// last /reset; false if there are none yet
+bool restoreDailyTotalsFromDatabase(DailyNutrition& out);
+// Marks the day of now as reset: restoring it counts from zero again.
+// The rollups and /history keep every entry.
+bool resetDailyTotals(time_t now);
+static int32_t dayKey(time_t t);  // local date as YYYYMMDD
+static time_t dayStart(int32_t day);  // local midnight of a YYYYMMDD date
+static uint8_t mealSlot(time_t t);
+
+// Next page of up to max buckets of query into out; 0 once the range is
+// done. Reads only the DailyTotals and MealTotals rollups, never LogEntry,
+// so the cost follows the range and not the size of the log.
+size_t readHistory(HistoryQuery& query, HistoryRow* out, size_t max);
+
+// Calls fn(const LogExportRow&) for up to limit log entries of query, with
+// their food, and returns how many; fewer than limit means the query is
+// done. The row's strings are only valid inside fn. Each page is one
+// rowid range scan under the lock, like forEachFoodColor().
+template <typename Fn>
+size_t forEachLogEntry(ExportQuery& query, size_t limit, Fn&& fn) {
+    Guard guard(*this);
+    if (query.lastId < 0 && !findExportRange(query)) return 0;
+    CachedStatement stmt = statement(STMT_EXPORT_LOG);
+    if (!stmt) return 0;
+    sqlite3_bind_int64(stmt, 1, query.afterId);
+    sqlite3_bind_int64(stmt, 2, query.lastId);
+    sqlite3_bind_int64(stmt, 3, query.from);
+    sqlite3_bind_int64(stmt, 4, query.to);
+    sqlite3_bind_int64(stmt, 5, (sqlite3_int64)limit);
+    size_t n = 0;
+    LogExportRow row;
+    while (stmt.step() == SQLITE_ROW) {
+        row.logId     = sqlite3_column_int64(stmt, 0);
+        row.ts        = sqlite3_column_int64(stmt, 1);
+        row.timestamp = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        row.foodId    = sqlite3_column_int(stmt, 3);
+        row.food      = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+        row.grams     = sqlite3_column_double(stmt, 5);
+        row.calories  = sqlite3_column_double(stmt, 6);
+        row.protein   = sqlite3_column_double(stmt, 7);
+        row.carbs     = sqlite3_column_double(stmt, 8);
+        row.fat       = sqlite3_column_double(stmt, 9);
+        query.afterId = row.logId;
+        fn(row);
+        n++;
+    }
+    return n;
+}
+
+// Recomputes both rollups from LogEntry, e.g. after rows were written
+// behind FoodManager's back. One pass over the covering ts index.
+bool rebuildRollups();
+
+void loadColorMap();
+String getColorForFood(const String& name);
+
+
+private:
+ void migrateSchema();
+ void loadContainers();
+ bool hasColumn(const char* table, const char* column);
+ void configureJournal();
+ void registerFunctions();
+ bool findExportRange(ExportQuery& query);
+ bool addToRollups(time_t ts, const DailyNutrition& macros);
+ bool rebuildRollupDay(int32_t day);
+ bool writeLogEntry(const PendingLogEntry& entry);
+
+ CachedStatement statement(StatementId id);
+ void finalizeStatements();
+
+ sqlite3_stmt* statements[STMT_COUNT] = {};
+ MetricHistogram* statementLatency[STMT_COUNT] = {};
+ PendingLogEntry pendingLogs[LOG_QUEUE_SIZE];
+ size_t pendingCount = 0;
+
+ FoodIndex foodIndex;
+ ContainerItem containers[CONTAINER_MAX];   // sorted by name
+ size_t containerTotal = 0;
+ bool importing = false;
+ bool importBatchOpen = false;   // holds the lock while true
+ size_t importBatchRows = 0;
+    std::map<String, String> foodColorMap;
+    sqlite3* db = nullptr;  // ✅ DB handle here
+    SemaphoreHandle_t lock = nullptr;
+};
@@ -0,0 +1,1044 @@
+#include "HttpServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <esp_timer.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef ESP32_NATIVE
+#include "NativeHal.h"
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // lwIP never raises SIGPIPE
+#endif
+
+#define HTTP_CHUNK_HEAD    6   // "xxxx\r\n"
+#define HTTP_CHUNK_TAIL    2   // "\r\n"
+#define HTTP_LAST_CHUNK    "0\r\n\r\n"
+#define HTTP_WS_GUID       "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+static uint32_t nowMs() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static const char* statusText(int code) {
+    switch (code) {
+        case 100: return "Continue";
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 426: return "Upgrade Required";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default:  return "";
+    }
+}
+
+static HttpMethod parseMethod(const char* m) {
+    if (strcmp(m, "GET") == 0) return HTTP_METHOD_GET;
+    if (strcmp(m, "HEAD") == 0) return HTTP_METHOD_HEAD;
+    if (strcmp(m, "POST") == 0) return HTTP_METHOD_POST;
+    return HTTP_METHOD_OTHER;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Percent-decodes text[0, length) in place and terminates it
+static void urlDecode(char* text, size_t length, bool plusIsSpace) {
+    char* out = text;
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        if (c == '+' && plusIsSpace) {
+            c = ' ';
+        } else if (c == '%' && i + 2 < length) {
+            int hi = hexValue(text[i + 1]);
+            int lo = hexValue(text[i + 2]);
+            if (hi >= 0 && lo >= 0) {
+                c = (char)(hi * 16 + lo);
+                i += 2;
+            }
+        }
+        *out++ = c;
+    }
+    *out = '\0';
+}
+
+// Case-insensitive "name:" at the start of a header line
+static const char* headerValue(const char* line, const char* lineEnd, const char* name) {
+    size_t n = strlen(name);
+    if ((size_t)(lineEnd - line) <= n || strncasecmp(line, name, n) != 0 || line[n] != ':') return nullptr;
+    const char* v = line + n + 1;
+    while (v < lineEnd && (*v == ' ' || *v == '\t')) ++v;
+    return v;
+}
+
+// Content-Length value: digits only (optional whitespace after), no sign,
+// and it has to fit. False for anything else, which is then a 400: a
+// length read any other way would frame the rest of the stream wrongly.
+static bool parseLength(const char* v, const char* lineEnd, size_t& out) {
+    while (lineEnd > v && (lineEnd[-1] == ' ' || lineEnd[-1] == '\t')) --lineEnd;
+    if (v == lineEnd) return false;
+    size_t n = 0;
+    for (; v < lineEnd; ++v) {
+        if (*v < '0' || *v > '9') return false;
+        size_t digit = *v - '0';
+        if (n > (SIZE_MAX - 1 - digit) / 10) return false;   // SIZE_MAX itself is HTTP_LENGTH_CHUNKED
+        n = n * 10 + digit;
+    }
+    out = n;
+    return true;
+}
+
+// Next "\r\n" in [from, end), or nullptr
+static char* findCrlf(char* from, const char* end) {
+    for (char* p = from; p + 1 < end; ++p)
+        if (p[0] == '\r' && p[1] == '\n') return p;
+    return nullptr;
+}
+
+static size_t base64Decode(const char* in, char* out, size_t cap) {
+    uint32_t bits = 0;
+    int count = 0;
+    size_t n = 0;
+    for (; *in && *in != '='; ++in) {
+        const char c = *in;
+        int v;
+        if (c >= 'A' && c <= 'Z') v = c - 'A';
+        else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') v = c - '0' + 52;
+        else if (c == '+') v = 62;
+        else if (c == '/') v = 63;
+        else break;
+        bits = (bits << 6) | v;
+        count += 6;
+        if (count >= 8) {
+            count -= 8;
+            if (n + 1 >= cap) break;
+            out[n++] = (char)((bits >> count) & 0xff);
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
+
+static size_t base64Encode(const uint8_t* in, size_t length, char* out) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < length) v |= (uint32_t)in[i + 1] << 8;
+        if (i + 2 < length) v |= in[i + 2];
+        out[n++] = alphabet[(v >> 18) & 63];
+        out[n++] = alphabet[(v >> 12) & 63];
+        out[n++] = i + 1 < length ? alphabet[(v >> 6) & 63] : '=';
+        out[n++] = i + 2 < length ? alphabet[v & 63] : '=';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+// SHA-1, only for the WebSocket handshake (Sec-WebSocket-Accept)
+static void sha1(const uint8_t* data, size_t length, uint8_t digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    auto rol = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+
+    uint8_t block[64];
+    uint64_t bits = (uint64_t)length * 8;
+    size_t blocks = (length + 8) / 64 + 1;
+    for (size_t b = 0; b < blocks; ++b) {
+        for (size_t i = 0; i < 64; ++i) {
+            size_t pos = b * 64 + i;
+            if (pos < length) block[i] = data[pos];
+            else if (pos == length) block[i] = 0x80;
+            else if (b == blocks - 1 && i >= 56) block[i] = (uint8_t)(bits >> (8 * (63 - i)));
+            else block[i] = 0;
+        }
+
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i)
+            w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+                   (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+        for (int i = 16; i < 80; ++i) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], bb = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20)      { f = (bb & c) | (~bb & d);           k = 0x5a827999; }
+            else if (i < 40) { f = bb ^ c ^ d;                     k = 0x6ed9eba1; }
+            else if (i < 60) { f = (bb & c) | (bb & d) | (c & d);  k = 0x8f1bbcdc; }
+            else             { f = bb ^ c ^ d;                     k = 0xca62c1d6; }
+            uint32_t t = rol(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rol(bb, 30);
+            bb = a;
+            a = t;
+        }
+        h[0] += a; h[1] += bb; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 20; ++i) digest[i] = (uint8_t)(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+// Case-insensitive token in a comma-separated header value
+static bool headerHasToken(const char* value, const char* token) {
+    size_t n = strlen(token);
+    for (const char* p = value; *p;) {
+        while (*p == ' ' || *p == ',') ++p;
+        const char* end = p;
+        while (*end && *end != ',') ++end;
+        const char* trim = end;
+        while (trim > p && trim[-1] == ' ') --trim;
+        if ((size_t)(trim - p) == n && strncasecmp(p, token, n) == 0) return true;
+        p = end;
+    }
+    return false;
+}
+
+
+size_t HttpStaticBody::read(char* out, size_t cap) {
+    size_t n = remaining < cap ? remaining : cap;
+    memcpy(out, data, n);
+    data += n;
+    remaining -= n;
+    return n;
+}
+
+
+// ---- Request ----------------------------------------------------------------
+
+void HttpRequest::addArgs(char* text, size_t length) {
+    char* end = text + length;
+    while (text < end && argCount < HTTP_MAX_ARGS) {
+        char* amp = (char*)memchr(text, '&', end - text);
+        char* pairEnd = amp ? amp : end;
+        char* eq = (char*)memchr(text, '=', pairEnd - text);
+        if (pairEnd > text) {
+            Field& f = args[argCount++];
+            if (eq) {
+                urlDecode(eq + 1, pairEnd - eq - 1, true);
+                urlDecode(text, eq - text, true);
+                f.value = eq + 1;
+            } else {
+                urlDecode(text, pairEnd - text, true);
+                f.value = "";
+            }
+            f.name = text;
+        }
+        text = pairEnd + 1;
+    }
+}
+
+bool HttpRequest::hasArg(const char* name) const {
+    for (uint8_t i = 0; i < argCount; ++i)
+        if (strcmp(args[i].name, name) == 0) return true;
+    return false;
+}
+
+const char* HttpRequest::arg(const char* name) const {
+    for (uint8_t i = 0; i < argCount; ++i)
+        if (strcmp(args[i].name, name) == 0) return args[i].value;
+    return "";
+}
+
+const char* HttpRequest::header(const char* name) const {
+    for (uint8_t i = 0; i < headerCount; ++i)
+        if (strcasecmp(headers[i].name, name) == 0) return headers[i].value;
+    return "";
+}
+
+bool HttpRequest::authenticate(const char* user, const char* password) const {
+    const char* auth = header("Authorization");
+    if (strncasecmp(auth, "Basic ", 6) != 0) return false;
+
+    char decoded[128];
+    base64Decode(auth + 6, decoded, sizeof(decoded));
+    const char* colon = strchr(decoded, ':');
+    size_t userLen = strlen(user);
+    return colon && (size_t)(colon - decoded) == userLen && strncmp(decoded, user, userLen) == 0 &&
+           strcmp(colon + 1, password) == 0;
+}
+
+
+// ---- Response ---------------------------------------------------------------
+
+void HttpResponse::sendHeader(const char* name, const char* value) {
+    int n = snprintf(extra + extraUsed, sizeof(extra) - extraUsed, "%s: %s\r\n", name, value);
+    if (n > 0 && extraUsed + n < sizeof(extra)) extraUsed += n;
+    else extra[extraUsed] = '\0';   // dropped: the header does not fit
+}
+
+// Status line and headers; false if they do not fit the transmit buffer
+bool HttpResponse::writeHead(int code, const char* contentType, size_t length) {
+    char* out = conn.tx + conn.txUsed;
+    size_t cap = HTTP_TX_BUFFER_SIZE - conn.txUsed;
+    int n = snprintf(out, cap, "HTTP/1.1 %d %s\r\n", code, statusText(code));
+    if (contentType && *contentType && n > 0 && (size_t)n < cap)
+        n += snprintf(out + n, cap - n, "Content-Type: %s\r\n", contentType);
+    if (code != 204 && code != 304 && n > 0 && (size_t)n < cap) {
+        if (length == HTTP_LENGTH_CHUNKED) n += snprintf(out + n, cap - n, "Transfer-Encoding: chunked\r\n");
+        else n += snprintf(out + n, cap - n, "Content-Length: %lu\r\n", (unsigned long)length);
+    }
+    if (n > 0 && (size_t)n < cap)
+        n += snprintf(out + n, cap - n, "Connection: %s\r\n%.*s\r\n",
+                      conn.keepAlive ? "keep-alive" : "close", (int)extraUsed, extra);
+    done = true;
+    if (n <= 0 || (size_t)n >= cap) {
+        conn.keepAlive = false;
+        return false;
+    }
+    conn.txUsed += n;
+    return true;
+}
+
+void HttpResponse::send(int code, const char* contentType, const char* body) {
+    send(code, contentType, body, body ? strlen(body) : 0);
+}
+
+// Small bodies go into the transmit buffer with the head; larger ones are
+// copied once to the heap and streamed from there
+void HttpResponse::send(int code, const char* contentType, const char* body, size_t length) {
+    if (code == 204 || code == 304) length = 0;
+    if (!writeHead(code, contentType, length) || headOnly || length == 0) return;
+
+    if (length <= HTTP_TX_BUFFER_SIZE - conn.txUsed) {
+        memcpy(conn.tx + conn.txUsed, body, length);
+        conn.txUsed += length;
+        return;
+    }
+
+    class CopiedBody : public HttpBodySource {
+    public:
+        CopiedBody(const char* data, size_t length) : copy(new char[length]), view((const uint8_t*)copy.get(), length) {
+            memcpy(copy.get(), data, length);
+        }
+        size_t read(char* out, size_t cap) override { return view.read(out, cap); }
+
+    private:
+        std::unique_ptr<char[]> copy;
+        HttpStaticBody          view;
+    };
+    conn.body.reset(new CopiedBody(body, length));
+    conn.bodyRemaining = length;
+    conn.chunked = false;
+}
+
+void HttpResponse::sendStatic(int code, const char* contentType, const uint8_t* body, size_t length) {
+    sendBody(code, contentType, std::unique_ptr<HttpBodySource>(new HttpStaticBody(body, length)), length);
+}
+
+void HttpResponse::sendBody(int code, const char* contentType, std::unique_ptr<HttpBodySource> source, size_t length) {
+    if (!writeHead(code, contentType, length) || headOnly || length == 0) return;
+    conn.body = std::move(source);
+    conn.chunked = length == HTTP_LENGTH_CHUNKED;
+    conn.bodyRemaining = conn.chunked ? 0 : length;
+}
+
+void HttpResponse::onComplete(std::function<void()> fn) {
+    conn.complete = std::move(fn);
+}
+
+void HttpResponse::requestAuthentication(const char* realm) {
+    char challenge[64];
+    snprintf(challenge, sizeof(challenge), "Basic realm=\"%s\"", realm);
+    sendHeader("WWW-Authenticate", challenge);
+    send(401, "text/plain", "Unauthorized");
+}
+
+
+// ---- Server -----------------------------------------------------------------
+
+HttpServer::~HttpServer() {
+    end();
+}
+
+bool HttpServer::begin(uint16_t port) {
+    end();
+    int hostPort = port;
+#ifdef ESP32_NATIVE
+    hostPort += native_portOffset();
+#endif
+
+    const size_t slot = HTTP_RX_BUFFER_SIZE + 1 + HTTP_TX_BUFFER_SIZE;   // +1: room to terminate a body
+    pool = (char*)malloc(slot * HTTP_MAX_CONNECTIONS);
+    if (!pool) return false;
+    for (size_t i = 0; i < HTTP_MAX_CONNECTIONS; ++i) {
+        connections[i].rx = pool + i * slot;
+        connections[i].tx = connections[i].rx + HTTP_RX_BUFFER_SIZE + 1;
+    }
+
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        end();
+        return false;
+    }
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(hostPort);
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listenFd, HTTP_MAX_CONNECTIONS) != 0) {
+        end();
+        return false;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+void HttpServer::end() {
+    for (HttpConnection& c : connections) closeConnection(c);
+    if (listenFd >= 0) ::close(listenFd);
+    listenFd = -1;
+    free(pool);
+    pool = nullptr;
+}
+
+void HttpServer::on(const char* path, Handler handler, uint8_t methods) {
+    if (routeCount < HTTP_MAX_ROUTES) routes[routeCount++] = {path, methods, std::move(handler), nullptr, nullptr};
+}
+
+void HttpServer::onWebSocket(const char* path, HttpWebSocketHandler* handler) {
+    if (routeCount < HTTP_MAX_ROUTES) routes[routeCount++] = {path, HTTP_METHOD_GET, nullptr, handler, nullptr};
+}
+
+void HttpServer::onUpload(const char* path, UploadHandler handler, uint8_t methods) {
+    if (routeCount < HTTP_MAX_ROUTES) routes[routeCount++] = {path, methods, nullptr, nullptr, std::move(handler)};
+}
+
+// target is the raw request target, up to the space before the version
+bool HttpServer::isUploadPath(const char* target) const {
+    size_t length = strcspn(target, "? ");
+    for (size_t i = 0; i < routeCount; ++i) {
+        if (routes[i].upload && strncmp(routes[i].path, target, length) == 0 && routes[i].path[length] == '\0')
+            return true;
+    }
+    return false;
+}
+
+size_t HttpServer::connectionCount() const {
+    size_t n = 0;
+    for (const HttpConnection& c : connections)
+        if (c.fd >= 0) ++n;
+    return n;
+}
+
+void HttpServer::poll(int timeoutMs) {
+    if (listenFd < 0) return;
+
+    pollfd fds[HTTP_MAX_CONNECTIONS + 1];
+    HttpConnection* owners[HTTP_MAX_CONNECTIONS + 1];
+    nfds_t count = 0;
+    bool slotFree = false;
+    for (HttpConnection& c : connections) {
+        if (c.fd < 0) {
+            slotFree = true;
+            continue;
+        }
+        short events = 0;
+        if (c.rxUsed < HTTP_RX_BUFFER_SIZE && !c.peerClosed) events |= POLLIN;
+        if (c.txSent < c.txUsed) events |= POLLOUT;
+        fds[count] = {c.fd, events, 0};
+        owners[count++] = &c;
+    }
+    // With the pool full, a waiting client takes the slot of an idle
+    // keep-alive connection; only when every slot is busy does it stay in
+    // the listen backlog
+    bool listening = slotFree || idleConnection() != nullptr;
+    if (listening) {
+        fds[count] = {listenFd, POLLIN, 0};
+        owners[count++] = nullptr;
+    }
+
+    if (::poll(fds, count, timeoutMs) < 0) return;
+    uint32_t now = nowMs();
+
+    for (nfds_t i = 0; i < count; ++i) {
+        HttpConnection* c = owners[i];
+        if (!c) continue;
+        if (fds[i].revents & (POLLERR | POLLNVAL)) {
+            closeConnection(*c);
+            continue;
+        }
+        if (fds[i].revents & (POLLIN | POLLHUP)) receive(*c, now);
+        if (c->fd >= 0) service(*c, now);
+    }
+    if (listening && (fds[count - 1].revents & POLLIN)) acceptConnections(now);
+
+    for (HttpConnection& c : connections) {
+        if (c.fd < 0) continue;
+        if (c.ws) {
+            // Browsers answer pings by themselves, so silence means a dead link
+            uint32_t quiet = now - c.wsLastReceiveMs;
+            if (quiet > 2 * HTTP_WS_PING_MS) {
+                closeConnection(c);
+            } else if (quiet > HTTP_WS_PING_MS && !c.wsPingSent) {
+                c.wsPingSent = wsSend(&c - connections, HTTP_WS_PING, nullptr, 0);
+            }
+            continue;
+        }
+        bool busy = c.rxUsed || c.txSent < c.txUsed || c.body || c.uploadRemaining;
+        uint32_t limit = busy ? HTTP_REQUEST_TIMEOUT_MS : HTTP_IDLE_TIMEOUT_MS;
+        if (now - c.lastActivityMs > limit) closeConnection(c);
+    }
+}
+
+// Least recently used keep-alive connection between requests: it has been
+// answered, nothing is buffered either way and no body or upload is in
+// flight. Fresh connections are left alone, their request is on its way.
+HttpConnection* HttpServer::idleConnection() {
+    HttpConnection* oldest = nullptr;
+    for (HttpConnection& c : connections) {
+        if (c.fd < 0 || c.ws || !c.answered || c.rxUsed || c.txSent < c.txUsed || c.body || c.upload ||
+            c.uploadRemaining)
+            continue;
+        if (!oldest || (int32_t)(c.lastActivityMs - oldest->lastActivityMs) < 0) oldest = &c;
+    }
+    return oldest;
+}
+
+void HttpServer::acceptConnections(uint32_t now) {
+    for (;;) {
+        HttpConnection* slot = nullptr;
+        for (HttpConnection& c : connections) {
+            if (c.fd < 0) {
+                slot = &c;
+                break;
+            }
+        }
+        HttpConnection* victim = slot ? nullptr : idleConnection();
+        if (!slot && !victim) return;   // every slot busy: the rest wait in the backlog
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;
+        if (victim) {
+            closeConnection(*victim);
+            slot = victim;
+        }
+        HttpConnection& c = *slot;
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        c.fd = fd;
+        c.rxUsed = c.txUsed = c.txSent = 0;
+        c.body.reset();
+        c.upload.reset();
+        c.uploadRemaining = 0;
+        c.keepAlive = true;
+        c.peerClosed = false;
+        c.continueSent = false;
+        c.answered = false;
+        c.lastActivityMs = now;
+        c.ws = nullptr;
+        c.wsClosing = false;
+        c.wsPingSent = false;
+        service(c, now);   // the request often arrives with the handshake
+    }
+}
+
+void HttpServer::receive(HttpConnection& c, uint32_t now) {
+    if (c.rxUsed >= HTTP_RX_BUFFER_SIZE || c.peerClosed) return;
+    ssize_t n = recv(c.fd, c.rx + c.rxUsed, HTTP_RX_BUFFER_SIZE - c.rxUsed, 0);
+    if (n > 0) {
+        c.rxUsed += n;
+        c.lastActivityMs = now;
+        c.wsLastReceiveMs = now;
+        c.wsPingSent = false;
+    } else if (n == 0) {
+        c.peerClosed = true;   // answer what was sent before the FIN, then close
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        closeConnection(c);
+    }
+}
+
+// Moves the connection as far as it can go without waiting: flush, refill
+// from the body source, then answer the next buffered request
+void HttpServer::service(HttpConnection& c, uint32_t now) {
+    size_t uploadBurst = 0;
+    while (c.fd >= 0) {
+        if (c.txSent < c.txUsed) {
+            if (!sendPending(c, now)) return;
+            continue;
+        }
+        c.txUsed = c.txSent = 0;
+
+        if (c.complete && !c.body) {
+            std::function<void()> complete = std::move(c.complete);
+            c.complete = nullptr;
+            complete();
+        }
+        if (c.ws) {
+            if (c.wsClosing) {
+                closeConnection(c);
+                return;
+            }
+            if (!readFrame(c)) {
+                if (c.peerClosed) closeConnection(c);
+                return;
+            }
+            continue;
+        }
+        if (c.body) {
+            fillBody(c);
+            continue;
+        }
+        if (c.upload || c.uploadRemaining) {
+            if (!receiveUpload(c)) {
+                // Straight to the next receive while the socket has data,
+                // instead of one receive buffer per poll
+                if (!c.peerClosed && uploadBurst < HTTP_UPLOAD_BURST) {
+                    receive(c, now);
+                    uploadBurst += c.rxUsed;
+                    if (c.rxUsed) continue;
+                }
+                if (c.peerClosed) closeConnection(c);
+                return;
+            }
+            continue;
+        }
+        if (!c.keepAlive) {
+            closeConnection(c);
+            return;
+        }
+        if (!dispatchNext(c)) {
+            if (c.peerClosed) closeConnection(c);
+            return;
+        }
+    }
+}
+
+// True once the transmit buffer is empty; false while the socket is full
+bool HttpServer::sendPending(HttpConnection& c, uint32_t now) {
+    ssize_t n = ::send(c.fd, c.tx + c.txSent, c.txUsed - c.txSent, MSG_NOSIGNAL);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) closeConnection(c);
+        return false;
+    }
+    c.txSent += n;
+    c.lastActivityMs = now;
+    return c.txSent == c.txUsed;
+}
+
+void HttpServer::fillBody(HttpConnection& c) {
+    if (c.chunked) {
+        size_t cap = HTTP_TX_BUFFER_SIZE - HTTP_CHUNK_HEAD - HTTP_CHUNK_TAIL;
+        size_t n = c.body->read(c.tx + HTTP_CHUNK_HEAD, cap);
+        if (n == 0) {
+            memcpy(c.tx, HTTP_LAST_CHUNK, sizeof(HTTP_LAST_CHUNK) - 1);
+            c.txUsed = sizeof(HTTP_LAST_CHUNK) - 1;
+            c.body.reset();
+            return;
+        }
+        static const char digits[] = "0123456789abcdef";
+        for (int i = 0; i < 4; ++i) c.tx[i] = digits[(n >> (12 - 4 * i)) & 0xf];
+        c.tx[4] = '\r';
+        c.tx[5] = '\n';
+        c.tx[HTTP_CHUNK_HEAD + n] = '\r';
+        c.tx[HTTP_CHUNK_HEAD + n + 1] = '\n';
+        c.txUsed = HTTP_CHUNK_HEAD + n + HTTP_CHUNK_TAIL;
+        return;
+    }
+
+    size_t cap = c.bodyRemaining < HTTP_TX_BUFFER_SIZE ? c.bodyRemaining : HTTP_TX_BUFFER_SIZE;
+    size_t n = cap ? c.body->read(c.tx, cap) : 0;
+    if (n == 0 && c.bodyRemaining) {
+        // Source ended before its Content-Length: the framing is broken
+        closeConnection(c);
+        return;
+    }
+    c.txUsed = n;
+    c.bodyRemaining -= n;
+    if (c.bodyRemaining == 0) c.body.reset();
+}
+
+// Hands the buffered part of a streamed request body to its sink, or drops
+// it when there is none. False while more of it has to arrive.
+bool HttpServer::receiveUpload(HttpConnection& c) {
+    size_t n = c.rxUsed < c.uploadRemaining ? c.rxUsed : c.uploadRemaining;
+    if (n == 0 && c.uploadRemaining) return false;
+
+    if (n) {
+        if (c.upload && !c.upload->write(c.rx, n)) finishUpload(c);
+        c.uploadRemaining -= n;
+        c.rxUsed -= n;
+        memmove(c.rx, c.rx + n, c.rxUsed);
+    }
+    if (c.uploadRemaining == 0 && c.upload) finishUpload(c);
+    return true;
+}
+
+void HttpServer::finishUpload(HttpConnection& c) {
+    std::unique_ptr<HttpBodySink> sink = std::move(c.upload);
+    HttpResponse res(c, false);
+    sink->finish(res);
+    if (!res.sent()) res.send(500, "text/plain", "Handler sent no response");
+}
+
+// Parses and answers the request at the front of the receive buffer. False
+// when no complete request is buffered yet.
+bool HttpServer::dispatchNext(HttpConnection& c) {
+    char* rx = c.rx;
+
+    // Stray line breaks between requests are allowed and ignored
+    size_t skip = 0;
+    while (skip < c.rxUsed && (rx[skip] == '\r' || rx[skip] == '\n')) ++skip;
+    if (skip) {
+        c.rxUsed -= skip;
+        memmove(rx, rx + skip, c.rxUsed);
+    }
+
+    char* headEnd = nullptr;
+    for (size_t i = 3; i < c.rxUsed; ++i) {
+        if (rx[i] == '\n' && rx[i - 1] == '\r' && rx[i - 2] == '\n' && rx[i - 3] == '\r') {
+            headEnd = rx + i + 1;
+            break;
+        }
+    }
+    if (!headEnd) {
+        if (c.rxUsed < HTTP_RX_BUFFER_SIZE) return false;
+        sendError(c, 431);
+        return true;
+    }
+
+    // Framing first, without touching the buffer: the body may still be on its way
+    size_t bodyLength = 0;
+    bool lengthSeen = false;
+    bool expectContinue = false;
+    const char* line = (const char*)memchr(rx, '\n', headEnd - rx) + 1;
+    while (line < headEnd - 2) {
+        const char* lineEnd = (const char*)memchr(line, '\r', headEnd - line);
+        const char* v;
+        if ((v = headerValue(line, lineEnd, "Content-Length"))) {
+            // Repeats must agree, or the two ends could frame it differently
+            size_t length;
+            if (!parseLength(v, lineEnd, length) || (lengthSeen && length != bodyLength)) {
+                sendError(c, 400);
+                return true;
+            }
+            bodyLength = length;
+            lengthSeen = true;
+        } else if ((v = headerValue(line, lineEnd, "Expect"))) expectContinue = strncasecmp(v, "100-continue", 12) == 0;
+        else if (headerValue(line, lineEnd, "Transfer-Encoding")) {
+            sendError(c, 411);   // chunked uploads are not supported
+            return true;
+        }
+        line = lineEnd + 2;
+    }
+
+    // An upload route is answered from the head alone; its body streams in
+    // after it, through the sink
+    const char* space = (const char*)memchr(rx, ' ', headEnd - rx);
+    bool streamBody = bodyLength && space && isUploadPath(space + 1);
+
+    size_t headLength = headEnd - rx;
+    if (!streamBody && bodyLength > HTTP_RX_BUFFER_SIZE - headLength) {
+        sendError(c, 413);
+        return true;
+    }
+    size_t requestLength = streamBody ? headLength : headLength + bodyLength;
+    if (c.rxUsed < requestLength) {
+        if (!expectContinue || c.continueSent) return false;
+        c.txUsed = snprintf(c.tx, HTTP_TX_BUFFER_SIZE, "HTTP/1.1 100 Continue\r\n\r\n");
+        c.continueSent = true;
+        return true;
+    }
+
+    // Complete: split it up in place. The byte after the body may belong to
+    // the next pipelined request, so it is saved around the terminator.
+    char saved = rx[requestLength];
+    rx[requestLength] = '\0';
+
+    HttpRequest req;
+    char* cursor = rx;
+    char* lineEnd = findCrlf(cursor, headEnd);
+    *lineEnd = '\0';
+    char* method = cursor;
+    char* target = strchr(method, ' ');
+    char* version = target ? strchr(target + 1, ' ') : nullptr;
+    if (!target || !version || target[1] != '/') {
+        rx[requestLength] = saved;
+        sendError(c, 400);
+        return true;
+    }
+    *target++ = '\0';
+    *version++ = '\0';
+    req.requestMethod = parseMethod(method);
+    bool http10 = strcmp(version, "HTTP/1.0") == 0;
+
+    char* query = strchr(target, '?');
+    if (query) *query++ = '\0';
+    urlDecode(target, strlen(target), false);
+    req.requestPath = target;
+    if (query) req.addArgs(query, strlen(query));
+
+    bool keepAlive = !http10;
+    cursor = lineEnd + 2;
+    while (cursor < headEnd - 2) {
+        lineEnd = findCrlf(cursor, headEnd);
+        *lineEnd = '\0';
+        char* colon = strchr(cursor, ':');
+        if (colon && req.headerCount < HTTP_MAX_HEADERS) {
+            *colon = '\0';
+            char* value = colon + 1;
+            while (*value == ' ' || *value == '\t') ++value;
+            req.headers[req.headerCount++] = {cursor, value};
+            if (strcasecmp(cursor, "Connection") == 0) {
+                if (strcasecmp(value, "close") == 0) keepAlive = false;
+                else if (strcasecmp(value, "keep-alive") == 0) keepAlive = true;
+            }
+        }
+        cursor = lineEnd + 2;
+    }
+
+    req.requestBody = streamBody ? "" : headEnd;
+    req.requestBodyLength = bodyLength;
+    if (!streamBody && bodyLength &&
+        strncasecmp(req.header("Content-Type"), "application/x-www-form-urlencoded", 33) == 0)
+        req.addArgs(headEnd, bodyLength);   // shortens the body in place; the length stays as sent
+
+    c.keepAlive = keepAlive && !c.peerClosed;
+    dispatch(c, req);
+
+    rx[requestLength] = saved;
+    c.rxUsed -= requestLength;
+    memmove(rx, rx + requestLength, c.rxUsed);
+    c.continueSent = false;
+
+    if (streamBody) {
+        if (c.upload) {
+            c.uploadRemaining = bodyLength;
+            if (expectContinue && c.rxUsed < bodyLength) {
+                c.txUsed = snprintf(c.tx, HTTP_TX_BUFFER_SIZE, "HTTP/1.1 100 Continue\r\n\r\n");
+            }
+        } else if (expectContinue) {
+            c.keepAlive = false;   // turned down; the client holds the body back
+        } else {
+            c.uploadRemaining = bodyLength;   // already answered; read past the body
+        }
+    }
+    return true;
+}
+
+void HttpServer::dispatch(HttpConnection& c, HttpRequest& req) {
+    ++requests;
+    c.answered = true;
+    HttpResponse res(c, req.method() == HTTP_METHOD_HEAD);
+
+    const Route* match = nullptr;
+    bool pathKnown = false;
+    for (size_t i = 0; i < routeCount && !match; ++i) {
+        if (strcmp(routes[i].path, req.path()) != 0) continue;
+        pathKnown = true;
+        if (routes[i].methods & req.method()) match = &routes[i];
+    }
+
+    if (match && match->ws) {
+        upgrade(c, req, match->ws);
+        return;
+    }
+
+    if (match && match->upload) {
+        std::unique_ptr<HttpBodySink> sink = match->upload(req, res);
+        if (!res.sent()) {
+            if (sink) c.upload = std::move(sink);
+            else res.send(500, "text/plain", "Handler sent no response");
+        }
+        return;
+    }
+
+    if (match) match->handler(req, res);
+    else if (pathKnown) res.send(405, "text/plain", "Method not allowed");
+    else if (notFound) notFound(req, res);
+    else res.send(404, "text/plain", "Not found");
+
+    if (!res.sent()) res.send(500, "text/plain", "Handler sent no response");
+}
+
+void HttpServer::upgrade(HttpConnection& c, HttpRequest& req, HttpWebSocketHandler* handler) {
+    HttpResponse res(c, false);
+    const char* key = req.header("Sec-WebSocket-Key");
+    if (!headerHasToken(req.header("Upgrade"), "websocket") || !headerHasToken(req.header("Connection"), "upgrade") ||
+        strcmp(req.header("Sec-WebSocket-Version"), "13") != 0 || strlen(key) > 40 || !*key) {
+        res.sendHeader("Sec-WebSocket-Version", "13");
+        res.send(426, "text/plain", "WebSocket upgrade required");
+        return;
+    }
+
+    size_t open = 0;
+    for (const HttpConnection& other : connections)
+        if (other.ws) ++open;
+    if (open >= HTTP_MAX_WEBSOCKETS) {
+        res.sendHeader("Retry-After", "5");
+        res.send(503, "text/plain", "Too many WebSocket clients");
+        return;
+    }
+    if (!handler->onUpgrade(req, res)) {
+        if (!res.sent()) res.send(403, "text/plain", "Forbidden");
+        return;
+    }
+
+    char input[40 + sizeof(HTTP_WS_GUID)];
+    snprintf(input, sizeof(input), "%s%s", key, HTTP_WS_GUID);
+    uint8_t digest[20];
+    sha1((const uint8_t*)input, strlen(input), digest);
+    char accept[32];
+    base64Encode(digest, sizeof(digest), accept);
+
+    c.txUsed += snprintf(c.tx + c.txUsed, HTTP_TX_BUFFER_SIZE - c.txUsed,
+                         "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                         "Connection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n", accept);
+    c.ws = handler;
+    c.wsLastReceiveMs = c.lastActivityMs;
+    if (!handler->onOpen(&c - connections, req)) wsClose(c, 1008);
+}
+
+// Handles the frame at the front of the receive buffer. False when no
+// complete frame is buffered yet.
+bool HttpServer::readFrame(HttpConnection& c) {
+    uint8_t* p = (uint8_t*)c.rx;
+    if (c.rxUsed < 2) return false;
+
+    bool fin = p[0] & 0x80;
+    uint8_t opcode = p[0] & 0x0f;
+    size_t length = p[1] & 0x7f;
+    size_t head = 2;
+    if (length == 126) {
+        if (c.rxUsed < 4) return false;
+        length = (size_t)p[2] << 8 | p[3];
+        head = 4;
+    }
+    if (!(p[1] & 0x80)) {               // clients must mask
+        wsClose(c, 1002);
+        return true;
+    }
+    if (length == 127 || head + 4 + length > HTTP_RX_BUFFER_SIZE) {
+        wsClose(c, 1009);
+        return true;
+    }
+    size_t frameLength = head + 4 + length;
+    if (c.rxUsed < frameLength) return false;
+
+    const uint8_t* mask = p + head;
+    uint8_t* data = p + head + 4;
+    for (size_t i = 0; i < length; ++i) data[i] ^= mask[i & 3];
+
+    int id = &c - connections;
+    if (!fin || opcode == 0) {
+        wsClose(c, 1003);   // messages are small; fragments are not worth a reassembly buffer
+        return true;
+    }
+    switch (opcode) {
+        case HTTP_WS_TEXT:
+        case HTTP_WS_BINARY:
+            c.ws->onMessage(id, (HttpWsOpcode)opcode, data, length);
+            break;
+        case HTTP_WS_PING:
+            wsSend(id, HTTP_WS_PONG, data, length);
+            break;
+        case HTTP_WS_PONG:
+            break;
+        case HTTP_WS_CLOSE:
+            wsClose(c, 1000);
+            return true;
+        default:
+            wsClose(c, 1002);
+            return true;
+    }
+
+    if (c.fd < 0) return true;
+    c.rxUsed -= frameLength;
+    memmove(c.rx, c.rx + frameLength, c.rxUsed);
+    return true;
+}
+
+// Queues a close frame; the socket closes once it is out
+void HttpServer::wsClose(HttpConnection& c, uint16_t status) {
+    uint8_t payload[2] = {(uint8_t)(status >> 8), (uint8_t)status};
+    wsSend(&c - connections, HTTP_WS_CLOSE, payload, sizeof(payload));
+    c.wsClosing = true;
+    c.rxUsed = 0;
+}
+
+bool HttpServer::wsSend(int id, HttpWsOpcode opcode, const void* data, size_t length) {
+    if (id < 0 || id >= HTTP_MAX_CONNECTIONS) return false;
+    HttpConnection& c = connections[id];
+    if (c.fd < 0 || !c.ws || c.wsClosing || length > wsSpace(id)) return false;
+
+    if (c.txSent) {
+        c.txUsed -= c.txSent;
+        memmove(c.tx, c.tx + c.txSent, c.txUsed);
+        c.txSent = 0;
+    }
+    uint8_t* out = (uint8_t*)c.tx + c.txUsed;
+    out[0] = 0x80 | opcode;
+    if (length < 126) {
+        out[1] = (uint8_t)length;
+        out += 2;
+    } else {
+        out[1] = 126;
+        out[2] = (uint8_t)(length >> 8);
+        out[3] = (uint8_t)length;
+        out += 4;
+    }
+    if (length) memcpy(out, data, length);
+    c.txUsed = (char*)out + length - c.tx;
+    return true;
+}
+
+size_t HttpServer::wsSpace(int id) const {
+    if (id < 0 || id >= HTTP_MAX_CONNECTIONS) return 0;
+    const HttpConnection& c = connections[id];
+    if (c.fd < 0 || !c.ws) return 0;
+    size_t free = HTTP_TX_BUFFER_SIZE - (c.txUsed - c.txSent);
+    if (free >= 126 + 4) return free - 4;      // extended length header
+    return free > 2 ? std::min(free - 2, (size_t)125) : 0;
+}
+
+// Protocol errors end the connection: what follows cannot be framed
+void HttpServer::sendError(HttpConnection& c, int code) {
+    c.keepAlive = false;
+    c.rxUsed = 0;
+    HttpResponse res(c, false);
+    res.send(code, "text/plain", statusText(code));
+}
+
+void HttpServer::closeConnection(HttpConnection& c) {
+    if (c.fd >= 0) ::close(c.fd);
+    c.fd = -1;
+    if (c.ws) {
+        HttpWebSocketHandler* handler = c.ws;
+        c.ws = nullptr;
+        handler->onClose(&c - connections);
+    }
+    c.rxUsed = c.txUsed = c.txSent = 0;
+    c.body.reset();
+    c.upload.reset();
+    c.uploadRemaining = 0;
+    c.complete = nullptr;   // cut off: not a response time
+}
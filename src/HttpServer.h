@@ -0,0 +1,291 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// Event-driven HTTP/1.1 server on BSD sockets: lwIP on the device, POSIX on
+// the host, so the same core can be load-tested on Linux (tools/http_load.py).
+// WebSocket upgrades (RFC 6455) share the port and the connection pool, up
+// to HTTP_MAX_WEBSOCKETS of it: browsers answer pings, so a WebSocket is
+// never idle enough to be closed for a new client.
+//
+// Every socket is non-blocking and poll() is the only place that waits. Each
+// connection gets a fixed receive and transmit buffer from one pool
+// allocated in begin(); nothing grows with the number of requests. Requests
+// are answered in order, so pipelined requests simply wait in the receive
+// buffer until the response before them has gone out. Large bodies are
+// pulled from an HttpBodySource whenever the socket can take more, so a slow
+// client holds its own buffers and nobody else's time.
+//
+//   server.on("/daily", [](HttpRequest& req, HttpResponse& res) {
+//       res.send(200, "text/plain", "hello");
+//   });
+//   server.begin(80);
+//   for (;;) server.poll();
+
+#define HTTP_MAX_CONNECTIONS       6
+#define HTTP_MAX_WEBSOCKETS        (HTTP_MAX_CONNECTIONS - 2)   // the rest stay free for plain requests
+#define HTTP_RX_BUFFER_SIZE        1536    // request line, headers and form body
+#define HTTP_TX_BUFFER_SIZE        2048    // response head plus one body slice
+#define HTTP_MAX_ROUTES            40
+#define HTTP_MAX_HEADERS           16
+#define HTTP_MAX_ARGS              12
+#define HTTP_RESPONSE_HEADERS_MAX  256     // bytes of sendHeader() lines per response
+#define HTTP_IDLE_TIMEOUT_MS       15000   // keep-alive connection without a request
+#define HTTP_REQUEST_TIMEOUT_MS    5000    // partial request, or a client that stopped reading
+#define HTTP_WS_PING_MS            20000   // quiet WebSocket gets a ping; closed after twice this
+#define HTTP_UPLOAD_BURST          32768   // upload bytes read per connection per poll()
+
+#define HTTP_LENGTH_CHUNKED ((size_t)-1)
+
+static_assert(HTTP_TX_BUFFER_SIZE <= 0xffff, "chunk sizes are written as four hex digits");
+
+enum HttpMethod : uint8_t {
+    HTTP_METHOD_GET   = 1,
+    HTTP_METHOD_HEAD  = 2,
+    HTTP_METHOD_POST  = 4,
+    HTTP_METHOD_OTHER = 8,
+};
+
+enum HttpWsOpcode : uint8_t {
+    HTTP_WS_TEXT   = 0x1,
+    HTTP_WS_BINARY = 0x2,
+    HTTP_WS_CLOSE  = 0x8,
+    HTTP_WS_PING   = 0x9,
+    HTTP_WS_PONG   = 0xa,
+};
+
+// Response body produced on demand, a buffer-full at a time
+class HttpBodySource {
+public:
+    virtual ~HttpBodySource() = default;
+
+    // Copies up to cap bytes of the body into out; 0 means the body is complete
+    virtual size_t read(char* out, size_t cap) = 0;
+};
+
+class HttpResponse;
+
+// Request body taken as it arrives, for uploads larger than the receive
+// buffer (see HttpServer::onUpload)
+class HttpBodySink {
+public:
+    virtual ~HttpBodySink() = default;
+
+    // Next slice of the body, as much as the receive buffer held; false
+    // refuses the rest, which is then read and dropped
+    virtual bool write(const char* data, size_t len) = 0;
+
+    // Once, after the last slice or a refusal: answers the request
+    virtual void finish(HttpResponse& res) = 0;
+};
+
+// Body that already sits in memory for the life of the program (flash assets)
+class HttpStaticBody : public HttpBodySource {
+public:
+    HttpStaticBody(const uint8_t* data, size_t length) : data(data), remaining(length) {}
+    size_t read(char* out, size_t cap) override;
+
+private:
+    const uint8_t* data;
+    size_t         remaining;
+};
+
+// Parsed in place in the connection's receive buffer: every pointer is only
+// valid until the handler returns
+class HttpRequest {
+public:
+    HttpMethod  method() const { return requestMethod; }
+    const char* path() const { return requestPath; }
+
+    // Query string and urlencoded form body; "" when absent
+    bool        hasArg(const char* name) const;
+    const char* arg(const char* name) const;
+
+    // Case-insensitive name; "" when absent
+    const char* header(const char* name) const;
+
+    // On upload routes body() is "" and bodyLength() the announced length
+    const char* body() const { return requestBody; }
+    size_t      bodyLength() const { return requestBodyLength; }
+
+    // HTTP Basic credentials
+    bool authenticate(const char* user, const char* password) const;
+
+private:
+    friend class HttpServer;
+
+    struct Field {
+        const char* name;
+        const char* value;
+    };
+
+    void addArgs(char* text, size_t length);
+
+    HttpMethod  requestMethod = HTTP_METHOD_GET;
+    const char* requestPath = "";
+    const char* requestBody = "";
+    size_t      requestBodyLength = 0;
+    Field       args[HTTP_MAX_ARGS];
+    Field       headers[HTTP_MAX_HEADERS];
+    uint8_t     argCount = 0;
+    uint8_t     headerCount = 0;
+};
+
+// Events of the WebSockets upgraded on one path. A connection's id is its
+// slot, 0 .. HTTP_MAX_CONNECTIONS - 1, and is reused after onClose().
+class HttpWebSocketHandler {
+public:
+    virtual ~HttpWebSocketHandler() = default;
+
+    // Before the 101: returning false refuses the upgrade with the response
+    // sent on res, 403 if none was
+    virtual bool onUpgrade(HttpRequest& req, HttpResponse& res) { return true; }
+
+    // After the 101 is queued; returning false closes the socket again (1008)
+    virtual bool onOpen(int id, HttpRequest& req) { return true; }
+
+    // One complete text or binary message; fragmented messages are refused
+    virtual void onMessage(int id, HttpWsOpcode opcode, const uint8_t* data, size_t length) = 0;
+
+    virtual void onClose(int id) {}
+};
+
+struct HttpConnection {
+    int      fd = -1;
+    char*    rx = nullptr;     // slices of the server's pool
+    char*    tx = nullptr;
+    size_t   rxUsed = 0;
+    size_t   txUsed = 0;
+    size_t   txSent = 0;
+    std::unique_ptr<HttpBodySource> body;
+    size_t   bodyRemaining = 0;    // for bodies with a Content-Length
+    std::function<void()> complete;        // see HttpResponse::onComplete()
+    std::unique_ptr<HttpBodySink> upload;
+    size_t   uploadRemaining = 0;  // request body still to come; dropped without a sink
+    bool     chunked = false;
+    bool     keepAlive = true;     // applies once the current response is out
+    bool     peerClosed = false;
+    bool     continueSent = false;
+    bool     answered = false;     // a request came in: idle from now on means keep-alive
+    uint32_t lastActivityMs = 0;
+    HttpWebSocketHandler* ws = nullptr;   // set once upgraded
+    bool     wsClosing = false;            // close frame queued
+    bool     wsPingSent = false;
+    uint32_t wsLastReceiveMs = 0;
+};
+
+// Writes straight into the connection's transmit buffer. Call sendHeader()
+// first, then exactly one of the send functions.
+class HttpResponse {
+public:
+    void sendHeader(const char* name, const char* value);
+
+    // Copies the body; it may be a temporary
+    void send(int code, const char* contentType = nullptr, const char* body = "");
+    void send(int code, const char* contentType, const char* body, size_t length);
+
+    // Body that outlives the response (flash data); not copied
+    void sendStatic(int code, const char* contentType, const uint8_t* body, size_t length);
+
+    // Body pulled from source as the client reads; chunked unless length is known
+    void sendBody(int code, const char* contentType, std::unique_ptr<HttpBodySource> source,
+                  size_t length = HTTP_LENGTH_CHUNKED);
+
+    // Called once the whole response, streamed body included, has gone to
+    // the socket; not called if the connection drops first
+    void onComplete(std::function<void()> fn);
+
+    // 401 with a Basic challenge
+    void requestAuthentication(const char* realm = "Login Required");
+
+    bool sent() const { return done; }
+
+private:
+    friend class HttpServer;
+
+    HttpResponse(HttpConnection& conn, bool headOnly) : conn(conn), headOnly(headOnly) {}
+    bool writeHead(int code, const char* contentType, size_t length);
+
+    HttpConnection& conn;
+    bool            headOnly;
+    bool            done = false;
+    char            extra[HTTP_RESPONSE_HEADERS_MAX];
+    size_t          extraUsed = 0;
+};
+
+class HttpServer {
+public:
+    using Handler = std::function<void(HttpRequest&, HttpResponse&)>;
+    // Sees the request head; returns the sink for the body, or answers
+    // itself and returns nullptr to turn the body down
+    using UploadHandler = std::function<std::unique_ptr<HttpBodySink>(HttpRequest&, HttpResponse&)>;
+
+    ~HttpServer();
+
+    // Listens on port (plus SCALE_PORT_OFFSET on the host) and allocates the
+    // connection buffers; false if either fails
+    bool begin(uint16_t port);
+    void end();
+
+    // path must stay valid while the server runs (a literal or a static table)
+    void on(const char* path, Handler handler, uint8_t methods = HTTP_METHOD_GET | HTTP_METHOD_HEAD);
+    void onNotFound(Handler handler) { notFound = std::move(handler); }
+
+    // Routes whose body is streamed into a sink instead of buffered, so it
+    // can be any size. A 100-continue is only sent once a sink took it.
+    void onUpload(const char* path, UploadHandler handler, uint8_t methods = HTTP_METHOD_POST);
+
+    // Upgrades GET requests for path to WebSockets served by handler
+    void onWebSocket(const char* path, HttpWebSocketHandler* handler);
+
+    // Queues one unfragmented message for WebSocket id. False when the
+    // connection is gone or closing, or its transmit buffer lacks the room;
+    // nothing is queued then. Goes out on the next poll().
+    bool   wsSend(int id, HttpWsOpcode opcode, const void* data, size_t length);
+
+    // Largest payload wsSend() would take for id right now
+    size_t wsSpace(int id) const;
+
+    // Accepts, reads, answers and writes whatever is ready, waiting up to
+    // timeoutMs for the first socket to become ready
+    void poll(int timeoutMs = 0);
+
+    size_t   connectionCount() const;
+    uint32_t requestCount() const { return requests; }
+
+private:
+    struct Route {
+        const char*           path;
+        uint8_t               methods;
+        Handler               handler;
+        HttpWebSocketHandler* ws;
+        UploadHandler         upload;
+    };
+
+    void acceptConnections(uint32_t now);
+    HttpConnection* idleConnection();
+    void receive(HttpConnection& c, uint32_t now);
+    void service(HttpConnection& c, uint32_t now);
+    bool sendPending(HttpConnection& c, uint32_t now);
+    void fillBody(HttpConnection& c);
+    bool receiveUpload(HttpConnection& c);
+    void finishUpload(HttpConnection& c);
+    bool isUploadPath(const char* target) const;
+    bool dispatchNext(HttpConnection& c);
+    void dispatch(HttpConnection& c, HttpRequest& req);
+    void upgrade(HttpConnection& c, HttpRequest& req, HttpWebSocketHandler* handler);
+    bool readFrame(HttpConnection& c);
+    void wsClose(HttpConnection& c, uint16_t status);
+    void sendError(HttpConnection& c, int code);
+    void closeConnection(HttpConnection& c);
+
+    Route          routes[HTTP_MAX_ROUTES];
+    size_t         routeCount = 0;
+    Handler        notFound;
+    HttpConnection connections[HTTP_MAX_CONNECTIONS];
+    char*          pool = nullptr;
+    int            listenFd = -1;
+    uint32_t       requests = 0;
+};
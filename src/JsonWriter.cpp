@@ -0,0 +1,149 @@
+#include "JsonWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity, FlushFn flushFn, void* ctx)
+    : buffer(buffer), capacity(capacity), flushFn(flushFn), ctx(ctx) {}
+
+void JsonWriter::flush() {
+    if (used == 0) return;
+    flushFn(ctx, buffer, used);
+    total += used;
+    used = 0;
+}
+
+void JsonWriter::put(char c) {
+    if (used == capacity) flush();
+    buffer[used++] = c;
+}
+
+void JsonWriter::write(const char* data, size_t len) {
+    while (len) {
+        if (used == capacity) flush();
+        size_t n = capacity - used < len ? capacity - used : len;
+        memcpy(buffer + used, data, n);
+        used += n;
+        data += n;
+        len -= n;
+    }
+}
+
+// Comma before every item but the first in a container; none after a key
+void JsonWriter::separator() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (depth == 0) return;
+    uint32_t bit = 1u << (depth - 1);
+    if (hasItems & bit) put(',');
+    hasItems |= bit;
+}
+
+void JsonWriter::open(char c) {
+    separator();
+    put(c);
+    if (depth < MAX_DEPTH) depth++;
+    hasItems &= ~(1u << (depth - 1));
+}
+
+void JsonWriter::close(char c) {
+    if (depth) depth--;
+    put(c);
+}
+
+JsonWriter& JsonWriter::beginObject() { open('{'); return *this; }
+JsonWriter& JsonWriter::endObject()   { close('}'); return *this; }
+JsonWriter& JsonWriter::beginArray()  { open('['); return *this; }
+JsonWriter& JsonWriter::endArray()    { close(']'); return *this; }
+
+JsonWriter& JsonWriter::key(const char* name) {
+    value(name);
+    put(':');
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* str) {
+    if (!str) return null();
+    separator();
+    put('"');
+
+    const char* run = str;
+    for (const char* p = str; *p; ++p) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        write(run, p - run);
+        run = p + 1;
+        switch (c) {
+            case '"':  write("\\\"", 2); break;
+            case '\\': write("\\\\", 2); break;
+            case '\n': write("\\n", 2); break;
+            case '\r': write("\\r", 2); break;
+            case '\t': write("\\t", 2); break;
+            default: {
+                char esc[7];
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                write(esc, 6);
+            }
+        }
+    }
+    write(run, strlen(run));
+    put('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number, uint8_t decimals) {
+    if (!std::isfinite(number)) return null();
+    separator();
+
+    char tmp[32];
+    int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals, number);
+    if (n < 0) n = 0;
+    if (n >= (int)sizeof(tmp)) n = sizeof(tmp) - 1;
+
+    // "12.50" -> "12.5", "3.00" -> "3"
+    if (memchr(tmp, '.', n)) {
+        while (n > 0 && tmp[n - 1] == '0') n--;
+        if (n > 0 && tmp[n - 1] == '.') n--;
+    }
+    write(tmp, n);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(float number, uint8_t decimals) {
+    return value((double)number, decimals);
+}
+
+JsonWriter& JsonWriter::value(int32_t number) {
+    return value((int64_t)number);
+}
+
+JsonWriter& JsonWriter::value(int64_t number) {
+    separator();
+    char tmp[24];
+    int n = snprintf(tmp, sizeof(tmp), "%lld", (long long)number);
+    write(tmp, n);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separator();
+    if (flag) write("true", 4);
+    else      write("false", 5);
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separator();
+    write("null", 4);
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(const char* json, size_t len) {
+    separator();
+    write(json, len);
+    return *this;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Minimal streaming JSON writer. Output goes into a caller-provided buffer
+// and is handed to the flush callback whenever it fills up, so memory use is
+// the buffer size no matter how large the document gets. Nothing allocates.
+//
+//   JsonWriter json(buf, sizeof(buf), sendChunk, &server);
+//   json.beginObject().key("calories").value(123.4f).endObject();
+//   json.flush();
+class JsonWriter {
+public:
+    using FlushFn = void (*)(void* ctx, const char* data, size_t len);
+
+    JsonWriter(char* buffer, size_t capacity, FlushFn flushFn, void* ctx);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(const char* name);
+
+    JsonWriter& value(const char* str);   // escaped; nullptr writes null
+    JsonWriter& value(float number, uint8_t decimals = 2);
+    JsonWriter& value(double number, uint8_t decimals = 2);
+    JsonWriter& value(int32_t number);
+    JsonWriter& value(int64_t number);
+    JsonWriter& value(bool flag);
+    JsonWriter& null();
+
+    // Raw, already valid JSON (e.g. a cached fragment)
+    JsonWriter& raw(const char* json, size_t len);
+
+    void flush();
+    size_t bytesWritten() const { return total + used; }
+
+    static constexpr uint8_t MAX_DEPTH = 32;
+
+private:
+    void separator();
+    void open(char c);
+    void close(char c);
+    void put(char c);
+    void write(const char* data, size_t len);
+
+    char*    buffer;
+    size_t   capacity;
+    size_t   used = 0;
+    size_t   total = 0;
+    FlushFn  flushFn;
+    void*    ctx;
+    uint32_t hasItems = 0;   // bit per nesting level: an item was written
+    uint8_t  depth = 0;
+    bool     afterKey = false;
+};
@@ -0,0 +1,231 @@
+#include "LogExport.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+LogExportWriter::LogExportWriter(ExportFormat format, char* buffer, size_t capacity, FlushFn flushFn, void* ctx)
+    : format(format), buffer(buffer), capacity(capacity), flushFn(flushFn), ctx(ctx),
+      json(buffer, capacity, flushFn, ctx) {}
+
+bool LogExportWriter::parseFormat(const char* name, ExportFormat& out) {
+    if (strcmp(name, "csv") == 0) out = EXPORT_CSV;
+    else if (strcmp(name, "ndjson") == 0) out = EXPORT_NDJSON;
+    else if (strcmp(name, "bin") == 0) out = EXPORT_BINARY;
+    else return false;
+    return true;
+}
+
+const char* LogExportWriter::contentType(ExportFormat format) {
+    switch (format) {
+        case EXPORT_CSV:    return "text/csv";
+        case EXPORT_NDJSON: return "application/x-ndjson";
+        default:            return "application/octet-stream";
+    }
+}
+
+void LogExportWriter::begin() {
+    if (format == EXPORT_CSV) {
+        text("log_id,time,ts,food_id,food,grams,calories,protein,carbs,fat\n");
+    } else if (format == EXPORT_BINARY) {
+        text(EXPORT_BINARY_MAGIC);
+        put(EXPORT_BINARY_VERSION);
+    }
+}
+
+void LogExportWriter::row(const LogExportRow& row) {
+    if (format == EXPORT_NDJSON) {
+        json.beginObject();
+        json.key("log_id").value(row.logId);
+        json.key("time").value(row.timestamp);
+        json.key("ts");
+        if (row.ts) json.value(row.ts);
+        else        json.null();
+        json.key("food_id").value(row.foodId);
+        json.key("food").value(row.food);
+        json.key("grams").value(row.grams, 1);
+        json.key("calories").value(row.calories);
+        json.key("protein").value(row.protein);
+        json.key("carbs").value(row.carbs);
+        json.key("fat").value(row.fat);
+        json.endObject();
+        json.raw("\n", 1);
+        return;
+    }
+
+    if (format == EXPORT_CSV) {
+        char tmp[24];
+        write(tmp, snprintf(tmp, sizeof(tmp), "%lld,", (long long)row.logId));
+        csvField(row.timestamp);
+        put(',');
+        if (row.ts) write(tmp, snprintf(tmp, sizeof(tmp), "%lld", (long long)row.ts));
+        write(tmp, snprintf(tmp, sizeof(tmp), ",%ld,", (long)row.foodId));
+        csvField(row.food);
+        put(',');
+        fixed(row.grams, 1);
+        put(',');
+        fixed(row.calories, 2);
+        put(',');
+        fixed(row.protein, 2);
+        put(',');
+        fixed(row.carbs, 2);
+        put(',');
+        fixed(row.fat, 2);
+        put('\n');
+        return;
+    }
+
+    // Binary: look the food up in this block's names, adding it if new
+    const char* food = row.food ? row.food : "";
+    size_t name = 0;
+    while (name < nameCount && nameIds[name] != row.foodId) ++name;
+    if (name == nameCount) {
+        size_t len = strlen(food);
+        if (len > EXPORT_NAME_POOL - 1) len = EXPORT_NAME_POOL - 1;
+        if (poolUsed + len + 1 > EXPORT_NAME_POOL) {
+            writeBlock();
+            name = 0;
+        }
+        nameIds[name] = row.foodId;
+        nameOffsets[name] = (uint16_t)poolUsed;
+        memcpy(namePool + poolUsed, food, len);
+        namePool[poolUsed + len] = '\0';
+        poolUsed += len + 1;
+        nameCount++;
+    }
+
+    BlockRow& r = blockRows[blockCount++];
+    r.logId = row.logId;
+    r.ts = row.ts;
+    r.name = (uint8_t)name;
+    const float values[5] = {row.grams, row.calories, row.protein, row.carbs, row.fat};
+    for (int i = 0; i < 5; ++i) r.values[i] = std::isfinite(values[i]) ? (int32_t)lroundf(values[i] * 100) : 0;
+    if (blockCount == EXPORT_BLOCK_ROWS) writeBlock();
+}
+
+void LogExportWriter::end() {
+    if (format == EXPORT_BINARY) {
+        writeBlock();
+        varint(0);
+    }
+    flush();
+}
+
+void LogExportWriter::flush() {
+    if (format == EXPORT_NDJSON) {
+        json.flush();
+        return;
+    }
+    if (format == EXPORT_BINARY) writeBlock();
+    if (used) flushFn(ctx, buffer, used);
+    total += used;
+    used = 0;
+}
+
+// Column by column, so each column's varints sit together
+void LogExportWriter::writeBlock() {
+    if (blockCount == 0) return;
+
+    varint(blockCount);
+    varint(nameCount);
+    for (size_t i = 0; i < nameCount; ++i) {
+        const char* name = namePool + nameOffsets[i];
+        size_t len = strlen(name);
+        varint((uint32_t)nameIds[i]);
+        varint(len);
+        write(name, len);
+    }
+    for (size_t i = 0; i < blockCount; ++i) {
+        zigzag(blockRows[i].logId - lastLogId);
+        lastLogId = blockRows[i].logId;
+    }
+    for (size_t i = 0; i < blockCount; ++i) {
+        zigzag(blockRows[i].ts - lastTs);
+        lastTs = blockRows[i].ts;
+    }
+    for (size_t i = 0; i < blockCount; ++i) varint(blockRows[i].name);
+    for (int v = 0; v < 5; ++v) {
+        for (size_t i = 0; i < blockCount; ++i) zigzag(blockRows[i].values[v]);
+    }
+
+    blockCount = 0;
+    nameCount = 0;
+    poolUsed = 0;
+}
+
+void LogExportWriter::put(char c) {
+    if (used == capacity) {
+        flushFn(ctx, buffer, used);
+        total += used;
+        used = 0;
+    }
+    buffer[used++] = c;
+}
+
+void LogExportWriter::write(const char* data, size_t len) {
+    while (len) {
+        if (used == capacity) {
+            flushFn(ctx, buffer, used);
+            total += used;
+            used = 0;
+        }
+        size_t n = len < capacity - used ? len : capacity - used;
+        memcpy(buffer + used, data, n);
+        used += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void LogExportWriter::text(const char* str) {
+    write(str, strlen(str));
+}
+
+// Fixed-point without printf: this runs for every number of a million-row
+// export
+void LogExportWriter::fixed(float value, uint8_t decimals) {
+    if (!std::isfinite(value)) value = 0;
+    int64_t scale = 1;
+    for (uint8_t i = 0; i < decimals; ++i) scale *= 10;
+    int64_t n = llroundf(value * scale);
+    if (n < 0) {
+        put('-');
+        n = -n;
+    }
+
+    char tmp[24];
+    char* p = tmp + sizeof(tmp);
+    int64_t whole = n / scale, frac = n % scale;
+    for (uint8_t i = 0; i < decimals; ++i) {
+        *--p = (char)('0' + frac % 10);
+        frac /= 10;
+    }
+    if (decimals) *--p = '.';
+    do {
+        *--p = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole);
+    write(p, tmp + sizeof(tmp) - p);
+}
+
+// Quoted only when it has to be, with quotes doubled
+void LogExportWriter::csvField(const char* str) {
+    if (!str) return;
+    if (!strpbrk(str, ",\"\r\n")) {
+        text(str);
+        return;
+    }
+    put('"');
+    for (const char* p = str; *p; ++p) {
+        if (*p == '"') put('"');
+        put(*p);
+    }
+    put('"');
+}
+
+void LogExportWriter::varint(uint64_t value) {
+    while (value >= 0x80) {
+        put((char)(value | 0x80));
+        value >>= 7;
+    }
+    put((char)value);
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "JsonWriter.h"
+
+// Encoder for /export: food log rows in, CSV, NDJSON or a compact columnar
+// binary out. Like JsonWriter it writes into a caller-provided buffer and
+// hands it to the flush callback when full, so memory is fixed however many
+// rows go through. No Arduino dependencies.
+//
+//   LogExportWriter out(EXPORT_CSV, buf, sizeof(buf), sendChunk, ctx);
+//   out.begin();
+//   out.row(row); ...
+//   out.end();
+//
+// Binary layout (all integers little-endian base-128 varints, "zz" ones
+// zigzag-encoded; tools/export_decode.py turns it back into CSV):
+//
+//   "SCLG" version(=1)
+//   block*: rows, names, {food_id, length, bytes} * names,
+//           then column by column for the block's rows:
+//           zz log_id delta, zz ts delta (ts 0 = clock not synced),
+//           name index, zz grams, calories, protein, carbs, fat in hundredths
+//   rows = 0 ends the stream
+//
+// The log_id and ts deltas start from 0 at the head of the stream and run
+// on across blocks, so decoding has to start there. The food names are
+// the only per-block state: each block lists the ones it uses at its start.
+
+#define EXPORT_BLOCK_ROWS   64     // rows per binary block
+#define EXPORT_NAME_POOL    2048   // bytes of food names per binary block
+#define EXPORT_BINARY_MAGIC "SCLG"
+#define EXPORT_BINARY_VERSION 1
+
+enum ExportFormat : uint8_t {
+    EXPORT_CSV,
+    EXPORT_NDJSON,
+    EXPORT_BINARY,
+};
+
+// One LogEntry with its food; the strings only need to live until row()
+// returns
+struct LogExportRow {
+    int64_t     logId;
+    int64_t     ts;          // 0 when logged before the clock synced
+    const char* timestamp;   // as logged: "YYYY-MM-DD HH:MM:SS" local, or "offline"
+    int32_t     foodId;
+    const char* food;
+    float       grams;
+    float       calories;
+    float       protein;
+    float       carbs;
+    float       fat;
+};
+
+class LogExportWriter {
+public:
+    using FlushFn = JsonWriter::FlushFn;
+
+    LogExportWriter(ExportFormat format, char* buffer, size_t capacity, FlushFn flushFn, void* ctx);
+
+    // "csv", "ndjson" or "bin"; false for anything else
+    static bool parseFormat(const char* name, ExportFormat& out);
+    static const char* contentType(ExportFormat format);
+
+    void begin();                       // CSV header line, binary magic
+    void row(const LogExportRow& row);
+    void end();                         // binary end marker; flushes
+
+    // Hands buffered output to the callback. Closes the binary block, so
+    // flushing once per page makes a page one block.
+    void flush();
+    uint64_t bytesWritten() const { return format == EXPORT_NDJSON ? json.bytesWritten() : total + used; }
+
+private:
+    void put(char c);
+    void write(const char* data, size_t len);
+    void text(const char* str);
+    void fixed(float value, uint8_t decimals);
+    void csvField(const char* str);
+    void varint(uint64_t value);
+    void zigzag(int64_t value) { varint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63)); }
+    void writeBlock();
+
+    ExportFormat format;
+    char*        buffer;
+    size_t       capacity;
+    size_t       used = 0;
+    uint64_t     total = 0;
+    FlushFn      flushFn;
+    void*        ctx;
+    JsonWriter   json;   // NDJSON only; shares the buffer
+
+    // Binary block being collected
+    struct BlockRow {
+        int64_t  logId;
+        int64_t  ts;
+        int32_t  values[5];   // grams, calories, protein, carbs, fat in hundredths
+        uint8_t  name;
+    };
+    BlockRow blockRows[EXPORT_BLOCK_ROWS];
+    int32_t  nameIds[EXPORT_BLOCK_ROWS];
+    uint16_t nameOffsets[EXPORT_BLOCK_ROWS];
+    char     namePool[EXPORT_NAME_POOL];
+    size_t   blockCount = 0;
+    size_t   nameCount = 0;
+    size_t   poolUsed = 0;
+    int64_t  lastLogId = 0;
+    int64_t  lastTs = 0;
+};
@@ -0,0 +1,47 @@
+// Only built with the LVGL backend (env:lvgl) or the host harness
+#ifdef DISPLAY_BACKEND_LVGL
+
+#include "LvglScreen.h"
+
+// 320x170 landscape: weight and the current food on the left, daily totals
+// on the right, network status along the bottom
+struct LvglFieldLayout {
+    lv_coord_t      x;
+    lv_coord_t      y;
+    const lv_font_t* font;
+};
+
+static const LvglFieldLayout lvglLayouts[FIELD_COUNT] = {
+    {0,   0,   &lv_font_montserrat_14},   // FIELD_TITLE
+    {0,   20,  &lv_font_montserrat_28},   // FIELD_WEIGHT
+    {0,   60,  &lv_font_montserrat_14},   // FIELD_FOOD
+    {0,   80,  &lv_font_montserrat_14},   // FIELD_FOOD_MACROS1
+    {0,   100, &lv_font_montserrat_14},   // FIELD_FOOD_MACROS2
+    {170, 60,  &lv_font_montserrat_14},   // FIELD_TOTALS_TITLE
+    {170, 80,  &lv_font_montserrat_14},   // FIELD_TOTALS1
+    {170, 100, &lv_font_montserrat_14},   // FIELD_TOTALS2
+    {0,   132, &lv_font_montserrat_14},   // FIELD_MODE
+    {0,   150, &lv_font_montserrat_14},   // FIELD_IP
+};
+
+void LvglScreen::create(lv_obj_t* parent) {
+    lv_obj_set_style_bg_color(parent, lv_color_black(), 0);
+    lv_obj_clear_flag(parent, LV_OBJ_FLAG_SCROLLABLE);
+
+    for (uint8_t f = 0; f < FIELD_COUNT; ++f) {
+        lv_obj_t* label = lv_label_create(parent);
+        lv_obj_set_pos(label, lvglLayouts[f].x, lvglLayouts[f].y);
+        lv_obj_set_style_text_font(label, lvglLayouts[f].font, 0);
+        lv_obj_set_style_text_color(label, lv_palette_main(LV_PALETTE_GREEN), 0);
+        lv_label_set_text_static(label, "");
+        labels[f] = label;
+    }
+}
+
+void LvglScreen::render(ScreenModel& model) {
+    model.render([this](ScreenField field, const Rectangle&, const char* text, const ScreenFieldLayout&) {
+        lv_label_set_text(labels[field], text);
+    });
+}
+
+#endif
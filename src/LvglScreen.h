@@ -0,0 +1,15 @@
+#pragma once
+#include "lvgl.h"
+#include "ScreenModel.h"
+
+// LVGL view of the ScreenModel: one label per field. Only fields the model
+// reports as dirty get lv_label_set_text(), so LVGL invalidates just those
+// labels. No Arduino dependencies; the host harness drives the same code.
+class LvglScreen {
+public:
+    void create(lv_obj_t* parent);
+    void render(ScreenModel& model);
+
+private:
+    lv_obj_t* labels[FIELD_COUNT] = {};
+};
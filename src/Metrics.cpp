@@ -0,0 +1,230 @@
+#include "Metrics.h"
+#include <Arduino.h>
+#include <cstdarg>
+#include <cstring>
+
+const uint32_t MetricHistogram::bounds[METRICS_BUCKETS] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000
+};
+
+// Same bounds as exported `le` labels, in seconds
+static const char* const boundLabels[METRICS_BUCKETS] = {
+    "0.00005", "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01",
+    "0.025", "0.05", "0.1", "0.25", "0.5", "1", "2.5"
+};
+
+struct FamilyInfo {
+    const char* name;
+    const char* type;
+    const char* help;
+};
+
+static const FamilyInfo families[METRIC_FAMILY_COUNT] = {
+    {"scale_http_request_duration_seconds", "histogram", "Time spent in an HTTP route handler."},
+    {"scale_task_cycle_seconds", "histogram", "Busy time of one pass of a task loop, not counting the wait for work."},
+    {"scale_sqlite_statement_seconds", "histogram", "Time spent stepping a cached SQLite statement, per use."},
+    {"scale_sd_write_seconds", "histogram", "Duration of writes that reach the SD card."},
+    {"scale_queue_depth", "gauge", "Items waiting in a queue."},
+    {"scale_heap_free_bytes", "gauge", "Free heap."},
+    {"scale_heap_min_free_bytes", "gauge", "Lowest free heap since boot."},
+    {"scale_heap_largest_free_block_bytes", "gauge", "Largest block that can be allocated."},
+    {"scale_uptime_seconds", "gauge", "Time since boot."},
+};
+
+struct HistogramSlot {
+    MetricFamily    family;
+    char            labels[METRICS_LABELS_MAX];
+    MetricHistogram histogram;
+};
+
+struct GaugeSlot {
+    MetricFamily  family;
+    char          labels[METRICS_LABELS_MAX];
+    MetricGaugeFn read;
+    void*         ctx;
+};
+
+// Slots are filled under the lock and published by bumping the count, so a
+// scrape only ever sees complete entries. Recording never takes the lock.
+static HistogramSlot         histograms[METRICS_MAX_HISTOGRAMS];
+static GaugeSlot             gauges[METRICS_MAX_GAUGES];
+static std::atomic<uint32_t> histogramCount{0};
+static std::atomic<uint32_t> gaugeCount{0};
+static MetricHistogram       overflow;
+static portMUX_TYPE          registerLock = portMUX_INITIALIZER_UNLOCKED;
+
+void MetricHistogram::observe(uint32_t us) {
+    size_t i = 0;
+    while (i < METRICS_BUCKETS && us > bounds[i]) ++i;
+    buckets[i].fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t before = sumLow.fetch_add(us, std::memory_order_relaxed);
+    if (before > UINT32_MAX - us) sumHigh.fetch_add(1, std::memory_order_relaxed);
+}
+
+// label="value", with the value escaped as the text format wants
+static void formatLabels(char* out, const char* label, const char* value) {
+    out[0] = '\0';
+    if (!label || !value) return;
+
+    size_t n = snprintf(out, METRICS_LABELS_MAX, "%s=\"", label);
+    for (const char* p = value; *p && n + 4 < METRICS_LABELS_MAX; ++p) {
+        if (*p == '"' || *p == '\\') out[n++] = '\\';
+        if (*p == '\n') {
+            out[n++] = '\\';
+            out[n++] = 'n';
+        } else {
+            out[n++] = *p;
+        }
+    }
+    out[n++] = '"';
+    out[n] = '\0';
+}
+
+MetricHistogram& metrics_histogram(MetricFamily family, const char* label, const char* value) {
+    char labels[METRICS_LABELS_MAX];
+    formatLabels(labels, label, value);
+
+    MetricHistogram* result = &overflow;
+    portENTER_CRITICAL(&registerLock);
+    uint32_t n = histogramCount.load(std::memory_order_relaxed);
+    bool found = false;
+    for (uint32_t i = 0; i < n && !found; ++i) {
+        if (histograms[i].family == family && strcmp(histograms[i].labels, labels) == 0) {
+            result = &histograms[i].histogram;
+            found = true;
+        }
+    }
+    if (!found && n < METRICS_MAX_HISTOGRAMS) {
+        histograms[n].family = family;
+        strlcpy(histograms[n].labels, labels, sizeof(histograms[n].labels));
+        result = &histograms[n].histogram;
+        histogramCount.store(n + 1, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&registerLock);
+    return *result;
+}
+
+void metrics_gauge(MetricFamily family, const char* label, const char* value, MetricGaugeFn read, void* ctx) {
+    portENTER_CRITICAL(&registerLock);
+    uint32_t n = gaugeCount.load(std::memory_order_relaxed);
+    if (n < METRICS_MAX_GAUGES) {
+        gauges[n].family = family;
+        formatLabels(gauges[n].labels, label, value);
+        gauges[n].read = read;
+        gauges[n].ctx = ctx;
+        gaugeCount.store(n + 1, std::memory_order_release);
+    }
+    portEXIT_CRITICAL(&registerLock);
+}
+
+void metrics_begin() {
+    metrics_gauge(METRIC_HEAP_FREE, "pool", "internal", [](void*) -> uint32_t { return ESP.getFreeHeap(); });
+    metrics_gauge(METRIC_HEAP_MIN_FREE, "pool", "internal", [](void*) -> uint32_t { return ESP.getMinFreeHeap(); });
+    metrics_gauge(METRIC_HEAP_LARGEST, "pool", "internal", [](void*) -> uint32_t { return ESP.getMaxAllocHeap(); });
+    metrics_gauge(METRIC_HEAP_FREE, "pool", "psram", [](void*) -> uint32_t { return ESP.getFreePsram(); });
+    metrics_gauge(METRIC_HEAP_MIN_FREE, "pool", "psram", [](void*) -> uint32_t { return ESP.getMinFreePsram(); });
+    metrics_gauge(METRIC_HEAP_LARGEST, "pool", "psram", [](void*) -> uint32_t { return ESP.getMaxAllocPsram(); });
+    metrics_gauge(METRIC_UPTIME, nullptr, nullptr, [](void*) -> uint32_t { return millis() / 1000; });
+}
+
+// Fixed-size text buffer in front of the sink
+class MetricsText {
+public:
+    MetricsText(void (*sink)(void*, const char*, size_t), void* ctx) : sink(sink), ctx(ctx) {}
+    ~MetricsText() { flush(); }
+
+    void printf(const char* format, ...) {
+        char line[160];
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        if (n <= 0) return;
+        size_t len = (size_t)n < sizeof(line) ? n : sizeof(line) - 1;
+
+        if (used + len > sizeof(buffer)) flush();
+        memcpy(buffer + used, line, len);
+        used += len;
+    }
+
+    void flush() {
+        if (used) sink(ctx, buffer, used);
+        used = 0;
+    }
+
+private:
+    void (*sink)(void*, const char*, size_t);
+    void* ctx;
+    char buffer[512];
+    size_t used = 0;
+};
+
+// "{labels}", or nothing for an unlabelled series
+struct BracedLabels {
+    char text[METRICS_LABELS_MAX + 2];
+};
+
+static BracedLabels braced(const char* labels) {
+    BracedLabels out;
+    if (labels[0]) snprintf(out.text, sizeof(out.text), "{%s}", labels);
+    else out.text[0] = '\0';
+    return out;
+}
+
+size_t metrics_write(void (*sink)(void* ctx, const char* data, size_t len), void* ctx,
+                     size_t from, size_t maxSeries) {
+    MetricsText out(sink, ctx);
+    uint32_t histogramsUsed = histogramCount.load(std::memory_order_acquire);
+    uint32_t gaugesUsed = gaugeCount.load(std::memory_order_acquire);
+
+    // Series are numbered in output order; the family header goes with the
+    // family's first series, whichever call writes it
+    size_t index = 0;
+    size_t end = maxSeries > SIZE_MAX - from ? SIZE_MAX : from + maxSeries;
+
+    for (uint8_t f = 0; f < METRIC_FAMILY_COUNT; ++f) {
+        const FamilyInfo& family = families[f];
+        bool first = true;
+        auto take = [&]() {
+            bool write = index >= from && index < end;
+            if (write && first) {
+                out.printf("# HELP %s %s\n# TYPE %s %s\n", family.name, family.help, family.name, family.type);
+            }
+            first = false;
+            ++index;
+            return write;
+        };
+
+        for (uint32_t i = 0; i < histogramsUsed; ++i) {
+            const HistogramSlot& slot = histograms[i];
+            if (slot.family != f || !take()) continue;
+
+            const MetricHistogram& h = slot.histogram;
+            const char* sep = slot.labels[0] ? "," : "";
+            uint32_t cumulative = 0;
+            for (size_t b = 0; b < METRICS_BUCKETS; ++b) {
+                cumulative += h.buckets[b].load(std::memory_order_relaxed);
+                out.printf("%s_bucket{%s%sle=\"%s\"} %lu\n", family.name, slot.labels, sep, boundLabels[b],
+                           (unsigned long)cumulative);
+            }
+            cumulative += h.buckets[METRICS_BUCKETS].load(std::memory_order_relaxed);
+            out.printf("%s_bucket{%s%sle=\"+Inf\"} %lu\n", family.name, slot.labels, sep, (unsigned long)cumulative);
+
+            uint64_t sumUs = ((uint64_t)h.sumHigh.load(std::memory_order_relaxed) << 32) |
+                             h.sumLow.load(std::memory_order_relaxed);
+            out.printf("%s_sum%s %llu.%06llu\n", family.name, braced(slot.labels).text,
+                       (unsigned long long)(sumUs / 1000000), (unsigned long long)(sumUs % 1000000));
+            // The count is the +Inf bucket, so the two always agree within a scrape
+            out.printf("%s_count%s %lu\n", family.name, braced(slot.labels).text, (unsigned long)cumulative);
+        }
+
+        for (uint32_t i = 0; i < gaugesUsed; ++i) {
+            const GaugeSlot& slot = gauges[i];
+            if (slot.family != f || !take()) continue;
+            out.printf("%s%s %lu\n", family.name, braced(slot.labels).text, (unsigned long)slot.read(slot.ctx));
+        }
+    }
+    return index > end ? end : 0;
+}
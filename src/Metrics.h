@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <esp_timer.h>
+
+// Runtime instrumentation, served at /metrics in Prometheus text format.
+//
+// Histograms and gauges live in fixed tables filled at startup; recording a
+// value is a bucket search and two or three relaxed atomic adds, so it stays
+// on in production. Durations are recorded in microseconds, exported in seconds.
+//
+//   static MetricHistogram& cycle = metrics_histogram(METRIC_TASK_CYCLE, "task", "app");
+//   { MetricTimer timer(cycle); doWork(); }
+
+#define METRICS_MAX_HISTOGRAMS 64
+#define METRICS_MAX_GAUGES     24
+#define METRICS_LABELS_MAX     48   // rendered label set, e.g. route="/foods"
+#define METRICS_BUCKETS        15   // finite bounds; +Inf comes on top
+
+enum MetricFamily : uint8_t {
+    // Histograms
+    METRIC_HTTP_REQUEST,     // label route
+    METRIC_TASK_CYCLE,       // label task
+    METRIC_SQLITE_STATEMENT, // label statement
+    METRIC_SD_WRITE,         // label op
+    // Gauges
+    METRIC_QUEUE_DEPTH,      // label queue
+    METRIC_HEAP_FREE,        // label pool
+    METRIC_HEAP_MIN_FREE,    // label pool
+    METRIC_HEAP_LARGEST,     // label pool
+    METRIC_UPTIME,
+    METRIC_FAMILY_COUNT
+};
+
+class MetricHistogram {
+public:
+    void observe(uint32_t us);
+
+    // Upper bounds of the finite buckets, in microseconds
+    static const uint32_t bounds[METRICS_BUCKETS];
+
+private:
+    friend size_t metrics_write(void (*)(void*, const char*, size_t), void*, size_t, size_t);
+
+    std::atomic<uint32_t> buckets[METRICS_BUCKETS + 1] = {};   // per bucket; their total is the count
+    std::atomic<uint32_t> sumLow{0};    // microseconds, 64 bits across two
+    std::atomic<uint32_t> sumHigh{0};   // words; a scrape may see a carry late
+};
+
+// Records the lifetime of the scope into a histogram
+class MetricTimer {
+public:
+    explicit MetricTimer(MetricHistogram& histogram)
+        : histogram(histogram), start(esp_timer_get_time()) {}
+    ~MetricTimer() { histogram.observe((uint32_t)(esp_timer_get_time() - start)); }
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    MetricHistogram& histogram;
+    int64_t start;
+};
+
+using MetricGaugeFn = uint32_t (*)(void* ctx);
+
+// Registers a histogram with one label (label may be nullptr for none).
+// Registering the same family and label again returns the same histogram.
+// When the table is full the result is a shared overflow histogram that is
+// not exported.
+MetricHistogram& metrics_histogram(MetricFamily family, const char* label = nullptr, const char* value = nullptr);
+
+// Registers a gauge read at scrape time; read(ctx) must be safe from the web task
+void metrics_gauge(MetricFamily family, const char* label, const char* value, MetricGaugeFn read, void* ctx = nullptr);
+
+// Heap, PSRAM and uptime gauges; call once from setup()
+void metrics_begin();
+
+// Writes registered metrics in Prometheus text format (0.0.4): maxSeries
+// series (one histogram or gauge each) starting at series `from`. Returns
+// where the next call should start, or 0 once everything has been written,
+// so a response can be produced a few series at a time.
+size_t metrics_write(void (*sink)(void* ctx, const char* data, size_t len), void* ctx,
+                     size_t from = 0, size_t maxSeries = SIZE_MAX);
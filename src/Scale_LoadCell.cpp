@@ -2,23 +2,203 @@
 // calibrate_scale are nevoie de o valoare dupa care sa se calibreze
 
 #include "Scale_LoadCell.h"
+#include "SampleRing.h"
+#include <Preferences.h>
+#include <SD.h>
+#include "ds18b20.h"
+#include "Metrics.h"
 
 HX711 scale;
 
+// Raw conversions handed from the acquisition task to the consumer
+static SampleRing<ScaleSample, 64> scaleSamples;
+static TaskHandle_t scaleTaskHandle = nullptr;
+
+// Load-cell temperature, owned by the acquisition task
+static DS18B20* tempSensor = nullptr;
+static float    temperature = NAN;
+
+// Consumer-side state, only touched from the task that calls scale_getReading()
+static WeightFilter     weightFilter;
+static WeighEventDetector weighEvents;
+static SampleRing<WeighEvent, 8> pendingEvents;   // full only if nobody pops
+static CalibrationModel calibration;
+static float            zeroGrams = 0;    // boot tare
+static TareStack        tares;
+static std::atomic<uint32_t> filteredSamples{0};
+
+// DOUT falls when a conversion is ready; wake the acquisition task
+static void IRAM_ATTR scale_doutReadyISR() {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(scaleTaskHandle, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+static void scale_acquisitionTask(void*) {
+  MetricHistogram& cycle = metrics_histogram(METRIC_TASK_CYCLE, "task", "scale");
+  uint32_t nextTempRequest = 0;
+  uint32_t tempReadyAt = 0;
+  bool     tempPending = false;
+
+  for (;;) {
+    // Fall back to polling if an edge was missed (e.g. during a read)
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(200));
+    MetricTimer timer(cycle);
+
+    if (scale.is_ready()) {
+      ScaleSample sample;
+      sample.timestamp = millis();
+      sample.raw = (int32_t)scale.read();
+      sample.temperature = temperature;
+      scaleSamples.push(sample);
+
+      // Clocking the data out toggles DOUT; drop the edges that caused
+      ulTaskNotifyTake(pdTRUE, 0);
+    }
+
+    // Temperature moves slowly: one non-blocking conversion every few seconds
+    if (tempSensor) {
+      uint32_t now = millis();
+      if (tempPending && (int32_t)(now - tempReadyAt) >= 0) {
+        float t = tempSensor->readTemperature(0);
+        if (t != DEVICE_DISCONNECTED_C) temperature = t;
+        tempPending = false;
+      } else if (!tempPending && (int32_t)(now - nextTempRequest) >= 0) {
+        tempReadyAt = now + tempSensor->requestTemperature();
+        nextTempRequest = now + SCALE_TEMP_PERIOD_MS;
+        tempPending = true;
+      }
+    }
+  }
+}
+
+// A model fitted on the host is dropped on the SD card as /calibration.bin;
+// move it into NVS so it survives without the card.
+static void scale_importCalibration(Preferences& prefs) {
+  if (!SD.exists(CALIBRATION_BIN_FILE)) return;
+
+  File f = SD.open(CALIBRATION_BIN_FILE);
+  CalibrationModel model;
+  bool ok = f && f.read((uint8_t*)&model, sizeof(model)) == sizeof(model) && model.isValid();
+  if (f) f.close();
+
+  if (ok) {
+    prefs.putBytes(SCALE_PREFS_MODEL_KEY, &model, sizeof(model));
+    SD.remove(CALIBRATION_BIN_FILE);
+    Serial.println("✅ Imported calibration model from SD");
+  } else {
+    Serial.println("⚠️ Ignoring invalid /calibration.bin");
+  }
+}
+
 void scale_setup(const float calibration_factor) {
-  
+
   scale.begin(LOADCELL_DOUT_PIN, LOADCELL_SCK_PIN);
-  scale.tare();
-  scale.set_scale(calibration_factor);
+
+  tempSensor = new DS18B20(LOADCELL_TEMP_PIN);
+  if (tempSensor->getDeviceCount() > 0) {
+    temperature = tempSensor->getTemperature(0);
+  } else {
+    delete tempSensor;
+    tempSensor = nullptr;
+  }
+
+  Preferences prefs;
+  prefs.begin(SCALE_PREFS_NAMESPACE, false);
+  scale_importCalibration(prefs);
+  bool haveModel = prefs.getBytes(SCALE_PREFS_MODEL_KEY, &calibration, sizeof(calibration)) == sizeof(calibration) &&
+                   calibration.isValid();
+  prefs.end();
+
+  // Boot tare: zero whatever is on the platform right now
+  int32_t raw = (int32_t)scale.read_average(10);
+  if (haveModel) {
+    zeroGrams = calibration.toGrams(raw, temperature);
+    Serial.printf("✅ Temperature-compensated calibration loaded (%.1f°C)\n", temperature);
+  } else {
+    calibration = CalibrationModel::fromFactor(raw, calibration_factor);
+    zeroGrams = 0;
+    Serial.println("⚠️ No calibration model, using fixed factor");
+  }
+
+  metrics_gauge(METRIC_QUEUE_DEPTH, "queue", "scale", [](void*) -> uint32_t { return scaleSamples.size(); });
+  xTaskCreatePinnedToCore(scale_acquisitionTask, "scale", SCALE_TASK_STACK, nullptr,
+                          SCALE_TASK_PRIORITY, &scaleTaskHandle, SCALE_TASK_CORE);
+  attachInterrupt(digitalPinToInterrupt(LOADCELL_DOUT_PIN), scale_doutReadyISR, FALLING);
+}
+
+// The net weight moves opposite to the tare total; so does everything that
+// remembers past net weights
+static void scale_tareChanged(float totalBefore) {
+  float delta = totalBefore - tares.total();
+  weightFilter.shift(delta);
+  weighEvents.shift(delta);
+}
+
+bool scale_tare() {
+
+  float before = tares.total();
+  if (!tares.push(scale_getReading().grams)) return false;
+  scale_tareChanged(before);
+  return true;
+}
+
+bool scale_untare() {
+
+  float before = tares.total();
+  if (!tares.pop()) return false;
+  scale_tareChanged(before);
+  return true;
+}
+
+void scale_clearTare() {
+
+  float before = tares.total();
+  tares.clear();
+  scale_tareChanged(before);
+}
+
+void scale_recallTare(float grams, const char* label) {
+
+  float before = tares.total();
+  tares.clear();
+  tares.push(grams, label);
+  scale_tareChanged(before);
+}
+
+const TareStack& scale_getTares() {
+
+  return tares;
+}
+
+const WeightReading& scale_getReading() {
+
+  ScaleSample sample;
+  while (scaleSamples.pop(sample)) {
+    float grams = calibration.toGrams(sample.raw, sample.temperature) - zeroGrams - tares.total();
+    WeighEvent event;
+    if (weighEvents.push(weightFilter.push(grams, sample.timestamp), event)) pendingEvents.push(event);
+    filteredSamples.fetch_add(1, std::memory_order_relaxed);
+  }
+  return weightFilter.reading();
+}
+
+bool scale_popEvent(WeighEvent& out) {
+
+  return pendingEvents.pop(out);
+}
+
+bool scale_isSettling() {
+
+  return weighEvents.moving();
 }
 
-void scale_tare() {
+ScaleStats scale_getStats() {
 
-  scale.tare();
+  return {filteredSamples.load(std::memory_order_relaxed), scaleSamples.droppedCount()};
 }
 
 float scale_getWeight() {
 
-  float weight = scale.get_units(10);
-  return weight;
+  return scale_getReading().grams;
 }
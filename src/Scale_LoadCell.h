@@ -2,17 +2,78 @@
 #define SCALE_LOADCELL_H
 
 #include "HX711.h"
+#include "WeightFilter.h"
+#include "WeighEvent.h"
+#include "TareStack.h"
+#include "CalibrationModel.h"
 
 #define LOADCELL_DOUT_PIN 17  // HX711 data pin
 #define LOADCELL_SCK_PIN  18  // HX711 clock pin
+#define LOADCELL_TEMP_PIN 2   // DS18B20 next to the load cell
 
-// Initialize & tare the HX711, optionally override default calibration factor
+#define CALIBRATION_BIN_FILE "/calibration.bin"  // host-fitted model to import
+#define SCALE_PREFS_NAMESPACE "scale"
+#define SCALE_PREFS_MODEL_KEY "model"
+#define SCALE_TEMP_PERIOD_MS 5000
+
+#define SCALE_TASK_STACK     4096
+#define SCALE_TASK_PRIORITY  5
+#define SCALE_TASK_CORE      1
+
+// One raw HX711 conversion as pushed by the acquisition task
+struct ScaleSample {
+  int32_t  raw;          // raw 24-bit ADC counts
+  uint32_t timestamp;    // millis() when DOUT went ready
+  float    temperature;  // load-cell temperature in degC, NAN if unknown
+};
+
+// Acquisition counters since scale_setup()
+struct ScaleStats {
+  uint32_t samples;   // conversions that went through the filter chain
+  uint32_t dropped;   // conversions lost because the consumer fell behind
+};
+
+// Initialize & tare the HX711. Uses the temperature-compensated model stored
+// in NVS when there is one, otherwise the given calibration factor.
+// Starts the acquisition task that samples on every DOUT-ready edge.
 void scale_setup(const float calibration_factor = 391);
 
-// Tare the scale
-void scale_tare();
+// Tare stack over the boot zero. Every change is instant: the filter and
+// the event detector are moved by the difference instead of averaging fresh
+// samples, so a settled reading stays settled. Call from the same task as
+// scale_getReading().
+
+// Push the current filtered weight (nested tare); false when the stack is full
+bool scale_tare();
+
+// Drop the newest tare, showing what it hid again; false when there is none
+bool scale_untare();
+
+// Back to the boot zero
+void scale_clearTare();
 
-// Read the current weight in grams
+// A known container: the stack becomes just its weight
+void scale_recallTare(float grams, const char* label);
+
+const TareStack& scale_getTares();
+
+// Read the current weight in grams. Never blocks: drains pending samples
+// from the acquisition ring through the filter chain and returns the result.
 float scale_getWeight();
 
+// Same as scale_getWeight() but with the stability flag and settle time
+const WeightReading& scale_getReading();
+
+// Next weigh event (item added / removed / settled) found in the samples
+// scale_getReading() has filtered so far; false when there is none.
+// Call from the same task as scale_getReading().
+bool scale_popEvent(WeighEvent& out);
+
+// True from the moment the load starts to move until its event is out,
+// which is a little after the reading itself turns stable
+bool scale_isSettling();
+
+// Safe from any task
+ScaleStats scale_getStats();
+
 #endif
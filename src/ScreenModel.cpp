@@ -0,0 +1,73 @@
+#include "ScreenModel.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+// 320x170 landscape panel
+const ScreenFieldLayout ScreenModel::layouts[FIELD_COUNT] = {
+    {0,   0,   1},   // FIELD_TITLE
+    {0,   12,  3},   // FIELD_WEIGHT
+    {0,   42,  2},   // FIELD_FOOD
+    {0,   60,  2},   // FIELD_FOOD_MACROS1
+    {0,   78,  2},   // FIELD_FOOD_MACROS2
+    {0,   100, 2},   // FIELD_TOTALS_TITLE
+    {0,   118, 2},   // FIELD_TOTALS1
+    {0,   136, 2},   // FIELD_TOTALS2
+    {0,   152, 1},   // FIELD_MODE
+    {0,   162, 1},   // FIELD_IP
+};
+
+ScreenModel::ScreenModel() {
+    memset(fields, 0, sizeof(fields));
+}
+
+void ScreenModel::set(ScreenField field, const char* text) {
+    Field& f = fields[field];
+    strncpy(f.text, text, SCREEN_TEXT_MAX - 1);
+    f.text[SCREEN_TEXT_MAX - 1] = '\0';
+}
+
+void ScreenModel::setf(ScreenField field, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(fields[field].text, SCREEN_TEXT_MAX, format, args);
+    va_end(args);
+}
+
+void ScreenModel::invalidate() {
+    for (Field& f : fields) {
+        f.shown[0] = '\0';
+        f.full = true;
+    }
+}
+
+Rectangle ScreenModel::dirtyRect(ScreenField field) const {
+    const Field& f = fields[field];
+    const ScreenFieldLayout& l = layouts[field];
+    uint32_t cw = SCREEN_GLYPH_W * l.textSize;
+    uint32_t ch = SCREEN_GLYPH_H * l.textSize;
+
+    size_t newLen = strlen(f.text);
+    size_t oldLen = strlen(f.shown);
+    size_t len = newLen > oldLen ? newLen : oldLen;
+
+    if (f.full) return Rectangle(l.x, l.y, newLen * cw, newLen ? ch : 0);
+
+    // Columns past the end of either string compare as blanks
+    size_t first = len, last = 0;
+    for (size_t i = 0; i < len; ++i) {
+        char a = i < newLen ? f.text[i] : ' ';
+        char b = i < oldLen ? f.shown[i] : ' ';
+        if (a == b) continue;
+        if (first == len) first = i;
+        last = i;
+    }
+    if (first == len) return Rectangle(l.x, l.y, 0, 0);
+    return Rectangle(l.x + first * cw, l.y, (last - first + 1) * cw, ch);
+}
+
+void ScreenModel::markClean(ScreenField field) {
+    Field& f = fields[field];
+    memcpy(f.shown, f.text, SCREEN_TEXT_MAX);
+    f.full = false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "rectangle.h"
+
+// Retained-mode model of the status screen. Each field is one line of text
+// at a fixed position in the built-in 6x8 font (scaled by textSize). The
+// model remembers what is on the panel, and for each field it reports the
+// smallest column span that differs, so a changing weight only repaints the
+// digits that moved. No Arduino dependencies.
+
+#define SCREEN_TEXT_MAX    32
+#define SCREEN_GLYPH_W     6
+#define SCREEN_GLYPH_H     8
+
+enum ScreenField : uint8_t {
+    FIELD_TITLE,
+    FIELD_WEIGHT,
+    FIELD_FOOD,
+    FIELD_FOOD_MACROS1,
+    FIELD_FOOD_MACROS2,
+    FIELD_TOTALS_TITLE,
+    FIELD_TOTALS1,
+    FIELD_TOTALS2,
+    FIELD_MODE,
+    FIELD_IP,
+    FIELD_COUNT
+};
+
+struct ScreenFieldLayout {
+    uint16_t x;
+    uint16_t y;
+    uint8_t  textSize;
+};
+
+class ScreenModel {
+public:
+    ScreenModel();
+
+    void set(ScreenField field, const char* text);
+    void setf(ScreenField field, const char* format, ...);
+
+    // Panel was cleared: every field with text repaints in full
+    void invalidate();
+
+    // Area that needs repainting, width 0 when the field is up to date
+    Rectangle dirtyRect(ScreenField field) const;
+
+    // Repaint every dirty field, then remember what is on the panel:
+    //   fn(field, rect, text, layout) with rect from dirtyRect()
+    template <typename Fn>
+    void render(Fn fn) {
+        for (uint8_t f = 0; f < FIELD_COUNT; ++f) {
+            Rectangle rect = dirtyRect((ScreenField)f);
+            if (rect.width == 0) continue;
+            fn((ScreenField)f, rect, fields[f].text, layouts[f]);
+            markClean((ScreenField)f);
+        }
+    }
+
+    void markClean(ScreenField field);
+    const char* text(ScreenField field) const { return fields[field].text; }
+    const ScreenFieldLayout& layout(ScreenField field) const { return layouts[field]; }
+
+private:
+    struct Field {
+        char text[SCREEN_TEXT_MAX];
+        char shown[SCREEN_TEXT_MAX];   // what the panel currently shows
+        bool full;                     // repaint the whole line
+    };
+
+    static const ScreenFieldLayout layouts[FIELD_COUNT];
+    Field fields[FIELD_COUNT];
+};
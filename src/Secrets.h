@@ -3,3 +3,6 @@
 #define AUTH_USER  "admin"
 #define AUTH_PASS  "ciolan229"
 #define AUTH_REALM "SmartScaleRealm"
+
+#define WIFI_SSID     "TP-Link_D358"
+#define WIFI_PASSWORD "25194432"
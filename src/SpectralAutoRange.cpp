@@ -0,0 +1,60 @@
+#include "SpectralAutoRange.h"
+
+static uint16_t peakOf(const uint16_t* channels) {
+    uint16_t peak = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (channels[i] > peak) peak = channels[i];
+    }
+    return peak;
+}
+
+// Integration time in ATIME counts doubles/halves around (ATIME + 1)
+static uint8_t doubled(uint8_t atime, uint8_t limit) {
+    uint32_t next = (atime + 1u) * 2u - 1u;
+    return next > limit ? limit : (uint8_t)next;
+}
+
+static uint8_t halved(uint8_t atime, uint8_t limit) {
+    uint32_t next = (atime + 1u) / 2u;
+    next = next > 0 ? next - 1 : 0;
+    return next < limit ? limit : (uint8_t)next;
+}
+
+uint32_t SpectralSettings::fullScale() const {
+    uint32_t counts = (uint32_t)(atime + 1) * (astep + 1);
+    return counts > 65535 ? 65535 : counts;
+}
+
+bool SpectralAutoRange::saturated(const uint16_t* channels, const SpectralSettings& settings) {
+    return peakOf(channels) >= settings.fullScale();
+}
+
+bool SpectralAutoRange::update(const uint16_t* channels, SpectralSettings& settings) {
+    SpectralSettings before = settings;
+    float level = (float)peakOf(channels) / settings.fullScale();
+
+    if (level > SPECTRAL_RANGE_HIGH) {
+        if (settings.atime > SPECTRAL_ATIME_DEFAULT) {
+            settings.atime = halved(settings.atime, SPECTRAL_ATIME_DEFAULT);
+        } else if (settings.again > 0) {
+            // Clipped readings say nothing about how far over we are
+            uint8_t steps = level >= 0.99f ? 2 : 1;
+            settings.again = settings.again > steps ? settings.again - steps : 0;
+        } else {
+            settings.atime = halved(settings.atime, SPECTRAL_ATIME_MIN);
+        }
+    } else if (level < SPECTRAL_RANGE_LOW) {
+        if (settings.atime < SPECTRAL_ATIME_DEFAULT) {
+            settings.atime = doubled(settings.atime, SPECTRAL_ATIME_DEFAULT);
+        } else if (settings.again < SPECTRAL_AGAIN_MAX) {
+            // Each gain step doubles the counts; aim for the middle of the band
+            uint8_t steps = 1;
+            while (steps < 3 && level * (2u << steps) <= 0.5f * (SPECTRAL_RANGE_LOW + SPECTRAL_RANGE_HIGH)) steps++;
+            settings.again = settings.again + steps > SPECTRAL_AGAIN_MAX ? SPECTRAL_AGAIN_MAX : settings.again + steps;
+        } else {
+            settings.atime = doubled(settings.atime, SPECTRAL_ATIME_MAX);
+        }
+    }
+
+    return settings != before;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+
+// Gain / integration-time control for the AS7341. One step per complete
+// spectrum, so both SMUX groups of a spectrum always share the same settings.
+// No Arduino dependencies.
+//
+// Integration time is (ATIME + 1) * (ASTEP + 1) * 2.78 us. ASTEP stays at
+// 599 (1.67 ms per ATIME count); ATIME 29 gives 50 ms per SMUX group, about
+// nine full spectra per second. Gain is the main control. Integration only
+// grows past that when gain is maxed out and shrinks below it when gain is
+// at its minimum.
+
+#define SPECTRAL_ASTEP          599
+#define SPECTRAL_ATIME_MIN      5      // ~10 ms
+#define SPECTRAL_ATIME_DEFAULT  29     // ~50 ms
+#define SPECTRAL_ATIME_MAX      119    // ~200 ms, full scale reaches 65535
+#define SPECTRAL_AGAIN_MAX      10     // x512
+#define SPECTRAL_AGAIN_DEFAULT  4      // x8
+
+#define SPECTRAL_RANGE_HIGH     0.80f  // peak above this fraction of full scale: back off
+#define SPECTRAL_RANGE_LOW      0.20f  // peak below this: amplify
+
+struct SpectralSettings {
+    uint8_t  again = SPECTRAL_AGAIN_DEFAULT;
+    uint8_t  atime = SPECTRAL_ATIME_DEFAULT;
+    uint16_t astep = SPECTRAL_ASTEP;
+
+    uint32_t fullScale() const;
+    uint32_t integrationUs() const { return (uint32_t)((atime + 1) * (astep + 1) * 2.78f); }
+    bool operator==(const SpectralSettings& o) const {
+        return again == o.again && atime == o.atime && astep == o.astep;
+    }
+    bool operator!=(const SpectralSettings& o) const { return !(*this == o); }
+};
+
+class SpectralAutoRange {
+public:
+    // Looks at one complete spectrum (10 channels) taken with `settings` and
+    // adjusts them for the next one. Returns true if anything changed.
+    static bool update(const uint16_t* channels, SpectralSettings& settings);
+
+    // Peak channel at or above full scale: the spectrum is clipped
+    static bool saturated(const uint16_t* channels, const SpectralSettings& settings);
+};
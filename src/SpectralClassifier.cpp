@@ -0,0 +1,145 @@
+#include "SpectralClassifier.h"
+#include <cstdlib>
+#include <cstring>
+
+bool SpectralClassifier::features(const uint16_t* channels, int16_t* row) {
+    uint32_t clear = channels[SPECTRAL_CLEAR];
+    if (clear < SPECTRAL_MIN_CLEAR) return false;
+
+    size_t f = 0;
+    for (size_t i = 0; i < SPECTRAL_CHANNELS; ++i) {
+        if (i == SPECTRAL_CLEAR) continue;
+        uint32_t q = ((uint32_t)channels[i] * SPECTRAL_ONE + clear / 2) / clear;
+        row[f++] = (int16_t)(q > SPECTRAL_FEATURE_MAX ? SPECTRAL_FEATURE_MAX : q);
+    }
+    while (f < SPECTRAL_STRIDE) row[f++] = 0;
+    return true;
+}
+
+uint16_t SpectralClassifier::labelId(const char* name) {
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (labels[i] == name) return (uint16_t)i;
+    }
+    labels.emplace_back(name);
+    return (uint16_t)(labels.size() - 1);
+}
+
+bool SpectralClassifier::add(const char* label, const uint16_t* channels) {
+    int16_t row[SPECTRAL_STRIDE];
+    if (!features(channels, row)) return false;
+
+    if (rowLabels.size() < SPECTRAL_MAX_REFERENCES) {
+        rows.insert(rows.end(), row, row + SPECTRAL_STRIDE);
+        rowLabels.push_back(labelId(label));
+        return true;
+    }
+
+    // Full: the rows form a ring, so row order does not matter to classify()
+    memcpy(&rows[oldest * SPECTRAL_STRIDE], row, sizeof(row));
+    rowLabels[oldest] = labelId(label);
+    oldest = (oldest + 1) % SPECTRAL_MAX_REFERENCES;
+    return true;
+}
+
+bool SpectralClassifier::parseCsvLine(const char* line, char* food, size_t foodSize, uint16_t* channels) {
+    // Food,Weight,Color,Spec0..Spec9
+    const char* comma = strchr(line, ',');
+    if (!comma || comma == line) return false;
+
+    size_t len = comma - line;
+    if (len >= foodSize) return false;
+    memcpy(food, line, len);
+    food[len] = '\0';
+
+    const char* p = comma + 1;
+    for (int skip = 0; skip < 2; ++skip) {   // weight, colour
+        p = strchr(p, ',');
+        if (!p) return false;
+        ++p;
+    }
+
+    for (size_t i = 0; i < SPECTRAL_CHANNELS; ++i) {
+        char* end;
+        long v = strtol(p, &end, 10);
+        if (end == p || v < 0 || v > UINT16_MAX) return false;   // also rejects the header
+        channels[i] = (uint16_t)v;
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return true;
+}
+
+bool SpectralClassifier::addCsvLine(const char* line) {
+    char food[64];
+    uint16_t channels[SPECTRAL_CHANNELS];
+    return parseCsvLine(line, food, sizeof(food), channels) && add(food, channels);
+}
+
+size_t SpectralClassifier::classify(const uint16_t* channels, SpectralCandidate* out, size_t maxCandidates) const {
+    int16_t query[SPECTRAL_STRIDE];
+    if (rowLabels.empty() || maxCandidates == 0 || !features(channels, query)) return 0;
+
+    // k smallest distances, kept sorted by insertion
+    uint32_t bestDistance[SPECTRAL_K];
+    uint16_t bestLabel[SPECTRAL_K];
+    size_t found = 0;
+
+    const int16_t* row = rows.data();
+    for (size_t r = 0; r < rowLabels.size(); ++r, row += SPECTRAL_STRIDE) {
+        // Features are at most 16383 apart, so 9 squares fit in 32 bits
+        uint32_t d = 0;
+        for (size_t i = 0; i < SPECTRAL_STRIDE; ++i) {
+            int32_t diff = (int32_t)row[i] - query[i];
+            d += (uint32_t)(diff * diff);
+        }
+
+        if (found == SPECTRAL_K && d >= bestDistance[found - 1]) continue;
+        size_t i = found < SPECTRAL_K ? found++ : found - 1;
+        while (i > 0 && bestDistance[i - 1] > d) {
+            bestDistance[i] = bestDistance[i - 1];
+            bestLabel[i] = bestLabel[i - 1];
+            --i;
+        }
+        bestDistance[i] = d;
+        bestLabel[i] = rowLabels[r];
+    }
+
+    // Inverse-distance vote; the distance scale is one Q12 unit per channel
+    float votes[SPECTRAL_K];
+    size_t candidates = 0;
+    float total = 0;
+    for (size_t i = 0; i < found; ++i) {
+        float weight = 1.0f / (1.0f + bestDistance[i] / (float)SPECTRAL_FEATURES);
+        total += weight;
+
+        size_t c = 0;
+        while (c < candidates && out[c].label != bestLabel[i]) ++c;
+        if (c == candidates) {
+            if (candidates == maxCandidates) continue;
+            out[c] = {bestLabel[i], 0, bestDistance[i]};   // first hit is the closest
+            votes[c] = 0;
+            candidates++;
+        }
+        votes[c] += weight;
+    }
+
+    for (size_t c = 0; c < candidates; ++c) out[c].confidence = votes[c] / total;
+
+    // Few entries: insertion sort by confidence
+    for (size_t c = 1; c < candidates; ++c) {
+        SpectralCandidate item = out[c];
+        size_t j = c;
+        while (j > 0 && out[j - 1].confidence < item.confidence) {
+            out[j] = out[j - 1];
+            --j;
+        }
+        out[j] = item;
+    }
+    return candidates;
+}
+
+void SpectralClassifier::clear() {
+    rows.clear();
+    rowLabels.clear();
+    labels.clear();
+    oldest = 0;
+}
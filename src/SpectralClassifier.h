@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// k-nearest-neighbour food classifier for AS7341 spectra.
+//
+// Each spectrum is divided by its Clear channel, so the features describe
+// colour rather than brightness or distance to the sensor, and stored as
+// Q12 fixed point (4096 == Clear) in fixed-stride int16 rows. The distance
+// loop is a branch-free squared difference over one row, which the compiler
+// unrolls (and vectorises on the host). No Arduino dependencies.
+
+#define SPECTRAL_CHANNELS       10    // F1-F8, Clear, NIR (Color_Sensor.h order)
+#define SPECTRAL_CLEAR          8     // index of the Clear channel
+#define SPECTRAL_FEATURES       9     // F1-F8 and NIR over Clear
+#define SPECTRAL_STRIDE         12    // row padded to a multiple of 4 lanes
+#define SPECTRAL_ONE            4096  // Q12: a channel as bright as Clear
+#define SPECTRAL_FEATURE_MAX    16383 // ratios saturate at 4x Clear
+#define SPECTRAL_MIN_CLEAR      32    // darker than this is no measurement
+#define SPECTRAL_MAX_REFERENCES 512
+#define SPECTRAL_K              5
+#define SPECTRAL_MAX_CANDIDATES 5
+
+struct SpectralCandidate {
+    uint16_t label;
+    float    confidence;   // share of the k-NN vote, 0..1
+    uint32_t distance;     // squared Q12 distance to the closest reference
+};
+
+class SpectralClassifier {
+public:
+    // Adds a labelled reference. Once SPECTRAL_MAX_REFERENCES are held it
+    // replaces the oldest, so the newest spectra of each food are the ones
+    // kept. Returns false when the spectrum is too dark.
+    bool add(const char* label, const uint16_t* channels);
+
+    // Parse one line of /spectrum_log.csv ("Food,Weight,Color,Spec0..Spec9").
+    // The header and malformed lines are ignored. Returns true if added.
+    bool addCsvLine(const char* line);
+
+    // Ranked candidates, best first. Returns how many were written (0 when
+    // the spectrum is too dark or nothing has been learned yet).
+    size_t classify(const uint16_t* channels, SpectralCandidate* out, size_t maxCandidates) const;
+
+    const char* label(uint16_t id) const { return labels[id].c_str(); }
+    size_t referenceCount() const { return rowLabels.size(); }
+    size_t labelCount() const { return labels.size(); }
+    void clear();
+
+    // Q12 feature row for a raw spectrum; false if Clear is too dark
+    static bool features(const uint16_t* channels, int16_t* row);
+
+    // Split a /spectrum_log.csv line into food name and channels
+    static bool parseCsvLine(const char* line, char* food, size_t foodSize, uint16_t* channels);
+
+private:
+    uint16_t labelId(const char* name);
+
+    std::vector<int16_t>     rows;        // referenceCount() x SPECTRAL_STRIDE
+    std::vector<uint16_t>    rowLabels;
+    std::vector<std::string> labels;
+    size_t                   oldest = 0;  // row add() replaces when full
+};
@@ -0,0 +1,19 @@
+#include "TareStack.h"
+#include <cstring>
+
+bool TareStack::push(float grams, const char* label) {
+    if (count == TARE_STACK_DEPTH) return false;
+    TareEntry& entry = entries[count++];
+    entry.grams = grams;
+    strncpy(entry.label, label, sizeof(entry.label) - 1);
+    entry.label[sizeof(entry.label) - 1] = '\0';
+    sum += grams;
+    return true;
+}
+
+bool TareStack::pop() {
+    if (count == 0) return false;
+    sum -= entries[--count].grams;
+    if (count == 0) sum = 0;   // no rounding residue on an empty stack
+    return true;
+}
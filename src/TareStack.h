@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Nested tares on top of the boot zero. Each entry is the load that was on
+// the platform when it was pushed, relative to the entry below, so popping
+// one brings back exactly the reading that tare hid:
+//
+//   bowl recalled from the library   [Bowl 250]            reads 0
+//   flour poured, tared              [Bowl 250, 180]       reads 0
+//   sugar poured                     [Bowl 250, 180]       reads 95
+//   pop                              [Bowl 250]            reads 275
+//
+// Fixed size and no Arduino dependencies.
+
+#define TARE_STACK_DEPTH  8
+#define TARE_LABEL_MAX    32      // container name, "" for a plain tare
+
+struct TareEntry {
+    float grams;
+    char  label[TARE_LABEL_MAX];
+};
+
+class TareStack {
+public:
+    // False when the stack is full
+    bool push(float grams, const char* label = "");
+    bool pop();
+    void clear() { count = 0; sum = 0; }
+
+    float  total() const { return sum; }
+    size_t depth() const { return count; }
+    const TareEntry& operator[](size_t i) const { return entries[i]; }
+
+    // Container at the bottom of the stack, "" for none
+    const char* container() const { return count ? entries[0].label : ""; }
+
+private:
+    TareEntry entries[TARE_STACK_DEPTH];
+    size_t    count = 0;
+    float     sum = 0;
+};
@@ -1,193 +1,338 @@
 #include "WebServerManager.h"
-#include "DisplayManager.h"
 #include "WebSocketManager.h"
 #include "FoodManager.h"
 #include "ColorMap.h" 
 #include <SD.h>
 #include "Secrets.h"
-#include <sqlite3.h>
+#include "AppState.h"
+#include "JsonWriter.h"
+#include "WebAssets.h"
+#include "Metrics.h"
+#include "FoodImporter.h"
+#include <memory>
+#include <string>
 
 extern FoodManager foodManager;
-extern DailyNutrition dailyTotals;
-extern FoodItem currentFood;
-extern bool timeSynced;
-extern bool needDisplayUpdate;
-extern float weight;
-extern DisplayManager displayManager;
-extern String lastTimestamp;
-extern String lastMode; // optional, if used in display
 
+// A capture older than this no longer shows what is on the scale
+#define SPECTRUM_MAX_AGE_MS 2000
 
+// Routes that change state also take form POSTs; the web UI uses GET
+#define EDIT_METHODS (HTTP_METHOD_GET | HTTP_METHOD_POST)
 
-WiFiModeType WebServerManager::getCurrentMode() {
-  return currentMode;
+static bool spectrumIsFresh(const AppSnapshot& state) {
+    return state.spectrumAt != 0 && millis() - state.spectrumAt < SPECTRUM_MAX_AGE_MS;
 }
 
-IPAddress WebServerManager::getDeviceIP() {
-  return (currentMode == MODE_STA) ? WiFi.localIP() : WiFi.softAPIP();
+// Optional non-negative integer argument: true when it is absent (out is
+// left alone) or all digits, false for anything else
+static bool integerArg(HttpRequest& req, const char* name, int64_t& out) {
+    if (!req.hasArg(name)) return true;
+    const char* text = req.arg(name);
+    if (!*text) return false;
+    int64_t n = 0;
+    for (const char* p = text; *p; ++p) {
+        if (*p < '0' || *p > '9' || n > (INT64_MAX - (*p - '0')) / 10) return false;
+        n = n * 10 + (*p - '0');
+    }
+    out = n;
+    return true;
 }
 
 
-void WebServerManager::begin(const char* ssid, const char* password, sqlite3* database) {
-    db = database;
-server.on("/foods", HTTP_GET, [this]() {
-    if (!checkAuth()) return;
 
-    String json = "[";
-    const char* query = R"(
-        SELECT Food.name, IFNULL(ColorMap.color_name, '') AS color
-        FROM Food LEFT JOIN ColorMap ON Food.food_id = ColorMap.food_id;
-    )";
+// Response body produced a page at a time, whenever the connection can take
+// more: memory per response is one page however long the body gets, and no
+// lock is held while the client reads.
+class PagedBody : public HttpBodySource {
+public:
+    size_t read(char* out, size_t cap) override {
+        while (offset == page.size()) {
+            if (last) return 0;
+            page.clear();
+            offset = 0;
+            last = !nextPage();
+        }
+        size_t n = std::min(cap, page.size() - offset);
+        memcpy(out, page.data() + offset, n);
+        offset += n;
+        return n;
+    }
 
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) == SQLITE_OK) {
-        bool first = true;
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            if (!first) json += ",";
-            first = false;
+protected:
+    // Appends the next page with append(); false once that was the last one
+    virtual bool nextPage() = 0;
 
-            String name  = String(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
-            String color = String(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+    void append(const char* data, size_t len) { page.append(data, len); }
+    static void appendTo(void* ctx, const char* data, size_t len) {
+        static_cast<PagedBody*>(ctx)->append(data, len);
+    }
 
-            json += "{";
-            json += "\"name\":\"" + name + "\",";
-            json += "\"color\":\"" + color + "\"";
-            json += "}";
-        }
-        sqlite3_finalize(stmt);
+private:
+    std::string page;
+    size_t      offset = 0;
+    bool        last = false;
+};
+
+// Paged JSON document: nextPage(json) writes the next part of it
+class JsonPagedBody : public PagedBody {
+public:
+    JsonPagedBody() : json(buffer, sizeof(buffer), appendTo, this) {}
+
+protected:
+    virtual bool nextPage(JsonWriter& json) = 0;
+
+private:
+    bool nextPage() override {
+        bool more = nextPage(json);
+        json.flush();
+        return more;
     }
 
-    json += "]";
-    server.send(200, "application/json", json);
-});
+    char       buffer[256];
+    JsonWriter json;
+};
 
+// Small JSON document built in memory and sent with a Content-Length
+class JsonResponse : public JsonWriter {
+public:
+    JsonResponse() : JsonWriter(buffer, sizeof(buffer), appendTo, &text) {}
 
-    startWiFi(ssid, password);
-    server.on("/", HTTP_GET, [this]() {
-      if (!checkAuth()) return;
-      handleRoot();
-  });
-  server.on("/addfood", HTTP_GET, [this]() {
-    if (!checkAuth()) return;
-    handleAddFood();
-});
-server.on("/deletefood", HTTP_GET, [this]() {
-    if (!checkAuth()) return;
-    if (!server.hasArg("name")) {
-        server.send(400, "text/plain", "❌ Missing 'name'");
-        return;
+    void send(HttpResponse& res, int code = 200) {
+        flush();
+        res.send(code, "application/json", text.data(), text.size());
     }
 
-    String foodName = server.arg("name");
+private:
+    static void appendTo(void* ctx, const char* data, size_t len) {
+        static_cast<std::string*>(ctx)->append(data, len);
+    }
 
-    // Build SQL statements
-    const char* deleteColorSQL = R"(
-        DELETE FROM ColorMap
-        WHERE food_id = (SELECT food_id FROM Food WHERE name = ?);
-    )";
+    char        buffer[256];
+    std::string text;
+};
 
-    const char* deleteFoodSQL = R"(
-        DELETE FROM Food WHERE name = ?;
-    )";
+// SD file read as the client takes it
+class FileBody : public HttpBodySource {
+public:
+    explicit FileBody(File file) : file(file) {}
+    ~FileBody() override { file.close(); }
+    size_t read(char* out, size_t cap) override { return file.read((uint8_t*)out, cap); }
 
-    // Delete ColorMap entry
-    sqlite3_stmt* stmt1;
-    if (sqlite3_prepare_v2(db, deleteColorSQL, -1, &stmt1, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt1, 1, foodName.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_step(stmt1);  // Ignore result
-        sqlite3_finalize(stmt1);
-    }
+private:
+    File file;
+};
 
-    // Delete Food entry
-    sqlite3_stmt* stmt2;
-    bool deleted = false;
-    if (sqlite3_prepare_v2(db, deleteFoodSQL, -1, &stmt2, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt2, 1, foodName.c_str(), -1, SQLITE_TRANSIENT);
-        if (sqlite3_step(stmt2) == SQLITE_DONE && sqlite3_changes(db) > 0) {
-            deleted = true;
-        }
-        sqlite3_finalize(stmt2);
-    }
 
-    if (deleted) {
-        server.send(200, "text/plain", "✅ Deleted " + foodName);
-    } else {
-        server.send(404, "text/plain", "❌ Food not found: " + foodName);
+WiFiModeType WebServerManager::getCurrentMode() {
+  return currentMode;
+}
+
+IPAddress WebServerManager::getDeviceIP() {
+  return (currentMode == MODE_STA) ? WiFi.localIP() : WiFi.softAPIP();
+}
+
+AppNetwork WebServerManager::network() {
+  return {(uint32_t)getDeviceIP(), currentMode == MODE_AP};
+}
+
+
+void WebServerManager::begin(const char* ssid, const char* password) {
+appReply = app_createReplyQueue();
+
+on("/foods", [this](HttpRequest& req, HttpResponse& res) {
+    if (!checkAuth(req, res)) return;
+    handleFoods(req, res);
+});
+
+
+on("/foods/search", [this](HttpRequest& req, HttpResponse& res) {
+    if (!checkAuth(req, res)) return;
+    handleSearch(req, res);
+});
+
+on("/classify", [this](HttpRequest& req, HttpResponse& res) {
+    if (!checkAuth(req, res)) return;
+    handleClassify(req, res);
+});
+
+    loadClassifier();
+    startWiFi(ssid, password);
+    for (const WebAsset& asset : webAssets) {
+      on(asset.path, [this, &asset](HttpRequest& req, HttpResponse& res) {
+        if (!checkAuth(req, res)) return;
+        handleAsset(req, res, asset);
+      });
     }
+  on("/addfood", [this](HttpRequest& req, HttpResponse& res) {
+    if (!checkAuth(req, res)) return;
+    handleAddFood(req, res);
+}, EDIT_METHODS);
+onUpload("/foods/import", [this](HttpRequest& req, HttpResponse& res) -> std::unique_ptr<HttpBodySink> {
+    if (!checkAuth(req, res)) return nullptr;
+    return handleImport(req, res);
+});
+on("/deletefood", [this](HttpRequest& req, HttpResponse& res) {
+    if (!checkAuth(req, res)) return;
+    handleDeleteFood(req, res);
+}, EDIT_METHODS);
+on("/select", [this](HttpRequest& req, HttpResponse& res) {
+  if (!checkAuth(req, res)) return;
+  handleSelect(req, res);
+}, EDIT_METHODS);
+on("/autolog", [this](HttpRequest& req, HttpResponse& res) {
+  if (!checkAuth(req, res)) return;
+  handleAutoLog(req, res);
+}, EDIT_METHODS);
+on("/reset", [this](HttpRequest& req, HttpResponse& res) {
+  if (!checkAuth(req, res)) return;
+  handleReset(req, res);
+}, EDIT_METHODS);
+on("/tare", [this](HttpRequest& req, HttpResponse& res) {
+  if (!checkAuth(req, res)) return;
+  handleTare(req, res);
+}, EDIT_METHODS);
+on("/containers", [this](HttpRequest& req, HttpResponse& res) {
+  if (!checkAuth(req, res)) return;
+  handleContainers(req, res);
 });
-server.on("/select", HTTP_GET, [this]() {
-  if (!checkAuth()) return;
-  handleSelect();
+on("/containers/save", [this](HttpRequest& req, HttpResponse& res) {
+  if (!checkAuth(req, res)) return;
+  handleSaveContainer(req, res);
+}, EDIT_METHODS);
+on("/containers/delete", [this](HttpRequest& req, HttpResponse& res) {
+  if (!checkAuth(req, res)) return;
+  handleDeleteContainer(req, res);
+}, EDIT_METHODS);
+on("/daily", [this](HttpRequest& req, HttpResponse& res) {
+    handleDaily(req, res);
 });
-server.on("/reset", HTTP_GET, [this]() {
-  if (!checkAuth()) return;
-  handleReset();
+on("/history", [this](HttpRequest& req, HttpResponse& res) {
+    if (!checkAuth(req, res)) return;
+    handleHistory(req, res);
 });
-server.on("/daily", HTTP_GET, [this]() {
-    String json = "{";
-    json += "\"calories\":" + String(dailyTotals.calories) + ",";
-    json += "\"protein\":" + String(dailyTotals.protein) + ",";
-    json += "\"carbs\":" + String(dailyTotals.carbs) + ",";
-    json += "\"fat\":" + String(dailyTotals.fat);
-    json += "}";
-    server.send(200, "application/json", json);
+on("/export.csv", [this](HttpRequest& req, HttpResponse& res) {
+    if (!checkAuth(req, res)) return;
+    handleExport(req, res, EXPORT_CSV);
+});
+on("/export.ndjson", [this](HttpRequest& req, HttpResponse& res) {
+    if (!checkAuth(req, res)) return;
+    handleExport(req, res, EXPORT_NDJSON);
+});
+on("/export.bin", [this](HttpRequest& req, HttpResponse& res) {
+    if (!checkAuth(req, res)) return;
+    handleExport(req, res, EXPORT_BINARY);
 });
 
-    server.on("/manifest.json", HTTP_GET, [this]() {
-      File f = SD.open("/manifest.json");
-      if (f) {
-          server.streamFile(f, "application/json");
-          f.close();
-      } else {
-          server.send(404, "text/plain", "manifest.json not found");
-      }
+    on("/manifest.json", [this](HttpRequest& req, HttpResponse& res) {
+      serveSdFile(req, res, "/manifest.json", "application/json", "no-cache");
   });
-  
-  server.on("/service-worker.js", HTTP_GET, [this]() {
-      File f = SD.open("/service-worker.js");
-      if (f) {
-          server.streamFile(f, "application/javascript");
-          f.close();
-      } else {
-          server.send(404, "text/plain", "service-worker.js not found");
-      }
+  on("/service-worker.js", [this](HttpRequest& req, HttpResponse& res) {
+      serveSdFile(req, res, "/service-worker.js", "application/javascript", "no-cache");
   });
-  
-  server.on("/icon-192.png", HTTP_GET, [this]() {
-      File f = SD.open("/icon-192.png");
-      if (f) {
-          server.streamFile(f, "image/png");
-          f.close();
-      } else {
-          server.send(404, "text/plain", "icon-192.png not found");
-      }
+  on("/icon-192.png", [this](HttpRequest& req, HttpResponse& res) {
+      serveSdFile(req, res, "/icon-192.png", "image/png", "max-age=86400");
   });
-  
-  server.on("/icon-512.png", HTTP_GET, [this]() {
-      File f = SD.open("/icon-512.png");
-      if (f) {
-          server.streamFile(f, "image/png");
-          f.close();
-      } else {
-          server.send(404, "text/plain", "icon-512.png not found");
-      }
+  on("/icon-512.png", [this](HttpRequest& req, HttpResponse& res) {
+      serveSdFile(req, res, "/icon-512.png", "image/png", "max-age=86400");
+  });
+  // Not behind auth: scrapers poll it, and it holds no user data
+  on("/metrics", [this](HttpRequest& req, HttpResponse& res) {
+      handleMetrics(req, res);
+  });
+  // Last report written by the benchmark firmware (env:bench)
+  on("/bench.json", [this](HttpRequest& req, HttpResponse& res) {
+      if (!checkAuth(req, res)) return;
+      serveSdFile(req, res, "/bench.json", "application/json", "no-cache");
   });
-  
-  
 
-    server.begin();
-    Serial.println("🌐 HTTP Server started");
+    if (server.begin(80)) {
+        Serial.printf("🌐 HTTP Server started (%d connections)\n", HTTP_MAX_CONNECTIONS);
+    } else {
+        Serial.println("❌ HTTP Server failed to start");
+    }
+}
+
+// Every route goes through here so it gets a latency histogram at /metrics,
+// timed from dispatch until the last byte of the response is on the socket:
+// paged bodies are produced after the handler returns
+void WebServerManager::on(const char* uri, HttpServer::Handler handler, uint8_t methods) {
+    MetricHistogram& latency = metrics_histogram(METRIC_HTTP_REQUEST, "route", uri);
+    server.on(uri, [&latency, handler](HttpRequest& req, HttpResponse& res) {
+        int64_t start = esp_timer_get_time();
+        res.onComplete([&latency, start] { latency.observe((uint32_t)(esp_timer_get_time() - start)); });
+        handler(req, res);
+    }, methods);
+}
+
+// Same for uploads, timed from the head to the answer after the last byte
+void WebServerManager::onUpload(const char* uri, HttpServer::UploadHandler handler) {
+    MetricHistogram& latency = metrics_histogram(METRIC_HTTP_REQUEST, "route", uri);
+    class TimedSink : public HttpBodySink {
+    public:
+        TimedSink(MetricHistogram& latency, std::unique_ptr<HttpBodySink> sink)
+            : timer(latency), sink(std::move(sink)) {}
+        bool write(const char* data, size_t len) override { return sink->write(data, len); }
+        void finish(HttpResponse& res) override { sink->finish(res); }
+
+    private:
+        MetricTimer                   timer;
+        std::unique_ptr<HttpBodySink> sink;
+    };
+    server.onUpload(uri, [&latency, handler](HttpRequest& req, HttpResponse& res) -> std::unique_ptr<HttpBodySink> {
+        std::unique_ptr<HttpBodySink> sink = handler(req, res);
+        if (!sink) return nullptr;
+        return std::unique_ptr<HttpBodySink>(new TimedSink(latency, std::move(sink)));
+    });
+}
+
+// Rows go from sqlite3_step() into the response a page at a time; each page
+// is a fresh keyset query, so no read transaction outlives a page
+void WebServerManager::handleFoods(HttpRequest& req, HttpResponse& res) {
+    class FoodsBody : public JsonPagedBody {
+        bool nextPage(JsonWriter& json) override {
+            if (lastId == 0) json.beginArray();
+            int next = foodManager.forEachFoodColor(lastId, FOODS_PAGE_ROWS, [&](const char* name, const char* color) {
+                json.beginObject();
+                json.key("name").value(name);
+                json.key("color").value(color);
+                json.endObject();
+            });
+            if (next == lastId) {
+                json.endArray();
+                return false;
+            }
+            lastId = next;
+            return true;
+        }
+
+        int lastId = 0;
+    };
+    res.sendBody(200, "application/json", std::unique_ptr<HttpBodySource>(new FoodsBody()));
+}
+
+// Prometheus text exposition, a few series per page like /foods
+void WebServerManager::handleMetrics(HttpRequest& req, HttpResponse& res) {
+    class MetricsBody : public PagedBody {
+        bool nextPage() override {
+            next = metrics_write(appendTo, this, next, METRICS_PAGE_SERIES);
+            return next != 0;
+        }
+
+        size_t next = 0;
+    };
+    res.sendBody(200, "text/plain; version=0.0.4", std::unique_ptr<HttpBodySource>(new MetricsBody()));
 }
 
 void WebServerManager::handle() {
-    server.handleClient();
+    server.poll();
 }
 
-bool WebServerManager::checkAuth() {
-  if (server.authenticate(AUTH_USER, AUTH_PASS)) {
+bool WebServerManager::checkAuth(HttpRequest& req, HttpResponse& res) {
+  if (req.authenticate(AUTH_USER, AUTH_PASS)) {
       return true;
   }
-  server.requestAuthentication();  // Basic Auth
+  res.requestAuthentication();  // Basic Auth
   return false;
 }
 
@@ -229,11 +374,39 @@ WiFi.softAP("KitchenScale", "12345678", 6, 0, 1);  // Good channel, 1 client
 
 
 void WebServerManager::syncTime() {
-    configTzTime("CET-1CEST,M3.5.0/2,M10.5.0/3", "pool.ntp.org");
+    configTzTime(LOCAL_TIMEZONE, "pool.ntp.org");
     Serial.println("🔄 NTP time sync requested.");
 }
 
+// Every logged spectrum is a labelled reference for the classifier
+void WebServerManager::loadClassifier() {
+    File file = SD.open("/spectrum_log.csv");
+    if (!file) {
+        Serial.println("ℹ️ No /spectrum_log.csv yet, classifier starts empty");
+        return;
+    }
+
+    // Only the newest references fit, so skip to the tail that holds them;
+    // add() keeps the last SPECTRAL_MAX_REFERENCES of what is read
+    char line[160];
+    size_t tail = SPECTRAL_MAX_REFERENCES * sizeof(line);
+    if (file.size() > tail) {
+        file.seek(file.size() - tail);
+        file.readBytesUntil('\n', line, sizeof(line) - 1);   // partial line
+    }
+    while (file.available()) {
+        size_t n = file.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[n] = '\0';
+        classifier.addCsvLine(line);
+    }
+    file.close();
+    Serial.printf("🌈 Classifier: %u references, %u foods\n",
+                  (unsigned)classifier.referenceCount(), (unsigned)classifier.labelCount());
+}
+
 void WebServerManager::logSpectrumEntry(const String& foodName, float weight, const String& color, const Spectrum& spectrum) {
+    static MetricHistogram& sdWrite = metrics_histogram(METRIC_SD_WRITE, "op", "spectrum_log");
+    MetricTimer timer(sdWrite);
     const char* fileName = "/spectrum_log.csv";
 
     // Create CSV if needed
@@ -265,414 +438,521 @@ void WebServerManager::logSpectrumEntry(const String& foodName, float weight, co
 }
 
 String FoodManager::getColorForFood(const String& foodName) {
+    Guard guard(*this);
     auto it = foodColorMap.find(foodName);
     return (it != foodColorMap.end()) ? it->second : "";
 }
 
 
-void WebServerManager::handleSelect() {
-    if (!server.hasArg("food") || !server.hasArg("color")) {
-        server.send(400, "text/plain", "Missing parameters");
+void WebServerManager::handleSelect(HttpRequest& req, HttpResponse& res) {
+    if (!req.hasArg("food") || !req.hasArg("color")) {
+        res.send(400, "text/plain", "Missing parameters");
         return;
     }
 
-    String foodName = server.arg("food");
-    String colorName = server.arg("color");
+    String foodName = req.arg("food");
+    String colorName = req.arg("color");
+
+    // The app task checks the weight has settled, updates the totals and
+    // queues the log row; this task only waits for its verdict
+    AppCommand cmd = app_command(CMD_LOG_FOOD, foodName.c_str(), colorName.c_str());
+    AppReply reply = app_request(cmd, appReply);
+
+    switch (reply.result) {
+        case APP_OK:
+            break;
+        case APP_NOT_SETTLED:
+            res.send(409, "text/plain", "⏳ Weight not settled yet");
+            return;
+        case APP_INVALID_WEIGHT:
+            res.send(400, "text/plain", "Invalid weight");
+            return;
+        case APP_FOOD_NOT_FOUND:
+            res.send(404, "text/plain", "❌ Food not found");
+            return;
+        default:
+            res.send(503, "text/plain", "⏳ Scale busy, try again");
+            return;
+    }
 
-    if (weight <= 0) {
-        server.send(400, "text/plain", "Invalid weight");
-        return;
+    // The user just told us what is on the scale: keep the spectrum for training
+    AppSnapshot state;
+    app_getSnapshot(state);
+    if (spectrumIsFresh(state)) {
+        logSpectrumEntry(state.foodName, reply.grams, colorName, state.spectrum);
+        if (!classifier.add(state.foodName, state.spectrum.data()))
+            Serial.println("⚠️ Spectrum too dark to learn from");
     }
 
-    sqlite3* db = foodManager.getDatabaseHandle();
-    const char* query = "SELECT food_id, calories, protein, carbs, fat FROM Food WHERE name = ?";
-    sqlite3_stmt* stmt;
+    res.send(200, "text/plain", ("✅ Logged " + String(reply.grams) + "g of " + foodName).c_str());
+}
+
+// Hands-free logging: every item put on the scale from now on is logged as
+// `food`; no food (or an empty one) stops it
+void WebServerManager::handleAutoLog(HttpRequest& req, HttpResponse& res) {
+    const char* food = req.arg("food");
+    AppCommand cmd = app_command(CMD_AUTO_LOG, food, req.arg("color"));
+    AppReply reply = app_request(cmd, appReply);
+
+    switch (reply.result) {
+        case APP_OK:
+            break;
+        case APP_FOOD_NOT_FOUND:
+            res.send(404, "text/plain", "❌ Food not found");
+            return;
+        default:
+            res.send(503, "text/plain", "⏳ Scale busy, try again");
+            return;
+    }
+
+    if (*food) res.send(200, "text/plain", ("🤚 Logging every item as " + String(food)).c_str());
+    else res.send(200, "text/plain", "🤚 Hands-free logging off");
+}
 
-    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-        server.send(500, "text/plain", "DB query error");
+
+// Top-N prefix matches from the in-RAM catalogue index
+void WebServerManager::handleSearch(HttpRequest& req, HttpResponse& res) {
+    const char* query = req.arg("q");
+    int limit = req.hasArg("limit") ? atoi(req.arg("limit")) : 10;
+    if (limit < 1) limit = 1;
+    if (limit > 32) limit = 32;
+
+    // Entries point into the index: hold the lock until they are written out
+    FoodManager::Guard guard(foodManager);
+    const FoodIndex& index = foodManager.getIndex();
+    const FoodIndexEntry* results[32];
+    size_t count = index.search(query, results, limit);
+
+    JsonResponse json;
+    json.beginArray();
+    for (size_t i = 0; i < count; ++i) {
+        const FoodIndexEntry& e = *results[i];
+        json.beginObject();
+        json.key("name").value(index.name(e));
+        json.key("calories").value(e.per100g.calories);
+        json.key("protein").value(e.per100g.protein);
+        json.key("carbs").value(e.per100g.carbs);
+        json.key("fat").value(e.per100g.fat);
+        json.endObject();
+    }
+    json.endArray();
+    json.send(res);
+}
+
+
+void WebServerManager::handleClassify(HttpRequest& req, HttpResponse& res) {
+    AppSnapshot state;
+    app_getSnapshot(state);
+    if (!spectrumIsFresh(state)) {
+        res.send(503, "text/plain", "⏳ No current spectrum");
         return;
     }
 
-    sqlite3_bind_text(stmt, 1, foodName.c_str(), -1, SQLITE_TRANSIENT);
-
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-      int food_id      = sqlite3_column_int(stmt, 0);
-      float kcal       = sqlite3_column_double(stmt, 1);
-      float prot       = sqlite3_column_double(stmt, 2);
-      float carbs      = sqlite3_column_double(stmt, 3);
-      float fat        = sqlite3_column_double(stmt, 4);
-      sqlite3_finalize(stmt);
-
-      float factor = weight / 100.0;
-      float cal = kcal * factor;
-      float p   = prot * factor;
-      float c   = carbs * factor;
-      float f   = fat * factor;
-
-      // Update in-memory daily totals
-      dailyTotals.calories += cal;
-      dailyTotals.protein  += p;
-      dailyTotals.carbs    += c;
-      dailyTotals.fat      += f;
-
-      // Timestamp
-      String timestamp = "offline";
-      if (timeSynced && WiFi.status() == WL_CONNECTED) {
-          time_t now = time(nullptr);
-          struct tm tm;
-          localtime_r(&now, &tm);
-          char buf[25];
-          strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
-          timestamp = buf;
-      }
+    SpectralCandidate candidates[SPECTRAL_MAX_CANDIDATES];
+    uint32_t start = micros();
+    size_t n = classifier.classify(state.spectrum.data(), candidates, SPECTRAL_MAX_CANDIDATES);
+    uint32_t elapsed = micros() - start;
+
+    JsonResponse json;
+    json.beginObject();
+    json.key("age_ms").value((int32_t)(millis() - state.spectrumAt));
+    json.key("classify_us").value((int32_t)elapsed);
+    json.key("candidates").beginArray();
+    for (size_t i = 0; i < n; ++i) {
+        json.beginObject();
+        json.key("food").value(classifier.label(candidates[i].label));
+        json.key("confidence").value(candidates[i].confidence, 3);
+        json.key("distance").value((int64_t)candidates[i].distance);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    json.send(res);
+}
 
-      // Insert into LogEntry
-      const char* insertSQL = "INSERT INTO LogEntry (timestamp, food_id, grams, calories, protein, carbs, fat) VALUES (?, ?, ?, ?, ?, ?, ?)";
-      sqlite3_stmt* logStmt;
-      if (sqlite3_prepare_v2(db, insertSQL, -1, &logStmt, nullptr) == SQLITE_OK) {
-          sqlite3_bind_text(logStmt, 1, timestamp.c_str(), -1, SQLITE_TRANSIENT);
-          sqlite3_bind_int(logStmt, 2, food_id);
-          sqlite3_bind_double(logStmt, 3, weight);
-          sqlite3_bind_double(logStmt, 4, cal);
-          sqlite3_bind_double(logStmt, 5, p);
-          sqlite3_bind_double(logStmt, 6, c);
-          sqlite3_bind_double(logStmt, 7, f);
-          sqlite3_step(logStmt);
-          sqlite3_finalize(logStmt);
-      }
 
-      // Update ColorMap
-      const char* colorSQL = "REPLACE INTO ColorMap (food_id, color_name) VALUES (?, ?)";
-      sqlite3_stmt* colorStmt;
-      if (sqlite3_prepare_v2(db, colorSQL, -1, &colorStmt, nullptr) == SQLITE_OK) {
-          sqlite3_bind_int(colorStmt, 1, food_id);
-          sqlite3_bind_text(colorStmt, 2, colorName.c_str(), -1, SQLITE_TRANSIENT);
-          sqlite3_step(colorStmt);
-          sqlite3_finalize(colorStmt);
-      }
+// Flash assets are gzip blobs generated from web/ at build time
+// (tools/build_web_assets.py). Every browser we serve accepts gzip, so the
+// bytes go out as-is; a matching If-None-Match gets an empty 304.
+bool WebServerManager::notModified(HttpRequest& req, HttpResponse& res, const char* etag) {
+    res.sendHeader("ETag", etag);
+    if (strcmp(req.header("If-None-Match"), etag) != 0) return false;
+    res.send(304);
+    return true;
+}
+
+void WebServerManager::handleAsset(HttpRequest& req, HttpResponse& res, const WebAsset& asset) {
+    res.sendHeader("Cache-Control", "no-cache");  // revalidate, usually a 304
+    if (notModified(req, res, asset.etag)) return;
+    res.sendHeader("Content-Encoding", "gzip");
+    res.sendStatic(200, asset.contentType, asset.gzipData, asset.gzipLength);
+}
 
-      // Update Display
-      currentFood.name     = foodName;
-      currentFood.calories = kcal;
-      currentFood.protein  = prot;
-      currentFood.carbs    = carbs;
-      currentFood.fat      = fat;
+// SD files change without a rebuild, so their validator is size + mtime
+void WebServerManager::serveSdFile(HttpRequest& req, HttpResponse& res, const char* path, const char* contentType,
+                                   const char* cacheControl) {
+    File f = SD.open(path);
+    if (!f) {
+        res.send(404, "text/plain", (String(path + 1) + " not found").c_str());
+        return;
+    }
 
-      lastTimestamp = timestamp;  // 🟡 Save for display
+    char etag[32];
+    snprintf(etag, sizeof(etag), "\"%x-%lx\"", (unsigned)f.size(), (unsigned long)f.getLastWrite());
+    res.sendHeader("Cache-Control", cacheControl);
+    if (notModified(req, res, etag)) {
+        f.close();
+        return;
+    }
+    size_t size = f.size();
+    res.sendBody(200, contentType, std::unique_ptr<HttpBodySource>(new FileBody(f)), size);
+}
 
-      displayManager.updateDisplay(weight, &currentFood, dailyTotals, timestamp, colorName);
 
-      server.send(200, "text/plain", "✅ Logged " + String(weight) + "g of " + foodName);
-      needDisplayUpdate = true;
-    } else {
-        sqlite3_finalize(stmt);
-        server.send(404, "text/plain", "❌ Food not found");
-    }
-}
-
-
-void WebServerManager::handleRoot() {
-    String html = R"rawliteral(
-<!DOCTYPE html>
-<html>
-<head>
-  <meta charset='utf-8'>
-  <title>Smart Kitchen Scale</title>
-  <script src='https://cdn.jsdelivr.net/npm/chart.js'></script>
-  <style>
-    body { font-family: Arial, sans-serif; margin: 20px; background-color: #f0f8ff; }
-    h1 { color: #333; }
-    select, input[type='text'], input[type='number'], button {
-      padding: 12px; margin-bottom: 10px; font-size: 18px; border-radius: 5px; border: none;
-    }
-    button { background-color: #4CAF50; color: white; }
-    button:hover { background-color: #45a049; }
-    pre { background-color: #e0f7fa; padding: 10px; border-radius: 5px; }
-    #toast {
-      visibility: hidden; min-width: 250px; background-color: #4CAF50; color: white;
-      text-align: center; border-radius: 5px; padding: 16px; position: fixed;
-      z-index: 1; left: 50%; bottom: 30px; transform: translateX(-50%); font-size: 17px;
-    }
-    #toast.show { visibility: visible; animation: fadein 0.5s, fadeout 0.5s 2.5s; }
-    @keyframes fadein { from { bottom: 0; opacity: 0; } to { bottom: 30px; opacity: 1; } }
-    @keyframes fadeout { from { bottom: 30px; opacity: 1; } to { bottom: 0; opacity: 0; } }
-    .controls { display: flex; flex-wrap: wrap; gap: 10px; align-items: center; margin-bottom: 20px; }
-    .controls select, .controls input { flex: 1; min-width: 150px; }
-    .daily-container { display: flex; flex-wrap: wrap; align-items: center; gap: 20px; margin-top: 20px; }
-  </style>
-</head>
-<body>
-  <h1>Smart Kitchen Scale</h1>
-  <h2>Current Weight: <span id='liveWeight'>0g</span></h2>
-  <button id="tareBtn">Tare Scale</button>
-
-  <div class='controls'>
-    <select id='sortSelect' onchange='sortFoods()'>
-      <option value='newest'>Newest Added</option>
-      <option value='oldest'>Oldest Added</option>
-      <option value='most'>Most Selected</option>
-      <option value='least'>Least Selected</option>
-    </select>
-    <input type='text' id='searchInput' oninput='sortFoods()' placeholder='Search food.'>
-  </div>
-
-  <div id='foodList'></div>
-
-  <h2>Add New Food</h2>
-  <input type='text' id='newName' placeholder='Name (e.g. Apple)'>
-  <input type='number' id='newProtein' placeholder='Protein per 100g' oninput='calculateCalories()'>
-  <input type='number' id='newCarbs' placeholder='Carbs per 100g' oninput='calculateCalories()'>
-  <input type='number' id='newFat' placeholder='Fat per 100g' oninput='calculateCalories()'>
-  <input type='number' id='newCalories' placeholder='Calories per 100g' readonly>
-  <button onclick='submitNewFood()'>Add New Food</button>
-
-  <h2>Daily Totals</h2>
-  <div class='daily-container'>
-    <div id='dailyTotals'>Loading...</div>
-    <canvas id='macroChart' width='250' height='250'></canvas>
-  </div>
-
-  <h2>Reset Daily Totals</h2>
-  <button onclick='resetTotals()'>Reset Totals</button>
-
-  <h2>Status:</h2><pre id='status'>Select, add, or delete a food</pre>
-  <div id='toast'></div>
-
-  <script>
-    var foods = [];
-    var ws, macroChart;
-
-    window.addEventListener("load", () => {
-      document.getElementById('tareBtn').onclick = () => ws.send("tare");
-    });
 
-    function startWebSocket() {
-      ws = new WebSocket('ws://' + location.hostname + ':81');
-      ws.onmessage = function(event) {
-        document.getElementById('liveWeight').innerText = event.data + 'g';
-      };
-      ws.onclose = function() { setTimeout(startWebSocket, 2000); };
-    }
-
-    function fetchFoods() {
-      fetch('/foods')
-        .then(r => r.json())
-        .then(data => {
-          foods = data.map((f, i) => Object.assign(f, {usage: 0, order: i}));
-          sortFoods();
-        });
-    }
-
-    function sortFoods() {
-      var mode = document.getElementById('sortSelect').value;
-      if (mode == 'newest') foods.sort((a,b)=>b.order-a.order);
-      if (mode == 'oldest') foods.sort((a,b)=>a.order-b.order);
-      if (mode == 'most') foods.sort((a,b)=>b.usage-a.usage);
-      if (mode == 'least') foods.sort((a,b)=>a.usage-b.usage);
-      showFoods();
-    }
-
-    function showFoods() {
-      var container = document.getElementById('foodList');
-      var query = document.getElementById('searchInput').value.toLowerCase();
-      container.innerHTML = '';
-      foods.forEach(function(f, idx) {
-        if (f.name.toLowerCase().includes(query)) {
-          var wrapper = document.createElement('div');
-          wrapper.style.display = 'flex';
-          wrapper.style.alignItems = 'center';
-          wrapper.style.marginBottom = '10px';
-
-          var btn = document.createElement('button');
-          btn.className = 'foodButton';
-          btn.innerText = f.name;
-          btn.style.flex = '1';
-          btn.onclick = function() { logFood(f); };
-
-          var del = document.createElement('button');
-          del.innerText = '❌';
-          del.style.backgroundColor = '#f44336';
-          del.style.marginLeft = '10px';
-          del.onclick = function() { confirmDelete(f.name, idx); };
-
-          wrapper.appendChild(btn);
-          wrapper.appendChild(del);
-          container.appendChild(wrapper);
+void WebServerManager::handleDaily(HttpRequest& req, HttpResponse& res) {
+    AppSnapshot state;
+    app_getSnapshot(state);
+    JsonResponse json;
+    json.beginObject();
+    json.key("calories").value(state.totals.calories);
+    json.key("protein").value(state.totals.protein);
+    json.key("carbs").value(state.totals.carbs);
+    json.key("fat").value(state.totals.fat);
+    json.endObject();
+    json.send(res);
+}
+
+// /history?from=<epoch>&to=<epoch>&bucket=meal|day|week, totals per bucket
+// over the local days the range touches. Served from the rollups a page at
+// a time like /foods:
+//   {"bucket":"day","from":20260101,"to":20260331,"rows":[
+//     {"day":20260101,"t":1767222000,"calories":1830.5,...,"entries":9},...]}
+// Meal rows add "meal"; week rows are Monday to Sunday, keyed by the Monday.
+void WebServerManager::handleHistory(HttpRequest& req, HttpResponse& res) {
+    int64_t to = -1, from = -1;
+    if (!integerArg(req, "to", to) || !integerArg(req, "from", from)) {
+        res.send(400, "text/plain", "from and to are epoch seconds");
+        return;
+    }
+    if (to < 0) {
+        // Only the default needs the clock
+        to = time(nullptr);
+        if (to < 24 * 3600) {
+            res.send(503, "text/plain", "⏳ Clock not synced yet");
+            return;
         }
-      });
+    } else if (to < 24 * 3600 || to > INT32_MAX) {
+        res.send(400, "text/plain", "to is out of range");
+        return;
+    }
+    if (from < 0) from = to - (HISTORY_DEFAULT_DAYS - 1) * 24 * 3600;
+    if (from > to) {
+        res.send(400, "text/plain", "from is after to");
+        return;
     }
 
-    function logFood(foodObj) {
-      const text = document.getElementById('liveWeight').innerText;
-      const grams = parseFloat(text);
-      
-      if (isNaN(grams)) {
-        alert('Invalid weight.');
+    const char* name = req.arg("bucket");
+    HistoryBucket bucket;
+    if (strcmp(name, "meal") == 0) bucket = HISTORY_MEAL;
+    else if (strcmp(name, "day") == 0) bucket = HISTORY_DAY;
+    else if (strcmp(name, "week") == 0) bucket = HISTORY_WEEK;
+    else if (!*name) bucket = to - from < HISTORY_AUTO_DAYS * 24 * 3600 ? HISTORY_DAY : HISTORY_WEEK;
+    else {
+        res.send(400, "text/plain", "bucket is meal, day or week");
         return;
-      }
-      
-      let color = foodObj.color || prompt('What color is the food (e.g. red, green)?');
-      if (!color) return;
-
-      fetch(
-        `/select?food=${encodeURIComponent(foodObj.name)}` +
-        `&grams=${grams}` +
-        `&color=${encodeURIComponent(color.toLowerCase())}`)
-        .then(r => r.text())
-        .then(t => {
-          document.getElementById('status').innerText = t;
-          updateDailyTotals();
-          showToast('✅ Food logged!');
-        })
-        .catch(_ => {
-          document.getElementById('status').innerText = 'Error logging food';
-          showToast('❌ Error');
-        });
-    }
-
-    function updateDailyTotals() {
-      fetch('/daily')
-        .then(r => r.json())
-        .then(data => {
-          var div = document.getElementById('dailyTotals');
-          div.innerHTML = 'Calories: ' + data.calories.toFixed(0) + ' kcal<br>' +
-                          'Protein: ' + data.protein.toFixed(0) + ' g<br>' +
-                          'Carbs: ' + data.carbs.toFixed(0) + ' g<br>' +
-                          'Fat: ' + data.fat.toFixed(0) + ' g';
-          var { protein, carbs, fat } = data;
-          if (protein === 0 && carbs === 0 && fat === 0) {
-            macroChart.data.datasets[0].data = [1];
-            macroChart.data.datasets[0].backgroundColor = ['#cccccc'];
-            macroChart.data.labels = ['Empty'];
-          } else {
-            macroChart.data.datasets[0].data = [protein, carbs, fat];
-            macroChart.data.datasets[0].backgroundColor = ['#4CAF50', '#2196F3', '#FFC107'];
-            macroChart.data.labels = ['Protein', 'Carbs', 'Fat'];
-          }
-          macroChart.update();
-        });
-    }
-
-    function resetTotals() {
-      fetch('/reset')
-        .then(r => r.text())
-        .then(t => {
-          document.getElementById('status').innerText = t;
-          updateDailyTotals();
-          showToast('✅ Totals reset!');
-        });
-    }
-
-    function confirmDelete(name, index) {
-      if (confirm('Are you sure you want to delete ' + name + '?')) {
-        fetch('/deletefood?name=' + encodeURIComponent(name))
-          .then(r => r.text())
-          .then(t => {
-            document.getElementById('status').innerText = t;
-            foods.splice(index, 1);
-            showFoods();
-            showToast('✅ Deleted');
-          });
-      }
     }
 
-    function submitNewFood() {
-      let n = document.getElementById('newName').value.trim(),
-          p = document.getElementById('newProtein').value.trim(),
-          c = document.getElementById('newCarbs').value.trim(),
-          f = document.getElementById('newFat').value.trim(),
-          cal = document.getElementById('newCalories').value.trim();
-      if (n && p && c && f && cal) {
-        let q = '/addfood?name=' + encodeURIComponent(n) + '&protein=' + p + '&carbs=' + c + '&fat=' + f + '&calories=' + cal;
-        fetch(q).then(r => r.text()).then(t => {
-          document.getElementById('status').innerText = t;
-          fetchFoods();
-          clearNewFoodForm();
-          showToast('✅ Added');
-        });
-      } else {
-        showToast('⚠️ Fill all fields');
-      }
+    // Entries still queued for the card belong in the answer
+    foodManager.flushLogQueue();
+
+    class HistoryBody : public JsonPagedBody {
+    public:
+        HistoryBody(HistoryBucket bucket, int32_t fromDay, int32_t toDay) {
+            query.bucket  = bucket;
+            query.fromDay = fromDay;
+            query.toDay   = toDay;
+        }
+
+    private:
+        bool nextPage(JsonWriter& json) override {
+            if (!started) {
+                static const char* const bucketNames[] = {"meal", "day", "week"};
+                json.beginObject();
+                json.key("bucket").value(bucketNames[query.bucket]);
+                json.key("from").value(query.fromDay);
+                json.key("to").value(query.toDay);
+                json.key("rows").beginArray();
+                started = true;
+            }
+
+            size_t n = foodManager.readHistory(query, rows, HISTORY_PAGE_ROWS);
+            for (size_t i = 0; i < n; ++i) {
+                const HistoryRow& row = rows[i];
+                json.beginObject();
+                json.key("day").value(row.day);
+                json.key("t").value((int64_t)FoodManager::dayStart(row.day));
+                if (query.bucket == HISTORY_MEAL) json.key("meal").value(meal_name(row.meal));
+                json.key("calories").value(row.totals.calories, 1);
+                json.key("protein").value(row.totals.protein, 1);
+                json.key("carbs").value(row.totals.carbs, 1);
+                json.key("fat").value(row.totals.fat, 1);
+                json.key("entries").value(row.entries);
+                json.endObject();
+            }
+            if (n < HISTORY_PAGE_ROWS && query.bucket != HISTORY_WEEK) n = 0;   // a short page was the last
+            if (n == 0) {
+                json.endArray();
+                json.endObject();
+                return false;
+            }
+            return true;
+        }
+
+        HistoryQuery query;
+        HistoryRow   rows[HISTORY_PAGE_ROWS];
+        bool         started = false;
+    };
+    res.sendBody(200, "application/json", std::unique_ptr<HttpBodySource>(
+        new HistoryBody(bucket, FoodManager::dayKey(from), FoodManager::dayKey(to))));
+}
+
+// /export.csv, /export.ndjson or /export.bin?from=<epoch>&to=<epoch>&after=<log_id>:
+// the food log with food names, in log_id order (formats in LogExport.h).
+// Chunked and a page at a time like /foods, so any range streams in fixed
+// memory. Every row carries its log_id; after resumes a cut-off download
+// past the last one received. Without from the rows logged before the
+// clock synced are included.
+void WebServerManager::handleExport(HttpRequest& req, HttpResponse& res, ExportFormat format) {
+    ExportQuery query;
+    if (!integerArg(req, "from", query.from) || !integerArg(req, "to", query.to) ||
+        !integerArg(req, "after", query.afterId)) {
+        res.send(400, "text/plain", "from and to are epoch seconds, after a log_id");
+        return;
     }
+    if (query.from > query.to) {
+        res.send(400, "text/plain", "from is after to");
+        return;
+    }
+
+    // Entries still queued for the card belong in the answer
+    foodManager.flushLogQueue();
+
+    class ExportBody : public PagedBody {
+    public:
+        ExportBody(ExportFormat format, const ExportQuery& query)
+            : query(query), out(format, buffer, sizeof(buffer), appendTo, this) {}
+
+    private:
+        bool nextPage() override {
+            if (!started) {
+                out.begin();
+                started = true;
+            }
+            size_t n = foodManager.forEachLogEntry(query, EXPORT_PAGE_ROWS,
+                                                   [&](const LogExportRow& row) { out.row(row); });
+            if (n < EXPORT_PAGE_ROWS) {
+                out.end();
+                return false;
+            }
+            out.flush();
+            return true;
+        }
+
+        ExportQuery     query;
+        char            buffer[512];
+        LogExportWriter out;
+        bool            started = false;
+    };
 
-    function calculateCalories() {
-      var p = parseFloat(document.getElementById('newProtein').value) || 0,
-          c = parseFloat(document.getElementById('newCarbs').value) || 0,
-          f = parseFloat(document.getElementById('newFat').value) || 0;
-      document.getElementById('newCalories').value = (p*4 + c*4 + f*9).toFixed(1);
+    static const char* const fileNames[] = {
+        "attachment; filename=\"food_log.csv\"",
+        "attachment; filename=\"food_log.ndjson\"",
+        "attachment; filename=\"food_log.bin\"",
+    };
+    res.sendHeader("Content-Disposition", fileNames[format]);
+    res.sendBody(200, LogExportWriter::contentType(format),
+                 std::unique_ptr<HttpBodySource>(new ExportBody(format, query)));
+}
+
+void WebServerManager::handleReset(HttpRequest& req, HttpResponse& res) {
+    if (!app_post(app_command(CMD_RESET_TOTALS))) {
+        res.send(503, "text/plain", "⏳ Scale busy, try again");
+        return;
     }
+    res.send(200, "text/plain", "✅ Daily totals reset");
+}
 
-    function clearNewFoodForm() {
-      ['newName','newProtein','newCarbs','newFat','newCalories'].forEach(id => document.getElementById(id).value = '');
+// /tare (push), /tare?op=pop, /tare?op=clear or /tare?container=<name>;
+// answers with the tare stack as it is afterwards
+void WebServerManager::handleTare(HttpRequest& req, HttpResponse& res) {
+    const char* op = req.arg("op");
+    AppCommand cmd = app_command(CMD_TARE);
+    if (req.hasArg("container")) cmd = app_command(CMD_RECALL_CONTAINER, req.arg("container"));
+    else if (strcmp(op, "pop") == 0) cmd = app_command(CMD_UNTARE);
+    else if (strcmp(op, "clear") == 0) cmd = app_command(CMD_CLEAR_TARE);
+    else if (*op && strcmp(op, "push") != 0) {
+        res.send(400, "text/plain", "op is push, pop or clear");
+        return;
     }
 
-    function showToast(msg) {
-      var t = document.getElementById('toast');
-      t.innerText = msg;
-      t.className = 'show';
-      setTimeout(() => { t.className = ''; }, 3000);
+    AppReply reply = app_request(cmd, appReply);
+    switch (reply.result) {
+        case APP_OK:
+            break;
+        case APP_CONTAINER_NOT_FOUND:
+            res.send(404, "text/plain", "❌ Container not found");
+            return;
+        case APP_TARE_LIMIT:
+            res.send(409, "text/plain", cmd.type == CMD_TARE ? "Tare stack full" : "No tare to undo");
+            return;
+        default:
+            res.send(503, "text/plain", "⏳ Scale busy, try again");
+            return;
     }
 
-    window.onload = function() {
-      startWebSocket();
-      fetchFoods();
-      updateDailyTotals();
-      var ctx = document.getElementById('macroChart').getContext('2d');
-      macroChart = new Chart(ctx, {
-        type: 'pie',
-        data: { labels: [], datasets: [{ data: [], backgroundColor: [] }] },
-        options: { responsive: false, plugins: { legend: { position: 'bottom' } } }
-      });
-    };
-  </script>
-</body>
-</html>
-)rawliteral";
+    AppSnapshot state;
+    app_getSnapshot(state);
+    JsonResponse json;
+    json.beginObject();
+    json.key("tare").value(state.tareGrams, 1);
+    json.key("depth").value((int32_t)state.tareDepth);
+    json.key("container").value(state.container);
+    json.key("grams").value(state.reading.grams, 1);
+    json.endObject();
+    json.send(res);
+}
 
-    server.send(200, "text/html", html);
+void WebServerManager::handleContainers(HttpRequest& req, HttpResponse& res) {
+    JsonResponse json;
+    json.beginArray();
+    ContainerItem container;
+    for (size_t i = 0; foodManager.containerAt(i, container); ++i) {
+        json.beginObject();
+        json.key("name").value(container.name);
+        json.key("grams").value(container.tareGrams, 1);
+        json.endObject();
+    }
+    json.endArray();
+    json.send(res);
 }
 
+// Saves `grams`, or else whatever is on the platform now: put the empty
+// bowl on and save it
+void WebServerManager::handleSaveContainer(HttpRequest& req, HttpResponse& res) {
+    const char* name = req.arg("name");
+    if (!*name || strlen(name) >= TARE_LABEL_MAX) {
+        res.send(400, "text/plain", "Missing or too long name");
+        return;
+    }
+
+    float grams;
+    if (req.hasArg("grams")) {
+        grams = atof(req.arg("grams"));
+    } else {
+        AppSnapshot state;
+        app_getSnapshot(state);
+        if (!state.reading.stable) {
+            res.send(409, "text/plain", "⏳ Weight not settled yet");
+            return;
+        }
+        grams = state.reading.grams + state.tareGrams;
+    }
+    if (grams <= 0) {
+        res.send(400, "text/plain", "Invalid weight");
+        return;
+    }
 
+    if (!foodManager.saveContainer(name, grams)) {
+        if (foodManager.containerCount() >= CONTAINER_MAX) res.send(409, "text/plain", "❌ Container library full");
+        else res.send(500, "text/plain", "❌ Could not save container");
+        return;
+    }
+    res.send(200, "text/plain", ("✅ Saved " + String(name) + " (" + String(grams, 1) + "g)").c_str());
+}
 
-void WebServerManager::handleReset() {
-    dailyTotals = {0, 0, 0, 0};
-    currentFood.name = "";
-    currentFood.calories = 0;
-    currentFood.protein = 0;
-    currentFood.carbs = 0;
-    currentFood.fat = 0;
-    needDisplayUpdate = true;
-    server.send(200, "text/plain", "✅ Daily totals reset");
+void WebServerManager::handleDeleteContainer(HttpRequest& req, HttpResponse& res) {
+    if (!foodManager.deleteContainer(req.arg("name"))) {
+        res.send(404, "text/plain", "❌ Container not found");
+        return;
+    }
+    res.send(200, "text/plain", "✅ Container deleted");
 }
 
-void WebServerManager::handleAddFood() {
-    if (!server.hasArg("name") || !server.hasArg("calories") ||
-        !server.hasArg("protein") || !server.hasArg("carbs") || !server.hasArg("fat")) {
-        server.send(400, "text/plain", "Missing parameters");
+void WebServerManager::handleAddFood(HttpRequest& req, HttpResponse& res) {
+    if (!req.hasArg("name") || !req.hasArg("calories") ||
+        !req.hasArg("protein") || !req.hasArg("carbs") || !req.hasArg("fat")) {
+        res.send(400, "text/plain", "Missing parameters");
+        return;
+    }
+
+    FoodItem existing;
+    if (foodManager.findFood(req.arg("name"), existing)) {
+        res.send(409, "text/plain", (String("❌ Food already exists: ") + existing.name).c_str());
         return;
     }
+    if (!foodManager.addFood(
+            req.arg("name"),
+            atof(req.arg("calories")),
+            atof(req.arg("protein")),
+            atof(req.arg("carbs")),
+            atof(req.arg("fat")))) {
+        res.send(500, "text/plain", "❌ Failed to add food");
+        return;
+    }
+
+    res.send(200, "text/plain", (String("✅ Food added: ") + req.arg("name")).c_str());
+}
 
-    foodManager.addFood(
-        server.arg("name"),
-        server.arg("calories").toFloat(),
-        server.arg("protein").toFloat(),
-        server.arg("carbs").toFloat(),
-        server.arg("fat").toFloat()
-    );
+// POST /foods/import with a CSV body (see FoodCsv.h for the columns). The
+// body goes into the importer as it arrives, so the file can be any size;
+// the answer comes after the last row:
+//   {"rows":300000,"added":299870,"duplicates":130,"failed":0,"bytes":...,"ms":...,"rowsPerSec":...}
+std::unique_ptr<HttpBodySink> WebServerManager::handleImport(HttpRequest& req, HttpResponse& res) {
+    class ImportSink : public HttpBodySink {
+    public:
+        bool begin() { return importer.begin(); }
+        bool write(const char* data, size_t len) override { return importer.write(data, len); }
+
+        void finish(HttpResponse& res) override {
+            bool ok = importer.finish();
+            const ImportProgress& stats = importer.progress();
+            JsonResponse json;
+            json.beginObject();
+            json.key("rows").value((int32_t)stats.rows);
+            json.key("added").value((int32_t)stats.added);
+            json.key("duplicates").value((int32_t)stats.duplicates);
+            json.key("failed").value((int32_t)stats.failed);
+            json.key("bytes").value((int64_t)stats.bytes);
+            json.key("ms").value((int32_t)stats.elapsedMs);
+            json.key("rowsPerSec").value((int32_t)stats.rowsPerSecond());
+            if (!ok) json.key("error").value(importer.error());
+            json.endObject();
+            json.send(res, ok ? 200 : 422);
+        }
 
-    server.send(200, "text/plain", "✅ Food added: " + server.arg("name"));
+    private:
+        FoodImporter importer{foodManager};
+    };
+
+    std::unique_ptr<ImportSink> sink(new ImportSink());
+    if (!sink->begin()) {
+        res.send(409, "text/plain", "⏳ Another import is running");
+        return nullptr;
+    }
+    return sink;
 }
 
-void WebServerManager::handleDeleteFood() {
-    if (!server.hasArg("name")) {
-        server.send(400, "text/plain", "Missing food name");
+void WebServerManager::handleDeleteFood(HttpRequest& req, HttpResponse& res) {
+    if (!req.hasArg("name")) {
+        res.send(400, "text/plain", "❌ Missing 'name'");
         return;
     }
 
-    bool success = foodManager.deleteFood(server.arg("name"));
-    if (success) {
-        server.send(200, "text/plain", "✅ Food deleted");
+    String foodName = req.arg("name");
+    if (foodManager.deleteFood(foodName)) {
+        res.send(200, "text/plain", ("✅ Deleted " + foodName).c_str());
     } else {
-        server.send(404, "text/plain", "❌ Food not found");
+        res.send(404, "text/plain", ("❌ Food not found: " + foodName).c_str());
     }
 }
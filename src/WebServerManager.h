@@ -1,36 +1,80 @@
 #pragma once
 #include <Arduino.h>
-#include <WebServer.h>
+#include <WiFi.h>
+#include "HttpServer.h"
 #include "FoodManager.h"
 #include "ColorMap.h"
-#include <sqlite3.h>
+#include "SpectralClassifier.h"
+#include "AppState.h"
+#include <memory>
 
 // ✅ Define enum before the class so all scopes can see it
 enum WiFiModeType { MODE_STA, MODE_AP };
 
+// Rows per page of the /foods response: one SQLite query each, with the
+// catalogue lock released in between
+#define FOODS_PAGE_ROWS     32
+// Series per page of the /metrics response
+#define METRICS_PAGE_SERIES 4
+// Buckets per page of the /history response
+#define HISTORY_PAGE_ROWS    32
+// /history without from covers this many days up to to (or now)
+#define HISTORY_DEFAULT_DAYS 90
+// Without a bucket, ranges up to this many days come per day, longer ones
+// per week, so a chart never gets more points than it can draw
+#define HISTORY_AUTO_DAYS    120
+// Log entries per page of an /export response (one binary block each)
+#define EXPORT_PAGE_ROWS     EXPORT_BLOCK_ROWS
+
+struct WebAsset;
+
 class WebServerManager {
 public:
-    void begin(const char* ssid, const char* password, sqlite3* database);
+    void begin(const char* ssid, const char* password);
     void handle();
 
     // ✅ Add these accessors
     WiFiModeType getCurrentMode();
     IPAddress getDeviceIP();
+    AppNetwork network();   // as published in AppSnapshot
+
+    // The one listener on port 80; WebSocketManager adds /ws to it
+    HttpServer& httpServer() { return server; }
 
     void logSpectrumEntry(const String& foodName, float grams, const String& color, const Spectrum& spectrum);
     void logFoodEntry(const String& foodName, float grams, float cal, float prot, float carbs, float fat);
 
 private:
-    WebServer server = WebServer(80);
+    HttpServer server;
     WiFiModeType currentMode = MODE_STA;  // ✅ Store mode
+    SpectralClassifier classifier;        // trained from /spectrum_log.csv
+    QueueHandle_t appReply = nullptr;     // answers to this task's app requests
 
-    sqlite3* db = nullptr;
-    void handleRoot();
-    void handleAddFood();
-    void handleDeleteFood();
-    void handleSelect();
-    void handleReset();
+    void on(const char* uri, HttpServer::Handler handler, uint8_t methods = HTTP_METHOD_GET | HTTP_METHOD_HEAD);
+    void onUpload(const char* uri, HttpServer::UploadHandler handler);
+    void handleFoods(HttpRequest& req, HttpResponse& res);
+    void handleMetrics(HttpRequest& req, HttpResponse& res);
+    void handleAsset(HttpRequest& req, HttpResponse& res, const WebAsset& asset);
+    void serveSdFile(HttpRequest& req, HttpResponse& res, const char* path, const char* contentType,
+                     const char* cacheControl);
+    bool notModified(HttpRequest& req, HttpResponse& res, const char* etag);
+    void handleAddFood(HttpRequest& req, HttpResponse& res);
+    std::unique_ptr<HttpBodySink> handleImport(HttpRequest& req, HttpResponse& res);
+    void handleDeleteFood(HttpRequest& req, HttpResponse& res);
+    void handleSelect(HttpRequest& req, HttpResponse& res);
+    void handleAutoLog(HttpRequest& req, HttpResponse& res);
+    void handleSearch(HttpRequest& req, HttpResponse& res);
+    void handleClassify(HttpRequest& req, HttpResponse& res);
+    void handleDaily(HttpRequest& req, HttpResponse& res);
+    void handleHistory(HttpRequest& req, HttpResponse& res);
+    void handleExport(HttpRequest& req, HttpResponse& res, ExportFormat format);
+    void handleReset(HttpRequest& req, HttpResponse& res);
+    void handleTare(HttpRequest& req, HttpResponse& res);
+    void handleContainers(HttpRequest& req, HttpResponse& res);
+    void handleSaveContainer(HttpRequest& req, HttpResponse& res);
+    void handleDeleteContainer(HttpRequest& req, HttpResponse& res);
     void startWiFi(const char* ssid, const char* password);
     void syncTime();
-    bool checkAuth();
+    void loadClassifier();
+    bool checkAuth(HttpRequest& req, HttpResponse& res);
 };
@@ -1,42 +1,212 @@
 #include "WebSocketManager.h"
-#include "Scale_LoadCell.h"
-extern float weight;
-extern bool tareScale;
-
-void WebSocketManager::begin() {
-    webSocket.begin();
-    webSocket.onEvent([](uint8_t num, WStype_t type, uint8_t *payload, size_t length) {
-        if (type == WStype_CONNECTED) {
-            Serial.printf("[WebSocket] Client %u Connected\n", num);
-        } else if (type == WStype_DISCONNECTED) {
-            Serial.printf("[WebSocket] Client %u Disconnected\n", num);
-        } else if (type == WStype_TEXT) {
-            String msg((char*)payload, length);
-            if (msg == "tare") {
-                tareScale = true;
-                Serial.println("🟡 Tare command received");
+#include "JsonWriter.h"
+#include "Secrets.h"
+
+static const char* const topicNames[WS_TOPIC_COUNT] = {
+    "weight", "stable-weight", "totals", "log-events", "weigh-events", "spectrum",
+};
+
+// Bounded sink for a topic's JsonWriter; anything past the slot is cut off
+struct TopicText {
+    char*  out;
+    size_t used;
+};
+
+static void appendTopicText(void* ctx, const char* data, size_t len) {
+    TopicText& text = *static_cast<TopicText*>(ctx);
+    size_t room = WS_TOPIC_TEXT_MAX - 1 - text.used;
+    if (len > room) len = room;
+    memcpy(text.out + text.used, data, len);
+    text.used += len;
+}
+
+void WebSocketManager::begin(HttpServer& httpServer) {
+    server = &httpServer;
+    server->onWebSocket(WS_PATH, this);
+    Serial.println("🌐 WebSocket topics on " WS_PATH);
+}
+
+bool WebSocketManager::onUpgrade(HttpRequest& req, HttpResponse& res) {
+    // Clients can tare and recall containers, so /ws is no more open than /tare
+    if (req.authenticate(AUTH_USER, AUTH_PASS)) return true;
+    res.requestAuthentication();
+    return false;
+}
+
+bool WebSocketManager::onOpen(int id, HttpRequest&) {
+    Serial.printf("[WebSocket] Client %d Connected\n", id);
+    clients[id] = Client();
+    clients[id].connected = true;
+    return true;
+}
+
+void WebSocketManager::onClose(int id) {
+    Serial.printf("[WebSocket] Client %d Disconnected\n", id);
+    clients[id].connected = false;
+}
+
+void WebSocketManager::onMessage(int id, HttpWsOpcode opcode, const uint8_t* data, size_t length) {
+    if (opcode != HTTP_WS_TEXT) return;
+    Client& client = clients[id];
+    String msg((const char*)data, length);
+
+    if (msg == "tare") {
+        // The app task owns the scale; it tares between two readings
+        app_post(app_command(CMD_TARE));
+        Serial.println("🟡 Tare command received");
+    } else if (msg == "untare") {
+        app_post(app_command(CMD_UNTARE));
+    } else if (msg == "tare:clear") {
+        app_post(app_command(CMD_CLEAR_TARE));
+    } else if (msg.startsWith("container:")) {
+        app_post(app_command(CMD_RECALL_CONTAINER, msg.substring(10).c_str()));
+    } else if (msg.startsWith("rate:")) {
+        int hz = constrain(msg.substring(5).toInt(), 1, WS_MAX_RATE_HZ);
+        client.periodMs = 1000 / hz;
+        client.encoder.reset();
+        Serial.printf("[WebSocket] Client %d rate %d Hz\n", id, hz);
+    } else if (msg.startsWith("sub:")) {
+        setTopics(client, msg.substring(4), true);
+    } else if (msg.startsWith("unsub:")) {
+        setTopics(client, msg.substring(6), false);
+    }
+}
+
+void WebSocketManager::setTopics(Client& client, const String& list, bool subscribe) {
+    int start = 0;
+    while (start <= (int)list.length()) {
+        int comma = list.indexOf(',', start);
+        if (comma < 0) comma = list.length();
+        String name = list.substring(start, comma);
+        name.trim();
+        start = comma + 1;
+
+        for (uint8_t t = 0; t < WS_TOPIC_COUNT; ++t) {
+            if (name != topicNames[t]) continue;
+            uint8_t bit = 1 << t;
+            if (!subscribe) {
+                client.topics &= ~bit;
+                client.pending &= ~bit;
+            } else if (!(client.topics & bit)) {
+                client.topics |= bit;
+                // New subscribers start from the current value
+                if (t == WS_TOPIC_WEIGHT) client.encoder.reset();
+                else if (latest[t][0]) client.pending |= bit;
             }
         }
-    });
-    Serial.println("🌐 WebSocket Server started on port 81");
+    }
 }
 
+// Renders {"topic":..., fields} into the topic's slot and marks it pending
+// for every subscriber
+template <typename Fn>
+void WebSocketManager::publish(WsTopic topic, Fn&& writeFields) {
+    char buffer[64];
+    TopicText text = {latest[topic], 0};
+    JsonWriter json(buffer, sizeof(buffer), appendTopicText, &text);
+    json.beginObject();
+    json.key("topic").value(topicNames[topic]);
+    writeFields(json);
+    json.endObject();
+    json.flush();
+    text.out[text.used] = '\0';
 
+    uint8_t bit = 1 << topic;
+    for (Client& client : clients) {
+        if (client.connected && (client.topics & bit)) client.pending |= bit;
+    }
+}
 
-void WebSocketManager::handle(float weight, bool& tareScale) {
-    webSocket.loop();
+void WebSocketManager::publishChanges(const AppSnapshot& state) {
+    bool first = !published;
+    published = true;
 
-    // Broadcast weight every second
-    if (millis() - lastSendTime > 250) {
-        lastSendTime = millis();
-        String payload = String(weight, 0);
-        webSocket.broadcastTXT(payload);
+    const DailyNutrition& t = state.totals;
+    if (first || memcmp(&t, &totals, sizeof(t)) != 0) {
+        totals = t;
+        publish(WS_TOPIC_TOTALS, [&](JsonWriter& json) {
+            json.key("calories").value(t.calories);
+            json.key("protein").value(t.protein);
+            json.key("carbs").value(t.carbs);
+            json.key("fat").value(t.fat);
+        });
     }
 
-    // Handle tare scale command
-    if (tareScale) {
+    // A settled weight is news once, when it settles or settles somewhere else
+    int32_t decigrams = weightFrame_toDecigrams(state.reading.grams);
+    if (state.reading.stable && (!stable || decigrams != stableDecigrams)) {
+        stableDecigrams = decigrams;
+        publish(WS_TOPIC_STABLE_WEIGHT, [&](JsonWriter& json) {
+            json.key("grams").value(decigrams / 10.0f, 1);
+        });
+    }
+    stable = state.reading.stable;
 
-        scale_tare();
-        tareScale = false;
+    if (state.logCount != logCount) {
+        logCount = state.logCount;
+        const AppLogEvent& e = state.lastLog;
+        publish(WS_TOPIC_LOG_EVENTS, [&](JsonWriter& json) {
+            json.key("count").value((int32_t)state.logCount);
+            json.key("food").value(e.food);
+            json.key("grams").value(e.grams, 1);
+            json.key("calories").value(e.macros.calories);
+            json.key("protein").value(e.macros.protein);
+            json.key("carbs").value(e.macros.carbs);
+            json.key("fat").value(e.macros.fat);
+            json.key("ts").value((int64_t)e.ts);
+        });
+    }
+
+    if (state.weighCount != weighCount) {
+        weighCount = state.weighCount;
+        const WeighEvent& e = state.lastWeigh;
+        publish(WS_TOPIC_WEIGH_EVENTS, [&](JsonWriter& json) {
+            json.key("count").value((int32_t)state.weighCount);
+            json.key("type").value(weighEvent_typeName(e.type));
+            json.key("grams").value(e.grams, 1);
+            json.key("level").value(e.level, 1);
+            json.key("latencyMs").value((int32_t)(e.timestamp - e.onsetMs));
+        });
+    }
+
+    if (state.spectrumAt != spectrumAt) {
+        spectrumAt = state.spectrumAt;
+        publish(WS_TOPIC_SPECTRUM, [&](JsonWriter& json) {
+            json.key("at").value((int64_t)state.spectrumAt);
+            json.key("counts").beginArray();
+            for (uint16_t count : state.spectrum) json.value((int32_t)count);
+            json.endArray();
+        });
+    }
+}
+
+void WebSocketManager::handle(const AppSnapshot& state) {
+    if (!server) return;
+    publishChanges(state);
+
+    uint32_t now = millis();
+    for (int id = 0; id < HTTP_MAX_CONNECTIONS; ++id) {
+        Client& client = clients[id];
+        if (!client.connected) continue;
+
+        // Latest reading at the client's own rate, and nothing at all while
+        // the weight and stable flag stay the same. A frame is only encoded
+        // when it fits, so the delta chain never skips one.
+        if ((client.topics & (1 << WS_TOPIC_WEIGHT)) && now - client.lastSendTime >= client.periodMs &&
+            server->wsSpace(id) >= WEIGHT_FRAME_MAX_SIZE) {
+            uint8_t frame[WEIGHT_FRAME_MAX_SIZE];
+            size_t length = client.encoder.encode(state.reading, frame);
+            if (length) {
+                client.lastSendTime = now;
+                server->wsSend(id, HTTP_WS_BINARY, frame, length);
+            }
+        }
+
+        for (uint8_t t = 0; t < WS_TOPIC_COUNT && client.pending; ++t) {
+            uint8_t bit = 1 << t;
+            if (!(client.pending & bit)) continue;
+            if (!server->wsSend(id, HTTP_WS_TEXT, latest[t], strlen(latest[t]))) break;
+            client.pending &= ~bit;
+        }
     }
 }
@@ -1,14 +1,83 @@
-#include "esp_mac.h"
 #pragma once
 #include <Arduino.h>
-#include <WebSocketsServer.h>
+#include "HttpServer.h"
+#include "AppState.h"
+#include "WeightFrame.h"
 
-class WebSocketManager {
+// Per-client frame rate, set by the client with "rate:<hz>"
+#define WS_DEFAULT_RATE_HZ 4
+#define WS_MAX_RATE_HZ     50
+
+#define WS_PATH            "/ws"   // upgraded on the HTTP server's port
+#define WS_TOPIC_TEXT_MAX  200     // longest text message (spectrum)
+
+// Realtime topics on /ws. A client picks its topics with "sub:a,b" and
+// "unsub:a,b"; a new connection starts on weight alone.
+//
+//   weight         binary WeightFrames at the client's rate
+//   stable-weight  {"topic":"stable-weight","grams":..}     each new settled weight
+//   totals         {"topic":"totals","calories":..,...}     today's totals, on change
+//   log-events     {"topic":"log-events","count":..,"food":..,"grams":..,...}
+//   weigh-events   {"topic":"weigh-events","count":..,"type":"added","grams":..,...}
+//   spectrum       {"topic":"spectrum","at":..,"counts":[..]}   each new capture
+//
+// Text topics are conflated: a client that falls behind gets the newest
+// value of each topic instead of a backlog, and subscribing sends the
+// current value straight away. log-events and weigh-events carry a running
+// count, so a skipped event shows up as a gap.
+//
+// Other client messages: "rate:<hz>", and the tare stack with "tare",
+// "untare", "tare:clear" and "container:<name>". The upgrade takes the same
+// Basic credentials as the HTTP routes, which browsers send along for the
+// page's own /ws.
+enum WsTopic : uint8_t {
+    WS_TOPIC_WEIGHT,
+    WS_TOPIC_STABLE_WEIGHT,
+    WS_TOPIC_TOTALS,
+    WS_TOPIC_LOG_EVENTS,
+    WS_TOPIC_WEIGH_EVENTS,
+    WS_TOPIC_SPECTRUM,
+    WS_TOPIC_COUNT
+};
+
+class WebSocketManager : public HttpWebSocketHandler {
 public:
-    void begin();
-    void handle(float weight, bool& tareScale);
+    void begin(HttpServer& server);
+
+    // Publishes what changed since the last call and sends every client
+    // what it is due, as far as its transmit buffer allows
+    void handle(const AppSnapshot& state);
+
+    bool onUpgrade(HttpRequest& req, HttpResponse& res) override;
+    bool onOpen(int id, HttpRequest& req) override;
+    void onMessage(int id, HttpWsOpcode opcode, const uint8_t* data, size_t length) override;
+    void onClose(int id) override;
 
 private:
-    WebSocketsServer webSocket = WebSocketsServer(81);
-    unsigned long lastSendTime = 0;
+    struct Client {
+        bool               connected = false;
+        uint8_t            topics = 1 << WS_TOPIC_WEIGHT;
+        uint8_t            pending = 0;     // text topics with a value the client lacks
+        uint16_t           periodMs = 1000 / WS_DEFAULT_RATE_HZ;
+        uint32_t           lastSendTime = 0;
+        WeightFrameEncoder encoder;
+    };
+
+    void publishChanges(const AppSnapshot& state);
+    template <typename Fn>
+    void publish(WsTopic topic, Fn&& writeFields);
+    void setTopics(Client& client, const String& list, bool subscribe);
+
+    HttpServer* server = nullptr;
+    Client      clients[HTTP_MAX_CONNECTIONS];
+    char        latest[WS_TOPIC_COUNT][WS_TOPIC_TEXT_MAX] = {};   // "" until first published
+
+    // What was last published, to see changes in the next snapshot
+    bool           published = false;
+    DailyNutrition totals = {};
+    uint32_t       logCount = 0;
+    uint32_t       weighCount = 0;
+    uint32_t       spectrumAt = 0;
+    int32_t        stableDecigrams = 0;
+    bool           stable = false;
 };
@@ -0,0 +1,66 @@
+#include "WeighEvent.h"
+#include <algorithm>
+
+const char* weighEvent_typeName(WeighEventType type) {
+    switch (type) {
+        case WEIGH_ADDED:   return "added";
+        case WEIGH_REMOVED: return "removed";
+        default:            return "settled";
+    }
+}
+
+bool WeighEventDetector::push(const WeightReading& reading, WeighEvent& out) {
+    float    grams = reading.grams;
+    uint32_t t = reading.timestamp;
+    if (reading.stable && !wasStable) stableSince = t;
+    wasStable = reading.stable;
+
+    if (!primed) {
+        if (!reading.stable) return false;
+        reference = grams;
+        upStart = downStart = t;
+        primed = true;
+        return false;
+    }
+
+    if (!isMoving) {
+        float d = grams - reference;
+        cusumUp = std::max(0.0f, cusumUp + d - WEIGH_CUSUM_DRIFT);
+        cusumDown = std::max(0.0f, cusumDown - d - WEIGH_CUSUM_DRIFT);
+        if (cusumUp == 0) upStart = t;
+        if (cusumDown == 0) downStart = t;
+
+        if (cusumUp <= WEIGH_CUSUM_THRESHOLD && cusumDown <= WEIGH_CUSUM_THRESHOLD) {
+            // Sitting still: follow slow creep so it never adds up to an item
+            if (reading.stable) reference = grams;
+            return false;
+        }
+        isMoving = true;
+        onsetMs = cusumUp > WEIGH_CUSUM_THRESHOLD ? upStart : downStart;
+    }
+
+    // The hold counts from the move, not from a stable spell before it
+    uint32_t holdFrom = (int32_t)(stableSince - onsetMs) > 0 ? stableSince : onsetMs;
+    if (!reading.stable || t - holdFrom < WEIGH_SETTLE_HOLD_MS) return false;
+
+    float delta = grams - reference;
+    out.type = delta >= WEIGH_EVENT_MIN_GRAMS    ? WEIGH_ADDED
+             : delta <= -WEIGH_EVENT_MIN_GRAMS   ? WEIGH_REMOVED
+                                                 : WEIGH_SETTLED;
+    out.grams = delta;
+    out.level = grams;
+    out.onsetMs = onsetMs;
+    out.timestamp = t;
+
+    reference = grams;
+    cusumUp = cusumDown = 0;
+    upStart = downStart = t;
+    isMoving = false;
+    return true;
+}
+
+void WeighEventDetector::reset() {
+    primed = false;
+    isMoving = false;
+    cusumUp = cusumDown = 0;
+}
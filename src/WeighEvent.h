@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "WeightFilter.h"
+
+// Segments the filtered weight stream into weigh events, one reading at a
+// time in constant memory. No Arduino dependencies: the same code runs on
+// the scale and in tools/weigh_replay.cpp.
+//
+// A two-sided CUSUM against the last settled level notices that the load
+// started to move; the event is complete once the filter has been stable
+// for WEIGH_SETTLE_HOLD_MS at the new level:
+//
+//   added    settled at least WEIGH_EVENT_MIN_GRAMS above the old level
+//   removed  settled at least WEIGH_EVENT_MIN_GRAMS below it
+//   settled  disturbed but back where it was (a touch, a stir)
+//
+// The settled level becomes the next reference, so items stacked on one
+// plate come out one delta at a time without a tare.
+
+#define WEIGH_EVENT_MIN_GRAMS   2.0f   // smallest change that counts as an item
+#define WEIGH_CUSUM_DRIFT       0.5f   // grams per sample the CUSUM forgives (noise, creep)
+#define WEIGH_CUSUM_THRESHOLD   6.0f   // accumulated gram-samples that mean "moving"
+#define WEIGH_SETTLE_HOLD_MS    400    // stable this long after a move; bridges pauses in a pour
+
+enum WeighEventType : uint8_t {
+    WEIGH_ADDED,
+    WEIGH_REMOVED,
+    WEIGH_SETTLED,
+};
+
+struct WeighEvent {
+    WeighEventType type      = WEIGH_SETTLED;
+    float          grams     = 0;   // settled change, negative when removed
+    float          level     = 0;   // settled load afterwards
+    uint32_t       onsetMs   = 0;   // where the CUSUM places the start of the move
+    uint32_t       timestamp = 0;   // reading that completed the event
+};
+
+const char* weighEvent_typeName(WeighEventType type);
+
+class WeighEventDetector {
+public:
+    // Feeds one filtered reading; true when it completes an event
+    bool push(const WeightReading& reading, WeighEvent& out);
+
+    // Forgets the reference level; the next settled reading becomes the
+    // reference without an event
+    void reset();
+
+    // The zero moved by delta grams (a tare): no event, nothing to re-learn
+    void shift(float delta) { reference += delta; }
+
+    bool  moving() const { return isMoving; }
+    float level() const { return reference; }
+
+private:
+    float    reference = 0;
+    float    cusumUp = 0;
+    float    cusumDown = 0;
+    uint32_t upStart = 0;        // last reading where each CUSUM was zero
+    uint32_t downStart = 0;
+    uint32_t onsetMs = 0;
+    uint32_t stableSince = 0;
+    bool     primed = false;
+    bool     isMoving = false;
+    bool     wasStable = false;
+};
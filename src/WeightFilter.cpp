@@ -0,0 +1,66 @@
+#include "WeightFilter.h"
+#include <cmath>
+
+float AdaptiveAverage::push(float value) {
+    if (count > 0 && std::fabs(value - (float)(sum / count)) > WEIGHT_STEP_GRAMS) {
+        // Load changed: forget the old level so the output follows immediately
+        reset();
+    }
+
+    if (count == WEIGHT_AVERAGE_MAX) {
+        sum -= window[index];
+    } else {
+        count++;
+    }
+    window[index] = value;
+    sum += value;
+    index = (index + 1) % WEIGHT_AVERAGE_MAX;
+
+    return (float)(sum / count);
+}
+
+void AdaptiveAverage::shift(float delta) {
+    for (size_t i = 0; i < count; ++i) window[i] += delta;
+    sum += (double)delta * count;
+}
+
+bool StabilityDetector::push(float value, uint32_t timestamp) {
+    if (!tracking || std::fabs(value - reference) > WEIGHT_STABLE_BAND) {
+        if (stable || !tracking) disturbedAt = timestamp;
+        reference = value;
+        bandStart = timestamp;
+        tracking = true;
+        stable = false;
+        return false;
+    }
+
+    if (!stable && timestamp - bandStart >= WEIGHT_STABLE_HOLD_MS) {
+        stable = true;
+        settleMs = timestamp - disturbedAt;
+    }
+    return stable;
+}
+
+const WeightReading& WeightFilter::push(float grams, uint32_t timestamp) {
+    float value = average.push(median.push(grams));
+
+    current.grams = value;
+    current.stable = stability.push(value, timestamp);
+    current.settleMs = stability.settleTime();
+    current.timestamp = timestamp;
+    return current;
+}
+
+void WeightFilter::shift(float delta) {
+    median.shift(delta);
+    average.shift(delta);
+    stability.shift(delta);
+    current.grams += delta;
+}
+
+void WeightFilter::reset() {
+    median.reset();
+    average.reset();
+    stability.reset();
+    current = WeightReading();
+}
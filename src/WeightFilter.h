@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Streaming weight filter chain: median -> adaptive average -> stability.
+// Everything works on fixed-size arrays so one sample costs O(window) at most
+// and nothing is allocated after construction. No Arduino dependencies, so the
+// same code runs in the acquisition path and on the host.
+
+#define WEIGHT_MEDIAN_SIZE      5      // spike rejection window
+#define WEIGHT_AVERAGE_MAX      16     // longest averaging window when settled
+#define WEIGHT_STEP_GRAMS       3.0f   // jump that restarts the average
+#define WEIGHT_STABLE_BAND      1.0f   // +/- grams allowed while "stable"
+#define WEIGHT_STABLE_HOLD_MS   300    // time inside the band before stable
+
+struct WeightReading {
+    float    grams     = 0;
+    bool     stable    = false;
+    uint32_t settleMs  = 0;   // time from the last disturbance until stable
+    uint32_t timestamp = 0;   // time of the sample that produced this reading
+};
+
+// Median of the last N samples; rejects single-sample spikes.
+template <size_t N>
+class MedianFilter {
+    static_assert(N % 2 == 1, "MedianFilter size must be odd");
+
+public:
+    float push(float value) {
+        history[index] = value;
+        index = (index + 1) % N;
+        if (count < N) count++;
+
+        float sorted[N];
+        for (size_t i = 0; i < count; ++i) {
+            // insertion sort, N is tiny
+            size_t j = i;
+            while (j > 0 && sorted[j - 1] > history[i]) {
+                sorted[j] = sorted[j - 1];
+                --j;
+            }
+            sorted[j] = history[i];
+        }
+        return sorted[count / 2];
+    }
+
+    void reset() { count = 0; index = 0; }
+
+    void shift(float delta) {
+        for (size_t i = 0; i < count; ++i) history[i] += delta;
+    }
+
+private:
+    float  history[N];
+    size_t count = 0;
+    size_t index = 0;
+};
+
+// Moving average whose window collapses to one sample on a step and then
+// grows back to WEIGHT_AVERAGE_MAX while the load stays put.
+class AdaptiveAverage {
+public:
+    float push(float value);
+    void reset() { count = 0; index = 0; sum = 0; }
+    void shift(float delta);
+    size_t windowSize() const { return count; }
+
+private:
+    float  window[WEIGHT_AVERAGE_MAX];
+    size_t count = 0;
+    size_t index = 0;
+    double sum = 0;
+};
+
+// Flags the reading as stable once it stays inside +/- band for holdMs.
+class StabilityDetector {
+public:
+    bool push(float value, uint32_t timestamp);
+    void reset() { tracking = false; stable = false; }
+    void shift(float delta) { reference += delta; }
+    uint32_t settleTime() const { return settleMs; }
+
+private:
+    float    reference = 0;
+    uint32_t bandStart = 0;
+    uint32_t disturbedAt = 0;
+    uint32_t settleMs = 0;
+    bool     tracking = false;
+    bool     stable = false;
+};
+
+class WeightFilter {
+public:
+    const WeightReading& push(float grams, uint32_t timestamp);
+    const WeightReading& reading() const { return current; }
+    void reset();
+
+    // Moves every stage by delta grams as if the samples had always been
+    // that much off (a tare changed): the output follows at once and keeps
+    // its stable flag instead of settling again
+    void shift(float delta);
+
+private:
+    MedianFilter<WEIGHT_MEDIAN_SIZE> median;
+    AdaptiveAverage average;
+    StabilityDetector stability;
+    WeightReading current;
+};
@@ -0,0 +1,87 @@
+#include "WeightFrame.h"
+#include <cmath>
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+int32_t weightFrame_toDecigrams(float grams) {
+    if (!std::isfinite(grams)) return 0;
+    return (int32_t)lroundf(grams * 10.0f);
+}
+
+size_t WeightFrameEncoder::encode(const WeightReading& reading, uint8_t* out) {
+    int32_t  decigrams = weightFrame_toDecigrams(reading.grams);
+    int32_t  delta     = decigrams - lastDecigrams;
+    uint32_t dt        = reading.timestamp - lastTimestamp;
+
+    bool key = !started || reading.timestamp - lastKeyAt >= WEIGHT_FRAME_KEY_PERIOD_MS ||
+               delta < INT16_MIN || delta > INT16_MAX || dt > UINT16_MAX;
+    if (!key && delta == 0 && reading.stable == lastStable) return 0;
+
+    uint8_t flags = (reading.stable ? WEIGHT_FRAME_STABLE : 0) | (key ? WEIGHT_FRAME_KEY : 0);
+    out[0] = WEIGHT_FRAME_VERSION;
+    out[1] = flags;
+    put16(out + 2, ++sequence);
+
+    size_t length;
+    if (key) {
+        put32(out + 4, reading.timestamp);
+        put32(out + 8, (uint32_t)decigrams);
+        length = WEIGHT_FRAME_KEY_SIZE;
+        lastKeyAt = reading.timestamp;
+        started = true;
+    } else {
+        put16(out + 4, (uint16_t)dt);
+        put16(out + 6, (uint16_t)(int16_t)delta);
+        length = WEIGHT_FRAME_DELTA_SIZE;
+    }
+
+    lastTimestamp = reading.timestamp;
+    lastDecigrams = decigrams;
+    lastStable = reading.stable;
+    return length;
+}
+
+bool WeightFrameDecoder::decode(const uint8_t* data, size_t length, WeightFrame& out) {
+    if (length < 2 || data[0] != WEIGHT_FRAME_VERSION) return false;
+
+    WeightFrame frame;
+    frame.stable = data[1] & WEIGHT_FRAME_STABLE;
+    frame.key = data[1] & WEIGHT_FRAME_KEY;
+
+    if (frame.key) {
+        if (length != WEIGHT_FRAME_KEY_SIZE) return false;
+        frame.sequence = get16(data + 2);
+        frame.timestamp = get32(data + 4);
+        frame.decigrams = (int32_t)get32(data + 8);
+    } else {
+        if (length != WEIGHT_FRAME_DELTA_SIZE) return false;
+        frame.sequence = get16(data + 2);
+        if (!synced || frame.sequence != (uint16_t)(last.sequence + 1)) {
+            synced = false;
+            return false;
+        }
+        frame.timestamp = last.timestamp + get16(data + 4);
+        frame.decigrams = last.decigrams + (int16_t)get16(data + 6);
+    }
+
+    last = frame;
+    synced = true;
+    out = frame;
+    return true;
+}
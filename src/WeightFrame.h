@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "WeightFilter.h"
+
+// Binary weight frames for the WebSocket stream. Little-endian, weight in
+// decigrams. A key frame carries absolute values; a delta frame carries the
+// change since the previous frame sent to the same client. No Arduino
+// dependencies, so the browser decoder can be checked against this on the host.
+//
+//   key   (12 bytes): version, flags, seq u16, timestamp u32, weight i32
+//   delta ( 8 bytes): version, flags, seq u16, dt u16,        dweight i16
+//
+// flags: bit 0 stable, bit 1 key frame. Frames are per connection and TCP
+// keeps them in order; a receiver that sees a sequence gap drops deltas until
+// the next key frame.
+
+#define WEIGHT_FRAME_VERSION       1
+#define WEIGHT_FRAME_KEY_SIZE      12
+#define WEIGHT_FRAME_DELTA_SIZE    8
+#define WEIGHT_FRAME_MAX_SIZE      WEIGHT_FRAME_KEY_SIZE
+#define WEIGHT_FRAME_KEY_PERIOD_MS 5000   // also a heartbeat for idle streams
+
+#define WEIGHT_FRAME_STABLE 0x01
+#define WEIGHT_FRAME_KEY    0x02
+
+struct WeightFrame {
+    uint16_t sequence  = 0;
+    uint32_t timestamp = 0;
+    int32_t  decigrams = 0;
+    bool     stable    = false;
+    bool     key       = false;
+};
+
+// One per client: remembers what that client last received.
+class WeightFrameEncoder {
+public:
+    // Writes the frame for `reading` into out (WEIGHT_FRAME_MAX_SIZE bytes).
+    // Returns 0 when nothing changed since the last frame and no key frame
+    // is due, i.e. the frame is suppressed.
+    size_t encode(const WeightReading& reading, uint8_t* out);
+
+    // Next frame will be a key frame (new connection, rate change)
+    void reset() { started = false; }
+
+private:
+    uint16_t sequence = 0;
+    uint32_t lastTimestamp = 0;
+    uint32_t lastKeyAt = 0;
+    int32_t  lastDecigrams = 0;
+    bool     lastStable = false;
+    bool     started = false;
+};
+
+class WeightFrameDecoder {
+public:
+    // False on a malformed frame, an unknown version, or a delta that can't
+    // be applied (no key frame yet, or a sequence gap).
+    bool decode(const uint8_t* data, size_t length, WeightFrame& out);
+
+private:
+    WeightFrame last;
+    bool synced = false;
+};
+
+int32_t weightFrame_toDecigrams(float grams);
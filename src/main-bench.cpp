@@ -0,0 +1,619 @@
+// Benchmark firmware (env:bench on the device, env:native_bench on the host).
+//
+// Runs every scenario once at boot against a scratch database (/bench.db),
+// keeps the JSON report on the card as /bench.json and prints it on one
+// serial line at the end. The device then joins Wi-Fi and serves the report
+// at /bench.json; the host build exits.
+//
+//   pio run -e native_bench && .pio/build/native_bench/program > run.log
+//   python3 tools/bench_diff.py baseline.json run.log
+//
+// On the device, put a mass on the platform when asked: /select only logs a
+// settled weight, so its results are skipped when nothing is there.
+
+#include <Arduino.h>
+#include <SD.h>
+#include <sqlite3.h>
+#include "Benchmark.h"
+#include "FoodManager.h"
+#include "FoodImporter.h"
+#include "DisplayManager.h"
+#include "WebServerManager.h"
+#include "AppState.h"
+#include "Scale_LoadCell.h"
+#include "WeightFrame.h"
+#include "Secrets.h"
+
+#ifdef ESP32_NATIVE
+#define BENCH_PLATFORM "native"
+#else
+#define BENCH_PLATFORM CONFIG_IDF_TARGET
+#endif
+
+#define BENCH_DB_FILE     "/bench.db"
+#define BENCH_DB_PATH     "/sd" BENCH_DB_FILE
+#define BENCH_REPORT_FILE "/bench.json"
+#define BENCH_IMPORT_FILE "/bench_foods.csv"
+
+#ifndef BENCH_LOG_ROWS_MAX
+#define BENCH_LOG_ROWS_MAX 1000000   // seeding 1M rows takes minutes on the card
+#endif
+#define BENCH_BOOT_FOODS      500
+#define BENCH_SELECT_FOODS    5000
+#define BENCH_LOAD_GRAMS      250.0f
+#define BENCH_SETTLE_TIMEOUT_MS 60000
+#define BENCH_HX711_SECONDS   10
+#define BENCH_FILTER_SAMPLES  4096
+#define BENCH_JSON_CHUNK      512      // same buffer as the HTTP handlers
+#define BENCH_LOG_END         1767225600   // seeded log ends 2026-01-01 UTC
+#define BENCH_LOG_SPACING_S   600
+
+static const int32_t catalogueSizes[] = {50, 5000, 50000};
+static const int32_t logSizes[]       = {0, 10000, 100000, 1000000};
+static const int32_t importSizes[]    = {10000, 100000};
+static const int32_t fanoutClients[]  = {1, 2, 4, 8, 16};
+static const int32_t filterRates[]    = {10, 80};   // HX711 RATE pin low / high
+
+const int SD_CS = 10;
+
+FoodManager foodManager;
+DisplayManager displayManager;
+WebServerManager webServerManager;
+
+static File reportFile;
+
+/* ---------- Test data ---------- */
+
+static const char* const nameStyles[] = {
+    "Smoked", "Roasted", "Raw", "Boiled", "Fried", "Grilled", "Dried", "Baked"
+};
+static const char* const nameFoods[] = {
+    "Chicken Breast", "Apple", "Brown Rice", "Salmon", "Greek Yogurt", "Oat Flakes",
+    "Banana", "Egg", "Broccoli", "Almonds", "Cheddar", "Potato", "Lentils", "Tofu",
+    "Beef Mince", "Spinach"
+};
+#define NAME_STYLES (sizeof(nameStyles) / sizeof(nameStyles[0]))
+#define NAME_FOODS  (sizeof(nameFoods) / sizeof(nameFoods[0]))
+
+// Unique, searchable names: "Grilled Salmon", then "Grilled Salmon 2", ...
+static String benchFoodName(uint32_t i) {
+    String name = String(nameStyles[i % NAME_STYLES]) + " " + nameFoods[(i / NAME_STYLES) % NAME_FOODS];
+    uint32_t round = i / (NAME_STYLES * NAME_FOODS);
+    if (round) name += " " + String(round + 1);
+    return name;
+}
+
+// Deterministic noise, roughly Gaussian with the given RMS
+static float benchNoise(uint32_t& state, float rms) {
+    float sum = 0;
+    for (int i = 0; i < 4; ++i) {
+        state = state * 1664525u + 1013904223u;
+        sum += (state >> 8) / 16777216.0f;
+    }
+    return (sum - 2.0f) * rms * 1.7320508f;
+}
+
+static void countBytes(void* ctx, const char*, size_t len) {
+    *static_cast<size_t*>(ctx) += len;
+}
+
+static void writeReport(void*, const char* data, size_t len) {
+    reportFile.write(reinterpret_cast<const uint8_t*>(data), len);
+}
+
+// Fresh /bench.db with `foods` catalogue rows and `logRows` log entries, one
+// every BENCH_LOG_SPACING_S up to BENCH_LOG_END. Written on a raw connection
+// in one transaction, then rolled up by FoodManager; it is left closed.
+static void seedDatabase(int32_t foods, int32_t logRows) {
+    foodManager.end();
+    SD.remove(BENCH_DB_FILE);
+    SD.remove(BENCH_DB_FILE "-wal");
+    SD.remove(BENCH_DB_FILE "-journal");
+
+    // Schema and journal mode exactly as the firmware creates them
+    foodManager.begin(SD_CS, BENCH_DB_PATH);
+    foodManager.end();
+
+    Serial.printf("⚙️ Seeding %ld foods, %ld log rows...\n", (long)foods, (long)logRows);
+    sqlite3* db;
+    if (sqlite3_open(BENCH_DB_PATH, &db) != SQLITE_OK) {
+        Serial.println("❌ Cannot open the bench database");
+        return;
+    }
+    sqlite3_exec(db, "PRAGMA locking_mode = EXCLUSIVE; PRAGMA synchronous = OFF; BEGIN;", nullptr, nullptr, nullptr);
+
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(db, "INSERT INTO Food (name, calories, protein, carbs, fat) VALUES (?, ?, ?, ?, ?);",
+                       -1, &stmt, nullptr);
+    for (int32_t i = 0; i < foods; ++i) {
+        String name = benchFoodName(i);
+        sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_double(stmt, 2, 50 + i % 400);
+        sqlite3_bind_double(stmt, 3, i % 30);
+        sqlite3_bind_double(stmt, 4, i % 70);
+        sqlite3_bind_double(stmt, 5, i % 20);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    sqlite3_prepare_v2(db, "INSERT INTO LogEntry (timestamp, food_id, grams, calories, protein, carbs, fat, ts) "
+                           "VALUES (?, ?, ?, ?, ?, ?, ?, ?);", -1, &stmt, nullptr);
+    for (int32_t i = 0; i < logRows; ++i) {
+        time_t ts = BENCH_LOG_END - (time_t)(logRows - i) * BENCH_LOG_SPACING_S;
+        struct tm tm;
+        char timestamp[20];
+        gmtime_r(&ts, &tm);
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm);
+
+        sqlite3_bind_text(stmt, 1, timestamp, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, 1 + i % (foods ? foods : 1));
+        sqlite3_bind_double(stmt, 3, 20 + i % 300);
+        sqlite3_bind_double(stmt, 4, 100);
+        sqlite3_bind_double(stmt, 5, 10);
+        sqlite3_bind_double(stmt, 6, 12);
+        sqlite3_bind_double(stmt, 7, 4);
+        sqlite3_bind_int64(stmt, 8, ts);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+
+    if (logRows > 0) {
+        foodManager.begin(SD_CS, BENCH_DB_PATH);
+        foodManager.rebuildRollups();
+        foodManager.end();
+    }
+}
+
+/* ---------- Scenarios ---------- */
+
+// Step from empty to BENCH_LOAD_GRAMS with 0.3 g RMS noise through the
+// filter chain; returns the time from the step until stable again, -1 if never
+static int32_t replayStep(WeightFilter& filter, int32_t sps) {
+    const uint32_t stepAt = 64;
+    uint32_t rng = 1;
+    uint32_t period = 1000 / sps;
+    int32_t settleMs = -1;
+    bool disturbed = false;
+
+    for (uint32_t i = 0; i < BENCH_FILTER_SAMPLES; ++i) {
+        uint32_t t = i * period;
+        float grams = (i >= stepAt ? BENCH_LOAD_GRAMS : 0.0f) + benchNoise(rng, 0.3f);
+        const WeightReading& reading = filter.push(grams, t);
+
+        if (i < stepAt || settleMs >= 0) continue;
+        if (!reading.stable) disturbed = true;
+        else if (disturbed) settleMs = t - stepAt * period;
+    }
+    return settleMs;
+}
+
+// The same step through the filter and the weigh-event detector; returns the
+// time from the step to its "added" event, -1 if none
+static int32_t replayWeighEvent(WeightFilter& filter, WeighEventDetector& detector, int32_t sps) {
+    const uint32_t stepAt = 64;
+    uint32_t rng = 1;
+    uint32_t period = 1000 / sps;
+    int32_t latencyMs = -1;
+
+    for (uint32_t i = 0; i < BENCH_FILTER_SAMPLES; ++i) {
+        uint32_t t = i * period;
+        float grams = (i >= stepAt ? BENCH_LOAD_GRAMS : 0.0f) + benchNoise(rng, 0.3f);
+        WeighEvent event;
+        if (detector.push(filter.push(grams, t), event) && event.type == WEIGH_ADDED && latencyMs < 0) {
+            latencyMs = t - stepAt * period;
+        }
+    }
+    return latencyMs;
+}
+
+static void benchFilter(Benchmark& bench) {
+    for (int32_t sps : filterRates) {
+        WeightFilter filter;
+        bench.value("filter.settle", {{"sps", sps}}, "ms", replayStep(filter, sps));
+        bench.run("filter.replay", {{"sps", sps}, {"samples", BENCH_FILTER_SAMPLES}}, 20, [&] {
+            filter.reset();
+            replayStep(filter, sps);
+        });
+
+        WeighEventDetector detector;
+        filter.reset();
+        bench.value("weigh.latency", {{"sps", sps}}, "ms", replayWeighEvent(filter, detector, sps));
+        bench.run("weigh.replay", {{"sps", sps}, {"samples", BENCH_FILTER_SAMPLES}}, 20, [&] {
+            filter.reset();
+            detector.reset();
+            replayWeighEvent(filter, detector, sps);
+        });
+    }
+}
+
+// Frames for N WebSocket clients, 100 readings per iteration at 80 SPS with
+// a moving weight. Only the encoding: socket writes depend on the clients.
+static void benchFanout(Benchmark& bench) {
+    for (int32_t clients : fanoutClients) {
+        std::vector<WeightFrameEncoder> encoders(clients);
+        WeightReading reading;
+        uint8_t frame[WEIGHT_FRAME_MAX_SIZE];
+        uint32_t i = 0;
+
+        bench.run("ws.fanout", {{"clients", clients}, {"readings", 100}}, 200, [&] {
+            for (uint32_t n = 0; n < 100; ++n, ++i) {
+                reading.grams = 100.0f + (i % 50) * 0.3f;
+                reading.timestamp = i * 12;
+                for (WeightFrameEncoder& encoder : encoders) encoder.encode(reading, frame);
+            }
+        });
+    }
+}
+
+static void benchDisplay(Benchmark& bench) {
+    displayManager.begin();
+
+    AppSnapshot state = {};
+    strlcpy(state.foodName, "Grilled Chicken Breast", sizeof(state.foodName));
+    state.foodPer100g = {165, 31, 0, 3.6f};
+    uint32_t i = 0;
+
+    bench.run("display.full", {}, 50, [&] {
+        state.totals.calories = 1000 + i;
+        state.reading.grams = 100 + i;
+        i++;
+        displayManager.updateDisplay(state, "192.168.0.42", "STA");
+    });
+
+    // The live readout is rate-limited; wait out the limit between calls
+    BenchSamples samples;
+    for (uint32_t n = 0; n < 50; ++n) {
+        delay(DISPLAY_WEIGHT_PERIOD_MS + 1);
+        BenchTimer timer;
+        displayManager.updateWeight(100.0f + n * 7);
+        samples.add(timer.elapsed());
+    }
+    bench.record("display.weight", {}, samples);
+}
+
+static void benchCatalogue(Benchmark& bench) {
+    static const char* const queries[] = {"chi", "bre", "smoked", "r", "grilled sal", "zzz"};
+
+    for (int32_t foods : catalogueSizes) {
+        seedDatabase(foods, 0);
+        BenchParams params = {{"foods", foods}};
+
+        bench.run("catalogue.open", params, 3, [] { foodManager.begin(SD_CS, BENCH_DB_PATH); }, 0);
+        bench.run("catalogue.load", params, 5, [] { foodManager.loadDatabase(); });
+        bench.value("catalogue.indexBytes", params, "bytes", foodManager.getIndex().memoryUsage());
+
+        // Lookups and searches are too quick to time one by one
+        std::vector<String> names;
+        for (uint32_t n = 0; n < 64; ++n) names.push_back(benchFoodName((n * 7919u) % foods));
+        FoodItem item;
+        bench.run("catalogue.find", {{"foods", foods}, {"lookups", 64}}, 200, [&] {
+            for (const String& name : names) foodManager.findFood(name, item);
+        });
+
+        const FoodIndexEntry* results[10];
+        bench.run("catalogue.search", {{"foods", foods}, {"queries", 6}}, 200, [&] {
+            FoodManager::Guard guard(foodManager);
+            for (const char* query : queries) foodManager.getIndex().search(query, results, 10);
+        });
+
+        // Body of the /foods handler into a byte counter instead of the
+        // socket, walked in the same keyset pages
+        size_t bytes = 0;
+        auto walkFoods = [&] {
+            char chunk[BENCH_JSON_CHUNK];
+            bytes = 0;
+            JsonWriter json(chunk, sizeof(chunk), countBytes, &bytes);
+            json.beginArray();
+            for (int lastId = 0, next; (next = foodManager.forEachFoodColor(lastId, FOODS_PAGE_ROWS,
+                     [&](const char* name, const char* color) {
+                         json.beginObject();
+                         json.key("name").value(name);
+                         json.key("color").value(color);
+                         json.endObject();
+                     })) != lastId;) {
+                lastId = next;
+            }
+            json.endArray();
+            json.flush();
+        };
+        bench.run("route.foods", params, 3, walkFoods);
+        bench.value("route.foods.bytes", params, "bytes", bytes);
+
+        // Heap one walk takes on top of what was in use before it. SQLite is
+        // the only allocator on that path (the JSON chunk is on the stack)
+        // and its high-water mark can be reset, unlike the heap's own; 0 when
+        // the SQLite build keeps no memory statistics. The heap's low-water
+        // mark since boot is recorded with it, so a walk that went below
+        // every earlier low shows up as a drop there.
+        sqlite3_int64 used, peak;
+        sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &used, &peak, 1);
+        sqlite3_int64 before = used;
+        walkFoods();
+        sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &used, &peak, 0);
+        bench.value("route.foods.heapPeak", params, "bytes", (double)(peak - before));
+        bench.value("route.foods.heapMinFree", params, "bytes", ESP.getMinFreeHeap());
+    }
+}
+
+// Every page of a /history range ending where the seeded log ends; the
+// 90 days are what the web UI charts
+static void benchHistory(Benchmark& bench, int32_t rows) {
+    static const int32_t ranges[] = {90, 365};
+    HistoryRow page[HISTORY_PAGE_ROWS];
+
+    for (int32_t days : ranges) {
+        for (HistoryBucket bucket : {HISTORY_MEAL, HISTORY_DAY, HISTORY_WEEK}) {
+            size_t buckets = 0;
+            bench.run("history.query", {{"logRows", rows}, {"days", days}, {"bucket", bucket}}, 20, [&] {
+                HistoryQuery query;
+                query.bucket  = bucket;
+                query.fromDay = FoodManager::dayKey(BENCH_LOG_END - (time_t)(days - 1) * 24 * 3600);
+                query.toDay   = FoodManager::dayKey(BENCH_LOG_END);
+                buckets = 0;
+                for (size_t n; (n = foodManager.readHistory(query, page, HISTORY_PAGE_ROWS)) != 0;) buckets += n;
+            });
+            bench.value("history.buckets", {{"logRows", rows}, {"days", days}, {"bucket", bucket}}, "count", buckets);
+        }
+    }
+}
+
+// A nutrition table in the layout public exports use: header, quoted
+// names with commas in them every few rows, empty macros now and then
+static void writeImportCsv(int32_t rows) {
+    SD.remove(BENCH_IMPORT_FILE);
+    File f = SD.open(BENCH_IMPORT_FILE, FILE_WRITE);
+    f.print("Description,Energy (kcal),Protein (g),Carbohydrate (g),Total lipid (fat) (g),Fatty acids saturated (g)\n");
+    char line[128];
+    for (int32_t i = 0; i < rows; ++i) {
+        String name = benchFoodName(BENCH_BOOT_FOODS + i);
+        int n = i % 5 == 0
+            ? snprintf(line, sizeof(line), "\"%s, raw\",%d,%d.%d,%d,,%d\n", name.c_str(), 50 + i % 400, i % 30, i % 10, i % 70, i % 7)
+            : snprintf(line, sizeof(line), "%s,%d,%d.%d,%d,%d.5,%d\n", name.c_str(), 50 + i % 400, i % 30, i % 10, i % 70, i % 20, i % 7);
+        f.write(reinterpret_cast<const uint8_t*>(line), n);
+    }
+    f.close();
+}
+
+// CSV import into a catalogue of BENCH_BOOT_FOODS: straight off the card,
+// and in receive-buffer slices as an upload arrives
+static void benchImport(Benchmark& bench) {
+    for (int32_t rows : importSizes) {
+        writeImportCsv(rows);
+        BenchParams params = {{"rows", rows}};
+
+        seedDatabase(BENCH_BOOT_FOODS, 0);
+        foodManager.begin(SD_CS, BENCH_DB_PATH);
+        std::unique_ptr<FoodImporter> importer(new FoodImporter(foodManager));
+        BenchTimer timer;
+        importer->importFile(BENCH_IMPORT_FILE);
+        bench.value("import.file", params, "ms", timer.elapsed() / 1000.0);
+        bench.value("import.file.rate", params, "ops", importer->progress().rowsPerSecond());
+        bench.value("import.file.failed", params, "count", importer->progress().failed);
+
+        seedDatabase(BENCH_BOOT_FOODS, 0);
+        foodManager.begin(SD_CS, BENCH_DB_PATH);
+        importer.reset(new FoodImporter(foodManager));
+        File f = SD.open(BENCH_IMPORT_FILE);
+        char slice[HTTP_RX_BUFFER_SIZE];
+        timer = BenchTimer();
+        importer->begin();
+        for (size_t n; (n = f.read(reinterpret_cast<uint8_t*>(slice), sizeof(slice))) > 0;) importer->write(slice, n);
+        importer->finish();
+        f.close();
+        bench.value("import.upload", params, "ms", timer.elapsed() / 1000.0);
+        bench.value("import.upload.rate", params, "ops", importer->progress().rowsPerSecond());
+    }
+    SD.remove(BENCH_IMPORT_FILE);
+}
+
+// /export bodies into a byte counter, through the same writer and pages as
+// the handler: the whole log in each format, and the last 30 days as CSV
+static void benchExport(Benchmark& bench, int32_t rows) {
+    static const char* const formatNames[] = {"csv", "ndjson", "bin"};
+
+    for (ExportFormat format : {EXPORT_CSV, EXPORT_NDJSON, EXPORT_BINARY}) {
+        size_t bytes = 0, exported = 0;
+        BenchTimer timer;
+        char chunk[BENCH_JSON_CHUNK];
+        LogExportWriter out(format, chunk, sizeof(chunk), countBytes, &bytes);
+        ExportQuery query;
+        out.begin();
+        for (size_t n = EXPORT_PAGE_ROWS; n == EXPORT_PAGE_ROWS;) {
+            n = foodManager.forEachLogEntry(query, EXPORT_PAGE_ROWS, [&](const LogExportRow& row) { out.row(row); });
+            exported += n;
+            out.flush();
+        }
+        out.end();
+        double seconds = timer.elapsed() / 1e6;
+
+        BenchParams params = {{"logRows", rows}, {"format", format}};
+        Serial.printf("⏱️ export.%s: %u rows, %u bytes in %.2f s\n", formatNames[format], (unsigned)exported,
+                      (unsigned)bytes, seconds);
+        bench.value("export.ms", params, "ms", seconds * 1000);
+        bench.value("export.rate", params, "ops", seconds > 0 ? exported / seconds : 0);
+        bench.value("export.bytes", params, "bytes", bytes);
+    }
+
+    size_t bytes = 0;
+    bench.run("export.range", {{"logRows", rows}, {"days", 30}}, 5, [&] {
+        char chunk[BENCH_JSON_CHUNK];
+        LogExportWriter out(EXPORT_CSV, chunk, sizeof(chunk), countBytes, &bytes);
+        ExportQuery query;
+        query.from = BENCH_LOG_END - 30 * 24 * 3600;
+        query.to   = BENCH_LOG_END;
+        bytes = 0;
+        out.begin();
+        while (foodManager.forEachLogEntry(query, EXPORT_PAGE_ROWS, [&](const LogExportRow& row) { out.row(row); })
+               == EXPORT_PAGE_ROWS) {
+            out.flush();
+        }
+        out.end();
+    });
+}
+
+// Boot cost against log size, and the batched log write on top of that log
+static void benchBoot(Benchmark& bench) {
+    for (int32_t rows : logSizes) {
+        if (rows > BENCH_LOG_ROWS_MAX) break;
+        seedDatabase(BENCH_BOOT_FOODS, rows);
+        BenchParams params = {{"logRows", rows}};
+
+        DailyNutrition totals;
+        bench.run("boot.open", params, 3, [&] {
+            foodManager.begin(SD_CS, BENCH_DB_PATH);
+            foodManager.restoreDailyTotalsFromDatabase(totals);
+        }, 0);
+
+        File f = SD.open(BENCH_DB_FILE);
+        bench.value("boot.dbBytes", params, "bytes", f ? f.size() : 0);
+        if (f) f.close();
+
+        FoodItem food;
+        foodManager.findFood(benchFoodName(0), food);
+        DailyNutrition macros = {100, 10, 12, 4};
+        const int32_t batch = LOG_FLUSH_THRESHOLD / 2;
+        BenchSamples samples;
+        for (uint32_t n = 0; n < 20; ++n) {
+            for (int32_t b = 0; b < batch; ++b) {
+                foodManager.queueLogEntry(food, 100, "2026-01-01 12:00:00", BENCH_LOG_END, macros, "");
+            }
+            BenchTimer timer;
+            foodManager.flushLogQueue();
+            samples.add(timer.elapsed());
+        }
+        bench.record("log.flush", {{"logRows", rows}, {"batch", batch}}, samples);
+
+        benchHistory(bench, rows);
+        benchExport(bench, rows);
+    }
+}
+
+static bool waitForSettledLoad() {
+    uint32_t start = millis();
+    AppSnapshot state;
+    while (millis() - start < BENCH_SETTLE_TIMEOUT_MS) {
+        app_getSnapshot(state);
+        if (state.reading.stable && state.reading.grams > 5) return true;
+        delay(50);
+    }
+    return false;
+}
+
+// /select as the web task sees it: app task round trip, then the snapshot
+static void benchSelect(Benchmark& bench) {
+    seedDatabase(BENCH_SELECT_FOODS, 0);
+    foodManager.begin(SD_CS, BENCH_DB_PATH);
+
+#ifdef ESP32_NATIVE
+    native_setLoad(BENCH_LOAD_GRAMS);
+#else
+    Serial.println("⚖️ Put a mass on the platform for the /select benchmark...");
+#endif
+    if (!waitForSettledLoad()) {
+        Serial.println("⚠️ No settled load, skipping route.select");
+        return;
+    }
+
+    QueueHandle_t reply = app_createReplyQueue();
+    String name = benchFoodName(42);
+    AppSnapshot state;
+    uint32_t failures = 0;
+    BenchParams params = {{"foods", BENCH_SELECT_FOODS}};
+
+    bench.run("route.select", params, 200, [&] {
+        AppCommand cmd = app_command(CMD_LOG_FOOD, name.c_str());
+        if (app_request(cmd, reply).result != APP_OK) failures++;
+        app_getSnapshot(state);
+    });
+    bench.value("route.select.failures", params, "count", failures);
+    bench.run("app.snapshot", {{"reads", 100}}, 200, [&] {
+        for (int n = 0; n < 100; ++n) app_getSnapshot(state);
+    });
+    vQueueDelete(reply);
+}
+
+// Acquisition task and app task running as in the firmware
+static void benchHx711(Benchmark& bench) {
+    ScaleStats before = scale_getStats();
+    uint32_t start = millis();
+    delay(BENCH_HX711_SECONDS * 1000);
+    ScaleStats after = scale_getStats();
+    float seconds = (millis() - start) / 1000.0f;
+
+    BenchParams params = {{"seconds", BENCH_HX711_SECONDS}};
+    bench.value("hx711.rate", params, "sps", (after.samples - before.samples) / seconds);
+    bench.value("hx711.dropped", params, "count", after.dropped - before.dropped);
+}
+
+static void benchHeap(Benchmark& bench) {
+    bench.value("heap.minFree", {}, "bytes", ESP.getMinFreeHeap());
+    bench.value("heap.maxAlloc", {}, "bytes", ESP.getMaxAllocHeap());
+    bench.value("psram.free", {}, "bytes", ESP.getFreePsram());
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(200);
+
+  if (!SD.begin(SD_CS)) {
+    Serial.println("❌ SD card init failed, no benchmark");
+    return;
+  }
+  SD.remove(BENCH_REPORT_FILE);
+  reportFile = SD.open(BENCH_REPORT_FILE, FILE_WRITE);
+
+  // The report streams to the card; the serial log is free for progress
+  char chunk[BENCH_JSON_CHUNK];
+  JsonWriter json(chunk, sizeof(chunk), writeReport, nullptr);
+  Benchmark bench(json, BENCH_PLATFORM);
+  int64_t start = esp_timer_get_time();
+
+  Serial.println("⏱️ Benchmark: CPU paths");
+  benchFilter(bench);
+  benchFanout(bench);
+  benchDisplay(bench);
+
+  Serial.println("⏱️ Benchmark: storage");
+  benchCatalogue(bench);
+  benchBoot(bench);
+  benchImport(bench);
+
+  Serial.println("⏱️ Benchmark: live tasks");
+  scale_setup();
+  app_start();
+  benchSelect(bench);
+  benchHx711(bench);
+  benchHeap(bench);
+
+  bench.finish();
+  foodManager.flushLogQueue();
+  reportFile.close();
+  Serial.printf("✅ %u results in %.1f s\n", (unsigned)bench.resultCount(),
+                (esp_timer_get_time() - start) / 1e6);
+
+  // One line, so the report can be cut out of a serial log
+  File report = SD.open(BENCH_REPORT_FILE);
+  while (report && report.available()) {
+    uint8_t buf[256];
+    Serial.write(buf, report.read(buf, sizeof(buf)));
+  }
+  Serial.println();
+  report.close();
+
+#ifdef ESP32_NATIVE
+  fflush(stdout);
+  _Exit(0);
+#else
+  webServerManager.begin(WIFI_SSID, WIFI_PASSWORD);
+#endif
+}
+
+void loop() {
+  webServerManager.handle();
+  delay(2);
+}
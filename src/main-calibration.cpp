@@ -0,0 +1,191 @@
+// Temperature calibration firmware (env:calibration).
+//
+// Records raw HX711 counts against the DS18B20 temperature into
+// /calibration.csv while the scale is warmed up empty and cooled down with a
+// reference mass on it, then fits the drift model and stores it in NVS where
+// scale_setup() of the main firmware picks it up.
+
+#include "main.h"
+#include "calibration.h"
+#include "CalibrationModel.h"
+#include "Scale_LoadCell.h"
+#include <Preferences.h>
+
+#define CALIBRATION_REFERENCE_GRAMS ( 500.0f )
+#define CALIBRATION_HOT_TEMP        ( 40.0f )   // warm-up target, empty platform
+#define CALIBRATION_COLD_TEMP       ( 20.0f )   // cool-down target, reference mass
+#define CALIBRATION_SAMPLE_MS       ( 2000U )
+
+static HX711   loadCell;
+static DS18B20 temperatureSensors( DS18B20_PIN );
+static File    calibFile;
+static uint8_t deviceCount    = 0U;
+static float   referenceGrams = 0.0f;
+
+
+void waitForButtonPress( const String& message )
+{
+    Serial.println( message );
+    while( digitalRead( BUTTON_PIN ) == HIGH )
+    {
+        delay( 10U );
+    }
+    waitForHighSignal( BUTTON_PIN );
+}
+
+void init()
+{
+    Serial.begin( 115200 );
+    delay( 200 );
+    pinMode( BUTTON_PIN, INPUT_PULLUP );
+    loadCell.begin( LOADCELL_DOUT_PIN, LOADCELL_SCK_PIN );
+}
+
+void updateDeviceCount()
+{
+    deviceCount = temperatureSensors.getDeviceCount();
+    Serial.printf( "🌡️ %u temperature sensor(s) found\n", deviceCount );
+}
+
+void initializeSDCard()
+{
+    while( !SD.begin( SD_CS ) )
+    {
+        Serial.println( "❌ SD card init failed, retrying..." );
+        delay( 1000U );
+    }
+}
+
+void handleExistingCalibrationFile()
+{
+    if( !SD.exists( calibrationFile ) )
+    {
+        return;
+    }
+
+    // Keep previous runs, the host fitter can be pointed at any of them
+    for( uint16_t i = 1U;; ++i )
+    {
+        String backup = String( "/calibration-" ) + i + ".csv";
+        if( !SD.exists( backup ) )
+        {
+            SD.rename( calibrationFile, backup );
+            Serial.printf( "📁 Previous calibration kept as %s\n", backup.c_str() );
+            return;
+        }
+    }
+}
+
+void openNewCalibrationFile()
+{
+    calibFile = SD.open( calibrationFile, FILE_WRITE );
+    if( !calibFile )
+    {
+        Serial.println( "❌ Cannot create /calibration.csv" );
+    }
+}
+
+void writeSensorAddresses()
+{
+    for( uint8_t i = 0U; i < deviceCount; ++i )
+    {
+        calibFile.printf( "# sensor %u: %016llX\n", i, ( unsigned long long )temperatureSensors.getAddres( i ) );
+    }
+    calibFile.println( "# millis,temperature,raw,reference" );
+    calibFile.flush();
+}
+
+void recordTemperatureData( float targetTemperature )
+{
+    float      temperature = temperatureSensors.getTemperature( 0U );
+    const bool rising      = targetTemperature > temperature;
+
+    Serial.printf( "⏺️ Recording %.0f g from %.1f°C to %.1f°C (button stops)\n",
+                   referenceGrams, temperature, targetTemperature );
+
+    while( rising ? temperature < targetTemperature : temperature > targetTemperature )
+    {
+        const uint32_t start = millis();
+        const int32_t  raw   = ( int32_t )loadCell.read_average( 4U );
+        temperature          = temperatureSensors.getTemperature( 0U );
+
+        calibFile.printf( "%lu,%.2f,%ld,%.1f\n", ( unsigned long )start, temperature, ( long )raw, referenceGrams );
+        calibFile.flush();
+        Serial.printf( "%.2f°C  %ld\n", temperature, ( long )raw );
+
+        while( millis() - start < CALIBRATION_SAMPLE_MS )
+        {
+            if( digitalRead( BUTTON_PIN ) == LOW )
+            {
+                waitForHighSignal( BUTTON_PIN );
+                return;
+            }
+            delay( 10U );
+        }
+    }
+}
+
+static void fitAndStoreModel()
+{
+    CalibrationFitter fitter;
+    File              f = SD.open( calibrationFile );
+    while( f && f.available() )
+    {
+        fitter.addCsvLine( f.readStringUntil( '\n' ).c_str() );
+    }
+    if( f )
+    {
+        f.close();
+    }
+
+    CalibrationModel model;
+    if( !fitter.fit( model ) )
+    {
+        Serial.println( "❌ Calibration fit failed, need zero and reference rows over a temperature range" );
+        return;
+    }
+
+    Preferences prefs;
+    prefs.begin( SCALE_PREFS_NAMESPACE, false );
+    prefs.putBytes( SCALE_PREFS_MODEL_KEY, &model, sizeof( model ) );
+    prefs.end();
+
+    Serial.printf( "✅ Model stored: offset %.1f %+.2f/°C, gain %.4f %+.6f/°C, rms %.2f g over %u rows\n",
+                   model.offset0, model.offsetSlope, model.gain0, model.gainSlope,
+                   fitter.residualGrams( model ), ( unsigned )fitter.rowCount() );
+}
+
+void calibration()
+{
+    initializeSDCard();
+    handleExistingCalibrationFile();
+    openNewCalibrationFile();
+    updateDeviceCount();
+    if( !calibFile || deviceCount == 0U )
+    {
+        return;
+    }
+    writeSensorAddresses();
+
+    waitForButtonPress( "Empty the platform and start heating, then press the button" );
+    referenceGrams = 0.0f;
+    recordTemperatureData( CALIBRATION_HOT_TEMP );
+
+    waitForButtonPress( "Place the reference mass and let it cool down, then press the button" );
+    referenceGrams = CALIBRATION_REFERENCE_GRAMS;
+    recordTemperatureData( CALIBRATION_COLD_TEMP );
+
+    calibFile.close();
+    fitAndStoreModel();
+}
+
+void setup()
+{
+    init();
+    calibration();
+}
+
+void loop()
+{
+    delay( 1000U );
+}
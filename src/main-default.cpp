@@ -4,29 +4,29 @@
 #include "BLEManager.h"
 #include "WebServerManager.h"
 #include "WebSocketManager.h"
-#include "Utils.h"
+#include "AppState.h"
+#include "Metrics.h"
 #include "Scale_LoadCell.h"
 #include "Color_Sensor.h"
+#include "Secrets.h"
+#include "pin_config.h"
 
-// Wi-Fi credentials
-const char* ssid = "TP-Link_D358";
-const char* password = "25194432";
 const int SD_CS = 10;
 
-// Globals
-float weight = 1000.0;  // initial weight (simulate 1kg)
-bool tareScale = false;
-bool timeSynced = false;
-bool needDisplayUpdate = true;
-DailyNutrition dailyTotals = {0, 0, 0, 0};
-FoodItem currentFood;
+// Web task: HTTP and WebSocket clients, all on the one server. Runs next to
+// the Wi-Fi stack on core 0, away from the scale and app tasks on core 1.
+#define WEB_TASK_STACK     8192
+#define WEB_TASK_PRIORITY  3
+#define WEB_TASK_CORE      0
+
+// Display task: lowest priority, catches up whenever the others are idle
+#define DISPLAY_TASK_STACK    4096
+#define DISPLAY_TASK_PRIORITY 1
+#define DISPLAY_TASK_CORE     1
+#define DISPLAY_TASK_PERIOD_MS 10
 
 // Color sensor
 DFRobot_AS7341 colorSensor;
-colorSensorState colorState = INACTIVE;
-
-String lastTimestamp = "";
-String lastMode = "";
 
 // Managers
 FoodManager foodManager;
@@ -35,43 +35,90 @@ BLEManager bleManager;
 WebServerManager webServerManager;
 WebSocketManager webSocketManager;
 
+// The web task owns WebServerManager, so it is the one that tells the app
+// task when the address the display shows has changed
+static void webTask(void*) {
+  MetricHistogram& cycle = metrics_histogram(METRIC_TASK_CYCLE, "task", "web");
+  AppSnapshot state;
+  AppNetwork shownNetwork = {0, false};
+  bool networkPosted = false;
+  for (;;) {
+    {
+      MetricTimer timer(cycle);
+      webServerManager.handle();
+
+      AppNetwork network = webServerManager.network();
+      if (!networkPosted || network.ip != shownNetwork.ip || network.apMode != shownNetwork.apMode) {
+        AppCommand cmd = app_command(CMD_NETWORK);
+        cmd.network = network;
+        networkPosted = app_post(cmd);   // a full queue tries again next pass
+        if (networkPosted) shownNetwork = network;
+      }
+
+      app_getSnapshot(state);
+      webSocketManager.handle(state);
+    }
+    vTaskDelay(1);  // let the idle task on core 0 feed the watchdog
+  }
+}
+
+// Full redraw only when the app state changes, network included; the live
+// weight takes the cheap path, which rate-limits and repaints only changed
+// digits
+static void displayTask(void*) {
+  MetricHistogram& cycle = metrics_histogram(METRIC_TASK_CYCLE, "task", "display");
+  AppSnapshot state;
+  uint32_t shownVersion = 0;
+  bool first = true;
+
+  for (;;) {
+    {
+      MetricTimer timer(cycle);
+      app_getSnapshot(state);
+
+      if (first || state.version != shownVersion) {
+        String ip = IPAddress(state.network.ip).toString();
+        displayManager.updateDisplay(state, ip, state.network.apMode ? "AP" : "STA");
+        shownVersion = state.version;
+        first = false;
+      }
+      displayManager.updateWeight(state.reading.grams);
+      displayManager.handle();
+    }
+    vTaskDelay(pdMS_TO_TICKS(DISPLAY_TASK_PERIOD_MS));
+  }
+}
+
 void setup() {
   Serial.begin(115200);
   delay(200);
+  metrics_begin();
 
   // Initialize hardware
   displayManager.begin();
   foodManager.begin(SD_CS);
-  bleManager.begin();
-  webServerManager.begin(ssid, password, foodManager.getDatabaseHandle());
-  webSocketManager.begin();
-  foodManager.begin(SD_CS);
+  webServerManager.begin(WIFI_SSID, WIFI_PASSWORD);
+  webSocketManager.begin(webServerManager.httpServer());
 
-  initSpectralSensor(colorSensor);
+  if (initSpectralSensor(colorSensor)) {
+    startSpectralAcquisition(colorSensor);
+  } else {
+    Serial.println("⚠️ AS7341 not found, spectral classification disabled");
+  }
 
   scale_setup();
-  resetDailyTotals();
-}
-
-void loop() {
 
-  weight = scale_getWeight();
-
-  webServerManager.handle();
-  webSocketManager.handle(weight, tareScale);
-
-  if (!timeSynced && time(nullptr) > 24 * 3600) {
-    Serial.println("✅ Time synchronized!");
-    timeSynced = true;
-  }
-
-  if (needDisplayUpdate) {
-    String ip = webServerManager.getDeviceIP().toString();
-    String mode = webServerManager.getCurrentMode() == MODE_STA ? "STA" : "AP";
-    displayManager.updateDisplay(weight, &currentFood, dailyTotals, ip, mode);
-    needDisplayUpdate = false;
-  }
+  // The app task owns all shared state; start it before anything can post
+  app_start();
+  bleManager.begin();
 
-  delay(50);
+  xTaskCreatePinnedToCore(webTask, "web", WEB_TASK_STACK, nullptr,
+                          WEB_TASK_PRIORITY, nullptr, WEB_TASK_CORE);
+  xTaskCreatePinnedToCore(displayTask, "display", DISPLAY_TASK_STACK, nullptr,
+                          DISPLAY_TASK_PRIORITY, nullptr, DISPLAY_TASK_CORE);
 }
 
+// Everything runs in the tasks started by setup()
+void loop() {
+  vTaskDelete(nullptr);
+}
@@ -0,0 +1,317 @@
+#include <unity.h>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "FoodManager.h"
+#include "NativeHal.h"
+#include <sqlite3.h>
+
+// Every test gets a database of its own under a temporary SD root
+static FoodManager foodManager;
+static int databases = 0;
+static char dbPath[32];
+
+void setUp() {
+    snprintf(dbPath, sizeof(dbPath), "/sd/test%d.db", ++databases);
+    foodManager.begin(0, dbPath);
+    foodManager.addFood("Apple", 52, 0.3f, 14, 0.2f);
+    foodManager.addFood("Bread", 265, 9, 49, 3.2f);
+    foodManager.addFood("Cheese", 402, 25, 1.3f, 33);
+}
+
+void tearDown() {
+    foodManager.end();
+}
+
+static void logFood(const char* name, float grams, time_t ts) {
+    FoodItem food;
+    TEST_ASSERT_TRUE(foodManager.findFood(name, food));
+    float factor = grams / 100;
+    DailyNutrition macros = {food.calories * factor, food.protein * factor, food.carbs * factor, food.fat * factor};
+    TEST_ASSERT_TRUE(foodManager.queueLogEntry(food, grams, ts ? "logged" : "offline", ts, macros, ""));
+}
+
+static std::vector<HistoryRow> history(HistoryBucket bucket, int32_t fromDay, int32_t toDay) {
+    HistoryQuery query = {bucket, fromDay, toDay};
+    std::vector<HistoryRow> rows;
+    HistoryRow page[4];
+    while (size_t n = foodManager.readHistory(query, page, 4)) rows.insert(rows.end(), page, page + n);
+    return rows;
+}
+
+static time_t today() {
+    return time(nullptr);
+}
+
+/* ---------- rollups and startup ---------- */
+
+// What a boot restores comes from today's rollup row only: other days and
+// entries logged before the clock synced stay out of it
+static void test_restart_restores_only_today() {
+    time_t now = today();
+    logFood("Apple", 200, now);                 // 104 kcal
+    logFood("Bread", 100, now);                 // 265 kcal
+    logFood("Cheese", 100, now - 3 * 86400);
+    logFood("Cheese", 50, 0);
+    TEST_ASSERT_TRUE(foodManager.flushLogQueue());
+
+    foodManager.end();
+    foodManager.begin(0, dbPath);
+
+    DailyNutrition totals = {0, 0, 0, 0};
+    TEST_ASSERT_TRUE(foodManager.restoreDailyTotalsFromDatabase(totals));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 104 + 265, totals.calories);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.6f + 9, totals.protein);
+}
+
+static void test_restore_with_nothing_today() {
+    logFood("Apple", 100, today() - 86400);
+    DailyNutrition totals = {1, 1, 1, 1};
+    TEST_ASSERT_FALSE(foodManager.restoreDailyTotalsFromDatabase(totals));
+    TEST_ASSERT_EQUAL_FLOAT(1, totals.calories);
+}
+
+// The rollups kept up entry by entry are the ones a full rebuild from
+// LogEntry gives
+static void test_rollups_match_a_rebuild() {
+    int32_t day = 20250303;   // a Monday
+    time_t midnight = FoodManager::dayStart(day);
+    logFood("Apple", 150, midnight + 8 * 3600);          // breakfast
+    logFood("Bread", 80, midnight + 8 * 3600 + 600);     // breakfast
+    logFood("Cheese", 30, midnight + 12 * 3600);         // lunch
+    logFood("Bread", 60, midnight + 23 * 3600);          // snack
+    logFood("Apple", 100, midnight + 86400 + 9 * 3600);  // next day
+    TEST_ASSERT_TRUE(foodManager.flushLogQueue());
+
+    std::vector<HistoryRow> meals = history(HISTORY_MEAL, day, day + 1);
+    std::vector<HistoryRow> days = history(HISTORY_DAY, day, day + 1);
+    TEST_ASSERT_EQUAL(4, meals.size());
+    TEST_ASSERT_EQUAL(2, days.size());
+    TEST_ASSERT_EQUAL(MEAL_BREAKFAST, meals[0].meal);
+    TEST_ASSERT_EQUAL(2, meals[0].entries);
+    TEST_ASSERT_EQUAL(MEAL_LUNCH, meals[1].meal);
+    TEST_ASSERT_EQUAL(MEAL_SNACK, meals[2].meal);
+    TEST_ASSERT_EQUAL(4, days[0].entries);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 78 + 212 + 120.6f + 159, days[0].totals.calories);
+
+    std::vector<HistoryRow> weeks = history(HISTORY_WEEK, day, day + 6);
+    TEST_ASSERT_EQUAL(1, weeks.size());
+    TEST_ASSERT_EQUAL(day, weeks[0].day);
+    TEST_ASSERT_EQUAL(5, weeks[0].entries);
+
+    TEST_ASSERT_TRUE(foodManager.rebuildRollups());
+    std::vector<HistoryRow> rebuilt = history(HISTORY_MEAL, day, day + 1);
+    TEST_ASSERT_EQUAL(meals.size(), rebuilt.size());
+    for (size_t i = 0; i < meals.size(); ++i) {
+        TEST_ASSERT_EQUAL(meals[i].day, rebuilt[i].day);
+        TEST_ASSERT_EQUAL(meals[i].meal, rebuilt[i].meal);
+        TEST_ASSERT_EQUAL(meals[i].entries, rebuilt[i].entries);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, meals[i].totals.calories, rebuilt[i].totals.calories);
+    }
+}
+
+static void test_reset_survives_restart() {
+    time_t now = today();
+    logFood("Bread", 100, now);
+    TEST_ASSERT_TRUE(foodManager.resetDailyTotals(now));
+    logFood("Apple", 100, now);
+
+    foodManager.end();
+    foodManager.begin(0, dbPath);
+
+    DailyNutrition totals = {0, 0, 0, 0};
+    TEST_ASSERT_TRUE(foodManager.restoreDailyTotalsFromDatabase(totals));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 52, totals.calories);
+
+    // History still has the whole day
+    std::vector<HistoryRow> days = history(HISTORY_DAY, FoodManager::dayKey(now), FoodManager::dayKey(now));
+    TEST_ASSERT_EQUAL(1, days.size());
+    TEST_ASSERT_EQUAL(2, days[0].entries);
+}
+
+static void test_delete_food_takes_its_entries_out_of_the_rollups() {
+    int32_t day = 20250310;
+    time_t midnight = FoodManager::dayStart(day);
+    logFood("Cheese", 100, midnight + 8 * 3600);
+    logFood("Cheese", 100, midnight + 86400 + 12 * 3600);
+    logFood("Apple", 100, midnight + 12 * 3600);
+    TEST_ASSERT_TRUE(foodManager.flushLogQueue());
+
+    TEST_ASSERT_TRUE(foodManager.deleteFood("Cheese"));
+    FoodItem gone;
+    TEST_ASSERT_FALSE(foodManager.findFood("Cheese", gone));
+
+    std::vector<HistoryRow> days = history(HISTORY_DAY, day, day + 1);
+    TEST_ASSERT_EQUAL(1, days.size());
+    TEST_ASSERT_EQUAL(day, days[0].day);
+    TEST_ASSERT_EQUAL(1, days[0].entries);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 52, days[0].totals.calories);
+
+    std::vector<HistoryRow> meals = history(HISTORY_MEAL, day, day + 1);
+    TEST_ASSERT_EQUAL(1, meals.size());
+    TEST_ASSERT_EQUAL(MEAL_LUNCH, meals[0].meal);
+}
+
+// A card from before names were unique: a second "apple" with entries of
+// its own. Deleting the name takes both foods' days out of the rollups.
+static void test_delete_food_with_a_repeated_name() {
+    int32_t day = 20250312;
+    time_t midnight = FoodManager::dayStart(day);
+    logFood("Apple", 100, midnight + 8 * 3600);
+    logFood("Bread", 100, midnight + 12 * 3600);
+    TEST_ASSERT_TRUE(foodManager.flushLogQueue());
+    TEST_ASSERT_FALSE(foodManager.addFood("apple", 52, 0.3f, 14, 0.2f));
+    foodManager.end();
+
+    sqlite3* db;
+    TEST_ASSERT_EQUAL(SQLITE_OK, sqlite3_open(dbPath, &db));
+    char sql[512];
+    snprintf(sql, sizeof(sql), R"(
+        DROP INDEX idx_food_name;
+        INSERT INTO Food (name, calories, protein, carbs, fat) VALUES ('apple', 52, 0.3, 14, 0.2);
+        INSERT INTO LogEntry (timestamp, food_id, grams, calories, protein, carbs, fat, ts)
+        VALUES ('logged', last_insert_rowid(), 100, 52, 0.3, 14, 0.2, %lld);
+        PRAGMA user_version = 2;
+    )", (long long)(midnight + 86400 + 8 * 3600));
+    TEST_ASSERT_EQUAL(SQLITE_OK, sqlite3_exec(db, sql, nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    foodManager.begin(0, dbPath);
+    TEST_ASSERT_TRUE(foodManager.rebuildRollups());
+    TEST_ASSERT_EQUAL(2, history(HISTORY_DAY, day, day + 1).size());
+    TEST_ASSERT_EQUAL(3, foodManager.getIndex().size());
+
+    TEST_ASSERT_TRUE(foodManager.deleteFood("APPLE"));
+    std::vector<HistoryRow> days = history(HISTORY_DAY, day, day + 1);
+    TEST_ASSERT_EQUAL(1, days.size());
+    TEST_ASSERT_EQUAL(day, days[0].day);
+    TEST_ASSERT_EQUAL(1, days[0].entries);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 265, days[0].totals.calories);
+    TEST_ASSERT_EQUAL(1, history(HISTORY_MEAL, day, day + 1).size());
+}
+
+/* ---------- batched log writes ---------- */
+
+static void test_entries_wait_in_the_queue_until_a_batch_fills() {
+    int32_t day = 20250317;
+    time_t noon = FoodManager::dayStart(day) + 12 * 3600;
+    for (int i = 0; i < LOG_FLUSH_THRESHOLD - 1; ++i) logFood("Apple", 10, noon + i);
+
+    TEST_ASSERT_EQUAL(LOG_FLUSH_THRESHOLD - 1, foodManager.pendingLogCount());
+    TEST_ASSERT_EQUAL(0, history(HISTORY_DAY, day, day).size());
+
+    logFood("Apple", 10, noon + 60);
+    TEST_ASSERT_EQUAL(0, foodManager.pendingLogCount());
+    std::vector<HistoryRow> days = history(HISTORY_DAY, day, day);
+    TEST_ASSERT_EQUAL(1, days.size());
+    TEST_ASSERT_EQUAL(LOG_FLUSH_THRESHOLD, days[0].entries);
+}
+
+static void test_end_flushes_the_queue() {
+    int32_t day = 20250318;
+    logFood("Bread", 50, FoodManager::dayStart(day) + 9 * 3600);
+    TEST_ASSERT_EQUAL(1, foodManager.pendingLogCount());
+
+    foodManager.end();
+    foodManager.begin(0, dbPath);
+    std::vector<HistoryRow> days = history(HISTORY_DAY, day, day);
+    TEST_ASSERT_EQUAL(1, days.size());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 132.5f, days[0].totals.calories);
+}
+
+static void test_database_is_in_wal_mode() {
+    logFood("Apple", 10, today());
+    TEST_ASSERT_TRUE(foodManager.flushLogQueue());
+
+    std::string wal = native_sdPath(dbPath) + "-wal";
+    FILE* f = fopen(wal.c_str(), "rb");
+    TEST_ASSERT_NOT_NULL_MESSAGE(f, "no write-ahead log next to the database");
+    fclose(f);
+}
+
+/* ---------- catalogue import ---------- */
+
+// A name repeated within one import is a duplicate too, although FoodIndex
+// only learns the new names at endImport()
+static void test_import_skips_names_repeated_in_the_file() {
+    FoodMacros pear = {57, 0.4f, 15, 0.1f};
+    TEST_ASSERT_TRUE(foodManager.beginImport());
+    TEST_ASSERT_EQUAL(IMPORT_DUPLICATE, foodManager.importFood("apple", pear));
+    TEST_ASSERT_EQUAL(IMPORT_ADDED, foodManager.importFood("Pear", pear));
+    TEST_ASSERT_EQUAL(IMPORT_DUPLICATE, foodManager.importFood("pear", pear));
+    TEST_ASSERT_EQUAL(IMPORT_DUPLICATE, foodManager.importFood(" Pear ", pear));
+    TEST_ASSERT_TRUE(foodManager.endImport());
+
+    TEST_ASSERT_EQUAL(4, foodManager.getIndex().size());
+    TEST_ASSERT_TRUE(foodManager.deleteFood("Pear"));
+    FoodItem gone;
+    TEST_ASSERT_FALSE(foodManager.findFood("Pear", gone));
+}
+
+/* ---------- prepared statement cache ---------- */
+
+// A page cut short by its LIMIT leaves the statement mid-step; the next
+// call must start from its own bindings
+static void test_paged_walk_sees_every_food_once() {
+    TEST_ASSERT_TRUE(foodManager.setFoodColor(2, "Brown"));
+    std::vector<std::string> seen;
+    int after = 0, last;
+    while ((last = foodManager.forEachFoodColor(after, 1, [&](const char* name, const char* color) {
+               seen.push_back(std::string(name) + "/" + color);
+           })) != after) {
+        after = last;
+    }
+    TEST_ASSERT_EQUAL(3, seen.size());
+    TEST_ASSERT_EQUAL_STRING("Apple/", seen[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("Bread/Brown", seen[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("Cheese/", seen[2].c_str());
+}
+
+static void test_statement_is_reusable_after_a_miss() {
+    TEST_ASSERT_FALSE(foodManager.deleteFood("Durian"));
+    TEST_ASSERT_TRUE(foodManager.deleteFood("Apple"));
+    TEST_ASSERT_FALSE(foodManager.deleteFood("Apple"));
+    TEST_ASSERT_TRUE(foodManager.deleteFood("Bread"));
+}
+
+// end() finalizes the cached statements; they are prepared again on the
+// reopened database
+static void test_statements_work_after_reopen() {
+    TEST_ASSERT_TRUE(foodManager.saveContainer("Bowl", 210));
+    foodManager.end();
+    foodManager.begin(0, dbPath);
+
+    TEST_ASSERT_TRUE(foodManager.saveContainer("Plate", 380));
+    ContainerItem bowl;
+    TEST_ASSERT_TRUE(foodManager.findContainer("bowl", bowl));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 210, bowl.tareGrams);
+    TEST_ASSERT_TRUE(foodManager.deleteContainer("Plate"));
+    TEST_ASSERT_EQUAL(1, foodManager.containerCount());
+}
+
+int main() {
+    char root[] = "/tmp/scale-test-XXXXXX";
+    if (!mkdtemp(root)) return 1;
+    setenv("SCALE_SD_ROOT", root, 1);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_restart_restores_only_today);
+    RUN_TEST(test_restore_with_nothing_today);
+    RUN_TEST(test_rollups_match_a_rebuild);
+    RUN_TEST(test_reset_survives_restart);
+    RUN_TEST(test_delete_food_takes_its_entries_out_of_the_rollups);
+    RUN_TEST(test_delete_food_with_a_repeated_name);
+    RUN_TEST(test_entries_wait_in_the_queue_until_a_batch_fills);
+    RUN_TEST(test_end_flushes_the_queue);
+    RUN_TEST(test_database_is_in_wal_mode);
+    RUN_TEST(test_import_skips_names_repeated_in_the_file);
+    RUN_TEST(test_paged_walk_sees_every_food_once);
+    RUN_TEST(test_statement_is_reusable_after_a_miss);
+    RUN_TEST(test_statements_work_after_reopen);
+    int failures = UNITY_END();
+
+    std::filesystem::remove_all(root);
+    return failures;
+}
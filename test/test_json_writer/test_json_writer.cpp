@@ -0,0 +1,104 @@
+#include <unity.h>
+#include <cmath>
+#include <string>
+#include "JsonWriter.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Collects everything flushed, and how often it was
+struct Sink {
+    std::string out;
+    int flushes = 0;
+};
+
+static void collect(void* ctx, const char* data, size_t len) {
+    Sink& sink = *static_cast<Sink*>(ctx);
+    sink.out.append(data, len);
+    sink.flushes++;
+}
+
+static void test_nested_document() {
+    char buf[256];
+    Sink sink;
+    JsonWriter json(buf, sizeof(buf), collect, &sink);
+    json.beginObject();
+    json.key("food").value("Apple");
+    json.key("grams").value(120.0f, 1);
+    json.key("stable").value(true);
+    json.key("tags").beginArray().value("red").value("fruit").endArray();
+    json.key("empty").beginArray().endArray();
+    json.key("macros").beginObject().key("fat").value(0.25f).key("id").value((int32_t)-7).endObject();
+    json.key("none").null();
+    json.endObject();
+    json.flush();
+
+    TEST_ASSERT_EQUAL_STRING(
+        R"({"food":"Apple","grams":120,"stable":true,"tags":["red","fruit"],"empty":[],)"
+        R"("macros":{"fat":0.25,"id":-7},"none":null})",
+        sink.out.c_str());
+    TEST_ASSERT_EQUAL_UINT32(sink.out.size(), json.bytesWritten());
+}
+
+static void test_strings_are_escaped() {
+    char buf[64];
+    Sink sink;
+    JsonWriter json(buf, sizeof(buf), collect, &sink);
+    json.beginArray().value("say \"hi\"\\\n\t\x01").value((const char*)nullptr).endArray();
+    json.flush();
+    TEST_ASSERT_EQUAL_STRING(R"(["say \"hi\"\\\n\t\u0001",null])", sink.out.c_str());
+}
+
+static void test_numbers_drop_trailing_zeros() {
+    char buf[64];
+    Sink sink;
+    JsonWriter json(buf, sizeof(buf), collect, &sink);
+    json.beginArray();
+    json.value(12.5f).value(3.0f).value(0.004f).value(-1.26, 1).value((int64_t)1767225600123LL);
+    json.value(NAN).value(INFINITY);
+    json.endArray();
+    json.flush();
+    TEST_ASSERT_EQUAL_STRING("[12.5,3,0,-1.3,1767225600123,null,null]", sink.out.c_str());
+}
+
+// A document many times the buffer goes out in buffer-sized chunks and
+// comes out the same as one written in a single piece
+static void test_small_buffer_streams_in_chunks() {
+    char big[8192], small[16];
+    Sink whole, chunked;
+    JsonWriter a(big, sizeof(big), collect, &whole);
+    JsonWriter b(small, sizeof(small), collect, &chunked);
+
+    for (JsonWriter* json : {&a, &b}) {
+        json->beginArray();
+        for (int32_t i = 0; i < 200; ++i) {
+            json->beginObject().key("i").value(i).key("name").value("food \"x\"").endObject();
+        }
+        json->endArray();
+        json->flush();
+    }
+
+    TEST_ASSERT_EQUAL_STRING(whole.out.c_str(), chunked.out.c_str());
+    TEST_ASSERT_EQUAL(1, whole.flushes);
+    TEST_ASSERT_EQUAL((int)((chunked.out.size() + sizeof(small) - 1) / sizeof(small)), chunked.flushes);
+    TEST_ASSERT_EQUAL_UINT32(chunked.out.size(), b.bytesWritten());
+}
+
+static void test_raw_fragment_takes_a_comma() {
+    char buf[64];
+    Sink sink;
+    JsonWriter json(buf, sizeof(buf), collect, &sink);
+    json.beginArray().value((int32_t)1).raw("{\"cached\":1}", 12).value((int32_t)2).endArray();
+    json.flush();
+    TEST_ASSERT_EQUAL_STRING(R"([1,{"cached":1},2])", sink.out.c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_nested_document);
+    RUN_TEST(test_strings_are_escaped);
+    RUN_TEST(test_numbers_drop_trailing_zeros);
+    RUN_TEST(test_small_buffer_streams_in_chunks);
+    RUN_TEST(test_raw_fragment_takes_a_comma);
+    return UNITY_END();
+}
@@ -0,0 +1,87 @@
+#include <unity.h>
+#include <thread>
+#include "SampleRing.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_pops_in_push_order() {
+    SampleRing<int, 4> ring;
+    TEST_ASSERT_TRUE(ring.empty());
+    for (int i = 1; i <= 3; ++i) TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_EQUAL(3, ring.size());
+
+    int out;
+    for (int i = 1; i <= 3; ++i) {
+        TEST_ASSERT_TRUE(ring.pop(out));
+        TEST_ASSERT_EQUAL(i, out);
+    }
+    TEST_ASSERT_FALSE(ring.pop(out));
+}
+
+static void test_full_ring_drops_and_counts() {
+    SampleRing<int, 4> ring;
+    for (int i = 0; i < 4; ++i) TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_FALSE(ring.push(4));
+    TEST_ASSERT_FALSE(ring.push(5));
+    TEST_ASSERT_EQUAL_UINT32(2, ring.droppedCount());
+
+    // The oldest samples stay; the ones that did not fit are gone
+    int out;
+    TEST_ASSERT_TRUE(ring.pop(out));
+    TEST_ASSERT_EQUAL(0, out);
+    TEST_ASSERT_TRUE(ring.push(6));
+    for (int expected : {1, 2, 3, 6}) {
+        TEST_ASSERT_TRUE(ring.pop(out));
+        TEST_ASSERT_EQUAL(expected, out);
+    }
+}
+
+static void test_indices_wrap_around() {
+    SampleRing<int, 4> ring;
+    int out;
+    for (int i = 0; i < 1000; ++i) {
+        TEST_ASSERT_TRUE(ring.push(i));
+        TEST_ASSERT_TRUE(ring.push(i + 1000));
+        TEST_ASSERT_TRUE(ring.pop(out));
+        TEST_ASSERT_EQUAL(i, out);
+        TEST_ASSERT_TRUE(ring.pop(out));
+        TEST_ASSERT_EQUAL(i + 1000, out);
+    }
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.droppedCount());
+}
+
+// Producer and consumer on their own threads, as the HX711 task and the
+// app task use it: every sample arrives once and in order
+static void test_producer_and_consumer_threads() {
+    static SampleRing<uint32_t, 64> ring;
+    const uint32_t count = 200000;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < count; ++i) {
+            while (!ring.push(i)) std::this_thread::yield();
+        }
+    });
+
+    uint32_t next = 0, value;
+    bool inOrder = true;
+    while (next < count) {
+        if (!ring.pop(value)) continue;
+        inOrder &= value == next;
+        next++;
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(inOrder);
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_pops_in_push_order);
+    RUN_TEST(test_full_ring_drops_and_counts);
+    RUN_TEST(test_indices_wrap_around);
+    RUN_TEST(test_producer_and_consumer_threads);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+#include "ScreenModel.h"   // before unity.h: point.h's abs() on unsigned is ambiguous once <stdlib.h> is in
+#include <unity.h>
+#include <cstring>
+
+void setUp() {}
+void tearDown() {}
+
+static void assertRect(const Rectangle& rect, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    TEST_ASSERT_EQUAL_UINT32(x, rect.topLeft.x);
+    TEST_ASSERT_EQUAL_UINT32(y, rect.topLeft.y);
+    TEST_ASSERT_EQUAL_UINT32(width, rect.width);
+    TEST_ASSERT_EQUAL_UINT32(height, rect.height);
+}
+
+// Weight is drawn at text size 3: 18x24 pixel cells
+static const uint32_t CELL_W = SCREEN_GLYPH_W * 3;
+static const uint32_t CELL_H = SCREEN_GLYPH_H * 3;
+
+static ScreenModel shown(const char* weight) {
+    ScreenModel model;
+    model.set(FIELD_WEIGHT, weight);
+    model.markClean(FIELD_WEIGHT);
+    return model;
+}
+
+static void test_unchanged_field_is_clean() {
+    ScreenModel model = shown("123.4 g");
+    model.set(FIELD_WEIGHT, "123.4 g");
+    TEST_ASSERT_EQUAL_UINT32(0, model.dirtyRect(FIELD_WEIGHT).width);
+}
+
+static void test_only_changed_digits_are_dirty() {
+    ScreenModel model = shown("123.4 g");
+    const ScreenFieldLayout& l = model.layout(FIELD_WEIGHT);
+
+    model.set(FIELD_WEIGHT, "123.7 g");
+    assertRect(model.dirtyRect(FIELD_WEIGHT), l.x + 4 * CELL_W, l.y, CELL_W, CELL_H);
+
+    // First to last differing column, unchanged ones in between included
+    model.set(FIELD_WEIGHT, "128.9 g");
+    assertRect(model.dirtyRect(FIELD_WEIGHT), l.x + 2 * CELL_W, l.y, 3 * CELL_W, CELL_H);
+}
+
+// Columns past the end of the shorter text compare as blanks, so a shorter
+// text erases the leftover characters and nothing more
+static void test_length_changes_cover_the_tail() {
+    ScreenModel model = shown("99.5 g");
+    const ScreenFieldLayout& l = model.layout(FIELD_WEIGHT);
+
+    model.set(FIELD_WEIGHT, "100.0 g");
+    assertRect(model.dirtyRect(FIELD_WEIGHT), l.x, l.y, 7 * CELL_W, CELL_H);
+    model.markClean(FIELD_WEIGHT);
+
+    model.set(FIELD_WEIGHT, "100.0");
+    assertRect(model.dirtyRect(FIELD_WEIGHT), l.x + 6 * CELL_W, l.y, CELL_W, CELL_H);   // the "g"
+}
+
+static void test_invalidate_repaints_whole_lines() {
+    ScreenModel model;
+    model.set(FIELD_TITLE, "Smart Scale");
+    model.set(FIELD_WEIGHT, "0.0 g");
+    model.render([](ScreenField, const Rectangle&, const char*, const ScreenFieldLayout&) {});
+
+    model.invalidate();
+    const ScreenFieldLayout& title = model.layout(FIELD_TITLE);
+    assertRect(model.dirtyRect(FIELD_TITLE), title.x, title.y, 11 * SCREEN_GLYPH_W, SCREEN_GLYPH_H);
+    // Empty fields have nothing to paint even after a clear
+    TEST_ASSERT_EQUAL_UINT32(0, model.dirtyRect(FIELD_IP).width);
+}
+
+static void test_render_paints_dirty_fields_once() {
+    ScreenModel model;
+    model.set(FIELD_WEIGHT, "5.0 g");
+    model.setf(FIELD_FOOD, "%s", "Apple");
+
+    int painted = 0;
+    uint32_t fieldsPainted = 0;
+    auto paint = [&](ScreenField field, const Rectangle&, const char*, const ScreenFieldLayout&) {
+        painted++;
+        fieldsPainted |= 1u << field;
+    };
+    model.render(paint);
+    TEST_ASSERT_EQUAL(2, painted);
+    TEST_ASSERT_EQUAL_UINT32((1u << FIELD_WEIGHT) | (1u << FIELD_FOOD), fieldsPainted);
+
+    model.render(paint);
+    TEST_ASSERT_EQUAL(2, painted);
+
+    model.set(FIELD_FOOD, "Apple");
+    model.set(FIELD_WEIGHT, "5.5 g");
+    model.render(paint);
+    TEST_ASSERT_EQUAL(3, painted);
+}
+
+static void test_long_text_is_cut_to_the_field() {
+    ScreenModel model;
+    model.set(FIELD_FOOD, "A food name that is far too long for one line");
+    TEST_ASSERT_EQUAL_UINT32(SCREEN_TEXT_MAX - 1, strlen(model.text(FIELD_FOOD)));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_unchanged_field_is_clean);
+    RUN_TEST(test_only_changed_digits_are_dirty);
+    RUN_TEST(test_length_changes_cover_the_tail);
+    RUN_TEST(test_invalidate_repaints_whole_lines);
+    RUN_TEST(test_render_paints_dirty_fields_once);
+    RUN_TEST(test_long_text_is_cut_to_the_field);
+    return UNITY_END();
+}
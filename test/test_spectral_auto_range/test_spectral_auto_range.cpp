@@ -0,0 +1,135 @@
+#include <unity.h>
+#include "SpectralAutoRange.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Spectrum whose peak channel sits at `level` of full scale
+static void spectrumAt(float level, const SpectralSettings& settings, uint16_t* channels) {
+    for (int i = 0; i < 10; ++i) channels[i] = 10;
+    channels[3] = (uint16_t)(level * settings.fullScale());
+}
+
+static void test_in_band_changes_nothing() {
+    SpectralSettings settings;
+    uint16_t channels[10];
+    spectrumAt(0.5f, settings, channels);
+    TEST_ASSERT_FALSE(SpectralAutoRange::update(channels, settings));
+    TEST_ASSERT_TRUE(settings == SpectralSettings());
+}
+
+static void test_bright_steps_gain_down_clipped_twice_as_far() {
+    SpectralSettings settings;
+    uint16_t channels[10];
+    spectrumAt(0.9f, settings, channels);
+    TEST_ASSERT_TRUE(SpectralAutoRange::update(channels, settings));
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_AGAIN_DEFAULT - 1, settings.again);
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_ATIME_DEFAULT, settings.atime);
+
+    settings = SpectralSettings();
+    spectrumAt(1.0f, settings, channels);
+    TEST_ASSERT_TRUE(SpectralAutoRange::saturated(channels, settings));
+    SpectralAutoRange::update(channels, settings);
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_AGAIN_DEFAULT - 2, settings.again);
+}
+
+// Each gain step doubles the counts; a dark spectrum takes as many as
+// bring it to the middle of the band, at most three
+static void test_dark_steps_gain_up_towards_mid_band() {
+    SpectralSettings settings;
+    uint16_t channels[10];
+    spectrumAt(0.15f, settings, channels);
+    SpectralAutoRange::update(channels, settings);
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_AGAIN_DEFAULT + 1, settings.again);
+
+    settings = SpectralSettings();
+    spectrumAt(0.01f, settings, channels);
+    SpectralAutoRange::update(channels, settings);
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_AGAIN_DEFAULT + 3, settings.again);
+}
+
+static void test_integration_only_moves_at_gain_limits() {
+    SpectralSettings settings;
+    uint16_t channels[10];
+
+    settings.again = SPECTRAL_AGAIN_MAX;
+    spectrumAt(0.05f, settings, channels);
+    SpectralAutoRange::update(channels, settings);
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_AGAIN_MAX, settings.again);
+    TEST_ASSERT_EQUAL_UINT8((SPECTRAL_ATIME_DEFAULT + 1) * 2 - 1, settings.atime);
+
+    // Longer integration is given back before the gain drops
+    spectrumAt(0.9f, settings, channels);
+    SpectralAutoRange::update(channels, settings);
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_AGAIN_MAX, settings.again);
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_ATIME_DEFAULT, settings.atime);
+
+    settings = SpectralSettings();
+    settings.again = 0;
+    spectrumAt(0.9f, settings, channels);
+    SpectralAutoRange::update(channels, settings);
+    TEST_ASSERT_EQUAL_UINT8(0, settings.again);
+    TEST_ASSERT_EQUAL_UINT8((SPECTRAL_ATIME_DEFAULT + 1) / 2 - 1, settings.atime);
+}
+
+static void test_integration_stays_within_limits() {
+    SpectralSettings settings;
+    uint16_t channels[10];
+
+    settings.again = SPECTRAL_AGAIN_MAX;
+    for (int i = 0; i < 10; ++i) {
+        spectrumAt(0.01f, settings, channels);
+        SpectralAutoRange::update(channels, settings);
+    }
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_ATIME_MAX, settings.atime);
+    TEST_ASSERT_EQUAL_UINT32(65535, settings.fullScale());
+
+    settings = SpectralSettings();
+    settings.again = 0;
+    for (int i = 0; i < 10; ++i) {
+        spectrumAt(1.0f, settings, channels);
+        SpectralAutoRange::update(channels, settings);
+    }
+    TEST_ASSERT_EQUAL_UINT8(SPECTRAL_ATIME_MIN, settings.atime);
+}
+
+// A simulated sensor: counts grow with gain (x0.5 at AGAIN 0, doubling per
+// step) and integration time, and clip at full scale. From any light level
+// the loop settles within a few spectra: inside the band where the settings
+// can reach it, at the longest integration and gain where they cannot.
+static void test_converges_for_any_light_level() {
+    const float lights[] = {0.02f, 0.3f, 3.0f, 40.0f, 900.0f};
+    for (float light : lights) {
+        SpectralSettings settings;
+        uint16_t channels[10];
+        bool settled = false;
+        for (int step = 0; step < 12 && !settled; ++step) {
+            float counts = light * (float)(1u << settings.again) / 2 * (settings.atime + 1);
+            uint32_t full = settings.fullScale();
+            for (int i = 0; i < 10; ++i) channels[i] = 10;
+            channels[3] = (uint16_t)(counts > full ? full : counts);
+            settled = !SpectralAutoRange::update(channels, settings);
+        }
+        TEST_ASSERT_TRUE_MESSAGE(settled, "auto-range did not settle");
+        TEST_ASSERT_FALSE(SpectralAutoRange::saturated(channels, settings));
+
+        float level = (float)channels[3] / settings.fullScale();
+        if (light < 0.3f) {
+            TEST_ASSERT_EQUAL_UINT8(SPECTRAL_AGAIN_MAX, settings.again);
+            TEST_ASSERT_EQUAL_UINT8(SPECTRAL_ATIME_MAX, settings.atime);
+        } else {
+            TEST_ASSERT_TRUE(level >= SPECTRAL_RANGE_LOW && level <= SPECTRAL_RANGE_HIGH);
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_in_band_changes_nothing);
+    RUN_TEST(test_bright_steps_gain_down_clipped_twice_as_far);
+    RUN_TEST(test_dark_steps_gain_up_towards_mid_band);
+    RUN_TEST(test_integration_only_moves_at_gain_limits);
+    RUN_TEST(test_integration_stays_within_limits);
+    RUN_TEST(test_converges_for_any_light_level);
+    return UNITY_END();
+}
@@ -0,0 +1,131 @@
+#include <unity.h>
+#include "WeightFilter.h"
+
+#define SAMPLE_MS 12   // HX711 at 80 Hz
+
+void setUp() {}
+void tearDown() {}
+
+// Feeds count samples of grams and returns the last reading
+static WeightReading feed(WeightFilter& filter, float grams, int count, uint32_t& now) {
+    WeightReading reading;
+    for (int i = 0; i < count; ++i) {
+        reading = filter.push(grams, now);
+        now += SAMPLE_MS;
+    }
+    return reading;
+}
+
+static void test_median_rejects_a_single_spike() {
+    WeightFilter filter;
+    uint32_t now = 0;
+    feed(filter, 100.0f, 40, now);
+
+    WeightReading reading = filter.push(900.0f, now);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f, reading.grams);
+    TEST_ASSERT_TRUE(reading.stable);
+}
+
+static void test_average_smooths_noise() {
+    WeightFilter filter;
+    uint32_t now = 0;
+    WeightReading reading;
+    for (int i = 0; i < 64; ++i) {
+        reading = filter.push(i % 2 ? 50.4f : 49.6f, now);
+        now += SAMPLE_MS;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 50.0f, reading.grams);
+    TEST_ASSERT_TRUE(reading.stable);
+}
+
+// A step restarts the average: the output jumps to the new load as soon as
+// the median has, instead of creeping there over the averaging window
+static void test_step_is_followed_at_once() {
+    WeightFilter filter;
+    uint32_t now = 0;
+    feed(filter, 0.0f, 40, now);
+
+    WeightReading reading = feed(filter, 250.0f, WEIGHT_MEDIAN_SIZE / 2 + 1, now);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 250.0f, reading.grams);
+    TEST_ASSERT_FALSE(reading.stable);
+}
+
+static void test_stable_after_hold_time_with_settle_time() {
+    WeightFilter filter;
+    uint32_t now = 0;
+    TEST_ASSERT_TRUE(feed(filter, 0.0f, 40, now).stable);
+
+    // The median passes the new load on after half its window; from then on
+    // the reading has to stay in the band for the hold time
+    uint32_t placedAt = now;
+    uint32_t movedAt = 0, stableAt = 0;
+    for (int i = 0; i < 100 && !stableAt; ++i) {
+        WeightReading reading = filter.push(120.0f, now);
+        if (!movedAt && reading.grams > 60.0f) movedAt = now;
+        if (movedAt && reading.stable) stableAt = now;
+        TEST_ASSERT_TRUE(movedAt || reading.stable);   // the old load stays stable until then
+        now += SAMPLE_MS;
+    }
+    TEST_ASSERT_EQUAL_UINT32(placedAt + (WEIGHT_MEDIAN_SIZE / 2) * SAMPLE_MS, movedAt);
+    TEST_ASSERT_NOT_EQUAL(0, stableAt);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(movedAt + WEIGHT_STABLE_HOLD_MS, stableAt);
+    TEST_ASSERT_LESS_THAN_UINT32(movedAt + WEIGHT_STABLE_HOLD_MS + SAMPLE_MS, stableAt);
+    TEST_ASSERT_EQUAL_UINT32(stableAt - movedAt, filter.reading().settleMs);
+}
+
+static void test_drift_outside_band_clears_stable() {
+    WeightFilter filter;
+    uint32_t now = 0;
+    TEST_ASSERT_TRUE(feed(filter, 80.0f, 60, now).stable);
+
+    // Slow creep: each sample inside the step threshold, the total outside
+    // the stability band
+    WeightReading reading;
+    float grams = 80.0f;
+    bool lost = false;
+    for (int i = 0; i < 40; ++i) {
+        grams += 0.2f;
+        reading = filter.push(grams, now);
+        now += SAMPLE_MS;
+        lost |= !reading.stable;
+    }
+    TEST_ASSERT_TRUE(lost);
+}
+
+static void test_shift_moves_output_and_keeps_stable() {
+    WeightFilter filter;
+    uint32_t now = 0;
+    TEST_ASSERT_TRUE(feed(filter, 300.0f, 60, now).stable);
+
+    filter.shift(-300.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, filter.reading().grams);
+
+    // The next raw samples arrive tared as well
+    WeightReading reading = filter.push(0.0f, now);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, reading.grams);
+    TEST_ASSERT_TRUE(reading.stable);
+}
+
+static void test_reset_forgets_everything() {
+    WeightFilter filter;
+    uint32_t now = 0;
+    feed(filter, 42.0f, 60, now);
+    filter.reset();
+
+    TEST_ASSERT_FALSE(filter.reading().stable);
+    WeightReading reading = filter.push(7.0f, now);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 7.0f, reading.grams);
+    TEST_ASSERT_FALSE(reading.stable);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_median_rejects_a_single_spike);
+    RUN_TEST(test_average_smooths_noise);
+    RUN_TEST(test_step_is_followed_at_once);
+    RUN_TEST(test_stable_after_hold_time_with_settle_time);
+    RUN_TEST(test_drift_outside_band_clears_stable);
+    RUN_TEST(test_shift_moves_output_and_keeps_stable);
+    RUN_TEST(test_reset_forgets_everything);
+    return UNITY_END();
+}
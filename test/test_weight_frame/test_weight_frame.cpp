@@ -0,0 +1,157 @@
+#include <unity.h>
+#include "WeightFrame.h"
+
+void setUp() {}
+void tearDown() {}
+
+static WeightReading reading(float grams, uint32_t timestamp, bool stable = false) {
+    WeightReading r;
+    r.grams = grams;
+    r.timestamp = timestamp;
+    r.stable = stable;
+    return r;
+}
+
+// Everything an encoder sends comes back out of a decoder unchanged
+static void test_round_trip() {
+    WeightFrameEncoder encoder;
+    WeightFrameDecoder decoder;
+    uint8_t frame[WEIGHT_FRAME_MAX_SIZE];
+    const float weights[] = {0.0f, 12.3f, 12.3f, 250.0f, 249.9f, -3.5f, 1000.0f, 1000.0f};
+
+    uint32_t now = 1000;
+    int sent = 0;
+    for (size_t i = 0; i < sizeof(weights) / sizeof(weights[0]); ++i, now += 250) {
+        bool stable = i % 3 == 2;
+        size_t length = encoder.encode(reading(weights[i], now, stable), frame);
+        if (length == 0) continue;   // unchanged, suppressed
+        sent++;
+
+        TEST_ASSERT_EQUAL(sent == 1 ? WEIGHT_FRAME_KEY_SIZE : WEIGHT_FRAME_DELTA_SIZE, length);
+        WeightFrame out;
+        TEST_ASSERT_TRUE(decoder.decode(frame, length, out));
+        TEST_ASSERT_EQUAL_INT32(weightFrame_toDecigrams(weights[i]), out.decigrams);
+        TEST_ASSERT_EQUAL_UINT32(now, out.timestamp);
+        TEST_ASSERT_EQUAL(stable, out.stable);
+        TEST_ASSERT_EQUAL_UINT16(sent, out.sequence);
+    }
+    TEST_ASSERT_EQUAL(7, sent);   // 12.3 g twice with the same flag is one frame
+}
+
+static void test_unchanged_reading_is_suppressed() {
+    WeightFrameEncoder encoder;
+    uint8_t frame[WEIGHT_FRAME_MAX_SIZE];
+    TEST_ASSERT_EQUAL(WEIGHT_FRAME_KEY_SIZE, encoder.encode(reading(5.0f, 0), frame));
+    TEST_ASSERT_EQUAL(0, encoder.encode(reading(5.0f, 100), frame));
+    TEST_ASSERT_EQUAL(0, encoder.encode(reading(5.01f, 200), frame));   // same decigram
+
+    // The stable flag alone is a change
+    TEST_ASSERT_EQUAL(WEIGHT_FRAME_DELTA_SIZE, encoder.encode(reading(5.0f, 300, true), frame));
+}
+
+// A change beyond int16 decigrams does not fit a delta frame: the encoder
+// falls back to an absolute key frame
+static void test_delta_overflow_sends_a_key_frame() {
+    WeightFrameEncoder encoder;
+    WeightFrameDecoder decoder;
+    uint8_t frame[WEIGHT_FRAME_MAX_SIZE];
+    WeightFrame out;
+
+    decoder.decode(frame, encoder.encode(reading(0.0f, 0), frame), out);
+
+    size_t length = encoder.encode(reading(3276.7f, 100), frame);   // +32767 dg: still a delta
+    TEST_ASSERT_EQUAL(WEIGHT_FRAME_DELTA_SIZE, length);
+    TEST_ASSERT_TRUE(decoder.decode(frame, length, out));
+    TEST_ASSERT_EQUAL_INT32(32767, out.decigrams);
+
+    length = encoder.encode(reading(-1.0f, 200), frame);            // -32777 dg
+    TEST_ASSERT_EQUAL(WEIGHT_FRAME_KEY_SIZE, length);
+    TEST_ASSERT_TRUE(decoder.decode(frame, length, out));
+    TEST_ASSERT_TRUE(out.key);
+    TEST_ASSERT_EQUAL_INT32(-10, out.decigrams);
+
+    // and deltas carry on from it
+    length = encoder.encode(reading(-0.5f, 300), frame);
+    TEST_ASSERT_EQUAL(WEIGHT_FRAME_DELTA_SIZE, length);
+    TEST_ASSERT_TRUE(decoder.decode(frame, length, out));
+    TEST_ASSERT_EQUAL_INT32(-5, out.decigrams);
+}
+
+// Deltas after a lost frame would be applied to the wrong base: the
+// decoder refuses them until the next key frame
+static void test_sequence_gap_waits_for_a_key_frame() {
+    WeightFrameEncoder encoder;
+    WeightFrameDecoder decoder;
+    uint8_t frame[WEIGHT_FRAME_MAX_SIZE];
+    WeightFrame out;
+
+    TEST_ASSERT_TRUE(decoder.decode(frame, encoder.encode(reading(10.0f, 0), frame), out));
+    encoder.encode(reading(11.0f, 100), frame);   // lost on the way
+    size_t length = encoder.encode(reading(12.0f, 200), frame);
+    TEST_ASSERT_FALSE(decoder.decode(frame, length, out));
+    length = encoder.encode(reading(13.0f, 300), frame);
+    TEST_ASSERT_FALSE(decoder.decode(frame, length, out));
+
+    encoder.reset();
+    length = encoder.encode(reading(14.0f, 400), frame);
+    TEST_ASSERT_TRUE(decoder.decode(frame, length, out));
+    TEST_ASSERT_EQUAL_INT32(140, out.decigrams);
+    length = encoder.encode(reading(14.5f, 500), frame);
+    TEST_ASSERT_TRUE(decoder.decode(frame, length, out));
+    TEST_ASSERT_EQUAL_INT32(145, out.decigrams);
+}
+
+// An idle stream still gets a key frame every period, so a client can tell
+// the scale is alive and resync without waiting for a change
+static void test_heartbeat_key_frame_when_idle() {
+    WeightFrameEncoder encoder;
+    uint8_t frame[WEIGHT_FRAME_MAX_SIZE];
+    TEST_ASSERT_EQUAL(WEIGHT_FRAME_KEY_SIZE, encoder.encode(reading(7.0f, 0, true), frame));
+
+    uint32_t now = 0;
+    int keys = 0, suppressed = 0;
+    while (now < 3 * WEIGHT_FRAME_KEY_PERIOD_MS) {
+        now += 250;
+        size_t length = encoder.encode(reading(7.0f, now, true), frame);
+        if (length == WEIGHT_FRAME_KEY_SIZE) {
+            keys++;
+            TEST_ASSERT_EQUAL_UINT32(0, now % WEIGHT_FRAME_KEY_PERIOD_MS);
+            TEST_ASSERT_TRUE(frame[1] & WEIGHT_FRAME_KEY);
+        } else {
+            TEST_ASSERT_EQUAL(0, length);
+            suppressed++;
+        }
+    }
+    TEST_ASSERT_EQUAL(3, keys);
+    TEST_ASSERT_EQUAL(3 * WEIGHT_FRAME_KEY_PERIOD_MS / 250 - 3, suppressed);
+}
+
+static void test_malformed_frames_are_rejected() {
+    WeightFrameEncoder encoder;
+    WeightFrameDecoder decoder;
+    uint8_t frame[WEIGHT_FRAME_MAX_SIZE];
+    WeightFrame out;
+
+    size_t length = encoder.encode(reading(1.0f, 0), frame);
+    TEST_ASSERT_FALSE(decoder.decode(frame, length - 1, out));   // truncated
+    TEST_ASSERT_FALSE(decoder.decode(frame, 1, out));
+
+    frame[0] = WEIGHT_FRAME_VERSION + 1;
+    TEST_ASSERT_FALSE(decoder.decode(frame, length, out));
+
+    // A delta before any key frame has nothing to apply to
+    WeightFrameDecoder fresh;
+    encoder.encode(reading(2.0f, 100), frame);
+    TEST_ASSERT_FALSE(fresh.decode(frame, WEIGHT_FRAME_DELTA_SIZE, out));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_unchanged_reading_is_suppressed);
+    RUN_TEST(test_delta_overflow_sends_a_key_frame);
+    RUN_TEST(test_sequence_gap_waits_for_a_key_frame);
+    RUN_TEST(test_heartbeat_key_frame_when_idle);
+    RUN_TEST(test_malformed_frames_are_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,104 @@
+"""Compare two benchmark reports from the bench firmware (src/main-bench.cpp).
+
+Each argument is a report: /bench.json from the card or the web UI, or a
+serial/stdout log that contains the report line. Results are matched by
+name and params; distributions compare p50 and p95, single values compare
+the value. Lower is better except for rates ("sps", "ops").
+
+    python tools/bench_diff.py baseline.json run.log [--threshold 10] [--floor 5]
+
+Exits with 1 when any result regressed by more than the threshold (percent)
+and by more than the floor (absolute, in the result's unit), or disappeared,
+so it can gate a CI job.
+"""
+
+import argparse
+import json
+import sys
+
+HIGHER_IS_BETTER = {"sps", "ops"}
+SUITE_MARKER = '{"suite":"scale-bench"'
+
+
+def load_report(path):
+    with open(path, encoding="utf-8", errors="replace") as f:
+        text = f.read()
+    start = text.find(SUITE_MARKER)
+    if start < 0:
+        sys.exit(f"{path}: no scale-bench report found")
+    report, _ = json.JSONDecoder().raw_decode(text[start:])
+    return report
+
+
+def result_key(result):
+    params = ",".join(f"{k}={v}" for k, v in sorted(result["params"].items()))
+    return f"{result['name']}[{params}]" if params else result["name"]
+
+
+def metrics(result):
+    if "value" in result:
+        return {"value": result["value"]}
+    return {"p50": result["p50"], "p95": result["p95"]}
+
+
+def change(old, new, unit):
+    """Signed regression in percent: positive is worse."""
+    if old == new:
+        return 0.0
+    if old == 0:
+        return float("inf") if new > old else float("-inf")
+    pct = (new - old) / abs(old) * 100
+    return -pct if unit in HIGHER_IS_BETTER else pct
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="regression in percent that fails the run (default 10)")
+    parser.add_argument("--floor", type=float, default=5.0,
+                        help="ignore changes smaller than this, in the result's unit (default 5)")
+    args = parser.parse_args()
+
+    base = load_report(args.baseline)
+    cur = load_report(args.current)
+    if base.get("platform") != cur.get("platform"):
+        print(f"note: comparing {base.get('platform')} against {cur.get('platform')}")
+
+    base_results = {result_key(r): r for r in base["results"]}
+    cur_results = {result_key(r): r for r in cur["results"]}
+
+    failed = False
+    width = max((len(k) for k in base_results.keys() | cur_results.keys()), default=10)
+    for key, old in base_results.items():
+        new = cur_results.get(key)
+        if new is None:
+            print(f"{key:<{width}}  MISSING")
+            failed = True
+            continue
+        unit = old["unit"]
+        for metric, old_value in metrics(old).items():
+            new_value = metrics(new).get(metric)
+            if new_value is None:
+                continue
+            pct = change(old_value, new_value, unit)
+            flag = ""
+            if abs(new_value - old_value) < args.floor:
+                pass
+            elif pct > args.threshold:
+                flag = "  REGRESSED"
+                failed = True
+            elif pct < -args.threshold:
+                flag = "  improved"
+            print(f"{key:<{width}}  {metric:>5} {old_value:>12g} -> {new_value:>12g} {unit:<5} "
+                  f"{-pct if unit in HIGHER_IS_BETTER else pct:+7.1f}%{flag}")
+
+    for key in cur_results.keys() - base_results.keys():
+        print(f"{key:<{width}}  new")
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
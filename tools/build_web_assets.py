@@ -0,0 +1,102 @@
+"""Build-time web asset pipeline.
+
+Minifies and gzips everything listed in ASSETS from web/ into
+src/WebAssets.h: a flash-resident table of gzip blobs with strong ETags,
+served by WebServerManager with Content-Encoding: gzip and 304 handling.
+
+Runs as a PlatformIO pre-build script (extra_scripts = pre:...) and can
+also be run by hand: python tools/build_web_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+# (request path, file in web/, content type)
+ASSETS = [
+    ("/", "index.html", "text/html"),
+    ("/piechart.js", "piechart.js", "application/javascript"),
+]
+
+
+def project_dir():
+    try:
+        Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+        return env.subst("$PROJECT_DIR")  # noqa: F821
+    except NameError:
+        return os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def minify(text):
+    # Conservative: trim indentation, drop blank lines and whole-line //
+    # comments. Newlines stay so JS automatic semicolon insertion is safe.
+    lines = []
+    for line in text.splitlines():
+        line = line.strip()
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    text = "\n".join(lines)
+    return re.sub(r">\n<", "><", text)
+
+
+def c_identifier(path):
+    name = re.sub(r"[^0-9a-zA-Z]", "_", path.strip("/")) or "index"
+    return "asset_" + name
+
+
+def build(root):
+    web_dir = os.path.join(root, "web")
+    out_path = os.path.join(root, "src", "WebAssets.h")
+
+    blobs = []
+    for path, filename, content_type in ASSETS:
+        with open(os.path.join(web_dir, filename), "r", encoding="utf-8") as f:
+            source = f.read()
+        raw = minify(source).encode("utf-8")
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        etag = '"%s"' % hashlib.sha256(packed).hexdigest()[:16]
+        blobs.append((path, content_type, c_identifier(path), packed, etag, len(source)))
+
+    out = [
+        "// Generated by tools/build_web_assets.py from web/ - do not edit.",
+        "#pragma once",
+        "#include <Arduino.h>",
+        "",
+        "struct WebAsset {",
+        "    const char*    path;",
+        "    const char*    contentType;",
+        "    const uint8_t* gzipData;",
+        "    size_t         gzipLength;",
+        "    const char*    etag;",
+        "};",
+        "",
+    ]
+    for path, _, ident, packed, _, _ in blobs:
+        out.append("static const uint8_t %s[] PROGMEM = {" % ident)
+        for i in range(0, len(packed), 20):
+            out.append("    " + ", ".join("0x%02x" % b for b in packed[i:i + 20]) + ",")
+        out.append("};")
+        out.append("")
+
+    out.append("static const WebAsset webAssets[] = {")
+    for path, content_type, ident, packed, etag, _ in blobs:
+        out.append('    { "%s", "%s", %s, sizeof(%s), "%s" },'
+                   % (path, content_type, ident, ident, etag.replace('"', '\\"')))
+    out.append("};")
+    out.append("")
+    text = "\n".join(out)
+
+    # Only touch the header when it changes, so builds stay incremental
+    if os.path.exists(out_path):
+        with open(out_path, "r", encoding="utf-8") as f:
+            if f.read() == text:
+                return
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write(text)
+    for path, _, _, packed, _, size in blobs:
+        print("web asset %-14s %6d -> %5d bytes gzip" % (path, size, len(packed)))
+
+
+build(project_dir())
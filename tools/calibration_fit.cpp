@@ -0,0 +1,68 @@
+// Host-side fitter for /calibration.csv files recorded by env:calibration.
+//
+//   g++ -std=c++17 -O2 -Isrc tools/calibration_fit.cpp src/CalibrationModel.cpp -o calibration_fit
+//   ./calibration_fit calibration.csv [calibration-1.csv ...] [-o calibration.bin]
+//
+// Copy the written calibration.bin to the SD card root; scale_setup() moves
+// it into NVS on the next boot.
+
+#include "CalibrationModel.h"
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    const char* outPath = nullptr;
+    CalibrationFitter fitter;
+    int files = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+            continue;
+        }
+
+        FILE* f = fopen(argv[i], "r");
+        if (!f) {
+            fprintf(stderr, "cannot open %s\n", argv[i]);
+            return 1;
+        }
+        char line[256];
+        size_t before = fitter.rowCount();
+        while (fgets(line, sizeof(line), f)) fitter.addCsvLine(line);
+        fclose(f);
+        printf("%s: %zu rows\n", argv[i], fitter.rowCount() - before);
+        files++;
+    }
+
+    if (files == 0) {
+        fprintf(stderr, "usage: %s calibration.csv [...] [-o calibration.bin]\n", argv[0]);
+        return 1;
+    }
+
+    CalibrationModel model;
+    if (!fitter.fit(model)) {
+        fprintf(stderr, "fit failed: need zero-load and reference rows over a temperature range\n");
+        return 1;
+    }
+
+    float span = fitter.maxTemperature() - fitter.minTemperature();
+    printf("temperature  %.1f .. %.1f degC\n", fitter.minTemperature(), fitter.maxTemperature());
+    printf("offset       %.1f counts %+.3f counts/degC\n", model.offset0, model.offsetSlope);
+    printf("gain         %.5f counts/g %+.7f counts/g/degC\n", model.gain0, model.gainSlope);
+    printf("zero drift   %.2f g over the recorded range (uncompensated)\n",
+           model.offsetSlope * span / model.gain0);
+    printf("span drift   %.3f %% over the recorded range (uncompensated)\n",
+           100.0f * model.gainSlope * span / model.gain0);
+    printf("residual     %.2f g rms (compensated)\n", fitter.residualGrams(model));
+
+    if (outPath) {
+        FILE* out = fopen(outPath, "wb");
+        if (!out || fwrite(&model, sizeof(model), 1, out) != 1) {
+            fprintf(stderr, "cannot write %s\n", outPath);
+            return 1;
+        }
+        fclose(out);
+        printf("wrote %s (%zu bytes)\n", outPath, sizeof(model));
+    }
+    return 0;
+}
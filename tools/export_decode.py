@@ -0,0 +1,112 @@
+"""Turn a binary food log export (/export.bin, see src/LogExport.h) into CSV.
+
+    curl -u user:pass -o log.bin "http://scale.local/export.bin?from=1767225600"
+    python tools/export_decode.py log.bin > log.csv
+
+The columns are those of /export.csv except time, which the binary format
+does not carry: it is rebuilt from ts in the local time zone of this
+machine, or left empty when the entry was logged before the clock synced.
+A stream that stops before its end marker is decoded up to the last whole
+block and reported on stderr, with the log_id to pass as after= to resume.
+"""
+
+import argparse
+import csv
+import sys
+import time
+
+MAGIC = b"SCLG"
+VERSION = 1
+VALUE_COLUMNS = ("grams", "calories", "protein", "carbs", "fat")
+
+
+class Truncated(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def varint(self):
+        value = shift = 0
+        while True:
+            if self.pos >= len(self.data):
+                raise Truncated()
+            byte = self.data[self.pos]
+            self.pos += 1
+            value |= (byte & 0x7F) << shift
+            if byte < 0x80:
+                return value
+            shift += 7
+
+    def zigzag(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def bytes(self, n):
+        if self.pos + n > len(self.data):
+            raise Truncated()
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+
+def decode(data, writer):
+    """Writes every row; returns (rows, complete, last log_id)."""
+    if data[:4] != MAGIC or len(data) < 5 or data[4] != VERSION:
+        sys.exit("not a version 1 food log export")
+    r = Reader(data)
+    r.pos = 5
+    log_id = ts = rows = written = 0
+
+    while True:
+        try:
+            count = r.varint()
+            if count == 0:
+                return rows, True, written
+            names = []
+            for _ in range(r.varint()):
+                food_id = r.varint()
+                names.append((food_id, r.bytes(r.varint()).decode("utf-8", errors="replace")))
+            ids, stamps = [], []
+            for _ in range(count):
+                log_id += r.zigzag()
+                ids.append(log_id)
+            for _ in range(count):
+                ts += r.zigzag()
+                stamps.append(ts)
+            foods = [names[r.varint()] for _ in range(count)]
+            values = [[r.zigzag() / 100 for _ in range(count)] for _ in VALUE_COLUMNS]
+        except Truncated:
+            return rows, False, written
+
+        for i in range(count):
+            local = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(stamps[i])) if stamps[i] else ""
+            writer.writerow([ids[i], local, stamps[i] or "", foods[i][0], foods[i][1],
+                             f"{values[0][i]:.1f}"] + [f"{column[i]:.2f}" for column in values[1:]])
+        rows += count
+        written = log_id
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("export", help="binary export file")
+    args = parser.parse_args()
+
+    with open(args.export, "rb") as f:
+        data = f.read()
+    writer = csv.writer(sys.stdout, lineterminator="\n")
+    writer.writerow(["log_id", "time", "ts", "food_id", "food"] + list(VALUE_COLUMNS))
+    rows, complete, last = decode(data, writer)
+
+    if not complete:
+        # Blocks are written whole, so the rows so far are all good
+        print(f"{args.export}: truncated after {rows} rows; resume with after={last}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
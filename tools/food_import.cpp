@@ -0,0 +1,163 @@
+// Host-side bulk import of a nutrition CSV into a scale database, to preload
+// a large public table before the card goes into the scale.
+//
+//   g++ -std=c++17 -O2 -Isrc tools/food_import.cpp src/CsvReader.cpp src/FoodCsv.cpp -lsqlite3 -o food_import
+//   ./food_import foods.csv food.db [-b rows-per-transaction] [-n]
+//
+// Same tokenizer, column mapping, single reused INSERT and batching as
+// FoodImporter on the scale, and the same rule for names the catalogue
+// already has, or was given earlier in the same file (skipped). -n parses without a database, to time the
+// tokenizer alone. Copy food.db to the card root as /food.db; the scale
+// creates the rest of its schema on the next boot.
+
+#include "CsvReader.h"
+#include "FoodCsv.h"
+#include <sqlite3.h>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+
+#define IMPORT_BLOCK_SIZE 32768   // as on the scale
+#define IMPORT_BATCH_ROWS 1000
+
+struct Import {
+    sqlite3*      db = nullptr;
+    sqlite3_stmt* insert = nullptr;
+    FoodCsvColumns columns;
+    bool          headerChecked = false;
+    int           batch = IMPORT_BATCH_ROWS;
+    int           batchRows = 0;
+    uint64_t      rows = 0, added = 0, duplicates = 0, failed = 0;
+    std::unordered_set<std::string> existing;   // folded names, the ones added here included
+};
+
+// As FoodIndex::fold and the scale's idx_food_name: trimmed, ASCII lower case
+static std::string fold(const char* name) {
+    while (*name == ' ') ++name;
+    std::string s(name);
+    while (!s.empty() && s.back() == ' ') s.pop_back();
+    for (char& c : s) c = (char)tolower((unsigned char)c);
+    return s;
+}
+
+static bool onRow(void* ctx, const CsvRow& row) {
+    Import& im = *static_cast<Import*>(ctx);
+    if (!im.headerChecked) {
+        im.headerChecked = true;
+        if (im.columns.readHeader(row)) return true;
+    }
+
+    im.rows++;
+    const char* name;
+    FoodMacros per100g;
+    if (!im.columns.parse(row, name, per100g)) {
+        im.failed++;
+        return true;
+    }
+    if (!im.db) return true;
+    if (!im.existing.insert(fold(name)).second) {
+        im.duplicates++;
+        return true;
+    }
+
+    if (im.batchRows == 0) sqlite3_exec(im.db, "BEGIN;", nullptr, nullptr, nullptr);
+    sqlite3_bind_text(im.insert, 1, name, -1, SQLITE_STATIC);
+    sqlite3_bind_double(im.insert, 2, per100g.calories);
+    sqlite3_bind_double(im.insert, 3, per100g.protein);
+    sqlite3_bind_double(im.insert, 4, per100g.carbs);
+    sqlite3_bind_double(im.insert, 5, per100g.fat);
+    if (sqlite3_step(im.insert) == SQLITE_DONE) im.added++;
+    else im.failed++;
+    sqlite3_reset(im.insert);
+
+    if (++im.batchRows >= im.batch) {
+        sqlite3_exec(im.db, "COMMIT;", nullptr, nullptr, nullptr);
+        im.batchRows = 0;
+    }
+    return true;
+}
+
+static bool openDatabase(Import& im, const char* path) {
+    if (sqlite3_open(path, &im.db) != SQLITE_OK) {
+        fprintf(stderr, "cannot open %s: %s\n", path, sqlite3_errmsg(im.db));
+        return false;
+    }
+    // Same columns as FoodManager::begin() creates
+    const char* schema = R"(
+        PRAGMA journal_mode = WAL;
+        CREATE TABLE IF NOT EXISTS Food (
+            food_id INTEGER PRIMARY KEY AUTOINCREMENT,
+            name TEXT NOT NULL,
+            calories REAL,
+            protein REAL,
+            carbs REAL,
+            fat REAL
+        );
+    )";
+    char* err = nullptr;
+    if (sqlite3_exec(im.db, schema, nullptr, nullptr, &err) != SQLITE_OK) {
+        fprintf(stderr, "schema: %s\n", err);
+        sqlite3_free(err);
+        return false;
+    }
+
+    sqlite3_stmt* names;
+    sqlite3_prepare_v2(im.db, "SELECT name FROM Food;", -1, &names, nullptr);
+    while (sqlite3_step(names) == SQLITE_ROW) im.existing.insert(fold((const char*)sqlite3_column_text(names, 0)));
+    sqlite3_finalize(names);
+
+    return sqlite3_prepare_v3(im.db, "INSERT INTO Food (name, calories, protein, carbs, fat) VALUES (?, ?, ?, ?, ?);",
+                              -1, SQLITE_PREPARE_PERSISTENT, &im.insert, nullptr) == SQLITE_OK;
+}
+
+int main(int argc, char** argv) {
+    const char* csvPath = nullptr;
+    const char* dbPath = nullptr;
+    bool parseOnly = false;
+    Import im;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0) parseOnly = true;
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) im.batch = atoi(argv[++i]);
+        else if (!csvPath) csvPath = argv[i];
+        else dbPath = argv[i];
+    }
+    if (!csvPath || (!dbPath && !parseOnly) || im.batch < 1) {
+        fprintf(stderr, "usage: %s foods.csv food.db [-b rows-per-transaction] [-n]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* f = fopen(csvPath, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", csvPath);
+        return 1;
+    }
+    if (!parseOnly && !openDatabase(im, dbPath)) return 1;
+
+    static char block[IMPORT_BLOCK_SIZE];
+    CsvReader csv(block, sizeof(block));
+    auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    size_t n;
+    while (ok && (n = fread(csv.space(), 1, csv.spaceLeft(), f)) > 0) ok = csv.commit(n, onRow, &im);
+    if (ok) ok = csv.finish(onRow, &im);
+    fclose(f);
+
+    if (im.batchRows) sqlite3_exec(im.db, "COMMIT;", nullptr, nullptr, nullptr);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (im.db) {
+        sqlite3_finalize(im.insert);
+        sqlite3_close(im.db);
+    }
+
+    if (!ok) fprintf(stderr, "%s\n", csv.overflowed() ? "row longer than the import block" : "import stopped");
+    printf("%llu rows, %llu added, %llu duplicates, %llu failed, %.1f MB in %.2f s: %.0f rows/s, %.1f MB/s\n",
+           (unsigned long long)im.rows, (unsigned long long)im.added, (unsigned long long)im.duplicates,
+           (unsigned long long)im.failed, csv.bytes() / 1e6, seconds, im.rows / seconds,
+           csv.bytes() / 1e6 / seconds);
+    return ok ? 0 : 1;
+}
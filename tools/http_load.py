@@ -0,0 +1,147 @@
+"""Load generator for the scale's HTTP server (src/HttpServer.cpp).
+
+Opens a number of keep-alive connections and keeps each one busy for a fixed
+time, optionally pipelining several requests per round trip. Works against
+the device or the native build (env:native listens on :8080):
+
+    python tools/http_load.py http://localhost:8080 /daily /foods/search?q=ap \\
+        --connections 6 --pipeline 4 --duration 10 --user admin --password ...
+
+Paths are requested round-robin. Prints throughput, latency percentiles
+(from sending a request to the end of its response) and the status codes
+seen; exits with 1 if any request failed or a connection was dropped.
+"""
+
+import argparse
+import asyncio
+import base64
+import sys
+import time
+from collections import Counter
+from urllib.parse import urlsplit
+
+
+class Stats:
+    def __init__(self):
+        self.latencies = []
+        self.statuses = Counter()
+        self.errors = Counter()
+        self.bytes = 0
+
+
+async def read_response(reader):
+    """Reads one response; returns (status, body length)."""
+    status_line = await reader.readline()
+    if not status_line:
+        raise ConnectionError("closed by server")
+    status = int(status_line.split()[1])
+    length = None
+    chunked = False
+    close = False
+    while True:
+        line = await reader.readline()
+        if line in (b"\r\n", b""):
+            break
+        name, _, value = line.decode("latin-1").partition(":")
+        name = name.strip().lower()
+        value = value.strip().lower()
+        if name == "content-length":
+            length = int(value)
+        elif name == "transfer-encoding" and "chunked" in value:
+            chunked = True
+        elif name == "connection" and value == "close":
+            close = True
+
+    size = 0
+    if chunked:
+        while True:
+            chunk = int((await reader.readline()).split(b";")[0], 16)
+            await reader.readexactly(chunk + 2)
+            size += chunk
+            if chunk == 0:
+                break
+    elif length:
+        await reader.readexactly(length)
+        size = length
+    if close:
+        raise ConnectionResetError("server asked to close")
+    return status, size
+
+
+async def worker(host, port, requests, pipeline, deadline, stats):
+    reader, writer = await asyncio.open_connection(host, port)
+    index = 0
+    try:
+        while time.monotonic() < deadline:
+            batch = [requests[(index + i) % len(requests)] for i in range(pipeline)]
+            index += pipeline
+            start = time.perf_counter()
+            writer.write(b"".join(batch))
+            await writer.drain()
+            for _ in batch:
+                status, size = await read_response(reader)
+                stats.latencies.append(time.perf_counter() - start)
+                stats.statuses[status] += 1
+                stats.bytes += size
+    except (ConnectionError, asyncio.IncompleteReadError) as e:
+        stats.errors[type(e).__name__] += 1
+    finally:
+        writer.close()
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    rank = max(0, min(len(values) - 1, int(round(pct / 100 * len(values) + 0.5)) - 1))
+    return values[rank]
+
+
+async def run(args):
+    url = urlsplit(args.url)
+    host = url.hostname
+    port = url.port or 80
+
+    headers = f"Host: {url.netloc}\r\n"
+    if args.user:
+        token = base64.b64encode(f"{args.user}:{args.password}".encode()).decode()
+        headers += f"Authorization: Basic {token}\r\n"
+    requests = [f"GET {path} HTTP/1.1\r\n{headers}\r\n".encode() for path in args.paths or ["/daily"]]
+
+    stats = Stats()
+    deadline = time.monotonic() + args.duration
+    started = time.perf_counter()
+    await asyncio.gather(*(worker(host, port, requests, args.pipeline, deadline, stats)
+                           for _ in range(args.connections)))
+    elapsed = time.perf_counter() - started
+
+    lat = sorted(stats.latencies)
+    total = len(lat)
+    print(f"{total} requests in {elapsed:.1f} s over {args.connections} connections, "
+          f"pipeline {args.pipeline}")
+    print(f"  throughput {total / elapsed:10.1f} req/s  {stats.bytes / elapsed / 1024:8.1f} KiB/s")
+    if lat:
+        print("  latency ms  p50 {:.2f}  p95 {:.2f}  p99 {:.2f}  max {:.2f}".format(
+            *(percentile(lat, p) * 1000 for p in (50, 95, 99)), lat[-1] * 1000))
+    print("  status      " + "  ".join(f"{code}: {n}" for code, n in sorted(stats.statuses.items())))
+    if stats.errors:
+        print("  errors      " + "  ".join(f"{name}: {n}" for name, n in stats.errors.items()))
+
+    failed = sum(n for code, n in stats.statuses.items() if code >= 400)
+    return 1 if failed or stats.errors else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("url", help="server base, e.g. http://localhost:8080")
+    parser.add_argument("paths", nargs="*", help="request paths, round-robin (default /daily)")
+    parser.add_argument("--connections", type=int, default=6)
+    parser.add_argument("--pipeline", type=int, default=1, help="requests in flight per connection")
+    parser.add_argument("--duration", type=float, default=10.0, help="seconds")
+    parser.add_argument("--user")
+    parser.add_argument("--password", default="")
+    args = parser.parse_args()
+    return asyncio.run(run(args))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
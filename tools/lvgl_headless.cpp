@@ -0,0 +1,119 @@
+// Headless LVGL harness for the display UI: runs LvglScreen + ScreenModel on
+// Linux against an in-memory framebuffer, no SDL or panel needed.
+//
+//   mkdir -p build/lvgl && for f in $(find lib/lvgl/src -name '*.c'); do
+//       gcc -c -O2 -Ilib -DLV_CONF_INCLUDE_SIMPLE $f -o build/lvgl/$(basename $f .c).o; done
+//   g++ -std=c++17 -O2 -Ilib -Ilib/lvgl -Isrc -Iinclude -DLV_CONF_INCLUDE_SIMPLE -DDISPLAY_BACKEND_LVGL
+//       tools/lvgl_headless.cpp src/LvglScreen.cpp src/ScreenModel.cpp build/lvgl/*.o -o lvgl_headless
+//   ./lvgl_headless [frames] [-o screen.ppm]
+//
+// Simulates a live weight readout at 25 Hz and reports how many pixels each
+// frame flushed and how long rendering took, then optionally dumps the last
+// frame as a PPM image.
+
+#include "LvglScreen.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define HOR_RES 320
+#define VER_RES 170
+
+static lv_color_t framebuffer[HOR_RES * VER_RES];
+static uint32_t flushedPixels = 0;
+
+static void flush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* pixels) {
+    int32_t w = area->x2 - area->x1 + 1;
+    for (int32_t y = area->y1; y <= area->y2; ++y) {
+        memcpy(&framebuffer[y * HOR_RES + area->x1], pixels, w * sizeof(lv_color_t));
+        pixels += w;
+    }
+    flushedPixels += w * (area->y2 - area->y1 + 1);
+    lv_disp_flush_ready(drv);
+}
+
+static void writePpm(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", HOR_RES, VER_RES);
+    for (lv_color_t c : framebuffer) {
+        lv_color32_t rgb;
+        rgb.full = lv_color_to32(c);
+        fputc(rgb.ch.red, f);
+        fputc(rgb.ch.green, f);
+        fputc(rgb.ch.blue, f);
+    }
+    fclose(f);
+    printf("wrote %s\n", path);
+}
+
+int main(int argc, char** argv) {
+    int frames = 250;
+    const char* ppmPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) ppmPath = argv[++i];
+        else frames = atoi(argv[i]);
+    }
+
+    lv_init();
+
+    // Same partial double buffering as the device
+    static lv_color_t buf1[HOR_RES * 40], buf2[HOR_RES * 40];
+    static lv_disp_draw_buf_t drawBuffer;
+    lv_disp_draw_buf_init(&drawBuffer, buf1, buf2, HOR_RES * 40);
+
+    static lv_disp_drv_t driver;
+    lv_disp_drv_init(&driver);
+    driver.hor_res = HOR_RES;
+    driver.ver_res = VER_RES;
+    driver.flush_cb = flush;
+    driver.draw_buf = &drawBuffer;
+    lv_disp_drv_register(&driver);
+
+    ScreenModel model;
+    LvglScreen screen;
+    screen.create(lv_scr_act());
+    model.invalidate();
+    model.set(FIELD_TITLE, "Kitchen Scale");
+    model.set(FIELD_FOOD, "Banana");
+    model.set(FIELD_TOTALS_TITLE, "Daily Totals:");
+    model.set(FIELD_TOTALS1, "Cal: 1250  Prot: 64");
+    model.set(FIELD_TOTALS2, "Carb: 140  Fat:  41");
+    model.set(FIELD_MODE, "Mode: STA");
+    model.set(FIELD_IP, "IP: 192.168.0.42");
+
+    double totalMs = 0, maxMs = 0;
+    uint32_t firstFramePixels = 0, totalPixels = 0;
+
+    for (int frame = 0; frame < frames; ++frame) {
+        // A banana settling on the scale: ramps up, then sits at 118 g
+        float grams = frame < 50 ? frame * 2.4f : 118.0f + (frame % 7 == 0);
+        model.setf(FIELD_WEIGHT, "Wt: %5.0f g", grams);
+        model.setf(FIELD_FOOD_MACROS1, "Cal: %.0f  Prot: %.0f", 0.89f * grams, 0.011f * grams);
+        model.setf(FIELD_FOOD_MACROS2, "Carb: %.0f  Fat:  %.0f", 0.23f * grams, 0.003f * grams);
+
+        flushedPixels = 0;
+        auto start = std::chrono::steady_clock::now();
+        screen.render(model);
+        lv_tick_inc(40);
+        lv_refr_now(nullptr);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (frame == 0) firstFramePixels = flushedPixels;
+        else totalPixels += flushedPixels;
+        totalMs += ms;
+        if (ms > maxMs) maxMs = ms;
+    }
+
+    printf("frames       %d\n", frames);
+    printf("first frame  %u px (full screen %d)\n", firstFramePixels, HOR_RES * VER_RES);
+    printf("later frames %.0f px avg flushed\n", frames > 1 ? (double)totalPixels / (frames - 1) : 0.0);
+    printf("render       %.3f ms avg, %.3f ms max (host)\n", totalMs / frames, maxMs);
+
+    if (ppmPath) writePpm(ppmPath);
+    return 0;
+}
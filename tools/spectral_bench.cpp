@@ -0,0 +1,87 @@
+// Host-side accuracy and latency check for SpectralClassifier over
+// /spectrum_log.csv files recorded by the scale.
+//
+//   g++ -std=c++17 -O2 -Isrc tools/spectral_bench.cpp src/SpectralClassifier.cpp -o spectral_bench
+//   ./spectral_bench spectrum_log.csv [...] [-f folds]
+//
+// Rows are dealt round-robin into folds; each fold is classified against a
+// model trained on the others, so every row is tested exactly once.
+
+#include "SpectralClassifier.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    int folds = 5;
+    std::vector<std::string> lines;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            folds = std::max(2, atoi(argv[++i]));
+            continue;
+        }
+        FILE* f = fopen(argv[i], "r");
+        if (!f) {
+            fprintf(stderr, "cannot open %s\n", argv[i]);
+            return 1;
+        }
+        char line[256], food[64];
+        uint16_t channels[SPECTRAL_CHANNELS];
+        while (fgets(line, sizeof(line), f)) {
+            if (SpectralClassifier::parseCsvLine(line, food, sizeof(food), channels)) lines.emplace_back(line);
+        }
+        fclose(f);
+    }
+
+    if (lines.empty()) {
+        fprintf(stderr, "usage: %s spectrum_log.csv [...] [-f folds]\n", argv[0]);
+        return 1;
+    }
+
+    size_t tested = 0, top1 = 0, top3 = 0, rejected = 0;
+    double totalUs = 0, maxUs = 0;
+
+    for (int fold = 0; fold < folds; ++fold) {
+        SpectralClassifier model;
+        for (size_t i = 0; i < lines.size(); ++i) {
+            if ((int)(i % folds) != fold) model.addCsvLine(lines[i].c_str());
+        }
+
+        for (size_t i = fold; i < lines.size(); i += folds) {
+            char truth[64];
+            uint16_t channels[SPECTRAL_CHANNELS];
+            SpectralClassifier::parseCsvLine(lines[i].c_str(), truth, sizeof(truth), channels);
+
+            SpectralCandidate out[SPECTRAL_MAX_CANDIDATES];
+            auto start = std::chrono::steady_clock::now();
+            size_t n = model.classify(channels, out, SPECTRAL_MAX_CANDIDATES);
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            totalUs += us;
+            maxUs = std::max(maxUs, us);
+            tested++;
+
+            if (n == 0) {
+                rejected++;
+                continue;
+            }
+            for (size_t c = 0; c < n && c < 3; ++c) {
+                if (strcmp(model.label(out[c].label), truth) != 0) continue;
+                if (c == 0) top1++;
+                top3++;
+                break;
+            }
+        }
+    }
+
+    printf("rows         %zu in %d folds\n", tested, folds);
+    printf("top-1        %.1f %%\n", 100.0 * top1 / tested);
+    printf("top-3        %.1f %%\n", 100.0 * top3 / tested);
+    printf("rejected     %zu (no references or too dark)\n", rejected);
+    printf("latency      %.2f us mean, %.2f us max (host)\n", totalUs / tested, maxUs);
+    return 0;
+}
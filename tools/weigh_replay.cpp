@@ -0,0 +1,172 @@
+// Host replay of labelled load-cell traces through WeightFilter and
+// WeighEventDetector, as Scale_LoadCell runs them on the scale.
+//
+//   g++ -std=c++17 -O2 -Isrc tools/weigh_replay.cpp src/WeighEvent.cpp src/WeightFilter.cpp -o weigh_replay
+//   ./weigh_replay tools/traces/*.csv [-v]
+//
+// Traces come from tools/weigh_traces.py (or a real scale, same format).
+// An added/removed label is detected when an event of the same kind
+// completes before the next label; its weight is right within
+// WEIGH_REPLAY_TOLERANCE. Any other added/removed event is a false
+// detection. Latency runs from the labelled start of the action to the
+// event. Exits with 1 on a miss, a false detection or a wrong weight.
+
+#include "WeighEvent.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define WEIGH_REPLAY_TOLERANCE_GRAMS 2.0f    // weight error allowed, or
+#define WEIGH_REPLAY_TOLERANCE_RATIO 0.03f   // this share of the item, if more
+#define WEIGH_REPLAY_WINDOW_MS       8000    // longest wait for an event after its label
+
+struct Label {
+    uint32_t ms;
+    bool     item;     // false for touch
+    float    grams;
+};
+
+struct Result {
+    int      items = 0;
+    int      hits = 0;
+    int      wrongWeight = 0;
+    int      falseEvents = 0;
+    int      settled = 0;
+    float    maxError = 0;
+    uint64_t samples = 0;
+    double   detectorNs = 0;
+    std::vector<uint32_t> latencies;
+};
+
+static uint32_t percentile(std::vector<uint32_t> values, int pct) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t rank = std::min(values.size() - 1, (values.size() * pct + 99) / 100 - 1);
+    return values[rank];
+}
+
+static bool replay(const char* path, bool verbose, Result& result) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+
+    WeightFilter filter;
+    WeighEventDetector detector;
+    std::vector<Label> labels;
+    std::vector<WeighEvent> events;
+    char line[128];
+
+    while (fgets(line, sizeof(line), f)) {
+        char* end;
+        uint32_t ms = strtoul(line, &end, 10);
+        if (end == line || *end != ',') continue;   // comment or header
+        float grams = strtof(end + 1, &end);
+        const char* label = *end == ',' ? end + 1 : "";
+
+        if (strncmp(label, "added:", 6) == 0 || strncmp(label, "removed:", 8) == 0) {
+            labels.push_back({ms, true, strtof(strchr(label, ':') + 1, nullptr)});
+        } else if (strncmp(label, "touch", 5) == 0) {
+            labels.push_back({ms, false, 0});
+        }
+
+        const WeightReading& reading = filter.push(grams, ms);
+        WeighEvent event;
+        auto start = std::chrono::steady_clock::now();
+        bool done = detector.push(reading, event);
+        result.detectorNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        result.samples++;
+        if (done) events.push_back(event);
+    }
+    fclose(f);
+
+    std::vector<bool> used(events.size(), false);
+    for (size_t i = 0; i < labels.size(); ++i) {
+        const Label& label = labels[i];
+        if (!label.item) continue;
+        result.items++;
+
+        uint32_t until = label.ms + WEIGH_REPLAY_WINDOW_MS;
+        if (i + 1 < labels.size()) until = std::min(until, labels[i + 1].ms);
+        WeighEventType want = label.grams > 0 ? WEIGH_ADDED : WEIGH_REMOVED;
+
+        for (size_t e = 0; e < events.size(); ++e) {
+            const WeighEvent& event = events[e];
+            if (used[e] || event.type != want || event.timestamp < label.ms || event.timestamp >= until) continue;
+            used[e] = true;
+            result.hits++;
+            result.latencies.push_back(event.timestamp - label.ms);
+
+            float error = std::fabs(event.grams - label.grams);
+            result.maxError = std::max(result.maxError, error);
+            if (error > std::max(WEIGH_REPLAY_TOLERANCE_GRAMS, WEIGH_REPLAY_TOLERANCE_RATIO * std::fabs(label.grams))) {
+                result.wrongWeight++;
+            }
+            break;
+        }
+    }
+
+    for (size_t e = 0; e < events.size(); ++e) {
+        const WeighEvent& event = events[e];
+        if (event.type == WEIGH_SETTLED) result.settled++;
+        else if (!used[e]) result.falseEvents++;
+
+        if (verbose) {
+            printf("  %7u ms  %-8s %+8.1f g  level %7.1f g  onset %u ms%s\n", event.timestamp,
+                   weighEvent_typeName(event.type), event.grams, event.level, event.onsetMs,
+                   event.type != WEIGH_SETTLED && !used[e] ? "  FALSE" : "");
+        }
+    }
+    return true;
+}
+
+static void print(const char* name, const Result& r) {
+    printf("%-28s items %3d/%-3d false %2d  wrong weight %2d  settled %2d  "
+           "latency ms p50 %4u p95 %4u max %4u  max error %.2f g  %.0f ns/sample\n",
+           name, r.hits, r.items, r.falseEvents, r.wrongWeight, r.settled,
+           percentile(r.latencies, 50), percentile(r.latencies, 95), percentile(r.latencies, 100),
+           r.maxError, r.samples ? r.detectorNs / r.samples : 0.0);
+}
+
+int main(int argc, char** argv) {
+    bool verbose = false;
+    Result total;
+    int files = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+            continue;
+        }
+
+        Result r;
+        if (!replay(argv[i], verbose, r)) return 1;
+        const char* name = strrchr(argv[i], '/');
+        print(name ? name + 1 : argv[i], r);
+        files++;
+
+        total.items += r.items;
+        total.hits += r.hits;
+        total.wrongWeight += r.wrongWeight;
+        total.falseEvents += r.falseEvents;
+        total.settled += r.settled;
+        total.maxError = std::max(total.maxError, r.maxError);
+        total.samples += r.samples;
+        total.detectorNs += r.detectorNs;
+        total.latencies.insert(total.latencies.end(), r.latencies.begin(), r.latencies.end());
+    }
+
+    if (files == 0) {
+        fprintf(stderr, "usage: %s trace.csv [...] [-v]\n", argv[0]);
+        return 1;
+    }
+    if (files > 1) print("total", total);
+
+    bool ok = total.hits == total.items && total.falseEvents == 0 && total.wrongWeight == 0;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+"""Writes the labelled load-cell traces in tools/traces/ for weigh_replay.
+
+Each trace is a CSV of calibrated, tared samples as Scale_LoadCell feeds
+them to the filter chain, plus the ground truth on the sample where a hand
+starts the action:
+
+    ms,grams,label
+    0,0.21,
+    5000,-0.14,added:180
+    ...
+
+Labels are added:<g>, removed:<g> (negative grams) and touch (the load is
+disturbed but nothing changes). The load model has HX711 noise, single
+sample spikes, slow creep, hand pressure while placing or lifting, pours as
+ramps with short pauses, and the platform ringing after a drop. Seeds are
+fixed, so rerunning reproduces the committed files:
+
+    python tools/weigh_traces.py [outdir]
+
+Traces recorded on a real scale in the same format can sit alongside.
+"""
+
+import math
+import os
+import random
+import sys
+
+
+class Trace:
+    def __init__(self, name, sps, seed, description):
+        self.name = name
+        self.period = 1000 // sps
+        self.rng = random.Random(seed)
+        self.description = description
+        self.actions = []   # (start ms, fn(ms) -> grams offset, label)
+        self.end = 0
+
+    def at(self, ms, fn, label=""):
+        self.actions.append((ms, fn, label))
+        self.end = max(self.end, ms)
+
+    # The hand presses a little while setting the item down, lets go, and
+    # the platform rings for a moment
+    def place(self, ms, grams):
+        rng = self.rng
+        press = rng.uniform(0.15, 0.4) * max(grams, 30)
+        down = rng.uniform(200, 450)
+        hold = rng.uniform(100, 400)
+        ring = rng.uniform(1.5, 4.0)
+
+        def fn(t):
+            if t < down:
+                return (grams + press) * t / down
+            if t < down + hold:
+                return grams + press
+            t -= down + hold
+            return grams + press * math.exp(-t / 60) + ring * math.exp(-t / 300) * math.sin(t / 25)
+        self.at(ms, fn, f"added:{grams:g}")
+
+    # Grabbing pushes down first, then the load goes
+    def remove(self, ms, grams):
+        rng = self.rng
+        press = rng.uniform(5, 25)
+        grab = rng.uniform(150, 350)
+        lift = rng.uniform(150, 300)
+
+        def fn(t):
+            if t < grab:
+                return press * t / grab
+            if t < grab + lift:
+                return press - (press + grams) * (t - grab) / lift
+            return -grams + 2.0 * math.exp(-(t - grab - lift) / 200) * math.sin(t / 30)
+        self.at(ms, fn, f"removed:{-grams:g}")
+
+    # A stream that slows down, with the odd short pause
+    def pour(self, ms, grams, duration):
+        rng = self.rng
+        pause_at = rng.uniform(0.3, 0.7) * duration
+        pause = rng.uniform(100, 250)
+
+        def fn(t):
+            if t > pause_at:
+                t = max(pause_at, t - pause)
+            x = min(1.0, t / duration)
+            return grams * (1 - (1 - x) ** 2) + (rng.gauss(0, 0.6) if x < 1 else 0)
+        self.at(ms, fn, f"added:{grams:g}")
+
+    def touch(self, ms, grams, duration):
+        def fn(t):
+            if t >= duration:
+                return 0.0
+            return grams * math.sin(math.pi * t / duration)
+        self.at(ms, fn, "touch")
+
+    def stir(self, ms, grams, duration):
+        def fn(t):
+            if t >= duration:
+                return 0.0
+            return grams * math.sin(t / 70) * math.sin(math.pi * t / duration)
+        self.at(ms, fn, "touch")
+
+    def write(self, outdir, tail_ms=6000, noise=0.3, creep_per_s=0.01, spikes_per_min=4):
+        rng = self.rng
+        actions = sorted(self.actions, key=lambda a: a[0])
+        labels = {}
+        for start, _, label in actions:
+            if label:
+                labels[start - start % self.period] = label
+
+        path = os.path.join(outdir, self.name + ".csv")
+        with open(path, "w") as f:
+            f.write(f"# {self.description}\n")
+            f.write("ms,grams,label\n")
+            for ms in range(0, self.end + tail_ms, self.period):
+                grams = sum(fn(ms - start) for start, fn, _ in actions if ms >= start)
+                grams += rng.gauss(0, noise) + creep_per_s * ms / 1000
+                if rng.random() < spikes_per_min * self.period / 60000:
+                    grams += rng.choice((-1, 1)) * rng.uniform(20, 80)
+                f.write(f"{ms},{grams:.2f},{labels.get(ms, '')}\n")
+        return path
+
+
+def meal(name, sps, seed):
+    t = Trace(name, sps, seed, f"Plate, three foods and a sauce on it in turn, {sps} SPS")
+    t.place(3000, 350)
+    t.place(10000, 180)
+    t.touch(16000, 25, 500)
+    t.place(20000, 120)
+    t.pour(27000, 45, 2500)
+    t.stir(34000, 6, 1500)
+    t.place(39000, 12)
+    return t
+
+
+def pours(name, sps, seed):
+    t = Trace(name, sps, seed, f"Bowl, then pours of different size and speed, {sps} SPS")
+    t.place(2000, 420)
+    t.pour(8000, 30, 1500)
+    t.pour(15000, 250, 4000)
+    t.pour(25000, 8, 1000)
+    t.place(31000, 4)
+    t.pour(36000, 90, 2000)
+    return t
+
+
+def disturbances(name, sps, seed):
+    t = Trace(name, sps, seed, f"One plate, then touches, stirs and spikes that must not log, {sps} SPS")
+    t.place(2000, 300)
+    for i in range(8):
+        start = 8000 + i * 4500
+        if i % 2:
+            t.stir(start, t.rng.uniform(3, 10), t.rng.uniform(800, 2000))
+        else:
+            t.touch(start, t.rng.uniform(10, 60), t.rng.uniform(200, 900))
+    t.end += 2000
+    return t
+
+
+def clearing(name, sps, seed):
+    t = Trace(name, sps, seed, f"Foods added, then taken off one by one and the plate last, {sps} SPS")
+    t.place(2000, 280)
+    t.place(8000, 150)
+    t.place(14000, 60)
+    t.remove(21000, 60)
+    t.remove(27000, 150)
+    t.touch(32000, 20, 400)
+    t.remove(36000, 280)
+    return t
+
+
+def main():
+    outdir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), "traces")
+    os.makedirs(outdir, exist_ok=True)
+    traces = [
+        meal("meal_10sps", 10, 1),
+        meal("meal_80sps", 80, 2),
+        pours("pours_10sps", 10, 3),
+        pours("pours_80sps", 80, 4),
+        disturbances("disturbances_10sps", 10, 5),
+        clearing("clearing_10sps", 10, 6),
+    ]
+    for trace in traces:
+        print(trace.write(outdir))
+
+
+if __name__ == "__main__":
+    main()
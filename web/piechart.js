@@ -0,0 +1,122 @@
+// Minimal pie and stacked bar charts with the subset of the Chart.js API
+// the scale UI uses:
+//   var c = new Chart(ctx, { type: 'pie', data: { labels, datasets: [{ data, backgroundColor }] },
+//                            options: { plugins: { legend: { position: 'bottom' } } } });
+//   c.data.datasets[0].data = [...]; c.update();
+// type: 'bar' stacks every dataset ({ label, data, backgroundColor: one
+// color }) on one bar per label, as Chart.js does with stacked scales.
+// Served from flash so the page works in AP mode without a CDN.
+(function (global) {
+  function Chart(ctx, config) {
+    this.ctx = ctx;
+    this.type = config.type || 'pie';
+    this.data = config.data;
+    this.options = config.options || {};
+    this.update();
+  }
+
+  Chart.prototype.update = function () {
+    if (this.type === 'bar') return this.drawBars();
+    var ctx = this.ctx, canvas = ctx.canvas;
+    var w = canvas.width, h = canvas.height;
+    var ds = this.data.datasets[0] || { data: [], backgroundColor: [] };
+    var labels = this.data.labels || [];
+    var legendRows = labels.length ? Math.ceil(labels.length / 3) : 0;
+    var legendHeight = legendRows * 18 + (legendRows ? 8 : 0);
+    var r = Math.max(0, Math.min(w, h - legendHeight) / 2 - 4);
+    var cx = w / 2, cy = r + 4;
+
+    ctx.clearRect(0, 0, w, h);
+
+    var total = ds.data.reduce(function (a, b) { return a + (+b || 0); }, 0);
+    var angle = -Math.PI / 2;
+    ds.data.forEach(function (v, i) {
+      if (!total || !(+v > 0)) return;
+      var slice = (v / total) * Math.PI * 2;
+      ctx.beginPath();
+      ctx.moveTo(cx, cy);
+      ctx.arc(cx, cy, r, angle, angle + slice);
+      ctx.closePath();
+      ctx.fillStyle = ds.backgroundColor[i] || '#999';
+      ctx.fill();
+      ctx.strokeStyle = '#fff';
+      ctx.lineWidth = 2;
+      ctx.stroke();
+      angle += slice;
+    });
+
+    ctx.font = '12px Arial';
+    ctx.textBaseline = 'middle';
+    var colWidth = w / 3;
+    labels.forEach(function (label, i) {
+      var x = (i % 3) * colWidth + 6, y = 2 * r + 16 + Math.floor(i / 3) * 18;
+      ctx.fillStyle = ds.backgroundColor[i] || '#999';
+      ctx.fillRect(x, y - 6, 12, 12);
+      ctx.fillStyle = '#333';
+      ctx.fillText(label, x + 16, y);
+    });
+  };
+
+  Chart.prototype.drawBars = function () {
+    var ctx = this.ctx, canvas = ctx.canvas;
+    var w = canvas.width, h = canvas.height;
+    var labels = this.data.labels || [], sets = this.data.datasets || [];
+    var legendHeight = sets.length ? 22 : 0, axisWidth = 40, bottom = h - legendHeight - 16;
+
+    ctx.clearRect(0, 0, w, h);
+
+    var max = 0;
+    labels.forEach(function (_, i) {
+      var sum = sets.reduce(function (a, ds) { return a + (+ds.data[i] || 0); }, 0);
+      max = Math.max(max, sum);
+    });
+    max = max || 1;
+
+    ctx.font = '12px Arial';
+    ctx.textBaseline = 'middle';
+    ctx.fillStyle = '#333';
+    ctx.strokeStyle = '#ccc';
+    ctx.lineWidth = 1;
+    [0, 0.5, 1].forEach(function (f) {
+      var y = bottom - f * (bottom - 8);
+      ctx.fillText(Math.round(max * f), 2, y);
+      ctx.beginPath();
+      ctx.moveTo(axisWidth, y);
+      ctx.lineTo(w, y);
+      ctx.stroke();
+    });
+
+    var slot = (w - axisWidth) / Math.max(1, labels.length);
+    var barWidth = Math.max(1, slot * 0.8);
+    labels.forEach(function (label, i) {
+      var x = axisWidth + i * slot + (slot - barWidth) / 2, y = bottom;
+      sets.forEach(function (ds) {
+        var v = +ds.data[i] || 0;
+        if (v <= 0) return;
+        var bh = v / max * (bottom - 8);
+        ctx.fillStyle = ds.backgroundColor || '#999';
+        ctx.fillRect(x, y - bh, barWidth, bh);
+        y -= bh;
+      });
+    });
+
+    // First and last label under the axis; a bar per day leaves no room for more
+    ctx.fillStyle = '#333';
+    if (labels.length) {
+      ctx.fillText(labels[0], axisWidth, bottom + 8);
+      var last = labels[labels.length - 1];
+      ctx.fillText(last, w - ctx.measureText(last).width - 2, bottom + 8);
+    }
+
+    var x = axisWidth;
+    sets.forEach(function (ds) {
+      ctx.fillStyle = ds.backgroundColor || '#999';
+      ctx.fillRect(x, h - 14, 12, 12);
+      ctx.fillStyle = '#333';
+      ctx.fillText(ds.label, x + 16, h - 8);
+      x += ctx.measureText(ds.label).width + 32;
+    });
+  };
+
+  global.Chart = Chart;
+})(window);